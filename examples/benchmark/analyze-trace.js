@@ -1,6 +1,19 @@
 const fs = require('fs');
 
-const trace = JSON.parse(fs.readFileSync('Trace-20251205T165313.json', 'utf8'));
+// 用法: node analyze-trace.js [trace.json | 串口日志]
+// 也接受 Rasen 原生运行时的 trace（模拟器 --profile 的输出，或 ESP32 打印的日志）
+const traceFile = process.argv[2] || 'Trace-20251205T165313.json';
+let traceText = fs.readFileSync(traceFile, 'utf8');
+
+// 串口日志：只取标记行之间的 JSON
+const begin = traceText.indexOf('----- rasen trace begin -----');
+if (begin >= 0) {
+  const start = traceText.indexOf('{', begin);
+  const end = traceText.indexOf('----- rasen trace end -----', start);
+  traceText = traceText.slice(start, end < 0 ? undefined : end);
+}
+
+const trace = JSON.parse(traceText);
 
 // 统计事件
 const eventStats = {};
@@ -0,0 +1,309 @@
+/**
+ * Build-time feature selection
+ *
+ * Works out from the bundled app which element types, Tailwind fonts and
+ * engine parts the device needs, and writes them as a C header for the
+ * native build (RASEN_FEATURES_H, see native/common/qjs_rasen.h) and as
+ * an sdkconfig fragment for ESP-IDF. Anything it can't prove unused
+ * (namespace imports, class strings built at runtime) is kept.
+ */
+
+const fs = require('fs')
+const { FONT_SIZES, findClassSites, parseClass } = require('./tw-compiler.cjs')
+
+// Element types that can be left out: RASEN_USE_<TYPE>, CONFIG_LV_USE_<TYPE>
+const TYPES = [
+  'BAR',
+  'IMG',
+  'SLIDER',
+  'SWITCH',
+  'CHECKBOX',
+  'TEXTAREA',
+  'ARC',
+  'SPINNER',
+  'ROLLER',
+  'DROPDOWN',
+  'TABLE',
+  'CHART'
+]
+
+// @rasenjs/lvgl exports -> the types they create (div, label, button: always)
+const COMPONENT_TYPES = {
+  image: ['IMG'],
+  slider: ['SLIDER'],
+  lvSwitch: ['SWITCH'],
+  checkbox: ['CHECKBOX'],
+  textarea: ['TEXTAREA'],
+  arc: ['ARC'],
+  bar: ['BAR'],
+  spinner: ['SPINNER'],
+  dropdown: ['DROPDOWN'],
+  roller: ['ROLLER'],
+  table: ['TABLE'],
+  chart: ['CHART']
+}
+
+// Descriptor `type` strings -> feature, for descriptors apps append themselves
+const DESC_TYPES = {
+  bar: 'BAR',
+  img: 'IMG',
+  slider: 'SLIDER',
+  switch: 'SWITCH',
+  checkbox: 'CHECKBOX',
+  textarea: 'TEXTAREA',
+  arc: 'ARC',
+  spinner: 'SPINNER',
+  roller: 'ROLLER',
+  dropdown: 'DROPDOWN',
+  table: 'TABLE',
+  chart: 'CHART'
+}
+
+const DESC_TYPE_RE = /\btype\s*:\s*(["'`])(\w+)\1/g
+
+// LVGL widgets built on others (lv_slider is an lv_bar, lv_spinner an lv_arc)
+const WIDGET_DEPS = {
+  SLIDER: ['BAR'],
+  SPINNER: ['ARC']
+}
+
+// LV_FONT_DEFAULT on the ESP32 config; always linked
+const DEFAULT_FONT = 14
+
+const IMPORT_RE =
+  /\bimport\s*(\*\s*as\s+\w+|\{([^}]*)\})\s*from\s*(["'])@rasenjs\/lvgl\3/g
+
+// ============ Imports ============
+
+/**
+ * Names imported from @rasenjs/lvgl, or null when any export may be used
+ */
+function importedNames(code) {
+  const names = new Set()
+  let found = false
+  let m
+  IMPORT_RE.lastIndex = 0
+  while ((m = IMPORT_RE.exec(code))) {
+    found = true
+    if (!m[2]) return null
+    for (const spec of m[2].split(',')) {
+      const name = spec.trim().split(/\s+as\s+/)[0]
+      if (name) names.add(name)
+    }
+  }
+  return found ? names : null
+}
+
+// ============ RegExp Use ============
+
+// Tokens after which `/` starts a regular expression rather than a division
+const REGEX_AFTER = new Set('(,=:[!&|?{};+-*%<>~^'.split(''))
+const REGEX_KEYWORDS = new Set([
+  'return',
+  'typeof',
+  'case',
+  'do',
+  'else',
+  'in',
+  'of',
+  'new',
+  'delete',
+  'void',
+  'throw',
+  'yield',
+  'await'
+])
+
+// String methods that build a RegExp from a string argument
+const IMPLICIT_REGEXP_RE = /\.(match|matchAll|search)\s*\(/
+
+/**
+ * True when the script uses regular expressions: literals, RegExp, or
+ * String methods that create one. Strings, templates and comments are
+ * skipped; `/` is a regex only where an operand may start.
+ */
+function usesRegExp(code) {
+  let prev = '('
+  let i = 0
+  const templates = [] // Brace depth of each open ${ ... }
+
+  while (i < code.length) {
+    const c = code[i]
+
+    if (c === '/' && code[i + 1] === '/') {
+      const end = code.indexOf('\n', i)
+      i = end < 0 ? code.length : end
+    } else if (c === '/' && code[i + 1] === '*') {
+      const end = code.indexOf('*/', i + 2)
+      i = end < 0 ? code.length : end + 2
+    } else if (c === '"' || c === "'") {
+      i++
+      while (i < code.length && code[i] !== c && code[i] !== '\n') {
+        i += code[i] === '\\' ? 2 : 1
+      }
+      i++
+      prev = 'str'
+    } else if (c === '`' || (c === '}' && templates.at(-1) === 0)) {
+      // Template text up to the closing backtick or the next ${
+      if (c === '}') templates.pop()
+      i++
+      while (i < code.length && code[i] !== '`') {
+        if (code[i] === '\\') {
+          i += 2
+        } else if (code[i] === '$' && code[i + 1] === '{') {
+          break
+        } else {
+          i++
+        }
+      }
+      if (code[i] === '$') {
+        templates.push(0)
+        i += 2
+        prev = '('
+      } else {
+        i++
+        prev = 'str'
+      }
+    } else if (c === '/') {
+      if (REGEX_AFTER.has(prev) || REGEX_KEYWORDS.has(prev)) return true
+      i++
+      prev = '/'
+    } else if (/[A-Za-z_$]/.test(c)) {
+      const m = /^[\w$]+/.exec(code.slice(i, i + 64))
+      const word = m[0]
+      if (word === 'RegExp') return true
+      i += word.length
+      prev = word
+    } else if (/\s/.test(c)) {
+      i++
+    } else {
+      if (templates.length) {
+        if (c === '{') templates[templates.length - 1]++
+        if (c === '}') templates[templates.length - 1]--
+      }
+      if (c === '.' && IMPLICIT_REGEXP_RE.test(code.slice(i, i + 16))) {
+        return true
+      }
+      i++
+      prev = /[0-9.]/.test(c) ? 'num' : c === ')' || c === ']' ? ')' : c
+    }
+  }
+  return false
+}
+
+// ============ Detection ============
+
+/**
+ * Features the bundled (not yet precompiled) app needs
+ * @param {string} code - esbuild output
+ * @param {{ precompile: boolean }} options
+ */
+function detectFeatures(code, { precompile }) {
+  const names = importedNames(code)
+  const types = new Set(names ? [] : TYPES)
+  if (names) {
+    for (const name of names) {
+      for (const t of COMPONENT_TYPES[name] || []) types.add(t)
+    }
+  }
+
+  // Raw descriptors the app builds itself
+  DESC_TYPE_RE.lastIndex = 0
+  let m
+  while ((m = DESC_TYPE_RE.exec(code))) {
+    if (DESC_TYPES[m[2]]) types.add(DESC_TYPES[m[2]])
+  }
+
+  // Class strings that survive precompilation are parsed on the device
+  const found = findClassSites(code)
+  const dynamicClasses = !found || found.dynamic
+  let palette = false
+  const fonts = new Set()
+
+  for (const site of found ? found.sites : []) {
+    const s = parseClass(site.value)
+    if (s.fontSize) fonts.add(s.fontSize)
+    if (s.namedColor && (!precompile || s.dynamic || s.unknown)) palette = true
+  }
+
+  if (dynamicClasses) {
+    palette = true
+    FONT_SIZES.forEach((size) => fonts.add(size))
+  }
+
+  return { types, fonts, palette, regexp: usesRegExp(code), dynamicClasses }
+}
+
+// ============ Output ============
+
+function featuresHeader(name, f) {
+  const lines = [
+    '/**',
+    ` * Features used by ${name}, generated by rasen-lvgl build`,
+    ' * Build the runtime with RASEN_FEATURES_H="<path to this file>"',
+    ' */',
+    '',
+    '#ifndef RASEN_APP_FEATURES_H',
+    '#define RASEN_APP_FEATURES_H',
+    '',
+    '// Element types'
+  ]
+  for (const t of TYPES) {
+    lines.push(`#define RASEN_USE_${t} ${f.types.has(t) ? 1 : 0}`)
+  }
+  lines.push('', '// Tailwind parser')
+  lines.push(`#define RASEN_TW_PALETTE ${f.palette ? 1 : 0}`)
+  for (const size of FONT_SIZES) {
+    lines.push(`#define RASEN_TW_FONT_${size} ${f.fonts.has(size) ? 1 : 0}`)
+  }
+  lines.push('', '// Engine')
+  lines.push(`#define RASEN_USE_REGEXP ${f.regexp ? 1 : 0}`)
+  lines.push('', '#endif // RASEN_APP_FEATURES_H', '')
+  return lines.join('\n')
+}
+
+function sdkconfigFragment(name, f) {
+  const option = (key, on) => (on ? `${key}=y` : `# ${key} is not set`)
+  const widgets = new Set(f.types)
+  for (const t of f.types) {
+    for (const dep of WIDGET_DEPS[t] || []) widgets.add(dep)
+  }
+
+  const lines = [
+    `# Features used by ${name}, generated by rasen-lvgl build`,
+    '# Applied on top of sdkconfig.defaults when sdkconfig is created',
+    ''
+  ]
+  for (const t of TYPES) {
+    lines.push(option(`CONFIG_LV_USE_${t}`, widgets.has(t)))
+  }
+  lines.push('')
+  for (const size of FONT_SIZES) {
+    const on = size === DEFAULT_FONT || f.fonts.has(size)
+    lines.push(option(`CONFIG_LV_FONT_MONTSERRAT_${size}`, on))
+  }
+  lines.push('')
+  lines.push(option('CONFIG_RASEN_TW_PALETTE', f.palette))
+  lines.push(option('CONFIG_RASEN_USE_REGEXP', f.regexp))
+  lines.push('')
+  return lines.join('\n')
+}
+
+/**
+ * Write <name>_features.h and <name>.sdkconfig
+ * @returns {string} one-line summary
+ */
+function writeFeatures(f, { name, headerFile, sdkconfigFile }) {
+  fs.writeFileSync(headerFile, featuresHeader(name, f))
+  fs.writeFileSync(sdkconfigFile, sdkconfigFragment(name, f))
+
+  const fonts = [...FONT_SIZES].filter((size) => f.fonts.has(size))
+  return [
+    `${f.types.size} of ${TYPES.length} element types`,
+    fonts.length ? `fonts ${fonts.join('/')}` : 'no text-* fonts',
+    f.palette ? 'color names' : 'no color names',
+    f.regexp ? 'RegExp' : 'no RegExp'
+  ].join(', ')
+}
+
+module.exports = { detectFeatures, writeFeatures }
@@ -0,0 +1,64 @@
+import { describe, it, expect } from 'vitest'
+import { detectFeatures } from './features.cjs'
+
+const detect = (code) => detectFeatures(code, { precompile: true })
+
+describe('detectFeatures element types', () => {
+  it('selects the types of imported components', () => {
+    const f = detect("import { div, slider } from '@rasenjs/lvgl'")
+    expect([...f.types].sort()).toEqual(['SLIDER'])
+  })
+
+  it('selects table for the table component', () => {
+    const f = detect("import { div, table } from '@rasenjs/lvgl'")
+    expect([...f.types]).toEqual(['TABLE'])
+  })
+
+  it('selects table for raw table descriptors', () => {
+    const f = detect(`
+      import { div } from '@rasenjs/lvgl'
+      host.appendChild({ type: 'table', children: [] })
+    `)
+    expect(f.types.has('TABLE')).toBe(true)
+  })
+
+  it('keeps every type, table included, when imports are unresolved', () => {
+    const f = detect("import * as lv from '@rasenjs/lvgl'")
+    expect(f.types.has('TABLE')).toBe(true)
+    expect(f.types.has('CHART')).toBe(true)
+  })
+
+  it('leaves table out when nothing creates one', () => {
+    const f = detect("import { div, label } from '@rasenjs/lvgl'")
+    expect(f.types.has('TABLE')).toBe(false)
+  })
+})
+
+describe('detectFeatures class strings', () => {
+  const lvgl = "import { div } from '@rasenjs/lvgl'\n"
+
+  it('takes fonts from literal classes and drops precompiled colors', () => {
+    const f = detect(lvgl + "div({ class: 'text-lg bg-red-500' })")
+    expect(f.dynamicClasses).toBe(false)
+    expect([...f.fonts]).toEqual([18])
+    expect(f.palette).toBe(false)
+  })
+
+  it('keeps the palette for classes left to the device', () => {
+    const f = detect(lvgl + "div({ class: 'bg-red-500 shadow' })")
+    expect(f.palette).toBe(true)
+  })
+
+  it('ignores class keys outside component props', () => {
+    const f = detect(lvgl + "const u = { class: name }\ndiv({ class: 'p-2' })")
+    expect(f.dynamicClasses).toBe(false)
+  })
+
+  it('keeps everything for classes built at runtime', () => {
+    for (const call of ['div(props)', 'div({ class: c })', 'div({ ...p })']) {
+      const f = detect(lvgl + call)
+      expect(f.dynamicClasses).toBe(true)
+      expect(f.palette).toBe(true)
+    }
+  })
+})
@@ -0,0 +1,370 @@
+/**
+ * Build-time image converter
+ *
+ * Decodes the PNGs an app refers to and writes them in the display's
+ * native pixel format as an image table (see native/common/rasen_img.h),
+ * so the device draws them straight from flash instead of decoding them.
+ */
+
+const path = require('path')
+const fs = require('fs')
+const zlib = require('zlib')
+
+const TABLE_VERSION = 1
+const HEADER_SIZE = 16
+const ENTRY_SIZE = 20
+const FLAG_SWAP = 0x01
+
+const ENC_RAW = 0
+const ENC_RLE = 1
+
+// lv_img_cf_t
+const CF_TRUE_COLOR = 4
+const CF_TRUE_COLOR_ALPHA = 5
+
+// lv_img_header_t keeps width and height in 11 bits
+const MAX_SIZE = 2047
+
+// Display formats; must match LV_COLOR_DEPTH / LV_COLOR_16_SWAP on the device
+const COLOR_FORMATS = {
+  rgb565: { depth: 16, swap: false },
+  'rgb565-swap': { depth: 16, swap: true },
+  argb8888: { depth: 32, swap: false }
+}
+
+// ============ PNG Decoding ============
+
+const CHANNELS = { 0: 1, 2: 3, 3: 1, 4: 2, 6: 4 }
+
+function paeth(a, b, c) {
+  const p = a + b - c
+  const pa = Math.abs(p - a)
+  const pb = Math.abs(p - b)
+  const pc = Math.abs(p - c)
+  if (pa <= pb && pa <= pc) return a
+  return pb <= pc ? b : c
+}
+
+// Reverse the per-row filters in place; returns the packed rows
+function unfilter(raw, height, stride, bpp) {
+  const out = Buffer.alloc(height * stride)
+  for (let y = 0; y < height; y++) {
+    const filter = raw[y * (stride + 1)]
+    const src = y * (stride + 1) + 1
+    const row = y * stride
+    const prev = row - stride
+    for (let x = 0; x < stride; x++) {
+      const a = x >= bpp ? out[row + x - bpp] : 0
+      const b = y > 0 ? out[prev + x] : 0
+      const c = x >= bpp && y > 0 ? out[prev + x - bpp] : 0
+      let v = raw[src + x]
+      if (filter === 1) v += a
+      else if (filter === 2) v += b
+      else if (filter === 3) v += (a + b) >> 1
+      else if (filter === 4) v += paeth(a, b, c)
+      else if (filter !== 0) throw new Error(`bad filter ${filter}`)
+      out[row + x] = v & 0xff
+    }
+  }
+  return out
+}
+
+/**
+ * Decode a non-interlaced PNG of any color type and bit depth
+ * @returns {{ width: number, height: number, rgba: Buffer }}
+ */
+function decodePng(buf) {
+  if (buf.length < 8 || buf.readUInt32BE(0) !== 0x89504e47) {
+    throw new Error('not a PNG file')
+  }
+
+  let header = null
+  let palette = null
+  let trns = null
+  const idat = []
+  for (let off = 8; off + 8 <= buf.length; ) {
+    const len = buf.readUInt32BE(off)
+    const type = buf.toString('latin1', off + 4, off + 8)
+    const data = buf.subarray(off + 8, off + 8 + len)
+    off += 12 + len
+
+    if (type === 'IHDR') {
+      header = {
+        width: data.readUInt32BE(0),
+        height: data.readUInt32BE(4),
+        depth: data[8],
+        colorType: data[9],
+        interlace: data[12]
+      }
+    } else if (type === 'PLTE') {
+      palette = data
+    } else if (type === 'tRNS') {
+      trns = data
+    } else if (type === 'IDAT') {
+      idat.push(data)
+    } else if (type === 'IEND') {
+      break
+    }
+  }
+
+  if (!header || !CHANNELS[header.colorType]) throw new Error('unsupported PNG')
+  if (header.interlace) throw new Error('interlaced PNGs are not supported')
+  if (header.colorType === 3 && !palette) throw new Error('missing palette')
+
+  const { width, height, depth, colorType } = header
+  const channels = CHANNELS[colorType]
+  const bits = channels * depth
+  const stride = Math.ceil((width * bits) / 8)
+  const rows = unfilter(
+    zlib.inflateSync(Buffer.concat(idat)),
+    height,
+    stride,
+    Math.max(1, bits >> 3)
+  )
+
+  const max = (1 << depth) - 1
+  const sample = (row, i) => {
+    if (depth === 8) return rows[row + i]
+    if (depth === 16) return rows.readUInt16BE(row + i * 2)
+    const bit = i * depth
+    return (rows[row + (bit >> 3)] >> (8 - depth - (bit & 7))) & max
+  }
+  const scale = (v) => (depth === 8 ? v : Math.round((v * 255) / max))
+  const keyed = (v, i) => trns && trns.length >= i * 2 + 2 && trns.readUInt16BE(i * 2) === v
+
+  const rgba = Buffer.alloc(width * height * 4)
+  for (let y = 0; y < height; y++) {
+    const row = y * stride
+    for (let x = 0; x < width; x++) {
+      const s = x * channels
+      const o = (y * width + x) * 4
+      if (colorType === 3) {
+        const index = sample(row, s)
+        palette.copy(rgba, o, index * 3, index * 3 + 3)
+        rgba[o + 3] = trns && index < trns.length ? trns[index] : 255
+      } else if (colorType === 0 || colorType === 4) {
+        const g = sample(row, s)
+        rgba.fill(scale(g), o, o + 3)
+        rgba[o + 3] = colorType === 4 ? scale(sample(row, s + 1)) : keyed(g, 0) ? 0 : 255
+      } else {
+        const r = sample(row, s)
+        const g = sample(row, s + 1)
+        const b = sample(row, s + 2)
+        rgba[o] = scale(r)
+        rgba[o + 1] = scale(g)
+        rgba[o + 2] = scale(b)
+        rgba[o + 3] =
+          colorType === 6
+            ? scale(sample(row, s + 3))
+            : keyed(r, 0) && keyed(g, 1) && keyed(b, 2)
+              ? 0
+              : 255
+      }
+    }
+  }
+
+  return { width, height, rgba }
+}
+
+// ============ Pixel Conversion ============
+
+/**
+ * Convert RGBA pixels to LV_IMG_CF_TRUE_COLOR(_ALPHA) for a display format
+ * @returns {{ cf: number, px: number, data: Buffer }}
+ */
+function convertPixels(rgba, format) {
+  let opaque = true
+  for (let i = 3; i < rgba.length; i += 4) {
+    if (rgba[i] !== 255) {
+      opaque = false
+      break
+    }
+  }
+
+  const count = rgba.length / 4
+  const colorSize = format.depth / 8
+  const px = format.depth === 32 ? 4 : opaque ? 2 : 3
+  const data = Buffer.alloc(count * px)
+
+  for (let i = 0; i < count; i++) {
+    const r = rgba[i * 4]
+    const g = rgba[i * 4 + 1]
+    const b = rgba[i * 4 + 2]
+    const a = rgba[i * 4 + 3]
+    const o = i * px
+    if (format.depth === 32) {
+      // lv_color32_t is stored blue, green, red, alpha
+      data[o] = b
+      data[o + 1] = g
+      data[o + 2] = r
+      data[o + 3] = opaque ? 255 : a
+    } else {
+      const c = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+      if (format.swap) data.writeUInt16BE(c, o)
+      else data.writeUInt16LE(c, o)
+      if (!opaque) data[o + colorSize] = a
+    }
+  }
+
+  return { cf: opaque ? CF_TRUE_COLOR : CF_TRUE_COLOR_ALPHA, px, data }
+}
+
+/**
+ * RLE over whole pixels, as decoded by rle_decode() in rasen_img.c
+ */
+function rleEncode(data, px) {
+  const count = data.length / px
+  const out = []
+  const same = (i, j) => data.compare(data, i * px, i * px + px, j * px, j * px + px) === 0
+
+  let i = 0
+  while (i < count) {
+    let run = 1
+    while (i + run < count && run < 128 && same(i, i + run)) run++
+    if (run >= 2) {
+      out.push(Buffer.from([0x80 | (run - 1)]), data.subarray(i * px, i * px + px))
+      i += run
+      continue
+    }
+
+    // Literals up to the next run of two
+    let lit = 1
+    while (i + lit < count && lit < 128 && !(i + lit + 1 < count && same(i + lit, i + lit + 1))) lit++
+    out.push(Buffer.from([lit - 1]), data.subarray(i * px, (i + lit) * px))
+    i += lit
+  }
+  return Buffer.concat(out)
+}
+
+// ============ Image Table ============
+
+/**
+ * Convert PNG files into an image table
+ * @param {{ name: string, file: string }[]} images
+ * @param {{ color: string, compress: boolean }} options
+ * @returns {{ table: Buffer, entries: { name: string, width: number, height: number, size: number, encoding: number }[] }}
+ */
+function encodeImageTable(images, options) {
+  const format = COLOR_FORMATS[options.color]
+  if (!format) throw new Error(`unknown color format '${options.color}'`)
+
+  const entries = []
+  for (const image of images) {
+    const { width, height, rgba } = decodePng(fs.readFileSync(image.file))
+    if (width > MAX_SIZE || height > MAX_SIZE) {
+      throw new Error(`${image.name}: ${width}x${height} exceeds ${MAX_SIZE}px`)
+    }
+
+    const { cf, px, data } = convertPixels(rgba, format)
+    let encoding = ENC_RAW
+    let payload = data
+    if (options.compress) {
+      const packed = rleEncode(data, px)
+      // RLE entries are decoded into RAM; only worth it when they halve flash
+      if (packed.length * 2 <= data.length) {
+        encoding = ENC_RLE
+        payload = packed
+      }
+    }
+    entries.push({ name: image.name, width, height, cf, encoding, data: payload })
+  }
+
+  // rasen_img_lookup() binary-searches with strcmp()
+  entries.sort((a, b) => Buffer.compare(Buffer.from(a.name), Buffer.from(b.name)))
+
+  const align4 = (n) => (n + 3) & ~3
+  const names = entries.map((e) => Buffer.from(e.name + '\0'))
+  let offset = HEADER_SIZE + entries.length * ENTRY_SIZE
+  const nameOffsets = names.map((n) => {
+    const at = offset
+    offset += n.length
+    return at
+  })
+  const dataOffsets = entries.map((e) => {
+    offset = align4(offset)
+    const at = offset
+    offset += e.data.length
+    return at
+  })
+
+  const table = Buffer.alloc(align4(offset))
+  table.write('RIMG', 0, 'latin1')
+  table.writeUInt8(TABLE_VERSION, 4)
+  table.writeUInt8(format.depth, 5)
+  table.writeUInt8(format.swap ? FLAG_SWAP : 0, 6)
+  table.writeUInt16LE(entries.length, 8)
+
+  entries.forEach((e, i) => {
+    const at = HEADER_SIZE + i * ENTRY_SIZE
+    table.writeUInt32LE(nameOffsets[i], at)
+    table.writeUInt32LE(dataOffsets[i], at + 4)
+    table.writeUInt32LE(e.data.length, at + 8)
+    table.writeUInt16LE(e.width, at + 12)
+    table.writeUInt16LE(e.height, at + 14)
+    table.writeUInt8(e.cf, at + 16)
+    table.writeUInt8(e.encoding, at + 17)
+    names[i].copy(table, nameOffsets[i])
+    e.data.copy(table, dataOffsets[i])
+  })
+
+  return {
+    table,
+    entries: entries.map(({ name, width, height, encoding, data }) => ({
+      name,
+      width,
+      height,
+      encoding,
+      size: data.length
+    }))
+  }
+}
+
+// ============ Source Scanning ============
+
+// '...png' / "...png" string literals with no escapes
+const PNG_LITERAL_RE = /(["'])([^"'\\\n]+\.png)\1/gi
+
+function walkPngs(dir, out) {
+  for (const entry of fs.readdirSync(dir, { withFileTypes: true })) {
+    const file = path.join(dir, entry.name)
+    if (entry.isDirectory()) walkPngs(file, out)
+    else if (/\.png$/i.test(entry.name)) out.push(file)
+  }
+  return out
+}
+
+/**
+ * Find the PNGs a bundle refers to by literal path, plus every PNG in
+ * the extra directories. Names are paths relative to the project root
+ * with forward slashes, as written in `image({ src })`.
+ * @returns {{ name: string, file: string }[]}
+ */
+function findImages(code, { root, entryDir, dirs = [] }) {
+  const images = new Map()
+
+  for (const [, , literal] of code.matchAll(PNG_LITERAL_RE)) {
+    if (images.has(literal)) continue
+    const file = [root, entryDir]
+      .map((base) => path.resolve(base, literal))
+      .find((candidate) => fs.existsSync(candidate))
+    if (file) images.set(literal, file)
+  }
+
+  for (const dir of dirs) {
+    for (const file of walkPngs(path.resolve(root, dir), [])) {
+      const name = path.relative(root, file).split(path.sep).join('/')
+      if (!images.has(name)) images.set(name, file)
+    }
+  }
+
+  return [...images].map(([name, file]) => ({ name, file }))
+}
+
+module.exports = {
+  COLOR_FORMATS,
+  decodePng,
+  convertPixels,
+  rleEncode,
+  encodeImageTable,
+  findImages
+}
@@ -7,12 +7,15 @@
  *   run [file]   - Run in simulator
  *   flash        - Flash to ESP32
  *   init [name]  - Create new project
- *   build        - Build for production
+ *   build [file] - Build for production
  */
 
 const { spawn, execSync } = require('child_process')
 const path = require('path')
 const fs = require('fs')
+const { precompileClasses } = require('./tw-compiler.cjs')
+const { COLOR_FORMATS, encodeImageTable, findImages } = require('./img-compiler.cjs')
+const { detectFeatures, writeFeatures } = require('./features.cjs')
 
 // ============ Platform Detection ============
 
@@ -20,33 +23,23 @@ const platform = process.platform
 const isWindows = platform === 'win32'
 const ext = isWindows ? '.exe' : ''
 
-// ============ Find Simulator Binary ============
+// ============ Find Native Binaries ============
 
-function findSimulatorBinary() {
+function findNativeBinary(name, prebuilt) {
   const packageDir = path.dirname(__dirname)
   const nativeDir = path.join(packageDir, 'native')
 
   // Check common build locations
   const candidates = [
     // CMake build directory
-    path.join(nativeDir, 'simulator', 'build', 'rasen_simulator' + ext),
-    path.join(
-      nativeDir,
-      'simulator',
-      'build',
-      'Release',
-      'rasen_simulator' + ext
-    ),
-    path.join(
-      nativeDir,
-      'simulator',
-      'build',
-      'Debug',
-      'rasen_simulator' + ext
-    ),
-    // Pre-built binary
-    path.join(packageDir, 'bin', `rasen-lvgl-${platform}` + ext)
+    path.join(nativeDir, 'simulator', 'build', name + ext),
+    path.join(nativeDir, 'simulator', 'build', 'Release', name + ext),
+    path.join(nativeDir, 'simulator', 'build', 'Debug', name + ext)
   ]
+  if (prebuilt) {
+    // Pre-built binary
+    candidates.push(path.join(packageDir, 'bin', prebuilt + ext))
+  }
 
   for (const candidate of candidates) {
     if (fs.existsSync(candidate)) {
@@ -57,6 +50,87 @@ function findSimulatorBinary() {
   return null
 }
 
+function findSimulatorBinary() {
+  return findNativeBinary('rasen_simulator', `rasen-lvgl-${platform}`)
+}
+
+function findCompilerBinary() {
+  return findNativeBinary('rasen_compile', null)
+}
+
+// ============ Find Entry Script ============
+
+function findEntryScript() {
+  // Look for entry file in current directory
+  const candidates = [
+    'src/main.ts',
+    'src/main.js',
+    'src/index.ts',
+    'src/index.js',
+    'main.js'
+  ]
+  for (const candidate of candidates) {
+    if (fs.existsSync(candidate)) {
+      return candidate
+    }
+  }
+  return null
+}
+
+// ============ App Image ============
+
+// Section types, see "Mapped Loading" in native/common/qjs_rasen.h
+const SECTION_BYTECODE = 1
+const SECTION_SOURCE = 2
+const SECTION_STYLES = 3
+const SECTION_IMAGES = 4
+
+// Header flags: the source section already had transformImports() applied
+const IMAGE_IMPORTS_DONE = 0x01
+
+// Same rewrite as transform_imports() in native/common/qjs_rasen.c
+function transformImports(code) {
+  return code.replace(
+    /^import (.+?) from\s*(["'])([^"'\n]+)\2[^\n]*$/gm,
+    (match, names, quote, mod) => `const ${names} = __modules['${mod}'];`
+  )
+}
+
+/**
+ * Pack sections into one image that the device maps from flash
+ * @param {{ type: number, data: Buffer }[]} sections
+ * @param {number} flags - IMAGE_* header flags
+ */
+function writeAppImage(file, sections, flags = 0) {
+  const HEADER_SIZE = 16
+  const align4 = (n) => (n + 3) & ~3
+
+  let offset = align4(HEADER_SIZE + sections.length * 12)
+  const layout = sections.map((section) => {
+    const entry = { ...section, offset }
+    offset = align4(offset + section.data.length)
+    return entry
+  })
+
+  const image = Buffer.alloc(offset)
+  image.write('RSNA', 0, 'latin1')
+  image.writeUInt16LE(1, 4)
+  image.writeUInt16LE(sections.length, 6)
+  image.writeUInt32LE(offset, 8)
+  image.writeUInt32LE(flags, 12)
+
+  layout.forEach((entry, i) => {
+    const at = HEADER_SIZE + i * 12
+    image.writeUInt32LE(entry.type, at)
+    image.writeUInt32LE(entry.offset, at + 4)
+    image.writeUInt32LE(entry.data.length, at + 8)
+    entry.data.copy(image, entry.offset)
+  })
+
+  fs.writeFileSync(file, image)
+  return image.length
+}
+
 // ============ Commands ============
 
 function runSimulator(scriptPath) {
@@ -74,23 +148,7 @@ function runSimulator(scriptPath) {
   }
 
   // Resolve script path
-  let script = scriptPath
-  if (!script) {
-    // Look for entry file in current directory
-    const candidates = [
-      'src/main.ts',
-      'src/main.js',
-      'src/index.ts',
-      'src/index.js',
-      'main.js'
-    ]
-    for (const candidate of candidates) {
-      if (fs.existsSync(candidate)) {
-        script = candidate
-        break
-      }
-    }
-  }
+  let script = scriptPath || findEntryScript()
 
   if (!script) {
     console.error('Error: No script file specified and no entry file found.')
@@ -235,10 +293,186 @@ run(App)
   console.log('  npm run dev')
 }
 
-function buildProject() {
+function buildProject(args) {
+  let entry = null
+  let outDir = 'dist'
+  let name = null
+  let precompile = true
+  let bytecode = true
+  let color = 'rgb565-swap'
+  let compress = false
+  const imageDirs = []
+
+  for (let i = 0; i < args.length; i++) {
+    if (args[i] === '--out') {
+      outDir = args[++i]
+    } else if (args[i] === '--name') {
+      name = args[++i]
+    } else if (args[i] === '--no-precompile') {
+      precompile = false
+    } else if (args[i] === '--no-bytecode') {
+      bytecode = false
+    } else if (args[i] === '--color') {
+      color = args[++i]
+    } else if (args[i] === '--compress') {
+      compress = true
+    } else if (args[i] === '--images') {
+      imageDirs.push(args[++i])
+    } else {
+      entry = args[i]
+    }
+  }
+
+  entry = entry || findEntryScript()
+  if (!entry) {
+    console.error('Error: No entry file specified and no entry file found.')
+    console.error(
+      'Usage: rasen-lvgl build [file] [--out dir] [--name app] [--no-precompile] [--no-bytecode]'
+    )
+    console.error(
+      '                        [--images dir] [--color rgb565|rgb565-swap|argb8888] [--compress]'
+    )
+    process.exit(1)
+  }
+  if (!COLOR_FORMATS[color]) {
+    console.error(`Error: Unknown color format '${color}'.`)
+    console.error(`Use one of: ${Object.keys(COLOR_FORMATS).join(', ')}`)
+    process.exit(1)
+  }
+
   console.log('Building for production...')
-  // TODO: Bundle JS, optimize, prepare for ESP32
-  console.log('(Build not implemented yet)')
+
+  name = name || path.basename(entry).replace(/\.[cm]?[jt]s$/, '')
+  outDir = path.resolve(outDir)
+  const outFile = path.join(outDir, name + '.js')
+  const styleFile = path.join(outDir, name + '.tws')
+  const imagesFile = path.join(outDir, name + '.rimg')
+  const bytecodeFile = path.join(outDir, name + '.qjsbc')
+  const runtimeFile = path.join(outDir, 'rasen-runtime.qjsbc')
+  const featuresFile = path.join(outDir, name + '_features.h')
+  const sdkconfigFile = path.join(outDir, name + '.sdkconfig')
+
+  try {
+    execSync(
+      `npx esbuild ${entry} --outfile=${outFile} --format=esm --bundle --external:@rasenjs/*`,
+      {
+        stdio: 'inherit'
+      }
+    )
+  } catch (e) {
+    console.error('Failed to bundle. Make sure esbuild is installed.')
+    process.exit(1)
+  }
+  console.log(`✔ Built ${outFile}`)
+
+  // Leave element types, fonts and engine parts the app never uses out of
+  // the native build (RASEN_FEATURES_H, or the sdkconfig fragment on ESP32)
+  const features = detectFeatures(fs.readFileSync(outFile, 'utf8'), {
+    precompile
+  })
+  const summary = writeFeatures(features, {
+    name,
+    headerFile: featuresFile,
+    sdkconfigFile
+  })
+  console.log(`✔ Features: ${summary} (${featuresFile}, ${sdkconfigFile})`)
+
+  if (precompile) {
+    // Replace static class strings with ids into a binary style table,
+    // so the device never runs the Tailwind parser for them
+    const source = fs.readFileSync(outFile, 'utf8')
+    const { code, table, classes } = precompileClasses(source)
+    fs.writeFileSync(outFile, code)
+    fs.writeFileSync(styleFile, table)
+
+    const saved = Buffer.byteLength(source) - Buffer.byteLength(code)
+    console.log(
+      `✔ Precompiled ${classes.length} class strings into ${styleFile} (${table.length} bytes, script ${saved} bytes smaller)`
+    )
+  } else if (fs.existsSync(styleFile)) {
+    fs.unlinkSync(styleFile)
+  }
+
+  // Convert the PNGs the app uses to the display's pixel format, so the
+  // device draws them from flash instead of decoding them
+  const images = findImages(fs.readFileSync(outFile, 'utf8'), {
+    root: process.cwd(),
+    entryDir: path.dirname(path.resolve(entry)),
+    dirs: imageDirs
+  })
+  if (images.length > 0) {
+    let converted
+    try {
+      converted = encodeImageTable(images, { color, compress })
+    } catch (e) {
+      console.error(`Failed to convert images: ${e.message}`)
+      process.exit(1)
+    }
+    fs.writeFileSync(imagesFile, converted.table)
+    const packed = converted.entries.filter((e) => e.encoding !== 0).length
+    console.log(
+      `✔ Converted ${images.length} images to ${color} in ${imagesFile} (${converted.table.length} bytes${compress ? `, ${packed} RLE` : ''})`
+    )
+  } else if (fs.existsSync(imagesFile)) {
+    fs.unlinkSync(imagesFile)
+  }
+
+  const imageFile = path.join(outDir, name + '.rasen')
+  const sections = []
+  if (precompile) {
+    sections.push({ type: SECTION_STYLES, data: fs.readFileSync(styleFile) })
+  }
+  if (images.length > 0) {
+    sections.push({ type: SECTION_IMAGES, data: fs.readFileSync(imagesFile) })
+  }
+
+  // Compile the app and the runtime prelude to QuickJS bytecode, so the
+  // device loads them with JS_ReadObject instead of parsing source
+  const compiler = bytecode ? findCompilerBinary() : null
+  if (bytecode && !compiler) {
+    console.log('')
+    console.log('Skipping bytecode: rasen_compile not found.')
+    console.log('Build it with the simulator:')
+    console.log('  cd packages/lvgl/native/simulator/build')
+    console.log('  cmake --build . --target rasen_compile')
+    console.log('')
+  }
+
+  if (compiler) {
+    try {
+      execSync(`"${compiler}" "${outFile}" "${bytecodeFile}"`, {
+        stdio: 'inherit'
+      })
+      execSync(`"${compiler}" --runtime "${runtimeFile}"`, {
+        stdio: 'inherit'
+      })
+    } catch (e) {
+      console.error('Failed to compile bytecode.')
+      process.exit(1)
+    }
+    console.log(`✔ Compiled ${bytecodeFile}`)
+    sections.push({
+      type: SECTION_BYTECODE,
+      data: fs.readFileSync(bytecodeFile)
+    })
+  } else {
+    // Left over from an earlier build, the bytecode would be linked (and
+    // run) in place of this bundle, with class ids from another table
+    for (const file of [bytecodeFile, runtimeFile]) {
+      if (fs.existsSync(file)) fs.unlinkSync(file)
+    }
+
+    // Apply the runtime's import rewrite here and add the NUL it needs;
+    // IMAGE_IMPORTS_DONE lets the device evaluate the source in place
+    const source = transformImports(fs.readFileSync(outFile, 'utf8'))
+    sections.push({
+      type: SECTION_SOURCE,
+      data: Buffer.concat([Buffer.from(source), Buffer.from([0])])
+    })
+  }
+
+  const imageSize = writeAppImage(imageFile, sections, IMAGE_IMPORTS_DONE)
+  console.log(`✔ Packed ${imageFile} (${imageSize} bytes)`)
 }
 
 function showHelp() {
@@ -250,7 +484,7 @@ function showHelp() {
   console.log('  run [file]     Run in SDL2 simulator')
   console.log('  flash          Flash firmware to ESP32')
   console.log('  init [name]    Create a new project')
-  console.log('  build          Build for production')
+  console.log('  build [file]   Bundle, precompile styles and images, compile bytecode')
   console.log('')
   console.log('Examples:')
   console.log('  rasen-lvgl run src/main.ts')
@@ -274,7 +508,7 @@ switch (command) {
     initProject(args[1] || 'my-lvgl-app')
     break
   case 'build':
-    buildProject()
+    buildProject(args.slice(1))
     break
   case 'help':
   case '--help':
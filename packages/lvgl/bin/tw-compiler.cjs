@@ -0,0 +1,630 @@
+/**
+ * Build-time Tailwind compiler
+ *
+ * Mirrors tw_parse() in native/common/tw_parser.c using the same
+ * tw_tables.json, and encodes each class string as a fixed-size style
+ * record (see "Precompiled Styles" in native/common/qjs_rasen.h).
+ */
+
+const path = require('path')
+const fs = require('fs')
+const acorn = require('acorn')
+
+const TABLES_PATH = path.join(
+  __dirname,
+  '..',
+  'native',
+  'common',
+  'tw_tables.json'
+)
+
+const TABLE_VERSION = 1
+const HEADER_SIZE = 8
+const RECORD_SIZE = 40
+
+const REC_FLEX = 0x01
+const REC_BG_COLOR = 0x02
+const REC_BORDER_COLOR = 0x04
+const REC_TEXT_COLOR = 0x08
+
+const UNIT_PX = 0
+const UNIT_PCT = 1
+const UNIT_CONTENT = 2
+
+const RADIUS_CIRCLE = 0x7fff
+
+// Record codes for the LVGL enum names used in tw_tables.json
+const FLEX_FLOWS = {
+  LV_FLEX_FLOW_ROW: 0,
+  LV_FLEX_FLOW_COLUMN: 1
+}
+const FLEX_ALIGNS = {
+  LV_FLEX_ALIGN_START: 0,
+  LV_FLEX_ALIGN_END: 1,
+  LV_FLEX_ALIGN_CENTER: 2,
+  LV_FLEX_ALIGN_SPACE_BETWEEN: 3,
+  LV_FLEX_ALIGN_SPACE_AROUND: 4,
+  LV_FLEX_ALIGN_SPACE_EVENLY: 5
+}
+const FONT_SIZES = new Set([12, 14, 16, 18, 20, 24, 28, 32])
+
+// ============ Tables ============
+
+let tables = null
+
+function loadTables() {
+  if (tables) return tables
+
+  const spec = JSON.parse(fs.readFileSync(TABLES_PATH, 'utf8'))
+  const palette = new Map()
+  for (const [name, value] of Object.entries(spec.palette)) {
+    if (typeof value === 'string') {
+      palette.set(name, parseInt(value.slice(1), 16))
+    } else {
+      for (const [shade, hex] of Object.entries(value)) {
+        palette.set(`${name}-${shade}`, parseInt(hex.slice(1), 16))
+      }
+    }
+  }
+
+  tables = { keywords: new Map(Object.entries(spec.keywords)), palette }
+  return tables
+}
+
+// ============ Value Helpers ============
+
+function parseHex(str) {
+  let s = str.startsWith('#') ? str.slice(1) : str
+  if (!/^[0-9a-fA-F]+$/.test(s)) return null
+  if (s.length === 3) s = s.replace(/./g, (c) => c + c)
+  if (s.length !== 6) return null
+  return parseInt(s, 16)
+}
+
+// Same rules as parse_int(): optional '-', then decimal digits
+function parseIntPrefix(str) {
+  const m = /^-?[0-9]+/.exec(str)
+  if (!m) return null
+  return { value: parseInt(m[0], 10), rest: str.slice(m[0].length) }
+}
+
+function parseLength(str) {
+  const n = parseIntPrefix(str)
+  if (!n) return null
+  if (n.rest === '' || n.rest === 'px') return { unit: UNIT_PX, value: n.value }
+  if (n.rest === 'rem') return { unit: UNIT_PX, value: n.value * 16 }
+  if (n.rest === '%') return { unit: UNIT_PCT, value: n.value }
+  return null
+}
+
+function parseSpacing(str) {
+  if (str.length >= 2 && str[0] === '[' && str[str.length - 1] === ']') {
+    return parseLength(str.slice(1, -1))
+  }
+  const n = parseIntPrefix(str)
+  if (!n || n.value < 0) return null
+  if (n.rest === '') return { unit: UNIT_PX, value: n.value * 4 }
+  if (n.rest === '.5') return { unit: UNIT_PX, value: n.value * 4 + 2 }
+  return null
+}
+
+function parseColor(str) {
+  if (str.length >= 2 && str[0] === '[' && str[str.length - 1] === ']') {
+    return parseHex(str.slice(1, -1))
+  }
+  const rgb = loadTables().palette.get(str)
+  return rgb === undefined ? null : rgb
+}
+
+// ============ Parser ============
+
+function defaultStyles() {
+  return {
+    flex: false,
+    flexFlow: 0,
+    wrap: false,
+    justify: 0,
+    align: 0,
+    width: { unit: UNIT_CONTENT, value: 0 },
+    height: { unit: UNIT_CONTENT, value: 0 },
+    padTop: 0,
+    padBottom: 0,
+    padLeft: 0,
+    padRight: 0,
+    padRow: 0,
+    padColumn: 0,
+    bgColor: null,
+    bgOpa: 255,
+    borderWidth: 0,
+    borderColor: null,
+    radius: 0,
+    textColor: null,
+    fontSize: 0,
+    // Set when a value cannot be stored in a record (percent padding, or
+    // a size outside the record's int16 fields)
+    dynamic: false,
+    // Set when a color came from the palette (bg-red-500, not bg-[#ff0000])
+    namedColor: false,
+    // Set when a token is not a utility tw_parse() knows (it ignores those)
+    unknown: false
+  }
+}
+
+function argValue(arg) {
+  if (typeof arg === 'number') return arg
+  if (arg in FLEX_FLOWS) return FLEX_FLOWS[arg]
+  if (arg in FLEX_ALIGNS) return FLEX_ALIGNS[arg]
+  if (arg === 'LV_RADIUS_CIRCLE') return RADIUS_CIRCLE
+  return 0
+}
+
+function applyKeyword(entry, s) {
+  const arg = argValue(entry.arg)
+  switch (entry.op) {
+    case 'FLEX':
+      s.flex = true
+      break
+    case 'FLEX_FLOW':
+      s.flex = true
+      s.flexFlow = arg
+      s.wrap = false
+      break
+    case 'FLEX_WRAP':
+      s.wrap = true
+      break
+    case 'JUSTIFY':
+      s.justify = arg
+      break
+    case 'ITEMS':
+      s.align = arg
+      break
+    case 'SIZE_FULL':
+      s.width = { unit: UNIT_PCT, value: 100 }
+      s.height = { unit: UNIT_PCT, value: 100 }
+      break
+    case 'WIDTH_PCT':
+      s.width = { unit: UNIT_PCT, value: arg }
+      break
+    case 'HEIGHT_PCT':
+      s.height = { unit: UNIT_PCT, value: arg }
+      break
+    case 'FONT':
+      if (FONT_SIZES.has(arg)) s.fontSize = arg
+      break
+    case 'RADIUS':
+      s.radius = arg
+      break
+    case 'BG_TRANSPARENT':
+      s.bgOpa = 0
+      if (s.bgColor === null) s.bgColor = 0
+      break
+    case 'BORDER_WIDTH':
+      s.borderWidth = arg
+      break
+  }
+}
+
+function colorValue(v, s) {
+  const color = parseColor(v)
+  if (color !== null && v[0] !== '[') s.namedColor = true
+  return color
+}
+
+function padValue(n, s) {
+  if (n.unit !== UNIT_PX) s.dynamic = true
+  return n.value
+}
+
+// Returns false when the value is not valid for the prefix
+function applyPrefix(prefix, v, s) {
+  let n
+  let color
+  switch (prefix) {
+    case 'WIDTH':
+      if (!(n = parseSpacing(v))) return false
+      s.width = n
+      return true
+    case 'HEIGHT':
+      if (!(n = parseSpacing(v))) return false
+      s.height = n
+      return true
+    case 'SIZE':
+      if (!(n = parseSpacing(v))) return false
+      s.width = s.height = n
+      return true
+    case 'GAP':
+      if (!(n = parseSpacing(v))) return false
+      s.padRow = s.padColumn = padValue(n, s)
+      return true
+    case 'PAD':
+      if (!(n = parseSpacing(v))) return false
+      s.padTop = s.padBottom = s.padLeft = s.padRight = padValue(n, s)
+      return true
+    case 'PAD_X':
+      if (!(n = parseSpacing(v))) return false
+      s.padLeft = s.padRight = padValue(n, s)
+      return true
+    case 'PAD_Y':
+      if (!(n = parseSpacing(v))) return false
+      s.padTop = s.padBottom = padValue(n, s)
+      return true
+    case 'PAD_TOP':
+      if (!(n = parseSpacing(v))) return false
+      s.padTop = padValue(n, s)
+      return true
+    case 'PAD_BOTTOM':
+      if (!(n = parseSpacing(v))) return false
+      s.padBottom = padValue(n, s)
+      return true
+    case 'PAD_LEFT':
+      if (!(n = parseSpacing(v))) return false
+      s.padLeft = padValue(n, s)
+      return true
+    case 'PAD_RIGHT':
+      if (!(n = parseSpacing(v))) return false
+      s.padRight = padValue(n, s)
+      return true
+    case 'BG':
+      if ((color = colorValue(v, s)) === null) return false
+      s.bgColor = color
+      return true
+    case 'TEXT':
+      if ((color = colorValue(v, s)) === null) return false
+      s.textColor = color
+      return true
+    case 'BORDER':
+      if (/^[0-9]+$/.test(v)) {
+        s.borderWidth = parseInt(v, 10)
+        return true
+      }
+      if ((color = colorValue(v, s)) === null) return false
+      s.borderColor = color
+      return true
+  }
+  return false
+}
+
+/**
+ * Parse a class string exactly like the native tw_parse()
+ */
+function parseClass(classStr) {
+  const { keywords } = loadTables()
+  const s = defaultStyles()
+
+  for (const token of classStr.split(/[ \t\n\r]+/)) {
+    if (!token) continue
+
+    const entry = keywords.get(token)
+    if (entry && entry.op) {
+      applyKeyword(entry, s)
+      continue
+    }
+
+    const dash = token.indexOf('-')
+    const prefix = dash > 0 ? keywords.get(token.slice(0, dash)) : null
+    if (
+      !prefix ||
+      !prefix.prefix ||
+      !applyPrefix(prefix.prefix, token.slice(dash + 1), s)
+    ) {
+      s.unknown = true
+    }
+  }
+
+  if (recordWords(s).some((v) => v < -0x8000 || v > 0x7fff)) s.dynamic = true
+
+  return s
+}
+
+// ============ Encoding ============
+
+// The record's int16 fields, in order
+function recordWords(s) {
+  return [
+    s.width.value,
+    s.height.value,
+    s.padTop,
+    s.padBottom,
+    s.padLeft,
+    s.padRight,
+    s.padRow,
+    s.padColumn,
+    s.borderWidth,
+    s.radius
+  ]
+}
+
+function encodeRecord(s, buf, offset) {
+  let flags = 0
+  if (s.flex) flags |= REC_FLEX
+  if (s.bgColor !== null) flags |= REC_BG_COLOR
+  if (s.borderColor !== null) flags |= REC_BORDER_COLOR
+  if (s.textColor !== null) flags |= REC_TEXT_COLOR
+
+  // flex-wrap only applies to the flow chosen so far, as in tw_parse()
+  const flow = s.flexFlow + (s.wrap ? 2 : 0)
+
+  buf.writeUInt8(flags, offset)
+  buf.writeUInt8(flow, offset + 1)
+  buf.writeUInt8(s.justify, offset + 2)
+  buf.writeUInt8(s.align, offset + 3)
+  buf.writeUInt8(s.bgOpa, offset + 4)
+  buf.writeUInt8(s.fontSize, offset + 5)
+  buf.writeUInt8(s.width.unit, offset + 6)
+  buf.writeUInt8(s.height.unit, offset + 7)
+
+  recordWords(s).forEach((v, i) => buf.writeInt16LE(v, offset + 8 + i * 2))
+
+  const rgb = [s.bgColor, s.borderColor, s.textColor]
+  rgb.forEach((c, i) => {
+    const v = c || 0
+    buf.writeUInt8((v >> 16) & 0xff, offset + 28 + i * 3)
+    buf.writeUInt8((v >> 8) & 0xff, offset + 29 + i * 3)
+    buf.writeUInt8(v & 0xff, offset + 30 + i * 3)
+  })
+}
+
+/**
+ * Encode class strings as a style table; record i has id i + 1
+ */
+function encodeTable(classStrings) {
+  const buf = Buffer.alloc(HEADER_SIZE + classStrings.length * RECORD_SIZE)
+  buf.write('RTWS', 0, 'latin1')
+  buf.writeUInt8(TABLE_VERSION, 4)
+  buf.writeUInt8(RECORD_SIZE, 5)
+  buf.writeUInt16LE(classStrings.length, 6)
+
+  classStrings.forEach((str, i) => {
+    encodeRecord(parseClass(str), buf, HEADER_SIZE + i * RECORD_SIZE)
+  })
+  return buf
+}
+
+// ============ Class Sites ============
+
+// @rasenjs/lvgl exports taking a props object with `class` as first argument
+const COMPONENTS = new Set([
+  'div',
+  'label',
+  'text',
+  'button',
+  'image',
+  'slider',
+  'lvSwitch',
+  'checkbox',
+  'textarea',
+  'arc',
+  'bar',
+  'virtualList',
+  'spinner',
+  'dropdown',
+  'roller',
+  'table',
+  'chart'
+])
+
+// Descriptor `type` strings (ElementType in src/index.ts)
+const ELEMENT_TYPES = new Set([
+  'obj',
+  'label',
+  'btn',
+  'img',
+  'slider',
+  'switch',
+  'checkbox',
+  'textarea',
+  'arc',
+  'bar',
+  'spinner',
+  'roller',
+  'dropdown',
+  'table',
+  'chart',
+  'list'
+])
+
+function propName(prop) {
+  if (prop.type !== 'Property' || prop.computed) return null
+  if (prop.key.type === 'Identifier') return prop.key.name
+  if (prop.key.type === 'Literal') return String(prop.key.value)
+  return null
+}
+
+// Value of a string literal or a template without substitutions
+function staticString(node) {
+  if (node.type === 'Literal' && typeof node.value === 'string') {
+    return node.value
+  }
+  if (node.type === 'TemplateLiteral' && node.expressions.length === 0) {
+    return node.quasis[0].value.cooked
+  }
+  return null
+}
+
+// Child nodes that are references, not names (keys, labels, members)
+function forEachChild(node, fn) {
+  for (const key of Object.keys(node)) {
+    if (key === 'label') continue
+    if (key === 'key' && !node.computed) continue
+    if (key === 'property' && node.type === 'MemberExpression') {
+      if (!node.computed) continue
+    }
+    const value = node[key]
+    for (const child of Array.isArray(value) ? value : [value]) {
+      if (child && typeof child.type === 'string') fn(child)
+    }
+  }
+}
+
+/**
+ * Class strings that reach the device, found on the parsed bundle
+ *
+ * Only the `class` of props objects passed to @rasenjs/lvgl components and
+ * of element descriptors ({ type: 'obj', ... }) counts. `dynamic` is set
+ * when some class can't be followed to a literal: computed values, spreads,
+ * props passed as a variable, or components used other than by a call.
+ * @returns {{ sites: { start: number, end: number, value: string }[],
+ *   dynamic: boolean } | null} null when the code does not parse
+ */
+function findClassSites(code) {
+  let ast
+  try {
+    ast = acorn.parse(code, { ecmaVersion: 'latest', sourceType: 'module' })
+  } catch (e) {
+    return null
+  }
+
+  const components = new Set()
+  const namespaces = new Set()
+  for (const stmt of ast.body) {
+    if (stmt.type !== 'ImportDeclaration') continue
+    if (stmt.source.value !== '@rasenjs/lvgl') continue
+    for (const spec of stmt.specifiers) {
+      if (spec.type === 'ImportNamespaceSpecifier') {
+        namespaces.add(spec.local.name)
+      } else if (spec.type === 'ImportSpecifier') {
+        const name = spec.imported.name ?? spec.imported.value
+        if (COMPONENTS.has(name)) components.add(spec.local.name)
+      }
+    }
+  }
+
+  const sites = []
+  const seen = new Set()
+  let dynamic = false
+
+  const isComponent = (node) =>
+    (node.type === 'Identifier' && components.has(node.name)) ||
+    (node.type === 'MemberExpression' &&
+      !node.computed &&
+      node.object.type === 'Identifier' &&
+      namespaces.has(node.object.name) &&
+      COMPONENTS.has(node.property.name))
+
+  const addProps = (obj) => {
+    if (seen.has(obj)) return
+    seen.add(obj)
+    for (const prop of obj.properties) {
+      if (prop.type === 'SpreadElement' || prop.computed) {
+        dynamic = true
+        continue
+      }
+      if (propName(prop) !== 'class') continue
+
+      // Getters and methods have a function value, so they count as dynamic
+      const { value } = prop
+      const str = staticString(value)
+      if (str !== null) {
+        sites.push({ start: value.start, end: value.end, value: str })
+      } else if (value.type !== 'Literal' || typeof value.value !== 'number') {
+        dynamic = true // Numbers are ids from an earlier precompile
+      }
+    }
+  }
+
+  const visit = (node) => {
+    switch (node.type) {
+      case 'ImportDeclaration':
+        return
+      case 'ImportExpression': {
+        const source = staticString(node.source)
+        if (source === null || source === '@rasenjs/lvgl') dynamic = true
+        break
+      }
+      case 'CallExpression':
+        if (isComponent(node.callee)) {
+          const props = node.arguments[0]
+          if (props && props.type === 'ObjectExpression') addProps(props)
+          else if (props) dynamic = true
+          node.arguments.forEach(visit)
+          return
+        }
+        break
+      case 'ObjectExpression': {
+        const type = node.properties.find((p) => propName(p) === 'type')
+        if (type && ELEMENT_TYPES.has(staticString(type.value))) {
+          addProps(node)
+        }
+        break
+      }
+      case 'MemberExpression':
+        if (
+          node.object.type === 'Identifier' &&
+          namespaces.has(node.object.name)
+        ) {
+          // lv.stats() is fine; lv[name] or a bare lv.div is not followed
+          if (node.computed) {
+            dynamic = true
+            visit(node.property)
+          } else if (COMPONENTS.has(node.property.name)) {
+            dynamic = true
+          }
+          return
+        }
+        break
+      case 'Identifier':
+        // Aliased or passed on: calls through it are not followed
+        if (components.has(node.name) || namespaces.has(node.name)) {
+          dynamic = true
+        }
+        return
+    }
+    forEachChild(node, visit)
+  }
+  visit(ast)
+
+  sites.sort((a, b) => a.start - b.start)
+  return { sites, dynamic }
+}
+
+// ============ Source Rewriting ============
+
+/**
+ * Replace static class strings in bundled JS with style ids
+ *
+ * Strings with a token tw_parse() doesn't know, or with values a record
+ * can't hold, are left for the device to parse.
+ * @returns {{ code: string, table: Buffer, classes: string[] }}
+ */
+function precompileClasses(code) {
+  const found = findClassSites(code)
+  const ids = new Map()
+  const classes = []
+  const replaced = []
+
+  for (const site of found ? found.sites : []) {
+    const str = site.value
+    if (!str.trim()) continue
+    const s = parseClass(str)
+    if (s.dynamic || s.unknown) continue
+
+    let id = ids.get(str)
+    if (id === undefined) {
+      if (classes.length >= 0xffff) continue
+      classes.push(str)
+      id = classes.length
+      ids.set(str, id)
+    }
+    replaced.push({ site, id })
+  }
+
+  // Sites are in source order, so the untouched code between them is kept
+  const parts = []
+  let pos = 0
+  for (const { site, id } of replaced) {
+    parts.push(code.slice(pos, site.start), String(id))
+    pos = site.end
+  }
+  parts.push(code.slice(pos))
+
+  return { code: parts.join(''), table: encodeTable(classes), classes }
+}
+
+module.exports = {
+  FONT_SIZES,
+  parseClass,
+  encodeRecord,
+  encodeTable,
+  findClassSites,
+  precompileClasses
+}
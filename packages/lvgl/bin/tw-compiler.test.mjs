@@ -0,0 +1,237 @@
+import { describe, it, expect } from 'vitest'
+import { encodeTable, parseClass, precompileClasses } from './tw-compiler.cjs'
+
+// Records are checked against tw_parse() in native/common/tw_parser.c:
+// decoding each one with tw_decode_record() gives the same tw_styles_t.
+// [class, flags flow justify align bgOpa font wUnit hUnit,
+//  w h padTop padBottom padLeft padRight padRow padColumn border radius,
+//  bg border text]
+const GOLDEN = [
+  [
+    'flex flex-col',
+    [1, 1, 0, 0, 255, 0, 2, 2],
+    [0, 0, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'flex-col flex-wrap',
+    [1, 3, 0, 0, 255, 0, 2, 2],
+    [0, 0, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'flex-wrap flex-col',
+    [1, 1, 0, 0, 255, 0, 2, 2],
+    [0, 0, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'flex-row flex-wrap justify-between items-center',
+    [1, 2, 3, 2, 255, 0, 2, 2],
+    [0, 0, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'justify-evenly items-end',
+    [0, 0, 5, 1, 255, 0, 2, 2],
+    [0, 0, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'size-full',
+    [0, 0, 0, 0, 255, 0, 1, 1],
+    [100, 100, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'w-full h-4',
+    [0, 0, 0, 0, 255, 0, 1, 0],
+    [100, 16, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'w-[200px] h-[10rem]',
+    [0, 0, 0, 0, 255, 0, 0, 0],
+    [200, 160, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'w-[50%] h-[-10px]',
+    [0, 0, 0, 0, 255, 0, 1, 0],
+    [50, -10, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'size-12',
+    [0, 0, 0, 0, 255, 0, 0, 0],
+    [48, 48, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'p-4',
+    [0, 0, 0, 0, 255, 0, 2, 2],
+    [0, 0, 16, 16, 16, 16, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'p-0.5',
+    [0, 0, 0, 0, 255, 0, 2, 2],
+    [0, 0, 2, 2, 2, 2, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'px-2.5 py-1',
+    [0, 0, 0, 0, 255, 0, 2, 2],
+    [0, 0, 4, 4, 10, 10, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'pt-1 pb-2 pl-3 pr-4',
+    [0, 0, 0, 0, 255, 0, 2, 2],
+    [0, 0, 4, 8, 12, 16, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'gap-[7px]',
+    [0, 0, 0, 0, 255, 0, 2, 2],
+    [0, 0, 0, 0, 0, 0, 7, 7, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'bg-red-500 text-white',
+    [10, 0, 0, 0, 255, 0, 2, 2],
+    [0, 0, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0xef4444, 0x000000, 0xffffff]
+  ],
+  [
+    'bg-[#505050] text-[#abc]',
+    [10, 0, 0, 0, 255, 0, 2, 2],
+    [0, 0, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0x505050, 0x000000, 0xaabbcc]
+  ],
+  [
+    'bg-transparent',
+    [2, 0, 0, 0, 0, 0, 2, 2],
+    [0, 0, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'bg-transparent bg-blue-600',
+    [2, 0, 0, 0, 0, 0, 2, 2],
+    [0, 0, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0x2563eb, 0x000000, 0x000000]
+  ],
+  [
+    'border border-gray-300',
+    [4, 0, 0, 0, 255, 0, 2, 2],
+    [0, 0, 0, 0, 0, 0, 0, 0, 1, 0],
+    [0x000000, 0xd1d5db, 0x000000]
+  ],
+  [
+    'border-2 border-[#ff0000]',
+    [4, 0, 0, 0, 255, 0, 2, 2],
+    [0, 0, 0, 0, 0, 0, 0, 0, 2, 0],
+    [0x000000, 0xff0000, 0x000000]
+  ],
+  [
+    'rounded-full',
+    [0, 0, 0, 0, 255, 0, 2, 2],
+    [0, 0, 0, 0, 0, 0, 0, 0, 0, 32767],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'w-[32767px] h-[-32768px]',
+    [0, 0, 0, 0, 255, 0, 0, 0],
+    [32767, -32768, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x000000]
+  ],
+  [
+    'text-4xl text-slate-950',
+    [8, 0, 0, 0, 255, 32, 2, 2],
+    [0, 0, 0, 0, 0, 0, 0, 0, 0, 0],
+    [0x000000, 0x000000, 0x020617]
+  ]
+]
+
+function record(classStr) {
+  const rec = encodeTable([classStr]).subarray(8)
+  const words = []
+  for (let i = 0; i < 10; i++) words.push(rec.readInt16LE(8 + i * 2))
+  const rgb = [0, 1, 2].map((i) => rec.readUIntBE(28 + i * 3, 3))
+  return [[...rec.subarray(0, 8)], words, rgb]
+}
+
+describe('parseClass parity with tw_parse()', () => {
+  for (const [classStr, head, words, rgb] of GOLDEN) {
+    it(classStr, () => {
+      expect(record(classStr)).toEqual([head, words, rgb])
+    })
+  }
+
+  it('marks percent padding dynamic, since records hold pixels only', () => {
+    expect(parseClass('p-[50%]').dynamic).toBe(true)
+    expect(parseClass('gap-[10%]').dynamic).toBe(true)
+    expect(parseClass('w-[50%] p-[8px]').dynamic).toBe(false)
+  })
+
+  it('marks sizes outside the int16 record fields dynamic', () => {
+    expect(parseClass('w-9000').dynamic).toBe(true)
+    expect(parseClass('w-[40000px]').dynamic).toBe(true)
+    expect(parseClass('p-[-40000px]').dynamic).toBe(true)
+    expect(parseClass('border-99999').dynamic).toBe(true)
+    expect(parseClass('w-[32767px]').dynamic).toBe(false)
+  })
+
+  it('marks tokens tw_parse() ignores', () => {
+    expect(parseClass('p-2 m-2').unknown).toBe(true)
+    expect(parseClass('bg-nothing-500').unknown).toBe(true)
+    expect(parseClass('w--4').unknown).toBe(true)
+    expect(parseClass('p-1.25').unknown).toBe(true)
+    expect(parseClass('flex p-2 bg-[#fff]').unknown).toBe(false)
+  })
+
+  it('tracks palette colors only', () => {
+    expect(parseClass('bg-red-500').namedColor).toBe(true)
+    expect(parseClass('border-white').namedColor).toBe(true)
+    expect(parseClass('bg-[#ff0000] text-[#fff]').namedColor).toBe(false)
+  })
+})
+
+describe('precompileClasses', () => {
+  const lvgl = "import { div, label as lbl } from '@rasenjs/lvgl'\n"
+
+  it('rewrites component props and element descriptors', () => {
+    const { code, classes } = precompileClasses(
+      lvgl +
+        "div({ class: 'p-4', children: [lbl({ class: `text-lg` })] })\n" +
+        "host.appendChild({ type: 'obj', class: 'p-4' })"
+    )
+    expect(classes).toEqual(['p-4', 'text-lg'])
+    expect(code).toContain('div({ class: 1, children: [lbl({ class: 2 })] })')
+    expect(code).toContain("{ type: 'obj', class: 1 }")
+  })
+
+  it('leaves strings and unrelated objects alone', () => {
+    const source =
+      lvgl +
+      "const usage = \"usage: { class: 'p-2' }\"\n" +
+      "const user = { name: 'bob', class: 'admin' }\n" +
+      "div({ class: 'p-2 foo' })"
+    const { code, classes } = precompileClasses(source)
+    expect(classes).toEqual([])
+    expect(code).toBe(source)
+  })
+
+  it('leaves classes a record cannot hold to the device', () => {
+    const source = lvgl + "div({ class: 'w-9000 p-2' })"
+    const { code, classes } = precompileClasses(source)
+    expect(classes).toEqual([])
+    expect(code).toBe(source)
+  })
+
+  it('keeps the source when it does not parse', () => {
+    const { code, classes } = precompileClasses("div({ class: 'p-4' ")
+    expect(classes).toEqual([])
+    expect(code).toBe("div({ class: 'p-4' ")
+  })
+})
@@ -0,0 +1,34 @@
+// Benchmark: BENCH_N cells (default 120) with distinct class strings
+
+var N = typeof BENCH_N !== 'undefined' ? BENCH_N : 120
+var colors = ['red', 'green', 'blue', 'yellow', 'purple', 'gray', 'orange', 'teal']
+
+function App() {
+  var cells = []
+  for (var i = 0; i < N; i++) {
+    var color = colors[i % colors.length]
+    cells.push(
+      div({
+        key: i,
+        class:
+          'flex items-center justify-center w-' + (8 + (i % 8) * 2) +
+          ' h-8 p-' + (i % 4) + ' rounded-' + ['sm', 'md', 'lg', 'full'][i % 4] +
+          ' bg-' + color + '-' + (100 + (i % 9) * 100) +
+          ' border-2 border-' + color + '-900',
+        children: [
+          label({
+            class: 'text-xs text-' + color + '-50',
+            children: String(i)
+          })
+        ]
+      })
+    )
+  }
+
+  return div({
+    class: 'flex flex-row flex-wrap size-full bg-gray-900 gap-1',
+    children: cells
+  })
+}
+
+run(App)
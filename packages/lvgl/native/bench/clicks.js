@@ -0,0 +1,26 @@
+// Benchmark: counter driven by rapid clicks (click-to-flush latency)
+
+function App() {
+  var count = ref(0)
+
+  return div({
+    class: 'flex flex-col items-center justify-center size-full bg-gray-900 gap-4',
+    children: [
+      label({
+        class: 'text-2xl text-white',
+        children: function () {
+          return 'Count: ' + count.value
+        }
+      }),
+      button({
+        class: 'px-4 py-2 bg-blue-500 rounded-lg',
+        onClick: function () {
+          count.value++
+        },
+        children: [label({ class: 'text-white', children: '+' })]
+      })
+    ]
+  })
+}
+
+run(App)
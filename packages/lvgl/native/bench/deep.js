@@ -0,0 +1,17 @@
+// Benchmark: nested containers BENCH_N levels deep (default 64)
+
+var N = typeof BENCH_N !== 'undefined' ? BENCH_N : 64
+
+function App() {
+  var node = label({ class: 'text-white', children: 'leaf' })
+  for (var i = 0; i < N; i++) {
+    node = div({ class: 'p-1 border border-gray-700', children: [node] })
+  }
+
+  return div({
+    class: 'size-full bg-gray-900',
+    children: [node]
+  })
+}
+
+run(App)
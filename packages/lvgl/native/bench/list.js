@@ -0,0 +1,26 @@
+// Benchmark: flat list of BENCH_N rows (default 200)
+
+var N = typeof BENCH_N !== 'undefined' ? BENCH_N : 200
+
+function App() {
+  var rows = []
+  for (var i = 0; i < N; i++) {
+    rows.push(
+      div({
+        key: i,
+        class: 'flex flex-row items-center gap-2 px-2 py-1',
+        children: [
+          label({ class: 'text-sm text-gray-400', children: '#' + i }),
+          label({ class: 'text-white', children: 'Item ' + i })
+        ]
+      })
+    )
+  }
+
+  return div({
+    class: 'flex flex-col size-full bg-gray-900',
+    children: rows
+  })
+}
+
+run(App)
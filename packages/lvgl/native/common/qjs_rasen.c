@@ -6,270 +6,2814 @@
  */
 
 #include "qjs_rasen.h"
+#include "rasen_stats.h"
+#include "rasen_worker.h"
+#include "rasen_img.h"
+#include "rasen_alloc.h"
+#include "rasen_prof.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-// ============ Event Handler Storage ============
+// ============ Handle Tables ============
+
+/**
+ * Growable slab of fixed-size slots handing out stable 32-bit handles.
+ * A handle packs a slot index (low 20 bits, 1-based) with the slot's
+ * generation (high 12 bits), so lookups are a bounds check plus a compare
+ * and handles to freed slots never resolve, even after the slot is reused.
+ * Slot memory may move when the slab grows; don't hold slot pointers
+ * across calls that can allocate.
+ */
+#define HANDLE_INDEX_BITS 20
+#define HANDLE_INDEX_MASK ((1u << HANDLE_INDEX_BITS) - 1)
+#define HANDLE_GEN_MASK   ((1u << (32 - HANDLE_INDEX_BITS)) - 1)
+#define HANDLE_TABLE_INITIAL 32
+#define HANDLE_SLOT_USED  UINT32_MAX
+
+typedef struct {
+    uint8_t *slots;
+    uint16_t *gens;
+    uint32_t *next_free;    // 1-based free list link, HANDLE_SLOT_USED when occupied
+    uint32_t item_size;
+    uint32_t capacity;
+    uint32_t free_head;     // 1-based slot index, 0 when empty
+    uint32_t used;
+} handle_table_t;
+
+#define HANDLE_TABLE_INIT(type) { .item_size = sizeof(type) }
+
+static bool handle_table_grow(handle_table_t *t) {
+    uint32_t cap = t->capacity ? t->capacity * 2 : HANDLE_TABLE_INITIAL;
+    if (cap > HANDLE_INDEX_MASK) return false;
+    
+    uint8_t *slots = realloc(t->slots, (size_t)cap * t->item_size);
+    if (!slots) return false;
+    t->slots = slots;
+    uint16_t *gens = realloc(t->gens, cap * sizeof(uint16_t));
+    if (!gens) return false;
+    t->gens = gens;
+    uint32_t *next_free = realloc(t->next_free, cap * sizeof(uint32_t));
+    if (!next_free) return false;
+    t->next_free = next_free;
+    
+    // Chain the new slots onto the free list
+    for (uint32_t i = t->capacity; i < cap; i++) {
+        t->gens[i] = 1;
+        t->next_free[i] = (i + 1 < cap) ? i + 2 : t->free_head;
+    }
+    t->free_head = t->capacity + 1;
+    t->capacity = cap;
+    return true;
+}
+
+// Copy item into a free slot and return its handle, 0 on failure
+static uint32_t handle_alloc(handle_table_t *t, const void *item) {
+    if (!t->free_head && !handle_table_grow(t)) return 0;
+    
+    uint32_t slot = t->free_head - 1;
+    t->free_head = t->next_free[slot];
+    t->next_free[slot] = HANDLE_SLOT_USED;
+    memcpy(t->slots + (size_t)slot * t->item_size, item, t->item_size);
+    t->used++;
+    return ((uint32_t)t->gens[slot] << HANDLE_INDEX_BITS) | (slot + 1);
+}
+
+static void *handle_get(const handle_table_t *t, uint32_t handle) {
+    uint32_t index = handle & HANDLE_INDEX_MASK;
+    if (index == 0 || index > t->capacity) return NULL;
+    uint32_t slot = index - 1;
+    if (t->next_free[slot] != HANDLE_SLOT_USED) return NULL;
+    if (t->gens[slot] != (handle >> HANDLE_INDEX_BITS)) return NULL;
+    return t->slots + (size_t)slot * t->item_size;
+}
+
+// Occupied slot by raw index (for iteration), NULL if free
+static void *handle_slot_at(const handle_table_t *t, uint32_t slot) {
+    if (slot >= t->capacity || t->next_free[slot] != HANDLE_SLOT_USED) return NULL;
+    return t->slots + (size_t)slot * t->item_size;
+}
+
+static void handle_free(handle_table_t *t, uint32_t handle) {
+    if (!handle_get(t, handle)) return;
+    
+    uint32_t slot = (handle & HANDLE_INDEX_MASK) - 1;
+    t->gens[slot] = (uint16_t)((t->gens[slot] + 1) & HANDLE_GEN_MASK);
+    if (t->gens[slot] == 0) t->gens[slot] = 1;
+    t->next_free[slot] = t->free_head;
+    t->free_head = slot + 1;
+    t->used--;
+}
+
+static void handle_table_destroy(handle_table_t *t) {
+    free(t->slots);
+    free(t->gens);
+    free(t->next_free);
+    t->slots = NULL;
+    t->gens = NULL;
+    t->next_free = NULL;
+    t->capacity = 0;
+    t->free_head = 0;
+    t->used = 0;
+}
 
-#define MAX_HANDLERS 256
+// ============ Event Handler Storage ============
 
+/**
+ * Handler ids are handles into handler_table and travel as LVGL event
+ * user data. Entries are released together with their owning object
+ * (see node_delete_cb), so rerenders don't accumulate closures.
+ */
 typedef struct {
-    uint32_t id;
     JSValue func;
     lv_obj_t *obj;
 } handler_entry_t;
 
-static handler_entry_t handlers[MAX_HANDLERS];
-static uint32_t handler_count = 0;
-static uint32_t next_handler_id = 1;
+static handle_table_t handler_table = HANDLE_TABLE_INIT(handler_entry_t);
 static JSContext *global_ctx = NULL;
-static bool needs_rerender = false;
+static bool needs_rerender = false;   // Handler ran or requestRender(): reconcile next frame
+static bool frame_requested = false;  // Ref effects or nextTick callbacks queued in JS
+
+static uint32_t register_handler(JSContext *ctx, JSValue func, lv_obj_t *obj) {
+    handler_entry_t entry = { JS_DupValue(ctx, func), obj };
+    uint32_t id = handle_alloc(&handler_table, &entry);
+    if (!id) {
+        printf("Error: Too many handlers\n");
+        JS_FreeValue(ctx, entry.func);
+    } else {
+        rasen_stats.handlers_live++;
+    }
+    return id;
+}
+
+// Swap the function behind an existing handler id
+static void replace_handler(JSContext *ctx, uint32_t id, JSValue func) {
+    handler_entry_t *entry = handle_get(&handler_table, id);
+    if (!entry) return;
+    
+    JS_FreeValue(ctx, entry->func);
+    entry->func = JS_DupValue(ctx, func);
+}
+
+static void release_handler(JSContext *ctx, uint32_t id) {
+    handler_entry_t *entry = handle_get(&handler_table, id);
+    if (!entry) return;
+    
+    if (ctx) JS_FreeValue(ctx, entry->func);
+    handle_free(&handler_table, id);
+    rasen_stats.handlers_live--;
+}
+
+// ============ Threading Hooks ============
+
+/**
+ * With qjs_rasen_set_threading() JS runs on its own task: every LVGL call
+ * made from qjs_rasen_* entry points happens between lvgl_lock() and
+ * lvgl_unlock(), and the only data crossing from the LVGL task is the
+ * event queue below. Without hooks these are no-ops.
+ */
+static qjs_rasen_threading_t threading;
+
+static void lvgl_lock(void) {
+    if (threading.lock) threading.lock();
+}
+
+// The tree may have changed; let the LVGL task render it
+static void lvgl_unlock(void) {
+    if (threading.unlock) threading.unlock();
+    if (threading.wake_lvgl) threading.wake_lvgl();
+}
+
+void qjs_rasen_set_threading(const qjs_rasen_threading_t *hooks) {
+    if (hooks) {
+        threading = *hooks;
+    } else {
+        memset(&threading, 0, sizeof(threading));
+    }
+}
+
+// ============ Event Queue ============
+
+#ifndef RASEN_EVENT_QUEUE_SIZE
+#define RASEN_EVENT_QUEUE_SIZE 32       // Power of two
+#endif
+#ifndef RASEN_EVENT_BUDGET_US
+#define RASEN_EVENT_BUDGET_US 8000      // Handler time per qjs_rasen_process_events()
+#endif
+
+/**
+ * LVGL callbacks only record events here; qjs_rasen_process_events()
+ * runs the handlers outside lv_timer_handler(), so JS never mutates the
+ * tree while LVGL is iterating it. Events past the per-call budget wait
+ * for the next loop iteration, after LVGL has rendered a frame.
+ *
+ * Single producer (LVGL task), single consumer (JS task): each side only
+ * writes its own index, published with release/acquire ordering, so the
+ * queue needs no lock when the two run on different cores.
+ */
+typedef enum {
+    EVENT_HANDLER = 0,      // target: handler id
+    EVENT_LIST,             // target: node handle of a scrolled or resized virtual list
+} rasen_event_kind_t;
+
+typedef struct {
+    uint32_t target;
+    uint8_t kind;           // rasen_event_kind_t
+    uint16_t code;          // lv_event_code_t
+    int16_t x, y;           // Pointer position when the event fired
+} rasen_event_t;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define QUEUE_LOAD(p)     __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define QUEUE_STORE(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#else
+// Compilers without the builtins only build the single-task front ends
+#define QUEUE_LOAD(p)     (*(volatile uint32_t *)(p))
+#define QUEUE_STORE(p, v) (*(volatile uint32_t *)(p) = (v))
+#endif
+
+static rasen_event_t event_queue[RASEN_EVENT_QUEUE_SIZE];
+static uint32_t event_head = 0;     // Next slot to read, written by the consumer
+static uint32_t event_tail = 0;     // Next slot to write, written by the producer
+
+static bool event_queue_empty(void) {
+    return QUEUE_LOAD(&event_head) == QUEUE_LOAD(&event_tail);
+}
+
+// Set while the runtime itself changes a widget; events LVGL raises for that are not input
+static bool suppress_events = false;
+
+static void list_run_event(JSContext *ctx, uint32_t node_handle);
+static JSValue read_event_value(JSContext *ctx, lv_obj_t *obj);
+
+// A change for target still waiting in the queue
+static bool event_change_queued(uint32_t target) {
+    for (uint32_t i = QUEUE_LOAD(&event_head); i != event_tail; i++) {
+        const rasen_event_t *ev = &event_queue[i % RASEN_EVENT_QUEUE_SIZE];
+        if (ev->kind == EVENT_HANDLER && ev->target == target && ev->code == LV_EVENT_VALUE_CHANGED) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Record an LVGL event; false (and counted as dropped) if the queue is full
+static bool event_push(rasen_event_kind_t kind, uint32_t target, lv_event_t *e) {
+    /*
+     * A dragged slider reports every input sample. The handler reads the
+     * widget's value when it runs (under the LVGL lock, so never older
+     * than this event), so one queued change per target is enough.
+     */
+    if (kind == EVENT_HANDLER && lv_event_get_code(e) == LV_EVENT_VALUE_CHANGED &&
+        event_change_queued(target)) {
+        rasen_stats.events_coalesced++;
+        return true;
+    }
+    if (event_tail - QUEUE_LOAD(&event_head) >= RASEN_EVENT_QUEUE_SIZE) {
+        rasen_stats.events_dropped++;
+        return false;
+    }
+    
+    rasen_event_t *ev = &event_queue[event_tail % RASEN_EVENT_QUEUE_SIZE];
+    ev->target = target;
+    ev->kind = (uint8_t)kind;
+    ev->code = (uint16_t)lv_event_get_code(e);
+    ev->x = ev->y = 0;
+    
+    lv_indev_t *indev = lv_indev_get_act();
+    if (indev) {
+        lv_point_t point;
+        lv_indev_get_point(indev, &point);
+        ev->x = (int16_t)point.x;
+        ev->y = (int16_t)point.y;
+    }
+    QUEUE_STORE(&event_tail, event_tail + 1);
+    
+    if (threading.wake_js) threading.wake_js();
+    return true;
+}
+
+static void invoke_handler(JSContext *ctx, const rasen_event_t *ev) {
+    handler_entry_t *entry = handle_get(&handler_table, ev->target);
+    if (!entry) return;   // Object deleted since the event was queued
+    
+    uint64_t start = rasen_stats_now_us();
+    
+    JSValue arg = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, arg, "code", JS_NewInt32(ctx, ev->code));
+    JS_SetPropertyStr(ctx, arg, "x", JS_NewInt32(ctx, ev->x));
+    JS_SetPropertyStr(ctx, arg, "y", JS_NewInt32(ctx, ev->y));
+    if (ev->code == LV_EVENT_VALUE_CHANGED) {
+        lvgl_lock();
+        JSValue value = read_event_value(ctx, entry->obj);
+        lvgl_unlock();
+        if (!JS_IsUndefined(value)) JS_SetPropertyStr(ctx, arg, "value", value);
+    }
+    
+    // The handler may register new handlers and grow the slab; keep our own ref
+    JSValue func = JS_DupValue(ctx, entry->func);
+    RASEN_PROF_BEGIN(prof_start);
+    JSValue ret = JS_Call(ctx, func, JS_UNDEFINED, 1, &arg);
+    RASEN_PROF_END(RASEN_PROF_CALL, "handler", prof_start);
+    if (JS_IsException(ret)) {
+        JSValue exc = JS_GetException(ctx);
+        const char *str = JS_ToCString(ctx, exc);
+        printf("JS Error: %s\n", str);
+        JS_FreeCString(ctx, str);
+        JS_FreeValue(ctx, exc);
+    }
+    JS_FreeValue(ctx, ret);
+    JS_FreeValue(ctx, func);
+    JS_FreeValue(ctx, arg);
+    needs_rerender = true;
+    rasen_stats.render_requests++;
+    rasen_stats_add_time(RASEN_TIME_JS, start);
+}
+
+// Run queued handlers in order until the queue is empty or the budget is spent
+static void drain_events(JSContext *ctx) {
+    uint64_t start = rasen_stats_now_us();
+    
+    while (!event_queue_empty()) {
+        rasen_event_t ev = event_queue[event_head % RASEN_EVENT_QUEUE_SIZE];
+        QUEUE_STORE(&event_head, event_head + 1);
+        if (ev.kind == EVENT_LIST) {
+            list_run_event(ctx, ev.target);
+        } else {
+            invoke_handler(ctx, &ev);
+        }
+        
+        if (!event_queue_empty() && rasen_stats_now_us() - start >= RASEN_EVENT_BUDGET_US) {
+            rasen_stats.events_deferred++;
+            break;
+        }
+    }
+    
+    // Worker replies share the budget but always make progress
+    if (rasen_worker_dispatch(ctx, start + RASEN_EVENT_BUDGET_US) > 0) {
+        needs_rerender = true;
+        rasen_stats.render_requests++;
+    }
+}
+
+// LVGL event callback: record, don't run
+static void lvgl_event_cb(lv_event_t *e) {
+    if (suppress_events) return;
+    event_push(EVENT_HANDLER, (uint32_t)(uintptr_t)lv_event_get_user_data(e), e);
+}
+
+// Only while the LVGL task is not producing (init and cleanup)
+static void event_queue_clear(void) {
+    QUEUE_STORE(&event_head, 0);
+    QUEUE_STORE(&event_tail, 0);
+}
+
+// ============ Native Shadow Tree ============
+
+typedef enum {
+    ELEM_UNKNOWN = 0,
+    ELEM_OBJ,
+    ELEM_LABEL,
+    ELEM_BTN,
+    ELEM_BAR,
+    ELEM_LIST,      // Virtual list: rows come from a JS callback, not children
+    ELEM_IMG,
+    ELEM_SLIDER,
+    ELEM_SWITCH,
+    ELEM_CHECKBOX,
+    ELEM_TEXTAREA,
+    ELEM_ARC,
+    ELEM_SPINNER,
+    ELEM_ROLLER,
+    ELEM_DROPDOWN,
+    ELEM_TABLE,
+    ELEM_CHART,
+    ELEM_TYPE_COUNT
+} elem_type_t;
+
+// Handler kinds a descriptor can carry in `handlers`
+typedef enum {
+    HANDLER_CLICK = 0,
+    HANDLER_LONG_PRESS,
+    HANDLER_CHANGE,
+    HANDLER_KIND_COUNT
+} handler_kind_t;
+
+static const struct {
+    const char *name;
+    lv_event_code_t code;
+} handler_kinds[HANDLER_KIND_COUNT] = {
+    [HANDLER_CLICK]      = { "click",      LV_EVENT_CLICKED },
+    [HANDLER_LONG_PRESS] = { "long_press", LV_EVENT_LONG_PRESSED },
+    [HANDLER_CHANGE]     = { "change",     LV_EVENT_VALUE_CHANGED },
+};
+
+// Reactive sources a descriptor can bind in `bind`
+typedef enum {
+    BIND_TEXT = 0,
+    BIND_VALUE,
+    BIND_COUNT,
+    BIND_KIND_COUNT
+} bind_kind_t;
+
+static const char *bind_kind_names[BIND_KIND_COUNT] = {
+    [BIND_TEXT]  = "text",
+    [BIND_VALUE] = "value",
+    [BIND_COUNT] = "count",
+};
+
+/**
+ * Per-object record of what was last applied from a descriptor.
+ * Attached to the lv_obj_t as user data and freed on LV_EVENT_DELETE,
+ * so the live LVGL tree doubles as the previous descriptor tree.
+ */
+typedef struct {
+    lv_obj_t *obj;
+    uint32_t handle;    // Entry in node_table, used by binding callbacks
+    elem_type_t type;
+    char *key;          // Optional descriptor key, NULL if unkeyed
+    tw_style_t *style;  // Shared style from the class string, NULL if none
+    uint32_t handler_ids[HANDLER_KIND_COUNT];
+    JSValue bind_source[BIND_KIND_COUNT];   // Bound ref/getter, JS_UNDEFINED if none
+    JSValue bind_stop[BIND_KIND_COUNT];     // watch() stop handle
+    struct list_state *list;                // ELEM_LIST only
+    int32_t chart_min, chart_max;           // ELEM_CHART: Y range last applied
+    bool chart_ranged;                      // chart_min / chart_max are set
+    uint32_t memo;      // memo() stamp the whole subtree was last built from, 0 if none
+} rasen_node_t;
+
+/**
+ * Materialized window of a virtual list. Rows sit at a fixed pitch, so
+ * the visible range follows directly from the scroll offset; rows
+ * outside it (plus overscan) go back to the widget pool.
+ */
+typedef struct list_state {
+    JSValue render;     // Row callback: index -> descriptor
+    uint32_t count;
+    lv_coord_t row_h;
+    uint32_t overscan;
+    uint32_t first;     // rows[j] shows index first + j
+    uint32_t len;
+    lv_obj_t **rows;    // Entries are NULL where a row failed to render
+    lv_obj_t *spacer;   // Sizes the scrollable content to count * row_h
+    bool updating;
+    bool queued;        // An EVENT_LIST for this list is in the event queue
+} list_state_t;
+
+// Slots hold rasen_node_t pointers; the nodes themselves are owned by user data
+static handle_table_t node_table = HANDLE_TABLE_INIT(rasen_node_t *);
+
+static rasen_node_t *node_from_handle(uint32_t handle) {
+    rasen_node_t **slot = handle_get(&node_table, handle);
+    return slot ? *slot : NULL;
+}
+
+// Returns a malloc'd copy of desc.key, or NULL if the descriptor is unkeyed
+static char *read_desc_key(JSContext *ctx, JSValue desc) {
+    JSValue key_val = JS_GetPropertyStr(ctx, desc, "key");
+    char *key = NULL;
+    if (!JS_IsUndefined(key_val) && !JS_IsNull(key_val)) {
+        const char *str = JS_ToCString(ctx, key_val);
+        if (str) {
+            key = strdup(str);
+            JS_FreeCString(ctx, str);
+        }
+    }
+    JS_FreeValue(ctx, key_val);
+    return key;
+}
+
+static rasen_node_t *get_node(lv_obj_t *obj) {
+    return (rasen_node_t *)lv_obj_get_user_data(obj);
+}
+
+static void unbind_node(JSContext *ctx, rasen_node_t *node, bind_kind_t kind) {
+    if (JS_IsUndefined(node->bind_stop[kind])) return;
+    
+    JSValue ret = JS_Call(ctx, node->bind_stop[kind], JS_UNDEFINED, 0, NULL);
+    JS_FreeValue(ctx, ret);
+    JS_FreeValue(ctx, node->bind_stop[kind]);
+    JS_FreeValue(ctx, node->bind_source[kind]);
+    node->bind_stop[kind] = JS_UNDEFINED;
+    node->bind_source[kind] = JS_UNDEFINED;
+}
+
+// Drop every JS reference a node holds
+static void release_node_js(JSContext *ctx, rasen_node_t *node) {
+    for (int k = 0; k < BIND_KIND_COUNT && ctx; k++) {
+        unbind_node(ctx, node, k);
+    }
+    for (int k = 0; k < HANDLER_KIND_COUNT; k++) {
+        release_handler(ctx, node->handler_ids[k]);
+        node->handler_ids[k] = 0;
+    }
+    if (node->list && ctx) {
+        JS_FreeValue(ctx, node->list->render);
+        node->list->render = JS_UNDEFINED;
+    }
+}
+
+static void node_delete_cb(lv_event_t *e) {
+    lv_obj_t *obj = lv_event_get_target(e);
+    rasen_node_t *node = get_node(obj);
+    if (!node) return;
+    
+    release_node_js(global_ctx, node);
+    handle_free(&node_table, node->handle);
+    rasen_stats.objects_deleted++;
+    lv_obj_set_user_data(obj, NULL);
+    tw_style_release(node->style);
+    if (node->list) {
+        free(node->list->rows);
+        free(node->list);
+    }
+    free(node->key);
+    free(node);
+}
+
+// ============ Feature Selection ============
+
+/*
+ * RASEN_USE_<TYPE> 0 compiles an element type out even where lv_conf.h
+ * enables the widget, so nothing of ours references its LVGL code.
+ * `rasen-lvgl build` writes them for the types an app actually creates
+ * (see RASEN_FEATURES_H in qjs_rasen.h); left alone, every widget that
+ * lv_conf.h enables is available.
+ */
+#ifndef RASEN_USE_BAR
+#define RASEN_USE_BAR 1
+#endif
+#ifndef RASEN_USE_IMG
+#define RASEN_USE_IMG 1
+#endif
+#ifndef RASEN_USE_SLIDER
+#define RASEN_USE_SLIDER 1
+#endif
+#ifndef RASEN_USE_SWITCH
+#define RASEN_USE_SWITCH 1
+#endif
+#ifndef RASEN_USE_CHECKBOX
+#define RASEN_USE_CHECKBOX 1
+#endif
+#ifndef RASEN_USE_TEXTAREA
+#define RASEN_USE_TEXTAREA 1
+#endif
+#ifndef RASEN_USE_ARC
+#define RASEN_USE_ARC 1
+#endif
+#ifndef RASEN_USE_SPINNER
+#define RASEN_USE_SPINNER 1
+#endif
+#ifndef RASEN_USE_ROLLER
+#define RASEN_USE_ROLLER 1
+#endif
+#ifndef RASEN_USE_DROPDOWN
+#define RASEN_USE_DROPDOWN 1
+#endif
+#ifndef RASEN_USE_TABLE
+#define RASEN_USE_TABLE 1
+#endif
+#ifndef RASEN_USE_CHART
+#define RASEN_USE_CHART 1
+#endif
+
+#define RASEN_HAS_BAR       (LV_USE_BAR && RASEN_USE_BAR)
+#define RASEN_HAS_IMG       (LV_USE_IMG && RASEN_USE_IMG)
+#define RASEN_HAS_SLIDER    (LV_USE_SLIDER && RASEN_USE_SLIDER)
+#define RASEN_HAS_SWITCH    (LV_USE_SWITCH && RASEN_USE_SWITCH)
+#define RASEN_HAS_CHECKBOX  (LV_USE_CHECKBOX && RASEN_USE_CHECKBOX)
+#define RASEN_HAS_TEXTAREA  (LV_USE_TEXTAREA && RASEN_USE_TEXTAREA)
+#define RASEN_HAS_ARC       (LV_USE_ARC && RASEN_USE_ARC)
+#define RASEN_HAS_SPINNER   (LV_USE_SPINNER && RASEN_USE_SPINNER)
+#define RASEN_HAS_ROLLER    (LV_USE_ROLLER && RASEN_USE_ROLLER)
+#define RASEN_HAS_DROPDOWN  (LV_USE_DROPDOWN && RASEN_USE_DROPDOWN)
+#define RASEN_HAS_TABLE     (LV_USE_TABLE && RASEN_USE_TABLE)
+#define RASEN_HAS_CHART     (LV_USE_CHART && RASEN_USE_CHART)
+
+// ============ Widget Types ============
+
+#ifndef RASEN_CHART_MAX_SERIES
+#define RASEN_CHART_MAX_SERIES 4        // Series per chart element
+#endif
+
+/**
+ * Decoded descriptor properties. Filled either from a descriptor object
+ * (read_desc_props) or from a command buffer (commit_children), so both
+ * front ends share one patch path. Strings and JS values are borrowed.
+ */
+typedef struct {
+    elem_type_t type;
+    const char *key;                       // NULL if unkeyed
+    int32_t style_id;                      // > 0: precompiled style id
+    const char *class_str;                 // Used when style_id <= 0
+    const char *text;                      // Labels, checkboxes, textareas; NULL leaves the text alone
+    const char *placeholder;               // Textareas
+    const char *options;                   // Dropdowns, rollers: one option per line
+    const char *src;                       // Images: file path or symbol
+    int32_t rows, cols;                    // Tables: cell counts, -1 keeps the widget's
+    const char **cells;                    // Tables: rows * cols, row-major (NULL entries are empty); owned
+    bool has_value;                        // false leaves the widget's own value alone
+    int32_t value, min, max;               // Bars, sliders, arcs; checked (0/1) or selected index
+    int32_t count, row_h, overscan;        // Lists
+    JSValue render;                        // Lists: row callback
+    int32_t points;                        // Charts: ring length per series, 0 keeps it
+    int32_t chart_kind, chart_mode;        // Charts: 0 line / 1 bar, 0 shift / 1 circular
+    uint32_t series_count;
+    uint32_t series_colors[RASEN_CHART_MAX_SERIES];  // 0xRRGGBB
+    JSValue stream;                        // Charts: chartStream() to attach, JS_UNDEFINED if none
+    JSValue handlers[HANDLER_KIND_COUNT];  // JS_UNDEFINED if none
+    JSValue bind[BIND_KIND_COUNT];         // JS_UNDEFINED if none
+} elem_props_t;
+
+static void props_init(elem_props_t *props) {
+    memset(props, 0, sizeof(*props));
+    props->max = 100;
+    props->row_h = 32;
+    props->rows = -1;
+    props->cols = -1;
+    props->render = JS_UNDEFINED;
+    props->stream = JS_UNDEFINED;
+    for (int k = 0; k < HANDLER_KIND_COUNT; k++) props->handlers[k] = JS_UNDEFINED;
+    for (int k = 0; k < BIND_KIND_COUNT; k++) props->bind[k] = JS_UNDEFINED;
+}
+
+/*
+ * Setters compare against the widget first, so patching an unchanged
+ * node causes no invalidation. set_value also takes `bind.value` updates
+ * and set_text `bind.text` updates; get_value is the `value` of change
+ * events.
+ */
+
+static void set_label_text(lv_obj_t *obj, const char *text) {
+    if (strcmp(lv_label_get_text(obj), text) != 0) {
+        lv_label_set_text(obj, text);
+    }
+}
+
+#if RASEN_HAS_BAR
+static void patch_bar(lv_obj_t *obj, const elem_props_t *props) {
+    if (lv_bar_get_min_value(obj) != props->min || lv_bar_get_max_value(obj) != props->max) {
+        lv_bar_set_range(obj, props->min, props->max);
+    }
+}
+
+static void set_bar_value(lv_obj_t *obj, int32_t value) {
+    if (lv_bar_get_value(obj) != value) {
+        lv_bar_set_value(obj, value, LV_ANIM_OFF);
+    }
+}
+
+static JSValue get_bar_value(JSContext *ctx, lv_obj_t *obj) {
+    return JS_NewInt32(ctx, lv_bar_get_value(obj));
+}
+#endif
+
+#if RASEN_HAS_SWITCH || RASEN_HAS_CHECKBOX
+// Switches and checkboxes keep their value in LV_STATE_CHECKED
+static void set_checked(lv_obj_t *obj, int32_t value) {
+    bool checked = value != 0;
+    if (lv_obj_has_state(obj, LV_STATE_CHECKED) != checked) {
+        if (checked) {
+            lv_obj_add_state(obj, LV_STATE_CHECKED);
+        } else {
+            lv_obj_clear_state(obj, LV_STATE_CHECKED);
+        }
+    }
+}
+
+static JSValue get_checked(JSContext *ctx, lv_obj_t *obj) {
+    return JS_NewBool(ctx, lv_obj_has_state(obj, LV_STATE_CHECKED));
+}
+#endif
+
+#if RASEN_HAS_IMG
+static void patch_img(lv_obj_t *obj, const elem_props_t *props) {
+    if (!props->src) return;
+    const void *cur = lv_img_get_src(obj);
+    
+    // Names from the build's image table map to descriptors in that table
+    const void *converted = rasen_img_lookup(props->src);
+    if (converted) {
+        if (cur != converted) lv_img_set_src(obj, converted);
+        return;
+    }
+    // lv_img copies path and symbol sources, so the old one can be compared as text
+    if (!cur || lv_img_src_get_type(cur) == LV_IMG_SRC_VARIABLE || strcmp(cur, props->src) != 0) {
+        lv_img_set_src(obj, props->src);
+    }
+}
+#endif
+
+#if RASEN_HAS_SLIDER
+static void patch_slider(lv_obj_t *obj, const elem_props_t *props) {
+    if (lv_slider_get_min_value(obj) != props->min || lv_slider_get_max_value(obj) != props->max) {
+        lv_slider_set_range(obj, props->min, props->max);
+    }
+}
+
+static void set_slider_value(lv_obj_t *obj, int32_t value) {
+    if (lv_slider_get_value(obj) != value) {
+        lv_slider_set_value(obj, value, LV_ANIM_OFF);
+    }
+}
+
+static JSValue get_slider_value(JSContext *ctx, lv_obj_t *obj) {
+    return JS_NewInt32(ctx, lv_slider_get_value(obj));
+}
+#endif
+
+#if RASEN_HAS_CHECKBOX
+static void set_checkbox_text(lv_obj_t *obj, const char *text) {
+    if (strcmp(lv_checkbox_get_text(obj), text) != 0) {
+        lv_checkbox_set_text(obj, text);
+    }
+}
+#endif
+
+#if RASEN_HAS_TEXTAREA
+static void patch_textarea(lv_obj_t *obj, const elem_props_t *props) {
+    if (props->placeholder && strcmp(lv_textarea_get_placeholder_text(obj), props->placeholder) != 0) {
+        lv_textarea_set_placeholder_text(obj, props->placeholder);
+    }
+}
+
+static void set_textarea_text(lv_obj_t *obj, const char *text) {
+    if (strcmp(lv_textarea_get_text(obj), text) != 0) {
+        // Reports LV_EVENT_VALUE_CHANGED itself; that is not user input
+        suppress_events = true;
+        lv_textarea_set_text(obj, text);
+        suppress_events = false;
+    }
+}
+
+static JSValue get_textarea_text(JSContext *ctx, lv_obj_t *obj) {
+    return JS_NewString(ctx, lv_textarea_get_text(obj));
+}
+#endif
+
+#if RASEN_HAS_ARC
+static void patch_arc(lv_obj_t *obj, const elem_props_t *props) {
+    if (lv_arc_get_min_value(obj) != props->min || lv_arc_get_max_value(obj) != props->max) {
+        lv_arc_set_range(obj, (int16_t)props->min, (int16_t)props->max);
+    }
+}
+
+static void set_arc_value(lv_obj_t *obj, int32_t value) {
+    if (lv_arc_get_value(obj) != value) {
+        lv_arc_set_value(obj, (int16_t)value);
+    }
+}
+
+static JSValue get_arc_value(JSContext *ctx, lv_obj_t *obj) {
+    return JS_NewInt32(ctx, lv_arc_get_value(obj));
+}
+#endif
+
+#if RASEN_HAS_SPINNER
+static lv_obj_t *create_spinner(lv_obj_t *parent) {
+    return lv_spinner_create(parent, 1000, 60);
+}
+#endif
+
+#if RASEN_HAS_ROLLER
+// Setting options resets the selection, so the value is applied after this
+static void patch_roller(lv_obj_t *obj, const elem_props_t *props) {
+    if (props->options && strcmp(lv_roller_get_options(obj), props->options) != 0) {
+        lv_roller_set_options(obj, props->options, LV_ROLLER_MODE_NORMAL);
+    }
+}
+
+static void set_roller_selected(lv_obj_t *obj, int32_t value) {
+    if (lv_roller_get_selected(obj) != value) {
+        lv_roller_set_selected(obj, (uint16_t)value, LV_ANIM_OFF);
+    }
+}
+
+static JSValue get_roller_selected(JSContext *ctx, lv_obj_t *obj) {
+    return JS_NewInt32(ctx, lv_roller_get_selected(obj));
+}
+#endif
+
+#if RASEN_HAS_TABLE
+static void patch_table(lv_obj_t *obj, const elem_props_t *props) {
+    if (props->rows >= 0 && lv_table_get_row_cnt(obj) != props->rows) {
+        lv_table_set_row_cnt(obj, (uint16_t)props->rows);
+    }
+    if (props->cols >= 0 && lv_table_get_col_cnt(obj) != props->cols) {
+        lv_table_set_col_cnt(obj, (uint16_t)props->cols);
+    }
+    if (!props->cells) return;
+
+    // Cells are only rewritten (and the table invalidated) where the text differs
+    for (uint16_t r = 0; r < props->rows; r++) {
+        for (uint16_t c = 0; c < props->cols; c++) {
+            const char *text = props->cells[(uint32_t)r * props->cols + c];
+            const char *cur = lv_table_get_cell_value(obj, r, c);
+            if (!text) text = "";
+            if (strcmp(cur ? cur : "", text) != 0) {
+                lv_table_set_cell_value(obj, r, c, text);
+            }
+        }
+    }
+}
+
+// The pressed cell as { row, col }, null if none
+static JSValue get_table_selected(JSContext *ctx, lv_obj_t *obj) {
+    uint16_t row, col;
+    lv_table_get_selected_cell(obj, &row, &col);
+    if (row == LV_TABLE_CELL_NONE || col == LV_TABLE_CELL_NONE) return JS_NULL;
+
+    JSValue cell = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, cell, "row", JS_NewInt32(ctx, row));
+    JS_SetPropertyStr(ctx, cell, "col", JS_NewInt32(ctx, col));
+    return cell;
+}
+#endif
+
+#if RASEN_HAS_DROPDOWN
+static void patch_dropdown(lv_obj_t *obj, const elem_props_t *props) {
+    if (props->options && strcmp(lv_dropdown_get_options(obj), props->options) != 0) {
+        lv_dropdown_set_options(obj, props->options);
+    }
+}
+
+static void set_dropdown_selected(lv_obj_t *obj, int32_t value) {
+    if (lv_dropdown_get_selected(obj) != value) {
+        lv_dropdown_set_selected(obj, (uint16_t)value);
+    }
+}
+
+static JSValue get_dropdown_selected(JSContext *ctx, lv_obj_t *obj) {
+    return JS_NewInt32(ctx, lv_dropdown_get_selected(obj));
+}
+#endif
+
+#define ELEM_F_CONTAINER 0x01   // Children are reconciled
+#define ELEM_F_EVENTS    0x02   // Takes `handlers`
+#define ELEM_F_RANGE     0x04   // Reads `min` / `max`
+#define ELEM_F_POOLED    0x08   // Removed objects may be parked in the widget pool
+
+/**
+ * Everything type-specific, indexed by elem_type_t (which is also the type
+ * code of the command buffer). Widgets compiled out (lv_conf.h or
+ * RASEN_USE_*) keep only their name; descriptors using them are reported
+ * and skipped.
+ */
+typedef struct {
+    const char *name;                                        // Descriptor `type`
+    lv_obj_t *(*create)(lv_obj_t *parent);                   // NULL if not enabled
+    void (*patch)(lv_obj_t *obj, const elem_props_t *props); // Runs before set_text / set_value
+    void (*set_text)(lv_obj_t *obj, const char *text);
+    void (*set_value)(lv_obj_t *obj, int32_t value);
+    JSValue (*get_value)(JSContext *ctx, lv_obj_t *obj);
+    uint8_t flags;
+} elem_class_t;
+
+static const elem_class_t elem_classes[ELEM_TYPE_COUNT] = {
+    [ELEM_OBJ]      = { "obj",      lv_obj_create,      .flags = ELEM_F_CONTAINER | ELEM_F_EVENTS | ELEM_F_POOLED },
+    [ELEM_LABEL]    = { "label",    lv_label_create,    .set_text = set_label_text, .flags = ELEM_F_POOLED },
+    [ELEM_BTN]      = { "btn",      lv_btn_create,      .flags = ELEM_F_CONTAINER | ELEM_F_EVENTS | ELEM_F_POOLED },
+#if RASEN_HAS_BAR
+    [ELEM_BAR]      = { "bar",      lv_bar_create,      patch_bar, .set_value = set_bar_value,
+                        .get_value = get_bar_value, .flags = ELEM_F_RANGE | ELEM_F_POOLED },
+#else
+    [ELEM_BAR]      = { "bar" },
+#endif
+    // Rows are driven by patch_list(); the container itself is a plain object
+    [ELEM_LIST]     = { "list",     lv_obj_create },
+#if RASEN_HAS_IMG
+    [ELEM_IMG]      = { "img",      lv_img_create,      patch_img, .flags = ELEM_F_EVENTS },
+#else
+    [ELEM_IMG]      = { "img" },
+#endif
+#if RASEN_HAS_SLIDER
+    [ELEM_SLIDER]   = { "slider",   lv_slider_create,   patch_slider, .set_value = set_slider_value,
+                        .get_value = get_slider_value, .flags = ELEM_F_EVENTS | ELEM_F_RANGE },
+#else
+    [ELEM_SLIDER]   = { "slider" },
+#endif
+#if RASEN_HAS_SWITCH
+    [ELEM_SWITCH]   = { "switch",   lv_switch_create,   .set_value = set_checked,
+                        .get_value = get_checked, .flags = ELEM_F_EVENTS },
+#else
+    [ELEM_SWITCH]   = { "switch" },
+#endif
+#if RASEN_HAS_CHECKBOX
+    [ELEM_CHECKBOX] = { "checkbox", lv_checkbox_create, .set_text = set_checkbox_text, .set_value = set_checked,
+                        .get_value = get_checked, .flags = ELEM_F_EVENTS },
+#else
+    [ELEM_CHECKBOX] = { "checkbox" },
+#endif
+#if RASEN_HAS_TEXTAREA
+    [ELEM_TEXTAREA] = { "textarea", lv_textarea_create, patch_textarea, .set_text = set_textarea_text,
+                        .get_value = get_textarea_text, .flags = ELEM_F_EVENTS },
+#else
+    [ELEM_TEXTAREA] = { "textarea" },
+#endif
+#if RASEN_HAS_ARC
+    [ELEM_ARC]      = { "arc",      lv_arc_create,      patch_arc, .set_value = set_arc_value,
+                        .get_value = get_arc_value, .flags = ELEM_F_EVENTS | ELEM_F_RANGE },
+#else
+    [ELEM_ARC]      = { "arc" },
+#endif
+#if RASEN_HAS_SPINNER
+    [ELEM_SPINNER]  = { "spinner",  create_spinner },
+#else
+    [ELEM_SPINNER]  = { "spinner" },
+#endif
+#if RASEN_HAS_ROLLER
+    [ELEM_ROLLER]   = { "roller",   lv_roller_create,   patch_roller, .set_value = set_roller_selected,
+                        .get_value = get_roller_selected, .flags = ELEM_F_EVENTS },
+#else
+    [ELEM_ROLLER]   = { "roller" },
+#endif
+#if RASEN_HAS_DROPDOWN
+    [ELEM_DROPDOWN] = { "dropdown", lv_dropdown_create, patch_dropdown, .set_value = set_dropdown_selected,
+                        .get_value = get_dropdown_selected, .flags = ELEM_F_EVENTS },
+#else
+    [ELEM_DROPDOWN] = { "dropdown" },
+#endif
+#if RASEN_HAS_TABLE
+    [ELEM_TABLE]    = { "table",    lv_table_create,    patch_table, .get_value = get_table_selected,
+                        .flags = ELEM_F_EVENTS },
+#else
+    [ELEM_TABLE]    = { "table" },
+#endif
+#if RASEN_HAS_CHART
+    // Series and points are applied by patch_chart()
+    [ELEM_CHART]    = { "chart",    lv_chart_create,    .flags = ELEM_F_RANGE },
+#else
+    [ELEM_CHART]    = { "chart" },
+#endif
+};
+
+static bool is_container(elem_type_t type) {
+    return (elem_classes[type].flags & ELEM_F_CONTAINER) != 0;
+}
+
+// Name lookup for the C API; descriptors go through type_atoms instead
+static elem_type_t elem_type_from_name(const char *name) {
+    for (int t = ELEM_OBJ; t < ELEM_TYPE_COUNT; t++) {
+        if (strcmp(elem_classes[t].name, name) == 0) return (elem_type_t)t;
+    }
+    return ELEM_UNKNOWN;
+}
+
+// Type codes used by the command buffer are the elem_type_t values
+static elem_type_t elem_type_from_code(int32_t code) {
+    if (code <= ELEM_UNKNOWN || code >= ELEM_TYPE_COUNT || !elem_classes[code].create) {
+        return ELEM_UNKNOWN;
+    }
+    return (elem_type_t)code;
+}
+
+// Interned type names: resolving a descriptor's `type` is one atom lookup and integer compares
+static JSAtom type_atoms[ELEM_TYPE_COUNT];
+
+static void type_atoms_init(JSContext *ctx) {
+    for (int t = ELEM_OBJ; t < ELEM_TYPE_COUNT; t++) {
+        type_atoms[t] = JS_NewAtom(ctx, elem_classes[t].name);
+    }
+}
+
+static void type_atoms_free(JSContext *ctx) {
+    for (int t = ELEM_OBJ; t < ELEM_TYPE_COUNT; t++) {
+        if (type_atoms[t] != JS_ATOM_NULL) JS_FreeAtom(ctx, type_atoms[t]);
+        type_atoms[t] = JS_ATOM_NULL;
+    }
+}
+
+static elem_type_t read_desc_type(JSContext *ctx, JSValue desc) {
+    JSValue type_val = JS_GetPropertyStr(ctx, desc, "type");
+    elem_type_t t = ELEM_UNKNOWN;
+    
+    if (JS_IsString(type_val)) {
+        JSAtom atom = JS_ValueToAtom(ctx, type_val);
+        for (int i = ELEM_OBJ; i < ELEM_TYPE_COUNT; i++) {
+            if (type_atoms[i] == atom) {
+                t = (elem_type_t)i;
+                break;
+            }
+        }
+        JS_FreeAtom(ctx, atom);
+        
+        if (t == ELEM_UNKNOWN || !elem_classes[t].create) {
+            const char *type = JS_ToCString(ctx, type_val);
+            printf(t ? "Element type not compiled in: %s\n" : "Unknown element type: %s\n",
+                   type ? type : "?");
+            if (type) JS_FreeCString(ctx, type);
+            t = ELEM_UNKNOWN;
+        }
+    }
+    JS_FreeValue(ctx, type_val);
+    return t;
+}
+
+// The `value` of a change event: the widget's current value, or undefined
+static JSValue read_event_value(JSContext *ctx, lv_obj_t *obj) {
+    rasen_node_t *node = get_node(obj);
+    if (!node || !elem_classes[node->type].get_value) return JS_UNDEFINED;
+    return elem_classes[node->type].get_value(ctx, obj);
+}
+
+// ============ Widget Pool ============
+
+#ifndef RASEN_POOL_CAP
+#define RASEN_POOL_CAP 16
+#endif
+#ifndef RASEN_POOL_CAP_OBJ
+#define RASEN_POOL_CAP_OBJ RASEN_POOL_CAP
+#endif
+#ifndef RASEN_POOL_CAP_LABEL
+#define RASEN_POOL_CAP_LABEL RASEN_POOL_CAP
+#endif
+#ifndef RASEN_POOL_CAP_BTN
+#define RASEN_POOL_CAP_BTN RASEN_POOL_CAP
+#endif
+#ifndef RASEN_POOL_CAP_BAR
+#define RASEN_POOL_CAP_BAR RASEN_POOL_CAP
+#endif
+
+/**
+ * Per-type free lists of removed widgets. Instead of lv_obj_del() the
+ * reconciler parks objects here (hidden, on a screen that is never
+ * loaded, with styles, events and JS references stripped) and
+ * create_node() takes them back before calling lv_*_create(). Steady
+ * list churn then stops going through the LVGL allocator, and the pools
+ * are bounded by their caps. Parked objects keep their rasen_node_t.
+ */
+typedef struct {
+    lv_obj_t **items;
+    uint32_t count;
+    uint32_t cap;
+    uint32_t size;      // Allocated length of items
+} widget_pool_t;
+
+// Only ELEM_F_POOLED types are parked; the others' caps stay 0
+static widget_pool_t pools[ELEM_TYPE_COUNT] = {
+    [ELEM_OBJ]   = { .cap = RASEN_POOL_CAP_OBJ },
+    [ELEM_LABEL] = { .cap = RASEN_POOL_CAP_LABEL },
+    [ELEM_BTN]   = { .cap = RASEN_POOL_CAP_BTN },
+    [ELEM_BAR]   = { .cap = RASEN_POOL_CAP_BAR },
+};
+
+static lv_obj_t *pool_screen = NULL;
+
+// Remove everything a descriptor applied; the object looks freshly created
+static void pool_strip(lv_obj_t *obj, rasen_node_t *node) {
+    for (int k = 0; k < HANDLER_KIND_COUNT; k++) {
+        if (node->handler_ids[k]) {
+            lv_obj_remove_event_cb_with_user_data(obj, lvgl_event_cb, (void *)(uintptr_t)node->handler_ids[k]);
+        }
+    }
+    release_node_js(global_ctx, node);
+
+    if (node->style) {
+        lv_obj_remove_style(obj, &node->style->style, LV_PART_MAIN);
+        tw_style_release(node->style);
+        node->style = NULL;
+    }
+
+    // Binding callbacks holding the old handle must not find the node again
+    handle_free(&node_table, node->handle);
+    node->handle = 0;
+    free(node->key);
+    node->key = NULL;
+    node->memo = 0;
+
+    lv_anim_del(obj, NULL);
+    lv_indev_reset(NULL, obj);
+    lv_obj_clear_state(obj, LV_STATE_ANY);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_IGNORE_LAYOUT);
+    lv_obj_set_pos(obj, 0, 0);
+    lv_obj_scroll_to(obj, 0, 0, LV_ANIM_OFF);
+
+    // A descriptor that leaves out the range or value gets the defaults, not the last owner's
+    const elem_class_t *cls = &elem_classes[node->type];
+    if (cls->flags & ELEM_F_RANGE) {
+        elem_props_t defaults;
+        props_init(&defaults);
+        if (cls->patch) cls->patch(obj, &defaults);
+        if (cls->set_value) cls->set_value(obj, 0);
+    }
+    if (node->type == ELEM_LABEL) {
+        // Don't keep long texts alive in the LVGL heap
+        lv_label_set_text(obj, "");
+    }
+}
+
+static bool pool_reserve(widget_pool_t *pool) {
+    if (pool->count < pool->size) return true;
+
+    uint32_t size = pool->size ? pool->size * 2 : 4;
+    if (size > pool->cap) size = pool->cap;
+    lv_obj_t **items = realloc(pool->items, size * sizeof(lv_obj_t *));
+    if (!items) return false;
+    pool->items = items;
+    pool->size = size;
+    return true;
+}
+
+/**
+ * Take obj out of the tree: park it (children first) if its pool has
+ * room, delete it otherwise.
+ */
+static void pool_release(lv_obj_t *obj) {
+    rasen_node_t *node = get_node(obj);
+    widget_pool_t *pool = node ? &pools[node->type] : NULL;
+
+    if (!pool || pool->count >= pool->cap || !pool_reserve(pool)) {
+        lv_obj_del(obj);
+        return;
+    }
+    if (!pool_screen) {
+        pool_screen = lv_obj_create(NULL);
+        if (!pool_screen) {
+            lv_obj_del(obj);
+            return;
+        }
+    }
+
+    // Park containers empty so each child goes back to its own pool
+    uint32_t child_cnt;
+    while ((child_cnt = lv_obj_get_child_cnt(obj)) > 0) {
+        pool_release(lv_obj_get_child(obj, child_cnt - 1));
+    }
+
+    pool_strip(obj, node);
+    lv_obj_add_flag(obj, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_set_parent(obj, pool_screen);
+    pool->items[pool->count++] = obj;
+    rasen_stats.objects_pooled++;
+}
+
+// A parked object of this type moved to parent, or NULL if the pool is empty
+static lv_obj_t *pool_take(elem_type_t type, lv_obj_t *parent) {
+    widget_pool_t *pool = &pools[type];
+    if (!pool->count) return NULL;
+
+    lv_obj_t *obj = pool->items[--pool->count];
+    rasen_stats.objects_pooled--;
+    rasen_stats.pool_reuses++;
+    lv_obj_set_parent(obj, parent);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_HIDDEN);
+    return obj;
+}
+
+// Delete parked objects beyond the pool's cap
+static void pool_trim(widget_pool_t *pool) {
+    while (pool->count > pool->cap) {
+        lv_obj_del(pool->items[--pool->count]);
+        rasen_stats.objects_pooled--;
+    }
+}
+
+int qjs_rasen_set_pool_cap(const char *type, uint32_t cap) {
+    elem_type_t t = type ? elem_type_from_name(type) : ELEM_UNKNOWN;
+    if (type && !(elem_classes[t].flags & ELEM_F_POOLED)) return -1;
+
+    for (int i = ELEM_OBJ; i < ELEM_TYPE_COUNT; i++) {
+        if (type ? i != (int)t : !(elem_classes[i].flags & ELEM_F_POOLED)) continue;
+        pools[i].cap = cap;
+        pool_trim(&pools[i]);
+    }
+    return 0;
+}
+
+static void pool_destroy(void) {
+    for (int i = ELEM_OBJ; i < ELEM_TYPE_COUNT; i++) {
+        free(pools[i].items);
+        pools[i].items = NULL;
+        pools[i].count = 0;
+        pools[i].size = 0;
+    }
+    if (pool_screen) {
+        lv_obj_del(pool_screen);
+        pool_screen = NULL;
+    }
+    rasen_stats.objects_pooled = 0;
+}
+
+// ============ Element Creation ============
+
+static lv_obj_t *create_element_from_desc(JSContext *ctx, JSValue desc, elem_type_t type,
+                                          const char *key, lv_obj_t *parent);
+static void reconcile_children(JSContext *ctx, lv_obj_t *parent, JSValue children_val);
+static void patch_list(JSContext *ctx, lv_obj_t *obj, rasen_node_t *node, const elem_props_t *props);
+#if RASEN_HAS_CHART
+static void patch_chart(JSContext *ctx, lv_obj_t *obj, rasen_node_t *node, const elem_props_t *props);
+#endif
+static void list_set_count(JSContext *ctx, rasen_node_t *node, uint32_t count);
+static int check_exception(JSContext *ctx, JSValue ret, const char *what);
+
+static void patch_class(lv_obj_t *obj, rasen_node_t *node, const elem_props_t *props) {
+    // A positive id is a precompiled style from `rasen-lvgl build`
+    int32_t id = props->style_id;
+    const char *cur = id <= 0 && props->class_str ? props->class_str : "";
+    
+    bool same;
+    if (!node->style) {
+        same = id <= 0 && !cur[0];
+    } else if (node->style->id) {
+        same = node->style->id == id;
+    } else {
+        same = id <= 0 && strcmp(node->style->class_str, cur) == 0;
+    }
+    
+    if (!same) {
+        // Swap shared styles; theme styles and other local state stay untouched
+        tw_style_t *style = id > 0 ? tw_style_acquire_compiled((uint32_t)id) : tw_style_acquire(cur);
+        if (node->style) {
+            lv_obj_remove_style(obj, &node->style->style, LV_PART_MAIN);
+            tw_style_release(node->style);
+        }
+        if (style) {
+            lv_obj_add_style(obj, &style->style, LV_PART_MAIN);
+        }
+        node->style = style;
+    }
+}
+
+static void patch_handlers(JSContext *ctx, lv_obj_t *obj, rasen_node_t *node, const elem_props_t *props) {
+    for (int k = 0; k < HANDLER_KIND_COUNT; k++) {
+        JSValue fn = props->handlers[k];
+        
+        if (JS_IsFunction(ctx, fn)) {
+            if (node->handler_ids[k]) {
+                // Closures are recreated on every mount; swap in the new one
+                replace_handler(ctx, node->handler_ids[k], fn);
+            } else {
+                uint32_t id = register_handler(ctx, fn, obj);
+                if (id) {
+                    lv_obj_add_event_cb(obj, lvgl_event_cb, handler_kinds[k].code, (void *)(uintptr_t)id);
+                    node->handler_ids[k] = id;
+                }
+            }
+        } else if (node->handler_ids[k]) {
+            uint32_t id = node->handler_ids[k];
+            lv_obj_remove_event_cb_with_user_data(obj, lvgl_event_cb, (void *)(uintptr_t)id);
+            release_handler(ctx, id);
+            node->handler_ids[k] = 0;
+        }
+    }
+}
+
+// ============ Reactive Bindings ============
+
+// Apply a bound value to a single LVGL property; no rerender involved
+static void apply_bound_value(JSContext *ctx, rasen_node_t *node, bind_kind_t kind, JSValue value) {
+    const elem_class_t *cls = &elem_classes[node->type];
+    
+    if (kind == BIND_TEXT && cls->set_text) {
+        const char *text = JS_ToCString(ctx, value);
+        if (text) {
+            cls->set_text(node->obj, text);
+            JS_FreeCString(ctx, text);
+        }
+    }
+    else if (kind == BIND_VALUE && cls->set_value) {
+        // Booleans (a bound `checked`) convert to 0 / 1
+        int32_t v = 0;
+        JS_ToInt32(ctx, &v, value);
+        cls->set_value(node->obj, v);
+    }
+    else if (kind == BIND_COUNT && node->type == ELEM_LIST) {
+        uint32_t count = 0;
+        JS_ToUint32(ctx, &count, value);
+        list_set_count(ctx, node, count);
+    }
+}
+
+// watch() callback: magic = bind kind, data[0] = node handle. Effects run
+// unlocked, so the binding takes the LVGL lock for its own write only.
+static JSValue js_bound_update(JSContext *ctx, JSValueConst this_val, int argc,
+                               JSValueConst *argv, int magic, JSValue *func_data) {
+    uint32_t handle = 0;
+    JS_ToUint32(ctx, &handle, func_data[0]);
+    
+    lvgl_lock();
+    rasen_node_t *node = node_from_handle(handle);
+    if (node && argc > 0) {
+        apply_bound_value(ctx, node, (bind_kind_t)magic, argv[0]);
+    }
+    lvgl_unlock();
+    return JS_UNDEFINED;
+}
+
+static bool bind_node(JSContext *ctx, rasen_node_t *node, bind_kind_t kind, JSValue source) {
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue watch_fn = JS_GetPropertyStr(ctx, global, "watch");
+    JS_FreeValue(ctx, global);
+    
+    if (!JS_IsFunction(ctx, watch_fn)) {
+        JS_FreeValue(ctx, watch_fn);
+        return false;
+    }
+    
+    JSValue data = JS_NewUint32(ctx, node->handle);
+    JSValue cb = JS_NewCFunctionData(ctx, js_bound_update, 1, kind, 1, &data);
+    JSValue args[2] = { source, cb };
+    JSValue stop = JS_Call(ctx, watch_fn, JS_UNDEFINED, 2, args);
+    JS_FreeValue(ctx, cb);
+    JS_FreeValue(ctx, watch_fn);
+    
+    if (JS_IsException(stop)) {
+        JSValue exc = JS_GetException(ctx);
+        const char *str = JS_ToCString(ctx, exc);
+        printf("Bind error: %s\n", str);
+        JS_FreeCString(ctx, str);
+        JS_FreeValue(ctx, exc);
+        return false;
+    }
+    
+    node->bind_source[kind] = JS_DupValue(ctx, source);
+    node->bind_stop[kind] = stop;
+    return true;
+}
+
+static bool same_object(JSValue a, JSValue b) {
+    return JS_IsObject(a) && JS_IsObject(b) && JS_VALUE_GET_PTR(a) == JS_VALUE_GET_PTR(b);
+}
+
+/**
+ * Sync the bound sources with the node's subscriptions. A bound ref or
+ * getter updates its one LVGL property directly when it changes; rebinding
+ * only happens when the descriptor hands over a different source.
+ */
+static void patch_bindings(JSContext *ctx, rasen_node_t *node, const elem_props_t *props) {
+    for (int k = 0; k < BIND_KIND_COUNT; k++) {
+        JSValue src = props->bind[k];
+
+        if (!same_object(src, node->bind_source[k])) {
+            unbind_node(ctx, node, k);
+            if (JS_IsObject(src)) {
+                bind_node(ctx, node, k, src);
+            }
+        }
+    }
+}
+
+/**
+ * Bring an existing object in line with decoded properties of the same
+ * type. Only properties that differ from the last applied state touch
+ * LVGL, so unchanged nodes cause no invalidation. Children are left to
+ * the caller.
+ */
+static void patch_props(JSContext *ctx, lv_obj_t *obj, rasen_node_t *node, const elem_props_t *props) {
+    const elem_class_t *cls = &elem_classes[node->type];
+
+    if (cls->patch) cls->patch(obj, props);
+    if (props->text && cls->set_text) cls->set_text(obj, props->text);
+    if (props->has_value && cls->set_value) cls->set_value(obj, props->value);
+
+    if (!(cls->flags & ELEM_F_CONTAINER)) {
+        patch_bindings(ctx, node, props);
+    }
+    if (node->type == ELEM_LIST) {
+        patch_list(ctx, obj, node, props);
+    }
+#if RASEN_HAS_CHART
+    if (node->type == ELEM_CHART) {
+        patch_chart(ctx, obj, node, props);
+    }
+#endif
+
+    patch_class(obj, node, props);
+
+    if (cls->flags & ELEM_F_EVENTS) {
+        patch_handlers(ctx, obj, node, props);
+    }
+}
+
+// Create (or take from the pool) the LVGL object and its shadow node; nothing from props is applied yet
+static lv_obj_t *create_node(elem_type_t type, const char *key, lv_obj_t *parent) {
+    if (type == ELEM_UNKNOWN || !elem_classes[type].create) return NULL;
+
+    rasen_node_t *node;
+    lv_obj_t *obj = pool_take(type, parent);
+
+    if (obj) {
+        node = get_node(obj);
+    } else {
+        obj = elem_classes[type].create(parent);
+        if (!obj) return NULL;
+
+        node = calloc(1, sizeof(rasen_node_t));
+        if (!node) {
+            lv_obj_del(obj);
+            return NULL;
+        }
+        node->obj = obj;
+        node->type = type;
+        for (int k = 0; k < BIND_KIND_COUNT; k++) {
+            node->bind_source[k] = JS_UNDEFINED;
+            node->bind_stop[k] = JS_UNDEFINED;
+        }
+        lv_obj_set_user_data(obj, node);
+        lv_obj_add_event_cb(obj, node_delete_cb, LV_EVENT_DELETE, NULL);
+        rasen_stats.objects_created++;
+    }
+
+    node->handle = handle_alloc(&node_table, &node);
+    if (!node->handle) {
+        lv_obj_del(obj);
+        return NULL;
+    }
+    node->key = key ? strdup(key) : NULL;
+
+    return obj;
+}
+
+// ============ Descriptor Objects ============
+
+// desc[name] as a C string, NULL if absent
+static const char *read_desc_string(JSContext *ctx, JSValue desc, const char *name) {
+    JSValue val = JS_GetPropertyStr(ctx, desc, name);
+    const char *str = NULL;
+    if (!JS_IsUndefined(val) && !JS_IsNull(val)) {
+        str = JS_ToCString(ctx, val);
+    }
+    JS_FreeValue(ctx, val);
+    return str;
+}
+
+// desc.options (an array, or a string already) in the one-option-per-line form LVGL takes
+static const char *read_desc_options(JSContext *ctx, JSValue desc) {
+    JSValue val = JS_GetPropertyStr(ctx, desc, "options");
+    if (JS_IsArray(val)) {
+        JSValue join = JS_GetPropertyStr(ctx, val, "join");
+        JSValue sep = JS_NewString(ctx, "\n");
+        JSValue joined = JS_Call(ctx, join, val, 1, &sep);
+        JS_FreeValue(ctx, sep);
+        JS_FreeValue(ctx, join);
+        JS_FreeValue(ctx, val);
+        val = joined;
+    }
+    const char *str = NULL;
+    if (JS_IsString(val)) {
+        str = JS_ToCString(ctx, val);
+    } else if (JS_IsException(val)) {
+        check_exception(ctx, val, "Options error");
+        val = JS_UNDEFINED;
+    }
+    JS_FreeValue(ctx, val);
+    return str;
+}
+
+static int32_t read_desc_int(JSContext *ctx, JSValue desc, const char *name, int32_t def) {
+    JSValue val = JS_GetPropertyStr(ctx, desc, name);
+    int32_t v = def;
+    if (!JS_IsUndefined(val)) JS_ToInt32(ctx, &v, val);
+    JS_FreeValue(ctx, val);
+    return v;
+}
+
+/**
+ * rows, cols and cells (an array of rows, each an array of cell texts).
+ * Counts default to the size of cells; cells outside the arrays are empty.
+ */
+static void read_desc_table(JSContext *ctx, JSValue desc, elem_props_t *props) {
+    props->rows = read_desc_int(ctx, desc, "rows", -1);
+    props->cols = read_desc_int(ctx, desc, "cols", -1);
+
+    JSValue cells = JS_GetPropertyStr(ctx, desc, "cells");
+    if (JS_IsArray(cells) && props->rows >= 0 && props->rows <= UINT16_MAX &&
+        props->cols >= 0 && props->cols <= UINT16_MAX) {
+        size_t n = (size_t)props->rows * (size_t)props->cols;
+        props->cells = n ? calloc(n, sizeof(const char *)) : NULL;
+        for (int32_t r = 0; props->cells && r < props->rows; r++) {
+            JSValue row = JS_GetPropertyUint32(ctx, cells, (uint32_t)r);
+            if (JS_IsArray(row)) {
+                for (int32_t c = 0; c < props->cols; c++) {
+                    JSValue v = JS_GetPropertyUint32(ctx, row, (uint32_t)c);
+                    if (!JS_IsUndefined(v) && !JS_IsNull(v)) {
+                        props->cells[(size_t)r * props->cols + c] = JS_ToCString(ctx, v);
+                    }
+                    JS_FreeValue(ctx, v);
+                }
+            }
+            JS_FreeValue(ctx, row);
+        }
+    }
+    JS_FreeValue(ctx, cells);
+}
+
+// points, chartType, mode, series (array of 0xRRGGBB) and stream
+static void read_desc_chart(JSContext *ctx, JSValue desc, elem_props_t *props) {
+    props->points = read_desc_int(ctx, desc, "points", 0);
+    props->chart_kind = read_desc_int(ctx, desc, "chartType", 0);
+    props->chart_mode = read_desc_int(ctx, desc, "mode", 0);
+    props->stream = JS_GetPropertyStr(ctx, desc, "stream");
+
+    JSValue series = JS_GetPropertyStr(ctx, desc, "series");
+    if (JS_IsArray(series)) {
+        JSValue len_val = JS_GetPropertyStr(ctx, series, "length");
+        uint32_t len = 0;
+        JS_ToUint32(ctx, &len, len_val);
+        JS_FreeValue(ctx, len_val);
+        if (len > RASEN_CHART_MAX_SERIES) len = RASEN_CHART_MAX_SERIES;
+        for (uint32_t i = 0; i < len; i++) {
+            JSValue c = JS_GetPropertyUint32(ctx, series, i);
+            JS_ToUint32(ctx, &props->series_colors[i], c);
+            JS_FreeValue(ctx, c);
+        }
+        props->series_count = len;
+    }
+    JS_FreeValue(ctx, series);
+}
+
+// Fill props from a descriptor object; release with free_desc_props()
+static void read_desc_props(JSContext *ctx, JSValue desc, elem_props_t *props) {
+    props_init(props);
+    props->type = read_desc_type(ctx, desc);
+    props->key = read_desc_key(ctx, desc);
+
+    JSValue class_val = JS_GetPropertyStr(ctx, desc, "class");
+    if (JS_IsNumber(class_val)) {
+        JS_ToInt32(ctx, &props->style_id, class_val);
+    } else if (!JS_IsUndefined(class_val)) {
+        props->class_str = JS_ToCString(ctx, class_val);
+    }
+    JS_FreeValue(ctx, class_val);
+
+    const elem_class_t *cls = &elem_classes[props->type];
+
+    if (cls->set_text) {
+        props->text = read_desc_string(ctx, desc, "text");
+    }
+
+    if (cls->set_value) {
+        JSValue val = JS_GetPropertyStr(ctx, desc, "value");
+        if (!JS_IsUndefined(val) && !JS_IsNull(val)) {
+            JS_ToInt32(ctx, &props->value, val);
+            props->has_value = true;
+        }
+        JS_FreeValue(ctx, val);
+    }
+
+    if (cls->flags & ELEM_F_RANGE) {
+        JSValue min_val = JS_GetPropertyStr(ctx, desc, "min");
+        JSValue max_val = JS_GetPropertyStr(ctx, desc, "max");
+        if (!JS_IsUndefined(min_val)) JS_ToInt32(ctx, &props->min, min_val);
+        if (!JS_IsUndefined(max_val)) JS_ToInt32(ctx, &props->max, max_val);
+        JS_FreeValue(ctx, min_val);
+        JS_FreeValue(ctx, max_val);
+    }
+
+    if (props->type == ELEM_TEXTAREA) {
+        props->placeholder = read_desc_string(ctx, desc, "placeholder");
+    }
+    if (props->type == ELEM_IMG) {
+        props->src = read_desc_string(ctx, desc, "src");
+    }
+    if (props->type == ELEM_DROPDOWN || props->type == ELEM_ROLLER) {
+        props->options = read_desc_options(ctx, desc);
+    }
+    if (props->type == ELEM_CHART) {
+        read_desc_chart(ctx, desc, props);
+    }
+    if (props->type == ELEM_TABLE) {
+        read_desc_table(ctx, desc, props);
+    }
+
+    if (props->type == ELEM_LIST) {
+        JSValue count_val = JS_GetPropertyStr(ctx, desc, "count");
+        JSValue row_val = JS_GetPropertyStr(ctx, desc, "rowHeight");
+        JSValue overscan_val = JS_GetPropertyStr(ctx, desc, "overscan");
+        if (!JS_IsUndefined(count_val)) JS_ToInt32(ctx, &props->count, count_val);
+        if (!JS_IsUndefined(row_val)) JS_ToInt32(ctx, &props->row_h, row_val);
+        if (!JS_IsUndefined(overscan_val)) JS_ToInt32(ctx, &props->overscan, overscan_val);
+        props->render = JS_GetPropertyStr(ctx, desc, "render");
+        JS_FreeValue(ctx, count_val);
+        JS_FreeValue(ctx, row_val);
+        JS_FreeValue(ctx, overscan_val);
+    }
+
+    if (cls->flags & ELEM_F_EVENTS) {
+        JSValue handlers_val = JS_GetPropertyStr(ctx, desc, "handlers");
+        if (JS_IsObject(handlers_val)) {
+            for (int k = 0; k < HANDLER_KIND_COUNT; k++) {
+                props->handlers[k] = JS_GetPropertyStr(ctx, handlers_val, handler_kinds[k].name);
+            }
+        }
+        JS_FreeValue(ctx, handlers_val);
+    }
+    if (!(cls->flags & ELEM_F_CONTAINER)) {
+        JSValue bind_val = JS_GetPropertyStr(ctx, desc, "bind");
+        if (JS_IsObject(bind_val)) {
+            for (int k = 0; k < BIND_KIND_COUNT; k++) {
+                props->bind[k] = JS_GetPropertyStr(ctx, bind_val, bind_kind_names[k]);
+            }
+        }
+        JS_FreeValue(ctx, bind_val);
+    }
+}
+
+static void free_props_values(JSContext *ctx, elem_props_t *props) {
+    for (int k = 0; k < HANDLER_KIND_COUNT; k++) JS_FreeValue(ctx, props->handlers[k]);
+    for (int k = 0; k < BIND_KIND_COUNT; k++) JS_FreeValue(ctx, props->bind[k]);
+    JS_FreeValue(ctx, props->render);
+    JS_FreeValue(ctx, props->stream);
+    free(props->cells);
+}
+
+static void free_desc_props(JSContext *ctx, elem_props_t *props) {
+    free((char *)props->key);
+    if (props->class_str) JS_FreeCString(ctx, props->class_str);
+    if (props->text) JS_FreeCString(ctx, props->text);
+    if (props->placeholder) JS_FreeCString(ctx, props->placeholder);
+    if (props->options) JS_FreeCString(ctx, props->options);
+    if (props->src) JS_FreeCString(ctx, props->src);
+    if (props->cells) {
+        for (size_t i = 0; i < (size_t)props->rows * (size_t)props->cols; i++) {
+            if (props->cells[i]) JS_FreeCString(ctx, props->cells[i]);
+        }
+    }
+    free_props_values(ctx, props);
+}
+
+// memo() stamp of a descriptor, 0 if not memoized
+static uint32_t read_desc_memo(JSContext *ctx, JSValue desc) {
+    uint32_t memo = 0;
+    JSValue memo_val = JS_GetPropertyStr(ctx, desc, "memo");
+    if (JS_IsNumber(memo_val)) JS_ToUint32(ctx, &memo, memo_val);
+    JS_FreeValue(ctx, memo_val);
+    return memo;
+}
+
+/**
+ * A subtree built from the memo() result it was last built from needs no
+ * patching: same descriptors, same handlers, and bindings keep it live.
+ */
+static bool memo_unchanged(const rasen_node_t *node, uint32_t memo) {
+    if (!memo || node->memo != memo) return false;
+    rasen_stats.memo_skips++;
+    return true;
+}
+
+static void patch_element(JSContext *ctx, lv_obj_t *obj, rasen_node_t *node, JSValue desc) {
+    // Checked before reading anything else, so a hit costs one property
+    uint32_t memo = read_desc_memo(ctx, desc);
+    if (memo_unchanged(node, memo)) return;
+
+    elem_props_t props;
+    read_desc_props(ctx, desc, &props);
+    node->memo = 0;
+    patch_props(ctx, obj, node, &props);
+    free_desc_props(ctx, &props);
+
+    if (is_container(node->type)) {
+        JSValue children_val = JS_GetPropertyStr(ctx, desc, "children");
+        reconcile_children(ctx, obj, children_val);
+        JS_FreeValue(ctx, children_val);
+    }
+    node->memo = memo;
+}
+
+// Create from a descriptor whose type and key the caller has already read
+static lv_obj_t *create_element_from_desc(JSContext *ctx, JSValue desc, elem_type_t type,
+                                          const char *key, lv_obj_t *parent) {
+    RASEN_PROF_BEGIN(prof_start);
+    lv_obj_t *obj = create_node(type, key, parent);
+
+    // A fresh node has nothing applied yet, so patching applies everything
+    if (obj) patch_element(ctx, obj, get_node(obj), desc);
+
+    RASEN_PROF_END(RASEN_PROF_CREATE, elem_classes[type].name, prof_start);
+    return obj;
+}
+
+// ============ Virtual List ============
+
+// Render row index into row (patched if the type still matches); NULL if it renders nothing
+static lv_obj_t *list_render_row(JSContext *ctx, lv_obj_t *list, list_state_t *st,
+                                 uint32_t index, lv_obj_t *row) {
+    JSValue arg = JS_NewUint32(ctx, index);
+    uint64_t start = rasen_stats_now_us();
+    RASEN_PROF_BEGIN(prof_start);
+    JSValue desc = JS_Call(ctx, st->render, JS_UNDEFINED, 1, &arg);
+    RASEN_PROF_END(RASEN_PROF_CALL, "renderRow", prof_start);
+    rasen_stats_add_time(RASEN_TIME_JS, start);
+
+    if (JS_IsException(desc)) {
+        check_exception(ctx, desc, "Row render error");
+        desc = JS_UNDEFINED;
+    }
+    if (!JS_IsObject(desc)) {
+        if (row) pool_release(row);
+        JS_FreeValue(ctx, desc);
+        return NULL;
+    }
+
+    elem_type_t type = read_desc_type(ctx, desc);
+    if (row && get_node(row)->type == type) {
+        patch_element(ctx, row, get_node(row), desc);
+    } else {
+        if (row) pool_release(row);
+        char *key = read_desc_key(ctx, desc);
+        row = create_element_from_desc(ctx, desc, type, key, list);
+        free(key);
+    }
+    JS_FreeValue(ctx, desc);
+
+    if (row) {
+        // index < count, and list_clamp_count() keeps count * row_h in range
+        lv_obj_add_flag(row, LV_OBJ_FLAG_IGNORE_LAYOUT);
+        lv_obj_set_pos(row, 0, (lv_coord_t)((int32_t)index * st->row_h));
+    }
+    return row;
+}
+
+/**
+ * Materialize the rows in view plus overscan. Rows that stay in the
+ * window are left alone unless refresh is set (after a rerender, when
+ * the row callback may return different content).
+ */
+static void list_update(JSContext *ctx, rasen_node_t *node, bool refresh) {
+    list_state_t *st = node->list;
+    if (st->updating) return;
+
+    lv_coord_t top = lv_obj_get_scroll_y(node->obj);
+    lv_coord_t view_h = lv_obj_get_content_height(node->obj);
+    if (top < 0) top = 0;
+
+    uint32_t first = (uint32_t)(top / st->row_h);
+    uint32_t last = (uint32_t)((top + view_h) / st->row_h) + 1 + st->overscan;
+    first = first > st->overscan ? first - st->overscan : 0;
+    if (last > st->count) last = st->count;
+    if (first > last) first = last;
+    uint32_t len = last - first;
+
+    if (!refresh && first == st->first && len == st->len) return;
+
+    lv_obj_t **rows = NULL;
+    if (len) {
+        rows = calloc(len, sizeof(lv_obj_t *));
+        if (!rows) return;
+    }
+    st->updating = true;
+
+    // Keep rows that are still in the window, recycle the rest
+    for (uint32_t j = 0; j < st->len; j++) {
+        uint32_t i = st->first + j;
+        if (!st->rows[j]) continue;
+        if (i >= first && i < last) {
+            rows[i - first] = st->rows[j];
+        } else {
+            pool_release(st->rows[j]);
+        }
+    }
+    free(st->rows);
+    st->rows = rows;
+    st->first = first;
+    st->len = len;
+
+    for (uint32_t j = 0; j < len; j++) {
+        if (rows[j] && !refresh) continue;
+        rows[j] = list_render_row(ctx, node->obj, st, first + j, rows[j]);
+    }
+
+    st->updating = false;
+}
+
+/**
+ * Every row position, and the scroll range, must stay a plain
+ * coordinate: LVGL reads values past LV_COORD_MAX as special/percent
+ * coordinates. Rows beyond that height are not reachable and are cut.
+ */
+static uint32_t list_clamp_count(const list_state_t *st, uint32_t count) {
+    uint32_t max = (uint32_t)LV_COORD_MAX / (uint32_t)st->row_h;
+    if (count > max) {
+        printf("virtualList: %u rows of %d px exceed LV_COORD_MAX, showing %u\n",
+               (unsigned)count, (int)st->row_h, (unsigned)max);
+        count = max;
+    }
+    return count;
+}
+
+static void list_place_spacer(list_state_t *st) {
+    lv_coord_t end = (lv_coord_t)((int32_t)st->count * st->row_h);
+    lv_obj_set_pos(st->spacer, 0, end > 0 ? end - 1 : 0);
+}
+
+static void list_set_count(JSContext *ctx, rasen_node_t *node, uint32_t count) {
+    count = list_clamp_count(node->list, count);
+    if (node->list->count == count) return;
+
+    node->list->count = count;
+    list_place_spacer(node->list);
+    list_update(ctx, node, false);
+}
+
+// Scrolling and resizing move the window; rows render from the event queue, not here
+static void list_event_cb(lv_event_t *e) {
+    rasen_node_t *node = get_node(lv_event_get_current_target(e));
+    if (!node || !node->list || node->list->queued) return;
+
+    node->list->queued = event_push(EVENT_LIST, node->handle, e);
+}
+
+static void list_run_event(JSContext *ctx, uint32_t node_handle) {
+    rasen_node_t *node = node_from_handle(node_handle);
+    if (!node || !node->list) return;
+
+    lvgl_lock();
+    node->list->queued = false;
+    list_update(ctx, node, false);
+    lvgl_unlock();
+}
+
+static void patch_list(JSContext *ctx, lv_obj_t *obj, rasen_node_t *node, const elem_props_t *props) {
+    list_state_t *st = node->list;
+
+    if (!st) {
+        st = calloc(1, sizeof(list_state_t));
+        if (!st) return;
+        st->render = JS_UNDEFINED;
+        st->spacer = lv_obj_create(obj);
+        lv_obj_remove_style_all(st->spacer);
+        lv_obj_add_flag(st->spacer, LV_OBJ_FLAG_IGNORE_LAYOUT);
+        lv_obj_clear_flag(st->spacer, LV_OBJ_FLAG_CLICKABLE);
+        lv_obj_set_size(st->spacer, 1, 1);
+        node->list = st;
+        lv_obj_add_event_cb(obj, list_event_cb, LV_EVENT_SCROLL, NULL);
+        lv_obj_add_event_cb(obj, list_event_cb, LV_EVENT_SIZE_CHANGED, NULL);
+    }
+
+    st->row_h = props->row_h > 0 && props->row_h <= LV_COORD_MAX ? (lv_coord_t)props->row_h : 1;
+    st->count = list_clamp_count(st, props->count > 0 ? (uint32_t)props->count : 0);
+    st->overscan = props->overscan > 0 ? (uint32_t)props->overscan : 0;
+    JS_FreeValue(ctx, st->render);
+    st->render = JS_DupValue(ctx, props->render);
+
+    list_place_spacer(st);
+    list_update(ctx, node, true);
+}
+
+// ============ Charts ============
+
+/*
+ * A chart's points live in lv_chart's own per-series ring. Samples
+ * pushed from JS (chartStream().push) go straight into it with
+ * lv_chart_set_next_value(), which only invalidates the chart: no ref
+ * write, no rerender, no descriptor work. In circular mode only the
+ * columns around the new points are redrawn.
+ */
+
+#if RASEN_HAS_CHART
+static void patch_chart(JSContext *ctx, lv_obj_t *obj, rasen_node_t *node, const elem_props_t *props) {
+    // These setters return early when nothing changes
+    lv_chart_set_type(obj, props->chart_kind == 1 ? LV_CHART_TYPE_BAR : LV_CHART_TYPE_LINE);
+    lv_chart_set_update_mode(obj, props->chart_mode == 1 ? LV_CHART_UPDATE_MODE_CIRCULAR
+                                                         : LV_CHART_UPDATE_MODE_SHIFT);
+    if (props->points > 0) {
+        lv_chart_set_point_count(obj, (uint16_t)(props->points < UINT16_MAX ? props->points : UINT16_MAX));
+    }
+
+    // lv_chart has no public getter for the range, so the node remembers it
+    if (!node->chart_ranged || node->chart_min != props->min || node->chart_max != props->max) {
+        lv_chart_set_range(obj, LV_CHART_AXIS_PRIMARY_Y, (lv_coord_t)props->min, (lv_coord_t)props->max);
+        node->chart_min = props->min;
+        node->chart_max = props->max;
+        node->chart_ranged = true;
+    }
+
+    // Keep existing series (and their points); add, recolor or drop to match
+    lv_chart_series_t *ser = lv_chart_get_series_next(obj, NULL);
+    for (uint32_t i = 0; i < props->series_count; i++) {
+        lv_color_t color = lv_color_hex(props->series_colors[i]);
+        if (!ser) {
+            ser = lv_chart_add_series(obj, color, LV_CHART_AXIS_PRIMARY_Y);
+            if (!ser) break;
+        } else if (ser->color.full != color.full) {
+            lv_chart_set_series_color(obj, ser, color);
+        }
+        ser = lv_chart_get_series_next(obj, ser);
+    }
+    while (ser) {
+        lv_chart_series_t *next = lv_chart_get_series_next(obj, ser);
+        lv_chart_remove_series(obj, ser);
+        ser = next;
+    }
+
+    // Point the stream at this chart; a stale handle makes push() a no-op
+    if (JS_IsObject(props->stream)) {
+        JS_SetPropertyStr(ctx, props->stream, "node", JS_NewUint32(ctx, node->handle));
+    }
+}
+
+static lv_chart_series_t *chart_series_at(lv_obj_t *obj, uint32_t index) {
+    lv_chart_series_t *ser = lv_chart_get_series_next(obj, NULL);
+    while (ser && index--) ser = lv_chart_get_series_next(obj, ser);
+    return ser;
+}
+
+// NaN leaves a gap; everything else is rounded and clamped to lv_coord_t
+static inline lv_coord_t chart_coord(double v) {
+    if (v != v) return LV_CHART_POINT_NONE;
+    if (v >= LV_CHART_POINT_NONE - 1) return LV_CHART_POINT_NONE - 1;
+    if (v <= -LV_CHART_POINT_NONE) return -LV_CHART_POINT_NONE;
+    return (lv_coord_t)(v < 0 ? v - 0.5 : v + 0.5);
+}
+
+#define CHART_APPEND(type) do {                                         \
+        const type *src = (const type *)data;                            \
+        for (size_t i = first; i < count; i++) {                         \
+            lv_chart_set_next_value(obj, ser, chart_coord(src[i]));      \
+        }                                                                \
+    } while (0)
+#endif
+
+/**
+ * __rasen.chartPush(node, series, samples): append a number or the
+ * elements of a typed array to one series. The array's memory is read
+ * directly, with no per-point property access.
+ * @return false if the chart or series no longer exists
+ */
+static JSValue js_rasen_chart_push(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#if RASEN_HAS_CHART
+    uint32_t handle = 0, series = 0;
+    if (argc < 3 || JS_ToUint32(ctx, &handle, argv[0]) || JS_ToUint32(ctx, &series, argv[1])) {
+        return JS_ThrowTypeError(ctx, "chartPush(node, series, samples)");
+    }
+
+    double single;
+    const uint8_t *data;
+    size_t count;
+    int kind = JS_GetTypedArrayType(argv[2]);
+
+    if (kind < 0) {
+        if (JS_ToFloat64(ctx, &single, argv[2])) return JS_EXCEPTION;
+        data = (const uint8_t *)&single;
+        count = 1;
+        kind = JS_TYPED_ARRAY_FLOAT64;
+    } else if (kind == JS_TYPED_ARRAY_FLOAT32 || kind == JS_TYPED_ARRAY_FLOAT64 ||
+               kind == JS_TYPED_ARRAY_INT16 || kind == JS_TYPED_ARRAY_INT32) {
+        size_t offset, length, elem_size, size;
+        JSValue buffer = JS_GetTypedArrayBuffer(ctx, argv[2], &offset, &length, &elem_size);
+        if (JS_IsException(buffer)) return JS_EXCEPTION;
+        data = JS_GetArrayBuffer(ctx, &size, buffer);
+        JS_FreeValue(ctx, buffer);
+        if (!data) return JS_EXCEPTION;    // Detached
+        data += offset;
+        count = length / elem_size;
+    } else {
+        return JS_ThrowTypeError(ctx, "chart samples must be a number, Float32Array, Float64Array, Int16Array or Int32Array");
+    }
+
+    lvgl_lock();
+    rasen_node_t *node = node_from_handle(handle);
+    lv_obj_t *obj = node && node->type == ELEM_CHART ? node->obj : NULL;
+    lv_chart_series_t *ser = obj ? chart_series_at(obj, series) : NULL;
+
+    if (ser) {
+        // Samples older than one full ring would be overwritten by this same call
+        size_t cap = lv_chart_get_point_count(obj);
+        size_t first = count > cap ? count - cap : 0;
+        switch (kind) {
+            case JS_TYPED_ARRAY_FLOAT32: CHART_APPEND(float); break;
+            case JS_TYPED_ARRAY_FLOAT64: CHART_APPEND(double); break;
+            case JS_TYPED_ARRAY_INT16:   CHART_APPEND(int16_t); break;
+            case JS_TYPED_ARRAY_INT32:   CHART_APPEND(int32_t); break;
+        }
+        rasen_stats.chart_points += (uint32_t)(count - first);
+    }
+    lvgl_unlock();
+    return JS_NewBool(ctx, ser != NULL);
+#else
+    return JS_FALSE;
+#endif
+}
+
+// ============ Reconciler ============
+
+#define RECONCILE_STACK_CHILDREN 16
+
+typedef struct {
+    const char *key;        // The child's node->key
+    uint32_t index;         // Into old_children_t.old
+} old_key_t;
+
+/**
+ * Live children of a parent being reconciled. Keyed descriptors match an
+ * old child with the same type and key anywhere in the list (a binary
+ * search over the keyed children, sorted on the first keyed lookup);
+ * unkeyed ones match the unkeyed old child at the same position if its
+ * type agrees. Matched children are patched and moved into place,
+ * unmatched descriptors are created and leftover old children are deleted.
+ */
+typedef struct {
+    lv_obj_t *stack[RECONCILE_STACK_CHILDREN];
+    lv_obj_t **old;         // stack, or malloc'd when heap is set
+    uint32_t len;
+    uint32_t unkeyed_cursor;
+    old_key_t *keys;        // Keyed old children by key, NULL until needed
+    uint32_t key_count;
+    bool keys_sorted;       // keys is built (it may still be NULL if none are keyed)
+    bool heap;
+} old_children_t;
+
+// Snapshot the current children that we own
+static bool old_children_init(old_children_t *oc, lv_obj_t *parent) {
+    uint32_t child_cnt = lv_obj_get_child_cnt(parent);
+    oc->old = oc->stack;
+    oc->len = 0;
+    oc->unkeyed_cursor = 0;
+    oc->keys = NULL;
+    oc->key_count = 0;
+    oc->keys_sorted = false;
+    oc->heap = child_cnt > RECONCILE_STACK_CHILDREN;
+    if (oc->heap) {
+        oc->old = malloc(child_cnt * sizeof(lv_obj_t *));
+        if (!oc->old) return false;
+    }
+
+    for (uint32_t i = 0; i < child_cnt; i++) {
+        lv_obj_t *child = lv_obj_get_child(parent, i);
+        if (get_node(child)) oc->old[oc->len++] = child;
+    }
+    return true;
+}
+
+static int old_key_cmp(const void *a, const void *b) {
+    const old_key_t *ka = a, *kb = b;
+    int c = strcmp(ka->key, kb->key);
+    if (c) return c;
+    // Equal keys keep document order, so duplicates match first to first
+    return ka->index < kb->index ? -1 : ka->index > kb->index;
+}
+
+// Sort the keyed old children once, so each keyed lookup is a binary search
+static void old_children_sort_keys(old_children_t *oc) {
+    oc->keys_sorted = true;
+    uint32_t n = 0;
+    // Entries already taken are unkeyed ones, so skipping them loses nothing
+    for (uint32_t j = 0; j < oc->len; j++) {
+        if (oc->old[j] && get_node(oc->old[j])->key) n++;
+    }
+    if (!n || !(oc->keys = malloc(n * sizeof(old_key_t)))) return;
+
+    for (uint32_t j = 0; j < oc->len; j++) {
+        const char *key = oc->old[j] ? get_node(oc->old[j])->key : NULL;
+        if (key) oc->keys[oc->key_count++] = (old_key_t){ key, j };
+    }
+    qsort(oc->keys, oc->key_count, sizeof(old_key_t), old_key_cmp);
+}
+
+static lv_obj_t *old_children_take_keyed(old_children_t *oc, elem_type_t type, const char *key) {
+    lv_obj_t **old = oc->old;
+
+    if (!oc->keys_sorted) old_children_sort_keys(oc);
+    if (!oc->keys) {
+        // Nothing keyed, or no memory for the index: scan
+        for (uint32_t j = 0; j < oc->len; j++) {
+            rasen_node_t *n = old[j] ? get_node(old[j]) : NULL;
+            if (n && n->key && n->type == type && strcmp(n->key, key) == 0) {
+                old[j] = NULL;
+                return n->obj;
+            }
+        }
+        return NULL;
+    }
+
+    // Lower bound of key, then the first entry with that key still unmatched
+    uint32_t lo = 0, hi = oc->key_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (strcmp(oc->keys[mid].key, key) < 0) lo = mid + 1; else hi = mid;
+    }
+    for (uint32_t i = lo; i < oc->key_count && strcmp(oc->keys[i].key, key) == 0; i++) {
+        uint32_t j = oc->keys[i].index;
+        if (old[j] && get_node(old[j])->type == type) {
+            lv_obj_t *match = old[j];
+            old[j] = NULL;
+            return match;
+        }
+    }
+    return NULL;
+}
+
+static lv_obj_t *old_children_take(old_children_t *oc, elem_type_t type, const char *key) {
+    lv_obj_t **old = oc->old;
+
+    if (key) return old_children_take_keyed(oc, type, key);
+
+    // Advance to the next unkeyed old child, consuming it either way
+    while (oc->unkeyed_cursor < oc->len &&
+           (!old[oc->unkeyed_cursor] || get_node(old[oc->unkeyed_cursor])->key)) {
+        oc->unkeyed_cursor++;
+    }
+    if (oc->unkeyed_cursor < oc->len) {
+        lv_obj_t *match = NULL;
+        if (get_node(old[oc->unkeyed_cursor])->type == type) {
+            match = old[oc->unkeyed_cursor];
+            old[oc->unkeyed_cursor] = NULL;
+        }
+        oc->unkeyed_cursor++;
+        return match;
+    }
+    return NULL;
+}
+
+// Whatever was not matched is gone from the new tree; park or delete it
+static void old_children_finish(old_children_t *oc) {
+    for (uint32_t j = 0; j < oc->len; j++) {
+        if (oc->old[j]) pool_release(oc->old[j]);
+    }
+    free(oc->keys);
+    if (oc->heap) free(oc->old);
+}
+
+// Drop the snapshot of an abandoned reconcile; unmatched children stay
+static void old_children_discard(old_children_t *oc) {
+    free(oc->keys);
+    if (oc->heap) free(oc->old);
+}
+
+static void move_to_index(lv_obj_t *obj, uint32_t i) {
+    if (lv_obj_get_index(obj) != i) {
+        lv_obj_move_to_index(obj, (int32_t)i);
+    }
+}
+
+// Diff a descriptor children array against the live children of parent
+static void reconcile_children(JSContext *ctx, lv_obj_t *parent, JSValue children_val) {
+    uint32_t new_len = 0;
+    if (JS_IsArray(children_val)) {
+        JSValue len_val = JS_GetPropertyStr(ctx, children_val, "length");
+        JS_ToUint32(ctx, &new_len, len_val);
+        JS_FreeValue(ctx, len_val);
+    }
+
+    old_children_t oc;
+    if (!old_children_init(&oc, parent)) return;
+
+    // Skipped entries take no slot, so placement counts objects, not descriptors
+    uint32_t index = 0;
+    for (uint32_t i = 0; i < new_len; i++) {
+        JSValue desc = JS_GetPropertyUint32(ctx, children_val, i);
+        if (!JS_IsObject(desc)) {
+            JS_FreeValue(ctx, desc);
+            continue;
+        }
+
+        elem_type_t type = read_desc_type(ctx, desc);
+        char *key = read_desc_key(ctx, desc);
+        lv_obj_t *obj = old_children_take(&oc, type, key);
+
+        if (obj) {
+            patch_element(ctx, obj, get_node(obj), desc);
+        } else {
+            obj = create_element_from_desc(ctx, desc, type, key, parent);
+        }
+        free(key);
+        if (obj) move_to_index(obj, index++);
+
+        JS_FreeValue(ctx, desc);
+    }
+
+    old_children_finish(&oc);
+}
+
+// ============ Command Buffer ============
+
+/**
+ * Flat encoding of a descriptor tree produced by __encode() in the runtime
+ * JS and consumed by commit_children() in one linear pass. The buffer is a
+ * sequence of int32 words in pre-order:
+ *
+ *   CMD_ELEM type key      Open an element (type: elem_type_t, key: string or -1)
+ *   CMD_CLASS str          Class string
+ *   CMD_STYLE id           Precompiled style id
+ *   CMD_TEXT str           Label, checkbox or textarea text
+ *   CMD_VALUE v min max    Value (checked, selected index) and range
+ *   CMD_HANDLER kind ref   Event handler (handler_kind_t, index into refs)
+ *   CMD_BIND kind ref      Reactive source (bind_kind_t, index into refs)
+ *   CMD_END                Close the current element
+ *   CMD_LIST n h over ref  Virtual list count, row height, overscan, row callback
+ *   CMD_RANGE min max      Range alone; the widget keeps its own value
+ *   CMD_OPTIONS str        Dropdown / roller options, one per line
+ *   CMD_PLACEHOLDER str    Textarea placeholder
+ *   CMD_SRC str            Image source
+ *   CMD_CHART kind mode points stream n color...
+ *                          Chart type, update mode, ring length, stream (ref or -1),
+ *                          series count and one 0xRRGGBB color per series
+ *   CMD_MEMO stamp ref     Element comes from a memo() result (ref: its descriptor).
+ *                          Only CMD_END follows: a live node built from the same
+ *                          stamp keeps its subtree as is, anything else is built
+ *                          from the descriptor
+ *   CMD_TABLE rows cols n str...
+ *                          Table row and column counts (-1 keeps the widget's) and
+ *                          n cell texts in row-major order, -1 for an empty cell;
+ *                          n is rows * cols, or 0 to leave the cells alone
+ *
+ * An element's properties precede its children. Strings are indices into a
+ * string table deduplicated per commit, functions and refs indices into a
+ * refs array, so the only per-node JS access left is converting each
+ * distinct string once.
+ */
+enum {
+    CMD_ELEM = 1,
+    CMD_CLASS,
+    CMD_STYLE,
+    CMD_TEXT,
+    CMD_VALUE,
+    CMD_HANDLER,
+    CMD_BIND,
+    CMD_END,
+    CMD_LIST,
+    CMD_RANGE,
+    CMD_OPTIONS,
+    CMD_PLACEHOLDER,
+    CMD_SRC,
+    CMD_CHART,
+    CMD_MEMO,
+    CMD_TABLE,
+};
+
+// Exported as __rasen.cmdCodes, so __encode() names every opcode
+static const struct {
+    const char *name;
+    int32_t code;
+} cmd_names[] = {
+    { "ELEM", CMD_ELEM },
+    { "CLASS", CMD_CLASS },
+    { "STYLE", CMD_STYLE },
+    { "TEXT", CMD_TEXT },
+    { "VALUE", CMD_VALUE },
+    { "HANDLER", CMD_HANDLER },
+    { "BIND", CMD_BIND },
+    { "END", CMD_END },
+    { "LIST", CMD_LIST },
+    { "RANGE", CMD_RANGE },
+    { "OPTIONS", CMD_OPTIONS },
+    { "PLACEHOLDER", CMD_PLACEHOLDER },
+    { "SRC", CMD_SRC },
+    { "CHART", CMD_CHART },
+    { "MEMO", CMD_MEMO },
+    { "TABLE", CMD_TABLE },
+};
+
+typedef struct {
+    JSContext *ctx;
+    const int32_t *p;
+    const int32_t *end;
+    JSValue strings;
+    JSValue refs;
+    const char **cstr;    // String table, converted on first use
+    uint32_t str_count;
+    bool error;
+} cmd_reader_t;
+
+static bool cmd_has(cmd_reader_t *r, size_t words) {
+    if ((size_t)(r->end - r->p) < words) {
+        r->error = true;
+        return false;
+    }
+    return true;
+}
 
-static uint32_t register_handler(JSContext *ctx, JSValue func, lv_obj_t *obj) {
-    if (handler_count >= MAX_HANDLERS) {
-        printf("Error: Too many handlers\n");
-        return 0;
+static const char *cmd_string(cmd_reader_t *r, int32_t index) {
+    if (index < 0 || (uint32_t)index >= r->str_count) return NULL;
+    if (!r->cstr[index]) {
+        JSValue v = JS_GetPropertyUint32(r->ctx, r->strings, (uint32_t)index);
+        r->cstr[index] = JS_ToCString(r->ctx, v);
+        JS_FreeValue(r->ctx, v);
     }
-    
-    uint32_t id = next_handler_id++;
-    handlers[handler_count].id = id;
-    handlers[handler_count].func = JS_DupValue(ctx, func);
-    handlers[handler_count].obj = obj;
-    handler_count++;
-    
-    return id;
+    return r->cstr[index];
 }
 
-static void invoke_handler(uint32_t id) {
-    for (uint32_t i = 0; i < handler_count; i++) {
-        if (handlers[i].id == id) {
-            JSValue ret = JS_Call(global_ctx, handlers[i].func, JS_UNDEFINED, 0, NULL);
-            if (JS_IsException(ret)) {
-                JSValue exc = JS_GetException(global_ctx);
-                const char *str = JS_ToCString(global_ctx, exc);
-                printf("JS Error: %s\n", str);
-                JS_FreeCString(global_ctx, str);
-                JS_FreeValue(global_ctx, exc);
+// Read the properties following CMD_ELEM; stops at the first child or CMD_END
+static void cmd_read_props(cmd_reader_t *r, elem_props_t *props) {
+    while (!r->error && r->p < r->end) {
+        int32_t op = r->p[0];
+        if (op == CMD_ELEM || op == CMD_END) return;
+
+        switch (op) {
+            case CMD_CLASS:
+                if (!cmd_has(r, 2)) return;
+                props->class_str = cmd_string(r, r->p[1]);
+                r->p += 2;
+                break;
+            case CMD_STYLE:
+                if (!cmd_has(r, 2)) return;
+                props->style_id = r->p[1];
+                r->p += 2;
+                break;
+            case CMD_TEXT:
+                if (!cmd_has(r, 2)) return;
+                props->text = cmd_string(r, r->p[1]);
+                r->p += 2;
+                break;
+            case CMD_VALUE:
+                if (!cmd_has(r, 4)) return;
+                props->value = r->p[1];
+                props->has_value = true;
+                props->min = r->p[2];
+                props->max = r->p[3];
+                r->p += 4;
+                break;
+            case CMD_RANGE:
+                if (!cmd_has(r, 3)) return;
+                props->min = r->p[1];
+                props->max = r->p[2];
+                r->p += 3;
+                break;
+            case CMD_OPTIONS:
+                if (!cmd_has(r, 2)) return;
+                props->options = cmd_string(r, r->p[1]);
+                r->p += 2;
+                break;
+            case CMD_PLACEHOLDER:
+                if (!cmd_has(r, 2)) return;
+                props->placeholder = cmd_string(r, r->p[1]);
+                r->p += 2;
+                break;
+            case CMD_SRC:
+                if (!cmd_has(r, 2)) return;
+                props->src = cmd_string(r, r->p[1]);
+                r->p += 2;
+                break;
+            case CMD_CHART: {
+                if (!cmd_has(r, 6) || r->p[5] < 0 || !cmd_has(r, 6 + (size_t)r->p[5])) return;
+                uint32_t n = (uint32_t)r->p[5];
+                props->chart_kind = r->p[1];
+                props->chart_mode = r->p[2];
+                props->points = r->p[3];
+                JS_FreeValue(r->ctx, props->stream);
+                props->stream = r->p[4] >= 0 ? JS_GetPropertyUint32(r->ctx, r->refs, (uint32_t)r->p[4]) : JS_UNDEFINED;
+                props->series_count = n < RASEN_CHART_MAX_SERIES ? n : RASEN_CHART_MAX_SERIES;
+                for (uint32_t i = 0; i < props->series_count; i++) {
+                    props->series_colors[i] = (uint32_t)r->p[6 + i];
+                }
+                r->p += 6 + n;
+                break;
             }
-            JS_FreeValue(global_ctx, ret);
-            needs_rerender = true;
-            return;
+            case CMD_TABLE: {
+                if (!cmd_has(r, 4) || r->p[1] < -1 || r->p[1] > UINT16_MAX || r->p[2] < -1 ||
+                    r->p[2] > UINT16_MAX || r->p[3] < 0 ||
+                    (r->p[3] > 0 && (r->p[1] < 0 || (int64_t)r->p[1] * r->p[2] != r->p[3])) ||
+                    !cmd_has(r, 4 + (size_t)r->p[3])) {
+                    r->error = true;
+                    return;
+                }
+                uint32_t n = (uint32_t)r->p[3];
+                props->rows = r->p[1];
+                props->cols = r->p[2];
+                free(props->cells);
+                props->cells = n ? calloc(n, sizeof(const char *)) : NULL;
+                for (uint32_t i = 0; props->cells && i < n; i++) {
+                    props->cells[i] = cmd_string(r, r->p[4 + i]);
+                }
+                r->p += 4 + n;
+                break;
+            }
+            case CMD_HANDLER:
+            case CMD_BIND: {
+                if (!cmd_has(r, 3)) return;
+                int32_t kind = r->p[1];
+                JSValue v = JS_GetPropertyUint32(r->ctx, r->refs, (uint32_t)r->p[2]);
+                if (op == CMD_HANDLER && kind >= 0 && kind < HANDLER_KIND_COUNT) {
+                    JS_FreeValue(r->ctx, props->handlers[kind]);
+                    props->handlers[kind] = v;
+                } else if (op == CMD_BIND && kind >= 0 && kind < BIND_KIND_COUNT) {
+                    JS_FreeValue(r->ctx, props->bind[kind]);
+                    props->bind[kind] = v;
+                } else {
+                    JS_FreeValue(r->ctx, v);
+                }
+                r->p += 3;
+                break;
+            }
+            case CMD_LIST:
+                if (!cmd_has(r, 5)) return;
+                props->count = r->p[1];
+                props->row_h = r->p[2];
+                props->overscan = r->p[3];
+                JS_FreeValue(r->ctx, props->render);
+                props->render = JS_GetPropertyUint32(r->ctx, r->refs, (uint32_t)r->p[4]);
+                r->p += 5;
+                break;
+            default:
+                r->error = true;
+                return;
         }
     }
 }
 
-// LVGL event callback
-static void lvgl_event_cb(lv_event_t *e) {
-    uint32_t handler_id = (uint32_t)(uintptr_t)lv_event_get_user_data(e);
-    invoke_handler(handler_id);
+// Skip the rest of the current element, children included, and its CMD_END
+static void cmd_skip_element(cmd_reader_t *r) {
+    int depth = 1;
+    while (!r->error && r->p < r->end && depth > 0) {
+        switch (r->p[0]) {
+            case CMD_ELEM:    depth++; r->p += 3; break;
+            case CMD_END:     depth--; r->p += 1; break;
+            case CMD_LIST:    r->p += 5; break;
+            case CMD_CHART:
+                if (r->end - r->p < 6 || r->p[5] < 0) {
+                    r->error = true;
+                } else {
+                    r->p += 6 + r->p[5];
+                }
+                break;
+            case CMD_TABLE:
+                if (r->end - r->p < 4 || r->p[3] < 0) {
+                    r->error = true;
+                } else {
+                    r->p += 4 + r->p[3];
+                }
+                break;
+            case CMD_VALUE:   r->p += 4; break;
+            case CMD_HANDLER:
+            case CMD_BIND:
+            case CMD_MEMO:
+            case CMD_RANGE:   r->p += 3; break;
+            case CMD_CLASS:
+            case CMD_STYLE:
+            case CMD_TEXT:
+            case CMD_OPTIONS:
+            case CMD_PLACEHOLDER:
+            case CMD_SRC:     r->p += 2; break;
+            default:          r->error = true; break;
+        }
+    }
+    if (depth > 0 || r->p > r->end) r->error = true;
 }
 
-// ============ Element Creation ============
-
+/**
+ * One open container while applying a buffer: the snapshot of its live
+ * children and the index the next element goes to. Frames live on an
+ * explicit stack, so tree depth costs heap rather than task stack and a
+ * commit can stop between any two elements and resume later.
+ */
 typedef struct {
-    lv_obj_t *obj;
-    char *type;
-} element_t;
+    lv_obj_t *parent;
+    old_children_t oc;
+    uint32_t index;
+} commit_frame_t;
 
-static lv_obj_t *create_element_from_desc(JSContext *ctx, JSValue desc, lv_obj_t *parent);
+typedef struct {
+    cmd_reader_t r;
+    commit_frame_t *frames;
+    uint32_t depth;
+    uint32_t cap;
+} commit_state_t;
 
-static lv_obj_t *create_obj(JSContext *ctx, JSValue desc, lv_obj_t *parent) {
-    lv_obj_t *obj = lv_obj_create(parent);
-    
-    // Get class string and apply styles
-    JSValue class_val = JS_GetPropertyStr(ctx, desc, "class");
-    if (!JS_IsUndefined(class_val)) {
-        const char *class_str = JS_ToCString(ctx, class_val);
-        if (class_str) {
-            tw_styles_t styles;
-            tw_parse(class_str, &styles);
-            tw_apply(obj, &styles);
-            JS_FreeCString(ctx, class_str);
+static bool commit_push(commit_state_t *s, lv_obj_t *parent) {
+    if (s->depth == s->cap) {
+        uint32_t cap = s->cap ? s->cap * 2 : 8;
+        commit_frame_t *frames = realloc(s->frames, cap * sizeof(commit_frame_t));
+        if (!frames) return false;
+        // Small snapshots are stored inside their frame; follow the move
+        for (uint32_t i = 0; i < s->depth; i++) {
+            if (!frames[i].oc.heap) frames[i].oc.old = frames[i].oc.stack;
         }
+        s->frames = frames;
+        s->cap = cap;
     }
-    JS_FreeValue(ctx, class_val);
-    
-    // Handle click event
-    JSValue handlers_val = JS_GetPropertyStr(ctx, desc, "handlers");
-    if (!JS_IsUndefined(handlers_val) && !JS_IsNull(handlers_val)) {
-        JSValue click_val = JS_GetPropertyStr(ctx, handlers_val, "click");
-        if (JS_IsFunction(ctx, click_val)) {
-            uint32_t id = register_handler(ctx, click_val, obj);
-            lv_obj_add_event_cb(obj, lvgl_event_cb, LV_EVENT_CLICKED, (void *)(uintptr_t)id);
-        }
-        JS_FreeValue(ctx, click_val);
-        
-        JSValue longpress_val = JS_GetPropertyStr(ctx, handlers_val, "long_press");
-        if (JS_IsFunction(ctx, longpress_val)) {
-            uint32_t id = register_handler(ctx, longpress_val, obj);
-            lv_obj_add_event_cb(obj, lvgl_event_cb, LV_EVENT_LONG_PRESSED, (void *)(uintptr_t)id);
-        }
-        JS_FreeValue(ctx, longpress_val);
+
+    commit_frame_t *f = &s->frames[s->depth];
+    if (!old_children_init(&f->oc, parent)) return false;
+    f->parent = parent;
+    f->index = 0;
+    s->depth++;
+    return true;
+}
+
+/**
+ * Prepare to apply an encoded tree to the children of parent. The reader
+ * borrows buffer, strings and refs: keep them alive until commit_end().
+ */
+static bool commit_begin(commit_state_t *s, JSContext *ctx, lv_obj_t *parent,
+                         JSValue buffer, JSValue strings, JSValue refs) {
+    size_t size = 0;
+    const uint8_t *data = JS_GetArrayBuffer(ctx, &size, buffer);
+    memset(s, 0, sizeof(*s));
+    if (!data) return false;
+
+    s->r = (cmd_reader_t){
+        .ctx = ctx,
+        .p = (const int32_t *)data,
+        .end = (const int32_t *)(data + (size & ~(size_t)3)),
+        .strings = strings,
+        .refs = refs,
+    };
+
+    JSValue len_val = JS_GetPropertyStr(ctx, strings, "length");
+    JS_ToUint32(ctx, &s->r.str_count, len_val);
+    JS_FreeValue(ctx, len_val);
+    if (s->r.str_count) {
+        s->r.cstr = calloc(s->r.str_count, sizeof(const char *));
+        if (!s->r.cstr) return false;
     }
-    JS_FreeValue(ctx, handlers_val);
-    
-    // Process children
-    JSValue children_val = JS_GetPropertyStr(ctx, desc, "children");
-    if (JS_IsArray(children_val)) {
-        JSValue len_val = JS_GetPropertyStr(ctx, children_val, "length");
-        int32_t len;
-        JS_ToInt32(ctx, &len, len_val);
-        JS_FreeValue(ctx, len_val);
-        
-        for (int32_t i = 0; i < len; i++) {
-            JSValue child = JS_GetPropertyUint32(ctx, children_val, i);
-            create_element_from_desc(ctx, child, obj);
-            JS_FreeValue(ctx, child);
-        }
+
+    if (!commit_push(s, parent)) {
+        free(s->r.cstr);
+        s->r.cstr = NULL;
+        return false;
     }
-    JS_FreeValue(ctx, children_val);
-    
-    return obj;
+    return true;
 }
 
-static lv_obj_t *create_label(JSContext *ctx, JSValue desc, lv_obj_t *parent) {
-    lv_obj_t *label = lv_label_create(parent);
-    
-    // Get text
-    JSValue text_val = JS_GetPropertyStr(ctx, desc, "text");
-    if (!JS_IsUndefined(text_val)) {
-        const char *text = JS_ToCString(ctx, text_val);
-        if (text) {
-            lv_label_set_text(label, text);
-            JS_FreeCString(ctx, text);
+/**
+ * Apply a memo() element: a live node with the same stamp is only moved
+ * into place, without touching the descriptor. A changed or new one is
+ * built from the descriptor in one go, like a virtual list row; its
+ * subtree isn't in the buffer.
+ */
+static void commit_memo(commit_state_t *s, commit_frame_t *f, elem_type_t type, const char *key) {
+    cmd_reader_t *r = &s->r;
+    if (!cmd_has(r, 3)) return;
+    uint32_t memo = (uint32_t)r->p[1];
+    uint32_t ref = (uint32_t)r->p[2];
+    r->p += 3;
+
+    lv_obj_t *obj = old_children_take(&f->oc, type, key);
+    if (!obj || !memo_unchanged(get_node(obj), memo)) {
+        JSValue desc = JS_GetPropertyUint32(r->ctx, r->refs, ref);
+        if (obj) {
+            patch_element(r->ctx, obj, get_node(obj), desc);
+        } else {
+            obj = create_element_from_desc(r->ctx, desc, type, key, f->parent);
         }
+        JS_FreeValue(r->ctx, desc);
     }
-    JS_FreeValue(ctx, text_val);
-    
-    // Get class string and apply styles
-    JSValue class_val = JS_GetPropertyStr(ctx, desc, "class");
-    if (!JS_IsUndefined(class_val)) {
-        const char *class_str = JS_ToCString(ctx, class_val);
-        if (class_str) {
-            tw_styles_t styles;
-            tw_parse(class_str, &styles);
-            tw_apply(label, &styles);
-            JS_FreeCString(ctx, class_str);
+    if (obj) move_to_index(obj, f->index++);
+    cmd_skip_element(r);
+}
+
+/**
+ * Reconcile elements at the reader against the live children of the open
+ * containers until the buffer is applied or a budget runs out: max_nodes
+ * elements, or deadline_us on the stats clock (0 means no limit). Every
+ * call applies at least one element.
+ * @return true when the buffer is done (or turned out malformed)
+ */
+static bool commit_run(commit_state_t *s, uint32_t max_nodes, uint64_t deadline_us) {
+    cmd_reader_t *r = &s->r;
+    uint32_t nodes = 0;
+
+    while (s->depth > 0) {
+        commit_frame_t *f = &s->frames[s->depth - 1];
+        if (r->error || r->p >= r->end || r->p[0] == CMD_END) {
+            // Containers consume their CMD_END; the top level leaves it
+            if (!r->error && r->p < r->end && s->depth > 1) r->p++;
+            old_children_finish(&f->oc);
+            s->depth--;
+            continue;
+        }
+        if (nodes > 0 && ((max_nodes && nodes >= max_nodes) ||
+                          (deadline_us && rasen_stats_now_us() >= deadline_us))) {
+            return false;
+        }
+        if (r->p[0] != CMD_ELEM || !cmd_has(r, 3)) {
+            r->error = true;
+            continue;
+        }
+
+        elem_props_t props;
+        props_init(&props);
+        props.type = elem_type_from_code(r->p[1]);
+        props.key = cmd_string(r, r->p[2]);
+        r->p += 3;
+
+        if (r->p < r->end && r->p[0] == CMD_MEMO) {
+            commit_memo(s, f, props.type, props.key);
+            nodes++;
+            continue;
+        }
+        cmd_read_props(r, &props);
+
+        lv_obj_t *obj = old_children_take(&f->oc, props.type, props.key);
+        if (!obj) {
+            RASEN_PROF_BEGIN(prof_start);
+            obj = create_node(props.type, props.key, f->parent);
+            RASEN_PROF_END(RASEN_PROF_CREATE, elem_classes[props.type].name, prof_start);
+        }
+
+        if (obj) {
+            // No longer built from a memo() result
+            get_node(obj)->memo = 0;
+            patch_props(r->ctx, obj, get_node(obj), &props);
+            move_to_index(obj, f->index++);
+        }
+        free_props_values(r->ctx, &props);
+        nodes++;
+
+        if (obj && is_container(props.type)) {
+            if (!commit_push(s, obj)) r->error = true;
+        } else {
+            cmd_skip_element(r);
         }
     }
-    JS_FreeValue(ctx, class_val);
-    
-    return label;
+    return true;
 }
 
-static lv_obj_t *create_btn(JSContext *ctx, JSValue desc, lv_obj_t *parent) {
-    lv_obj_t *btn = lv_btn_create(parent);
-    
-    // Get class string and apply styles
-    JSValue class_val = JS_GetPropertyStr(ctx, desc, "class");
-    if (!JS_IsUndefined(class_val)) {
-        const char *class_str = JS_ToCString(ctx, class_val);
-        if (class_str) {
-            tw_styles_t styles;
-            tw_parse(class_str, &styles);
-            tw_apply(btn, &styles);
-            JS_FreeCString(ctx, class_str);
-        }
+// Release the reader; containers still open (an abandoned commit) keep their children
+static int commit_end(commit_state_t *s) {
+    for (uint32_t i = 0; i < s->depth; i++) {
+        old_children_discard(&s->frames[i].oc);
     }
-    JS_FreeValue(ctx, class_val);
-    
-    // Handle click event
-    JSValue handlers_val = JS_GetPropertyStr(ctx, desc, "handlers");
-    if (!JS_IsUndefined(handlers_val) && !JS_IsNull(handlers_val)) {
-        JSValue click_val = JS_GetPropertyStr(ctx, handlers_val, "click");
-        if (JS_IsFunction(ctx, click_val)) {
-            uint32_t id = register_handler(ctx, click_val, btn);
-            lv_obj_add_event_cb(btn, lvgl_event_cb, LV_EVENT_CLICKED, (void *)(uintptr_t)id);
-        }
-        JS_FreeValue(ctx, click_val);
+    free(s->frames);
+    s->frames = NULL;
+    s->depth = s->cap = 0;
+
+    cmd_reader_t *r = &s->r;
+    for (uint32_t i = 0; i < r->str_count; i++) {
+        if (r->cstr[i]) JS_FreeCString(r->ctx, r->cstr[i]);
     }
-    JS_FreeValue(ctx, handlers_val);
-    
-    // Process children (button label)
-    JSValue children_val = JS_GetPropertyStr(ctx, desc, "children");
-    if (JS_IsArray(children_val)) {
-        JSValue len_val = JS_GetPropertyStr(ctx, children_val, "length");
-        int32_t len;
-        JS_ToInt32(ctx, &len, len_val);
-        JS_FreeValue(ctx, len_val);
-        
-        for (int32_t i = 0; i < len; i++) {
-            JSValue child = JS_GetPropertyUint32(ctx, children_val, i);
-            create_element_from_desc(ctx, child, btn);
-            JS_FreeValue(ctx, child);
-        }
+    free(r->cstr);
+    r->cstr = NULL;
+
+    if (r->error) {
+        printf("Malformed command buffer\n");
+        return -1;
     }
-    JS_FreeValue(ctx, children_val);
-    
-    return btn;
+    return 0;
 }
 
-static lv_obj_t *create_bar(JSContext *ctx, JSValue desc, lv_obj_t *parent) {
-    lv_obj_t *bar = lv_bar_create(parent);
-    
-    // Get value, min, max
-    JSValue val = JS_GetPropertyStr(ctx, desc, "value");
-    JSValue min_val = JS_GetPropertyStr(ctx, desc, "min");
-    JSValue max_val = JS_GetPropertyStr(ctx, desc, "max");
-    
-    int32_t min = 0, max = 100, value = 0;
-    if (!JS_IsUndefined(min_val)) JS_ToInt32(ctx, &min, min_val);
-    if (!JS_IsUndefined(max_val)) JS_ToInt32(ctx, &max, max_val);
-    if (!JS_IsUndefined(val)) JS_ToInt32(ctx, &value, val);
-    
-    lv_bar_set_range(bar, min, max);
-    lv_bar_set_value(bar, value, LV_ANIM_OFF);
-    
-    JS_FreeValue(ctx, val);
-    JS_FreeValue(ctx, min_val);
-    JS_FreeValue(ctx, max_val);
-    
-    // Apply styles
-    JSValue class_val = JS_GetPropertyStr(ctx, desc, "class");
-    if (!JS_IsUndefined(class_val)) {
-        const char *class_str = JS_ToCString(ctx, class_val);
-        if (class_str) {
-            tw_styles_t styles;
-            tw_parse(class_str, &styles);
-            tw_apply(bar, &styles);
-            JS_FreeCString(ctx, class_str);
+// Apply an encoded tree to the children of parent in one go; returns -1 if malformed
+static int commit_buffer(JSContext *ctx, lv_obj_t *parent, JSValue buffer, JSValue strings, JSValue refs) {
+    commit_state_t s;
+    if (!commit_begin(&s, ctx, parent, buffer, strings, refs)) return -1;
+    commit_run(&s, 0, 0);
+    return commit_end(&s);
+}
+
+// Encode root with the runtime's __encode(); JS_UNDEFINED if unavailable or it threw
+static JSValue encode_root(JSContext *ctx, JSValue global, JSValue root) {
+    JSValue encode_fn = JS_GetPropertyStr(ctx, global, "__encode");
+    JSValue cmd = JS_UNDEFINED;
+
+    if (JS_IsFunction(ctx, encode_fn)) {
+        uint64_t start = rasen_stats_now_us();
+        RASEN_PROF_BEGIN(prof_start);
+        cmd = JS_Call(ctx, encode_fn, JS_UNDEFINED, 1, &root);
+        RASEN_PROF_END(RASEN_PROF_CALL, "__encode", prof_start);
+        rasen_stats_add_time(RASEN_TIME_JS, start);
+
+        if (JS_IsException(cmd)) {
+            check_exception(ctx, cmd, "Encode error");
+            cmd = JS_UNDEFINED;
         }
     }
-    JS_FreeValue(ctx, class_val);
-    
-    return bar;
+
+    JS_FreeValue(ctx, encode_fn);
+    return cmd;
 }
 
-static lv_obj_t *create_element_from_desc(JSContext *ctx, JSValue desc, lv_obj_t *parent) {
-    JSValue type_val = JS_GetPropertyStr(ctx, desc, "type");
-    const char *type = JS_ToCString(ctx, type_val);
-    
-    lv_obj_t *obj = NULL;
-    
-    if (!type) {
-        // Skip
+// Split an encode_root() result into its parts; false if there is none
+static bool encoded_parts(JSContext *ctx, JSValue cmd, JSValue parts[3]) {
+    if (!JS_IsArray(cmd)) return false;
+    for (uint32_t i = 0; i < 3; i++) {
+        parts[i] = JS_GetPropertyUint32(ctx, cmd, i);
     }
-    else if (strcmp(type, "obj") == 0) {
-        obj = create_obj(ctx, desc, parent);
-    }
-    else if (strcmp(type, "label") == 0) {
-        obj = create_label(ctx, desc, parent);
+    return true;
+}
+
+static void free_parts(JSContext *ctx, JSValue parts[3]) {
+    for (uint32_t i = 0; i < 3; i++) {
+        JS_FreeValue(ctx, parts[i]);
+        parts[i] = JS_UNDEFINED;
     }
-    else if (strcmp(type, "btn") == 0) {
-        obj = create_btn(ctx, desc, parent);
+}
+
+// Commit an encode_root() result; false if there is none or it is malformed
+static bool commit_encoded(JSContext *ctx, lv_obj_t *parent, JSValue cmd) {
+    JSValue parts[3];
+    if (!encoded_parts(ctx, cmd, parts)) return false;
+    bool done = commit_buffer(ctx, parent, parts[0], parts[1], parts[2]) == 0;
+    free_parts(ctx, parts);
+    return done;
+}
+
+// Screen the tree is mounted on; __rasen.commit() reconciles against it
+static lv_obj_t *root_parent = NULL;
+
+// ============ Incremental Mount ============
+
+#ifndef RASEN_MOUNT_SLICE_NODES
+#define RASEN_MOUNT_SLICE_NODES 0       // Elements per slice, 0 = no element limit
+#endif
+#ifndef RASEN_MOUNT_SLICE_US
+#define RASEN_MOUNT_SLICE_US 8000       // Time per slice, 0 = no time limit
+#endif
+
+/**
+ * The first mount of a large tree can take longer than the watchdog and
+ * the touch controller will wait. When slicing is on, the mount commit is
+ * kept here and applied one budget at a time from
+ * qjs_rasen_process_events(), with lv_timer_handler() (and on dual-core
+ * builds the LVGL task, which gets the lock back) running in between.
+ * Elements are applied in document order, so what sits at the top of the
+ * screen appears first.
+ *
+ * A rerender while the mount is unfinished abandons it and starts a new
+ * sliced commit against the partial tree, which the reconciler completes.
+ */
+static struct {
+    commit_state_t state;
+    JSValue parts[3];       // buffer, strings, refs borrowed by state
+    bool active;
+} mount_job = { .parts = { JS_UNDEFINED, JS_UNDEFINED, JS_UNDEFINED } };
+
+static bool mounting = false;   // From qjs_rasen_render*() until a mount commit completes
+static uint32_t mount_slice_nodes = RASEN_MOUNT_SLICE_NODES;
+static uint32_t mount_slice_us = RASEN_MOUNT_SLICE_US;
+
+void qjs_rasen_set_mount_slice(uint32_t max_nodes, uint32_t max_us) {
+    mount_slice_nodes = max_nodes;
+    mount_slice_us = max_us;
+}
+
+bool qjs_rasen_is_mounting(void) {
+    return mount_job.active;
+}
+
+// Snapshots in the job point at live objects; drop it before anything else reconciles
+static void mount_abort(JSContext *ctx) {
+    if (!mount_job.active) return;
+    commit_end(&mount_job.state);
+    free_parts(ctx, mount_job.parts);
+    mount_job.active = false;
+}
+
+static void mount_slice(JSContext *ctx) {
+    uint64_t start = rasen_stats_now_us();
+    RASEN_PROF_BEGIN(prof_start);
+    lvgl_lock();
+    bool done = commit_run(&mount_job.state, mount_slice_nodes,
+                           mount_slice_us ? start + mount_slice_us : 0);
+    if (done) {
+        commit_end(&mount_job.state);
+        free_parts(ctx, mount_job.parts);
+        mount_job.active = false;
+        mounting = false;
+        tw_style_cache_trim();
     }
-    else if (strcmp(type, "bar") == 0) {
-        obj = create_bar(ctx, desc, parent);
+    lvgl_unlock();
+    RASEN_PROF_END(RASEN_PROF_RECONCILE, "mount slice", prof_start);
+    rasen_stats.mount_slices++;
+}
+
+// Keep the commit for slicing; false to apply it synchronously instead
+static bool mount_begin(JSContext *ctx, lv_obj_t *parent, JSValue cmd) {
+    if (!mounting || (!mount_slice_nodes && !mount_slice_us)) return false;
+    if (!encoded_parts(ctx, cmd, mount_job.parts)) return false;
+    if (!commit_begin(&mount_job.state, ctx, parent,
+                      mount_job.parts[0], mount_job.parts[1], mount_job.parts[2])) {
+        free_parts(ctx, mount_job.parts);
+        return false;
     }
-    else {
-        printf("Unknown element type: %s\n", type);
+    mount_job.active = true;
+    return true;
+}
+
+/**
+ * Reconcile the children of the screen against the single __rootElement.
+ * Goes through the command buffer when the runtime provides __encode(),
+ * and walks the descriptor objects otherwise. An unfinished first mount
+ * is sliced (see above); everything else is applied before returning.
+ */
+static void reconcile_root(JSContext *ctx, lv_obj_t *parent) {
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue root = JS_GetPropertyStr(ctx, global, "__rootElement");
+    root_parent = parent;
+    mount_abort(ctx);
+
+    // Encoding is JS only; the LVGL lock covers just the patch
+    JSValue cmd = encode_root(ctx, global, root);
+    RASEN_PROF_BEGIN(prof_start);
+    lvgl_lock();
+    bool sliced = mount_begin(ctx, parent, cmd);
+
+    if (!sliced && !commit_encoded(ctx, parent, cmd)) {
+        JSValue list = JS_NewArray(ctx);
+        if (!JS_IsNull(root) && !JS_IsUndefined(root)) {
+            JS_SetPropertyUint32(ctx, list, 0, JS_DupValue(ctx, root));
+        }
+        reconcile_children(ctx, parent, list);
+        JS_FreeValue(ctx, list);
     }
-    
-    if (type) JS_FreeCString(ctx, type);
-    JS_FreeValue(ctx, type_val);
-    
-    return obj;
+    if (!sliced) mounting = false;
+
+    JS_FreeValue(ctx, cmd);
+    JS_FreeValue(ctx, root);
+    JS_FreeValue(ctx, global);
+
+    // Deleted objects are fully destroyed by now
+    tw_style_cache_trim();
+    lvgl_unlock();
+    RASEN_PROF_END(RASEN_PROF_RECONCILE, "reconcile", prof_start);
+
+    // The first slice right away, so something is on screen at the next refresh
+    if (sliced) mount_slice(ctx);
+}
+
+// Initial render of a freshly evaluated app
+static void mount_root(JSContext *ctx, lv_obj_t *parent) {
+    mounting = true;
+    reconcile_root(ctx, parent);
 }
 
 // ============ JavaScript Runtime Code ============
@@ -277,41 +2821,131 @@ static lv_obj_t *create_element_from_desc(JSContext *ctx, JSValue desc, lv_obj_t
 static const char *rasen_runtime_js = 
 "var __rootElement = null;\n"
 "var __modules = {};\n"
-"var __handlerIdCounter = 1;\n"
 "\n"
 "// Reactivity\n"
+"var __activeEffect = null;\n"
+"\n"
 "function RefImpl(value) {\n"
 "    this._value = value;\n"
 "    this._subscribers = [];\n"
 "}\n"
 "RefImpl.prototype = {\n"
-"    get value() { return this._value; },\n"
+"    get value() {\n"
+"        var e = __activeEffect;\n"
+"        if (e && this._subscribers.indexOf(e) < 0) {\n"
+"            this._subscribers.push(e);\n"
+"            e.deps.push(this);\n"
+"        }\n"
+"        return this._value;\n"
+"    },\n"
 "    set value(v) {\n"
 "        if (this._value !== v) {\n"
 "            this._value = v;\n"
-"            for (var i = 0; i < this._subscribers.length; i++) {\n"
-"                this._subscribers[i]();\n"
-"            }\n"
+"            __queueEffects(this._subscribers);\n"
 "        }\n"
 "    }\n"
 "};\n"
 "\n"
+"// Scheduler: effects run once per frame however often their refs are written\n"
+"var __pendingEffects = [];\n"
+"var __ticks = [];\n"
+"\n"
+"function __queueEffects(subs) {\n"
+"    for (var i = 0; i < subs.length; i++) {\n"
+"        var e = subs[i];\n"
+"        if (!e.queued) { e.queued = true; __pendingEffects.push(e); }\n"
+"    }\n"
+"    if (subs.length) __rasen.requestFrame();\n"
+"}\n"
+"\n"
+"// Called by the native frame; writes made by effects run in the next frame\n"
+"function __flushEffects() {\n"
+"    var q = __pendingEffects;\n"
+"    __pendingEffects = [];\n"
+"    for (var i = 0; i < q.length; i++) { q[i].queued = false; q[i](); }\n"
+"}\n"
+"\n"
+"function __flushTicks() {\n"
+"    var q = __ticks;\n"
+"    __ticks = [];\n"
+"    for (var i = 0; i < q.length; i++) q[i]();\n"
+"}\n"
+"\n"
+"// nextTick(fn?) -> Promise; runs after the next frame has patched the tree\n"
+"function nextTick(fn) {\n"
+"    return new Promise(function(resolve) {\n"
+"        __ticks.push(function() { try { if (fn) fn(); } finally { resolve(); } });\n"
+"        __rasen.requestFrame();\n"
+"    });\n"
+"}\n"
+"\n"
+"function requestRender() { __rasen.requestRender(); }\n"
+"\n"
 "function ref(v) { return new RefImpl(v); }\n"
-"function unref(v) { return (v && typeof v === 'object' && 'value' in v) ? v.value : v; }\n"
+"function isRef(v) { return !!(v && typeof v === 'object' && 'value' in v); }\n"
+"function unref(v) { return isRef(v) ? v.value : v; }\n"
+"function isReactive(v) { return typeof v === 'function' || isRef(v); }\n"
+"function __read(v) { return typeof v === 'function' ? v() : unref(v); }\n"
+"\n"
+"function __untrack(effect) {\n"
+"    for (var i = 0; i < effect.deps.length; i++) {\n"
+"        var subs = effect.deps[i]._subscribers;\n"
+"        var idx = subs.indexOf(effect);\n"
+"        if (idx >= 0) subs.splice(idx, 1);\n"
+"    }\n"
+"    effect.deps.length = 0;\n"
+"}\n"
+"\n"
+"function __track(effect, getter) {\n"
+"    __untrack(effect);\n"
+"    var prev = __activeEffect;\n"
+"    __activeEffect = effect;\n"
+"    try { return getter(); } finally { __activeEffect = prev; }\n"
+"}\n"
+"\n"
+"// watch(source, cb, { immediate }) -> stop; source is a ref or getter\n"
+"function watch(source, cb, options) {\n"
+"    var getter = typeof source === 'function' ? source : function() { return unref(source); };\n"
+"    var value;\n"
+"    var effect = function() {\n"
+"        if (!effect.active) return;\n"
+"        var old = value;\n"
+"        value = __track(effect, getter);\n"
+"        if (value !== old) cb(value, old);\n"
+"    };\n"
+"    effect.deps = [];\n"
+"    effect.active = true;\n"
+"    value = __track(effect, getter);\n"
+"    if (options && options.immediate) cb(value, undefined);\n"
+"    return function() { effect.active = false; __untrack(effect); };\n"
+"}\n"
 "\n"
-"__modules['@rasenjs/reactive-signals'] = { ref: ref, unref: unref };\n"
+"__modules['@rasenjs/reactive-signals'] = { ref: ref, unref: unref, watch: watch };\n"
 "\n"
 "// Host helper\n"
 "function createHost() {\n"
 "    var elements = [];\n"
 "    return {\n"
 "        appendChild: function(d) { elements.push(d); },\n"
-"        requestRender: function() {},\n"
+"        requestRender: requestRender,\n"
+"        nextTick: nextTick,\n"
 "        on: function() { return function() {}; },\n"
 "        getElements: function() { return elements; }\n"
 "    };\n"
 "}\n"
 "\n"
+"// Run a mount function; while profiling, timed as a FunctionCall named after\n"
+"// its displayName, its function name or the type of the element it added\n"
+"var __profiling = __rasen.profile();\n"
+"function __mount(m, host) {\n"
+"    if (!__profiling) return m(host);\n"
+"    __rasen.profBegin();\n"
+"    try { return m(host); } finally {\n"
+"        var els = host.getElements(), last = els[els.length - 1];\n"
+"        __rasen.profEnd(m.displayName || m.name || (last ? last.type : 'mount'));\n"
+"    }\n"
+"}\n"
+"\n"
 "// Components\n"
 "function div(props) {\n"
 "    props = props || {};\n"
@@ -323,11 +2957,12 @@ static const char *rasen_runtime_js =
 "        for (var i = 0; i < children.length; i++) {\n"
 "            if (typeof children[i] === 'function') {\n"
 "                var ch = createHost();\n"
-"                children[i](ch);\n"
+"                __mount(children[i], ch);\n"
 "                var els = ch.getElements();\n"
 "                for (var j = 0; j < els.length; j++) desc.children.push(els[j]);\n"
 "            }\n"
 "        }\n"
+"        if (props.key != null) desc.key = props.key;\n"
 "        host.appendChild(desc);\n"
 "        return function() {};\n"
 "    };\n"
@@ -336,10 +2971,10 @@ static const char *rasen_runtime_js =
 "function label(props) {\n"
 "    props = props || {};\n"
 "    return function(host) {\n"
-"        var t = props.children;\n"
-"        if (typeof t === 'function') t = t();\n"
-"        t = unref(t);\n"
+"        var t = __read(props.children);\n"
 "        var desc = { type: 'label', class: unref(props.class) || '', text: t != null ? String(t) : '' };\n"
+"        if (isReactive(props.children)) desc.bind = { text: props.children };\n"
+"        if (props.key != null) desc.key = props.key;\n"
 "        host.appendChild(desc);\n"
 "        return function() {};\n"
 "    };\n"
@@ -356,36 +2991,332 @@ static const char *rasen_runtime_js =
 "        for (var i = 0; i < children.length; i++) {\n"
 "            if (typeof children[i] === 'function') {\n"
 "                var ch = createHost();\n"
-"                children[i](ch);\n"
+"                __mount(children[i], ch);\n"
 "                var els = ch.getElements();\n"
 "                for (var j = 0; j < els.length; j++) desc.children.push(els[j]);\n"
 "            }\n"
 "        }\n"
+"        if (props.key != null) desc.key = props.key;\n"
+"        host.appendChild(desc);\n"
+"        return function() {};\n"
+"    };\n"
+"}\n"
+"\n"
+"// virtualList({ count, rowHeight, overscan, renderRow: i => mountable }): only visible rows exist\n"
+"function virtualList(props) {\n"
+"    props = props || {};\n"
+"    return function(host) {\n"
+"        var render = function(i) {\n"
+"            var h = createHost();\n"
+"            var m = props.renderRow(i);\n"
+"            if (typeof m === 'function') __mount(m, h);\n"
+"            return h.getElements()[0] || null;\n"
+"        };\n"
+"        var desc = {\n"
+"            type: 'list',\n"
+"            class: unref(props.class) || '',\n"
+"            count: __read(props.count) || 0,\n"
+"            rowHeight: props.rowHeight || 32,\n"
+"            overscan: props.overscan != null ? props.overscan : 2,\n"
+"            render: render\n"
+"        };\n"
+"        if (isReactive(props.count)) desc.bind = { count: props.count };\n"
+"        if (props.key != null) desc.key = props.key;\n"
+"        host.appendChild(desc);\n"
+"        return function() {};\n"
+"    };\n"
+"}\n"
+"\n"
+"function bar(props) {\n"
+"    props = props || {};\n"
+"    return function(host) {\n"
+"        var desc = {\n"
+"            type: 'bar',\n"
+"            class: unref(props.class) || '',\n"
+"            value: __read(props.value) || 0,\n"
+"            min: props.min != null ? props.min : 0,\n"
+"            max: props.max != null ? props.max : 100\n"
+"        };\n"
+"        if (isReactive(props.value)) desc.bind = { value: props.value };\n"
+"        if (props.key != null) desc.key = props.key;\n"
+"        host.appendChild(desc);\n"
+"        return function() {};\n"
+"    };\n"
+"}\n"
+"\n"
+"// Input widgets: onChange gets e.value, the widget's value when the handler runs\n"
+"function __input(type, props, desc) {\n"
+"    desc.type = type;\n"
+"    desc.class = unref(props.class) || '';\n"
+"    if (props.onChange) {\n"
+"        var cb = props.onChange;\n"
+"        desc.handlers = { change: function(e) { cb(e.value); } };\n"
+"    }\n"
+"    if (props.key != null) desc.key = props.key;\n"
+"    return desc;\n"
+"}\n"
+"\n"
+"// A value prop that is left out keeps the widget uncontrolled\n"
+"function __value(desc, v, toValue) {\n"
+"    if (v === undefined) return;\n"
+"    desc.value = toValue(__read(v));\n"
+"    if (isReactive(v)) { desc.bind = desc.bind || {}; desc.bind.value = v; }\n"
+"}\n"
+"\n"
+"function __number(v) { return v | 0; }\n"
+"function __flag(v) { return v ? 1 : 0; }\n"
+"\n"
+"function __range(type) {\n"
+"    return function(props) {\n"
+"        props = props || {};\n"
+"        return function(host) {\n"
+"            var desc = __input(type, props, {\n"
+"                min: props.min != null ? props.min : 0,\n"
+"                max: props.max != null ? props.max : 100\n"
+"            });\n"
+"            __value(desc, props.value, __number);\n"
+"            host.appendChild(desc);\n"
+"            return function() {};\n"
+"        };\n"
+"    };\n"
+"}\n"
+"\n"
+"var slider = __range('slider');\n"
+"var arc = __range('arc');\n"
+"\n"
+"function lvSwitch(props) {\n"
+"    props = props || {};\n"
+"    return function(host) {\n"
+"        var desc = __input('switch', props, {});\n"
+"        __value(desc, props.checked, __flag);\n"
+"        host.appendChild(desc);\n"
+"        return function() {};\n"
+"    };\n"
+"}\n"
+"\n"
+"function checkbox(props) {\n"
+"    props = props || {};\n"
+"    return function(host) {\n"
+"        var desc = __input('checkbox', props, {});\n"
+"        var t = __read(props.label);\n"
+"        if (t != null) desc.text = String(t);\n"
+"        if (isReactive(props.label)) desc.bind = { text: props.label };\n"
+"        __value(desc, props.checked, __flag);\n"
+"        host.appendChild(desc);\n"
+"        return function() {};\n"
+"    };\n"
+"}\n"
+"\n"
+"function textarea(props) {\n"
+"    props = props || {};\n"
+"    return function(host) {\n"
+"        var desc = __input('textarea', props, {});\n"
+"        if (props.value !== undefined) desc.text = String(__read(props.value));\n"
+"        if (isReactive(props.value)) desc.bind = { text: props.value };\n"
+"        if (props.placeholder != null) desc.placeholder = String(__read(props.placeholder));\n"
+"        host.appendChild(desc);\n"
+"        return function() {};\n"
+"    };\n"
+"}\n"
+"\n"
+"function __options(type) {\n"
+"    return function(props) {\n"
+"        props = props || {};\n"
+"        return function(host) {\n"
+"            var desc = __input(type, props, { options: __read(props.options) || [] });\n"
+"            __value(desc, props.selected, __number);\n"
+"            host.appendChild(desc);\n"
+"            return function() {};\n"
+"        };\n"
+"    };\n"
+"}\n"
+"\n"
+"var dropdown = __options('dropdown');\n"
+"var roller = __options('roller');\n"
+"\n"
+"function image(props) {\n"
+"    props = props || {};\n"
+"    return function(host) {\n"
+"        var desc = { type: 'img', class: unref(props.class) || '', src: String(__read(props.src)), handlers: {} };\n"
+"        if (props.onClick) desc.handlers.click = props.onClick;\n"
+"        if (props.key != null) desc.key = props.key;\n"
+"        host.appendChild(desc);\n"
+"        return function() {};\n"
+"    };\n"
+"}\n"
+"\n"
+"function spinner(props) {\n"
+"    props = props || {};\n"
+"    return function(host) {\n"
+"        var desc = { type: 'spinner', class: unref(props.class) || '' };\n"
+"        if (props.key != null) desc.key = props.key;\n"
+"        host.appendChild(desc);\n"
+"        return function() {};\n"
+"    };\n"
+"}\n"
+"\n"
+"// table({ cells, rows, cols, onChange }): cells is an array of rows of cell texts;\n"
+"// rows / cols default to its size. onChange gets the pressed cell as { row, col }\n"
+"function table(props) {\n"
+"    props = props || {};\n"
+"    return function(host) {\n"
+"        var cells = __read(props.cells) || [], cols = 0;\n"
+"        for (var i = 0; i < cells.length; i++) if (cells[i] && cells[i].length > cols) cols = cells[i].length;\n"
+"        var desc = __input('table', props, {\n"
+"            rows: props.rows != null ? props.rows : cells.length,\n"
+"            cols: props.cols != null ? props.cols : cols,\n"
+"            cells: cells\n"
+"        });\n"
 "        host.appendChild(desc);\n"
 "        return function() {};\n"
 "    };\n"
 "}\n"
 "\n"
-"function bar(props) {\n"
+"// chartStream(): pass as chart({ stream }), then push(series, samples) appends\n"
+"// numbers or typed arrays natively; no ref write, no rerender\n"
+"function ChartStream() { this.node = 0; }\n"
+"ChartStream.prototype.push = function(series, samples) {\n"
+"    return __rasen.chartPush(this.node, series, samples);\n"
+"};\n"
+"function chartStream() { return new ChartStream(); }\n"
+"\n"
+"var __chartColors = [0x2196f3, 0xf44336, 0x4caf50, 0xff9800];\n"
+"function __color(c) { return typeof c === 'string' ? parseInt(c.replace('#', ''), 16) : c | 0; }\n"
+"\n"
+"// chart({ points, min, max, type: 'line' | 'bar', mode: 'shift' | 'circular', series, stream })\n"
+"// series: a count or an array of colors\n"
+"function chart(props) {\n"
 "    props = props || {};\n"
 "    return function(host) {\n"
+"        var s = props.series != null ? props.series : 1, colors = [];\n"
+"        if (typeof s === 'number') { for (var i = 0; i < s; i++) colors.push(__chartColors[i % __chartColors.length]); }\n"
+"        else { for (var j = 0; j < s.length; j++) colors.push(__color(s[j])); }\n"
 "        var desc = {\n"
-"            type: 'bar',\n"
+"            type: 'chart',\n"
 "            class: unref(props.class) || '',\n"
-"            value: unref(props.value) || 0,\n"
+"            points: props.points || 100,\n"
 "            min: props.min != null ? props.min : 0,\n"
-"            max: props.max != null ? props.max : 100\n"
+"            max: props.max != null ? props.max : 100,\n"
+"            chartType: props.type === 'bar' ? 1 : 0,\n"
+"            mode: props.mode === 'circular' ? 1 : 0,\n"
+"            series: colors\n"
 "        };\n"
+"        if (props.stream) desc.stream = props.stream;\n"
+"        if (props.key != null) desc.key = props.key;\n"
 "        host.appendChild(desc);\n"
 "        return function() {};\n"
 "    };\n"
 "}\n"
 "\n"
+"// memo(component, deps): reuse the component's descriptors until a dep changes.\n"
+"// deps: refs, getters or values, or a getter returning an array. The result\n"
+"// carries a stamp, and the native reconciler skips a subtree built from it.\n"
+"var __memoStamp = 0;\n"
+"function __depsChanged(prev, next) {\n"
+"    if (!prev || prev.length !== next.length) return true;\n"
+"    for (var i = 0; i < next.length; i++) if (prev[i] !== next[i]) return true;\n"
+"    return false;\n"
+"}\n"
+"function memo(component, deps) {\n"
+"    var last = null, els = [], unmount = null;\n"
+"    return function(host) {\n"
+"        var next = [];\n"
+"        if (typeof deps === 'function') next = deps() || [];\n"
+"        else if (deps) for (var i = 0; i < deps.length; i++) next.push(__read(deps[i]));\n"
+"        if (__depsChanged(last, next)) {\n"
+"            if (unmount) unmount();\n"
+"            var h = createHost();\n"
+"            var m = component.length ? component : component();\n"
+"            if (typeof m === 'function' && !m.displayName) m.displayName = component.name;\n"
+"            unmount = typeof m === 'function' ? __mount(m, h) : null;\n"
+"            els = h.getElements();\n"
+"            var stamp = ++__memoStamp;\n"
+"            for (var j = 0; j < els.length; j++) els[j].memo = stamp;\n"
+"            last = next;\n"
+"        }\n"
+"        for (var k = 0; k < els.length; k++) host.appendChild(els[k]);\n"
+"        return function() {};\n"
+"    };\n"
+"}\n"
+"\n"
+"// Flat command buffer for the native reconciler (see commit_buffer in qjs_rasen.c)\n"
+"var __typeCodes = __rasen.typeCodes;   // elem_type_t values of the enabled widgets\n"
+"var __cmd = __rasen.cmdCodes;          // CMD_* opcodes\n"
+"var __handlerKinds = ['click', 'long_press', 'change'];\n"
+"var __bindKinds = ['text', 'value', 'count'];\n"
+"\n"
+"function __encode(root) {\n"
+"    var words = [], strings = [], index = new Map(), refs = [];\n"
+"    function str(s) {\n"
+"        var i = index.get(s);\n"
+"        if (i === undefined) { i = strings.length; strings.push(s); index.set(s, i); }\n"
+"        return i;\n"
+"    }\n"
+"    function node(d) {\n"
+"        var k, v;\n"
+"        words.push(__cmd.ELEM, __typeCodes[d.type] || 0, d.key != null ? str(String(d.key)) : -1);\n"
+"        if (d.memo) {\n"
+"            // The native side keeps or rebuilds the subtree from d itself\n"
+"            words.push(__cmd.MEMO, d.memo, refs.length, __cmd.END);\n"
+"            refs.push(d);\n"
+"            return;\n"
+"        }\n"
+"        if (typeof d.class === 'number') words.push(__cmd.STYLE, d.class);\n"
+"        else if (d.class) words.push(__cmd.CLASS, str(d.class));\n"
+"        if (d.text != null) words.push(__cmd.TEXT, str(String(d.text)));\n"
+"        if (d.value != null) words.push(__cmd.VALUE, d.value | 0, d.min != null ? d.min | 0 : 0, d.max != null ? d.max | 0 : 100);\n"
+"        else if (d.min != null || d.max != null) words.push(__cmd.RANGE, d.min != null ? d.min | 0 : 0, d.max != null ? d.max | 0 : 100);\n"
+"        if (d.options != null) words.push(__cmd.OPTIONS, str(Array.isArray(d.options) ? d.options.join('\\n') : String(d.options)));\n"
+"        if (d.placeholder != null) words.push(__cmd.PLACEHOLDER, str(String(d.placeholder)));\n"
+"        if (d.src != null) words.push(__cmd.SRC, str(String(d.src)));\n"
+"        if (d.type === 'chart') {\n"
+"            var sr = d.series || [];\n"
+"            words.push(__cmd.CHART, d.chartType | 0, d.mode | 0, d.points | 0, d.stream ? refs.length : -1, sr.length);\n"
+"            if (d.stream) refs.push(d.stream);\n"
+"            for (k = 0; k < sr.length; k++) words.push(sr[k] | 0);\n"
+"        }\n"
+"        if (d.type === 'table') {\n"
+"            var tr = d.rows != null ? d.rows | 0 : -1, tn = d.cols != null ? d.cols | 0 : -1;\n"
+"            var tc = d.cells && tr >= 0 && tn >= 0 ? d.cells : null;\n"
+"            words.push(__cmd.TABLE, tr, tn, tc ? tr * tn : 0);\n"
+"            for (var ti = 0; tc && ti < tr; ti++) {\n"
+"                for (var tj = 0; tj < tn; tj++) {\n"
+"                    var cell = tc[ti] ? tc[ti][tj] : null;\n"
+"                    words.push(cell != null ? str(String(cell)) : -1);\n"
+"                }\n"
+"            }\n"
+"        }\n"
+"        if (d.type === 'list') { words.push(__cmd.LIST, d.count | 0, d.rowHeight | 0, d.overscan | 0, refs.length); refs.push(d.render); }\n"
+"        if (d.handlers) {\n"
+"            for (k = 0; k < __handlerKinds.length; k++) {\n"
+"                v = d.handlers[__handlerKinds[k]];\n"
+"                if (typeof v === 'function') { words.push(__cmd.HANDLER, k, refs.length); refs.push(v); }\n"
+"            }\n"
+"        }\n"
+"        if (d.bind) {\n"
+"            for (k = 0; k < __bindKinds.length; k++) {\n"
+"                v = d.bind[__bindKinds[k]];\n"
+"                if (v != null) { words.push(__cmd.BIND, k, refs.length); refs.push(v); }\n"
+"            }\n"
+"        }\n"
+"        var c = d.children;\n"
+"        if (c) {\n"
+"            for (k = 0; k < c.length; k++) {\n"
+"                if (c[k] && typeof c[k] === 'object') node(c[k]);\n"
+"            }\n"
+"        }\n"
+"        words.push(__cmd.END);\n"
+"    }\n"
+"    if (root) node(root);\n"
+"    return [new Int32Array(words).buffer, strings, refs];\n"
+"}\n"
+"\n"
 "var __mountFn = null;\n"
 "var __unmountFn = null;\n"
 "\n"
 "function run(App) {\n"
 "    __mountFn = App();\n"
+"    if (typeof __mountFn === 'function' && !__mountFn.displayName) __mountFn.displayName = App.name;\n"
 "    __rerender();\n"
 "}\n"
 "\n"
@@ -393,49 +3324,332 @@ static const char *rasen_runtime_js =
 "    if (!__mountFn) return null;\n"
 "    if (__unmountFn) __unmountFn();\n"
 "    var rootHost = createHost();\n"
-"    __unmountFn = __mountFn(rootHost);\n"
+"    __unmountFn = __mount(__mountFn, rootHost);\n"
 "    var elements = rootHost.getElements();\n"
 "    __rootElement = elements[0] || null;\n"
 "    return __rootElement;\n"
 "}\n"
 "\n"
+"function stats() { return __rasen.stats(); }\n"
+"\n"
+"// Byte budget for decoded compressed images (rasen-lvgl build --compress)\n"
+"function imageCache(bytes) { __rasen.imageCache(bytes); }\n"
+"\n"
+"// persist(key, ref): the ref's value goes into qjs_rasen_snapshot() and starts\n"
+"// from the saved value after qjs_rasen_restore(); plain data only\n"
+"var __persisted = {};\n"
+"var __restored = null;\n"
+"function persist(key, r) {\n"
+"    if (__restored && Object.prototype.hasOwnProperty.call(__restored, key)) r.value = __restored[key];\n"
+"    __persisted[key] = r;\n"
+"    return r;\n"
+"}\n"
+"function restored() { return __restored !== null; }\n"
+"function __snapshot() {\n"
+"    var out = {};\n"
+"    for (var k in __persisted) out[k] = __persisted[k].value;\n"
+"    return out;\n"
+"}\n"
+"\n"
+"// deepSleep(ms): snapshot and power down; 0 sleeps until the next touch\n"
+"function deepSleep(ms) { __rasen.deepSleep(ms || 0); }\n"
+"\n"
+"// profile(on): record a Chrome trace of mounts, reconciles and LVGL phases;\n"
+"// returns whether recording (false when built without RASEN_PROFILE)\n"
+"function profile(on) {\n"
+"    if (on !== undefined) __profiling = __rasen.profile(!!on);\n"
+"    return __profiling;\n"
+"}\n"
+"\n"
+"// Worker(source | function, { memoryLimit }) runs in its own runtime and thread.\n"
+"// Messages are copied (plain data only); replies arrive as onmessage({ data }).\n"
+"var __workers = {};\n"
+"function Worker(source, options) {\n"
+"    if (typeof source === 'function') source = '(' + source.toString() + ')();';\n"
+"    this.onmessage = null;\n"
+"    this.id = __rasen.workerSpawn(String(source), options && options.memoryLimit);\n"
+"    __workers[this.id] = this;\n"
+"}\n"
+"Worker.prototype.postMessage = function(data) { __rasen.workerPost(this.id, data); };\n"
+"Worker.prototype.terminate = function() {\n"
+"    __rasen.workerTerminate(this.id);\n"
+"    delete __workers[this.id];\n"
+"};\n"
+"function createWorker(source, options) { return new Worker(source, options); }\n"
+"\n"
+"function __workerMessage(id, data) {\n"
+"    var w = __workers[id];\n"
+"    if (w && w.onmessage) w.onmessage({ data: data });\n"
+"}\n"
+"\n"
 "__modules['@rasenjs/lvgl'] = {\n"
-"    ref: ref, unref: unref,\n"
-"    div: div, label: label, text: text, button: button, bar: bar,\n"
-"    run: run\n"
+"    ref: ref, unref: unref, watch: watch,\n"
+"    div: div, label: label, text: text, button: button, bar: bar, virtualList: virtualList,\n"
+"    image: image, slider: slider, lvSwitch: lvSwitch, checkbox: checkbox, textarea: textarea,\n"
+"    arc: arc, spinner: spinner, dropdown: dropdown, roller: roller, table: table,\n"
+"    chart: chart, chartStream: chartStream, memo: memo,\n"
+"    run: run, stats: stats, nextTick: nextTick, requestRender: requestRender, imageCache: imageCache,\n"
+"    persist: persist, restored: restored, deepSleep: deepSleep, profile: profile,\n"
+"    Worker: Worker, createWorker: createWorker\n"
 "};\n";
 
 // ============ Public API ============
 
+// Print and clear the pending exception if ret is one; returns -1 in that case
+static int check_exception(JSContext *ctx, JSValue ret, const char *what) {
+    if (!JS_IsException(ret)) {
+        JS_FreeValue(ctx, ret);
+        return 0;
+    }
+    JSValue exc = JS_GetException(ctx);
+    const char *str = JS_ToCString(ctx, exc);
+    printf("%s: %s\n", what, str);
+    JS_FreeCString(ctx, str);
+    JS_FreeValue(ctx, exc);
+    return -1;
+}
+
+// Run a function compiled by qjs_rasen_compile*(); buf may live in flash
+static int eval_bytecode(JSContext *ctx, const uint8_t *buf, size_t len, const char *what) {
+    uint64_t start = rasen_stats_now_us();
+    RASEN_PROF_BEGIN(prof_start);
+    JSValue fn = JS_ReadObject(ctx, buf, len, JS_READ_OBJ_BYTECODE);
+    if (JS_IsException(fn)) {
+        return check_exception(ctx, fn, what);
+    }
+    // JS_EvalFunction takes ownership of fn
+    int ret = check_exception(ctx, JS_EvalFunction(ctx, fn), what);
+    RASEN_PROF_END(RASEN_PROF_EVAL, "<bytecode>", prof_start);
+    rasen_stats_add_time(RASEN_TIME_JS, start);
+    return ret;
+}
+
+static JSValue js_rasen_stats(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    // Sampling walks the LVGL heap
+    lvgl_lock();
+    JSValue stats = rasen_stats_to_js(ctx);
+    lvgl_unlock();
+    return stats;
+}
+
+// __rasen.requestRender(): reconcile once at the next frame, however often it is called
+static JSValue js_rasen_request_render(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    needs_rerender = true;
+    rasen_stats.render_requests++;
+    return JS_UNDEFINED;
+}
+
+// __rasen.requestFrame(): run queued effects and nextTick callbacks at the next frame
+static JSValue js_rasen_request_frame(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    frame_requested = true;
+    return JS_UNDEFINED;
+}
+
+static bool sleep_requested = false;  // deepSleep() called; see qjs_rasen_take_sleep_request()
+static uint32_t sleep_ms = 0;
+
+// __rasen.deepSleep(ms): picked up by the platform's main loop
+static JSValue js_rasen_deep_sleep(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    uint32_t ms = 0;
+    if (argc > 0 && JS_ToUint32(ctx, &ms, argv[0])) return JS_EXCEPTION;
+    sleep_requested = true;
+    sleep_ms = ms;
+    return JS_UNDEFINED;
+}
+
+#if RASEN_PROFILE
+// Start ticks of the JS spans (component mounts) currently open
+#define PROF_JS_DEPTH 64
+static uint64_t prof_js_starts[PROF_JS_DEPTH];
+static int prof_js_depth = 0;
+
+// __rasen.profBegin(): open a span, closed by the matching profEnd(name)
+static JSValue js_rasen_prof_begin(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    if (prof_js_depth < PROF_JS_DEPTH) {
+        prof_js_starts[prof_js_depth] = rasen_prof_active ? rasen_prof_now() : 0;
+    }
+    prof_js_depth++;
+    return JS_UNDEFINED;
+}
+
+// __rasen.profEnd(name): the name is only known once the component has mounted
+static JSValue js_rasen_prof_end(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    if (prof_js_depth == 0) return JS_UNDEFINED;
+    prof_js_depth--;
+    if (prof_js_depth >= PROF_JS_DEPTH) return JS_UNDEFINED;
+
+    uint64_t start = prof_js_starts[prof_js_depth];
+    if (!start || !rasen_prof_active) return JS_UNDEFINED;
+    const char *name = argc > 0 ? JS_ToCString(ctx, argv[0]) : NULL;
+    rasen_prof_record(RASEN_PROF_CALL, name ? rasen_prof_intern(name) : NULL, start);
+    if (name) JS_FreeCString(ctx, name);
+    return JS_UNDEFINED;
+}
+#endif
+
+int qjs_rasen_profile(JSContext *ctx, bool on) {
+    int ret = 0;
+    if (on) {
+        ret = rasen_prof_start(0);
+    } else {
+        rasen_prof_stop();
+    }
+#if RASEN_PROFILE
+    prof_js_depth = 0;
+#endif
+    // __mount() checks this before timing anything
+    JSValue global = JS_GetGlobalObject(ctx);
+    JS_SetPropertyStr(ctx, global, "__profiling", JS_NewBool(ctx, rasen_prof_active));
+    JS_FreeValue(ctx, global);
+    return ret;
+}
+
+// __rasen.profile(on?): start or stop recording; returns whether it records
+static JSValue js_rasen_profile(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    if (argc > 0 && !JS_IsUndefined(argv[0])) {
+        qjs_rasen_profile(ctx, JS_ToBool(ctx, argv[0]) > 0);
+    }
+    return JS_NewBool(ctx, rasen_prof_active);
+}
+
+// __rasen.imageCache(bytes): budget of the cache of decoded compressed images
+static JSValue js_rasen_image_cache(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    uint64_t bytes;
+    if (argc < 1 || JS_ToIndex(ctx, &bytes, argv[0])) {
+        return JS_ThrowTypeError(ctx, "imageCache: expected a byte count");
+    }
+    // The decoder runs inside lv_timer_handler()
+    lvgl_lock();
+    rasen_img_set_cache_budget((size_t)bytes);
+    lvgl_unlock();
+    return JS_UNDEFINED;
+}
+
+// __rasen.commit(buffer, strings, refs): apply an __encode() result to the screen
+static JSValue js_rasen_commit(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    if (argc < 3 || !root_parent) {
+        return JS_ThrowTypeError(ctx, "commit: nothing mounted or missing arguments");
+    }
+    mount_abort(ctx);
+    lvgl_lock();
+    int ret = commit_buffer(ctx, root_parent, argv[0], argv[1], argv[2]);
+    tw_style_cache_trim();
+    lvgl_unlock();
+    return JS_NewBool(ctx, ret == 0);
+}
+
+// Native helpers reachable from scripts as __rasen.*
+static void install_native_api(JSContext *ctx) {
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue api = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, api, "stats", JS_NewCFunction(ctx, js_rasen_stats, "stats", 0));
+    JS_SetPropertyStr(ctx, api, "commit", JS_NewCFunction(ctx, js_rasen_commit, "commit", 3));
+    JS_SetPropertyStr(ctx, api, "requestRender", JS_NewCFunction(ctx, js_rasen_request_render, "requestRender", 0));
+    JS_SetPropertyStr(ctx, api, "requestFrame", JS_NewCFunction(ctx, js_rasen_request_frame, "requestFrame", 0));
+    JS_SetPropertyStr(ctx, api, "chartPush", JS_NewCFunction(ctx, js_rasen_chart_push, "chartPush", 3));
+    JS_SetPropertyStr(ctx, api, "imageCache", JS_NewCFunction(ctx, js_rasen_image_cache, "imageCache", 1));
+    JS_SetPropertyStr(ctx, api, "deepSleep", JS_NewCFunction(ctx, js_rasen_deep_sleep, "deepSleep", 1));
+    JS_SetPropertyStr(ctx, api, "profile", JS_NewCFunction(ctx, js_rasen_profile, "profile", 1));
+#if RASEN_PROFILE
+    JS_SetPropertyStr(ctx, api, "profBegin", JS_NewCFunction(ctx, js_rasen_prof_begin, "profBegin", 0));
+    JS_SetPropertyStr(ctx, api, "profEnd", JS_NewCFunction(ctx, js_rasen_prof_end, "profEnd", 1));
+#endif
+    rasen_worker_install(ctx, api);
+    
+    // __encode() takes its type codes from here, so JS and elem_classes can't drift
+    JSValue codes = JS_NewObject(ctx);
+    for (int t = ELEM_OBJ; t < ELEM_TYPE_COUNT; t++) {
+        if (elem_classes[t].create) JS_SetPropertyStr(ctx, codes, elem_classes[t].name, JS_NewInt32(ctx, t));
+    }
+    JS_SetPropertyStr(ctx, api, "typeCodes", codes);
+    
+    JSValue cmds = JS_NewObject(ctx);
+    for (size_t i = 0; i < sizeof(cmd_names) / sizeof(cmd_names[0]); i++) {
+        JS_SetPropertyStr(ctx, cmds, cmd_names[i].name, JS_NewInt32(ctx, cmd_names[i].code));
+    }
+    JS_SetPropertyStr(ctx, api, "cmdCodes", cmds);
+    
+    JS_SetPropertyStr(ctx, global, "__rasen", api);
+    JS_FreeValue(ctx, global);
+}
+
+#ifndef RASEN_USE_REGEXP
+#define RASEN_USE_REGEXP 1
+#endif
+
+JSContext *qjs_rasen_new_context(JSRuntime *rt) {
+#if RASEN_USE_REGEXP
+    return JS_NewContext(rt);
+#else
+    // JS_NewContext() minus JS_AddIntrinsicRegExp(): without the compiler
+    // hook and the RegExp class nothing references libregexp's engine
+    JSContext *ctx = JS_NewContextRaw(rt);
+    if (!ctx) return NULL;
+    JS_AddIntrinsicBaseObjects(ctx);
+    JS_AddIntrinsicDate(ctx);
+    JS_AddIntrinsicEval(ctx);
+    JS_AddIntrinsicJSON(ctx);
+    JS_AddIntrinsicProxy(ctx);
+    JS_AddIntrinsicMapSet(ctx);
+    JS_AddIntrinsicTypedArrays(ctx);
+    JS_AddIntrinsicPromise(ctx);
+    JS_AddIntrinsicBigInt(ctx);
+    JS_AddIntrinsicWeakRef(ctx);
+    return ctx;
+#endif
+}
+
 int qjs_rasen_init(JSContext *ctx) {
+    return qjs_rasen_init_bytecode(ctx, NULL, 0);
+}
+
+int qjs_rasen_init_bytecode(JSContext *ctx, const uint8_t *runtime_bc, size_t len) {
     global_ctx = ctx;
-    handler_count = 0;
-    next_handler_id = 1;
     needs_rerender = false;
+    frame_requested = false;
+    event_queue_clear();
+    install_native_api(ctx);
+    type_atoms_init(ctx);
     
-    // Evaluate the runtime JavaScript
-    JSValue ret = JS_Eval(ctx, rasen_runtime_js, strlen(rasen_runtime_js), "<rasen>", JS_EVAL_TYPE_GLOBAL);
-    if (JS_IsException(ret)) {
-        JSValue exc = JS_GetException(ctx);
-        const char *str = JS_ToCString(ctx, exc);
-        printf("Rasen init error: %s\n", str);
-        JS_FreeCString(ctx, str);
-        JS_FreeValue(ctx, exc);
-        JS_FreeValue(ctx, ret);
-        return -1;
+    if (runtime_bc) {
+        return eval_bytecode(ctx, runtime_bc, len, "Rasen init error");
     }
-    JS_FreeValue(ctx, ret);
     
-    return 0;
+    // Evaluate the runtime JavaScript
+    JSValue ret = JS_Eval(ctx, rasen_runtime_js, strlen(rasen_runtime_js), "<rasen>", JS_EVAL_TYPE_GLOBAL);
+    return check_exception(ctx, ret, "Rasen init error");
 }
 
 void qjs_rasen_cleanup(JSContext *ctx) {
-    // Free all handler references
-    for (uint32_t i = 0; i < handler_count; i++) {
-        JS_FreeValue(ctx, handlers[i].func);
+    // Workers may still be posting replies; stop them before anything else
+    rasen_worker_shutdown();
+    
+    mount_abort(ctx);
+    mounting = false;
+    
+    // Release JS values held by live nodes; the LVGL objects may outlive the context
+    for (uint32_t i = 0; i < node_table.capacity; i++) {
+        rasen_node_t **slot = handle_slot_at(&node_table, i);
+        if (slot) release_node_js(ctx, *slot);
+    }
+    lvgl_lock();
+    pool_destroy();
+    lvgl_unlock();
+    handle_table_destroy(&node_table);
+    
+    // Free any handler references not owned by a node
+    for (uint32_t i = 0; i < handler_table.capacity; i++) {
+        handler_entry_t *entry = handle_slot_at(&handler_table, i);
+        if (entry) JS_FreeValue(ctx, entry->func);
     }
-    handler_count = 0;
+    handle_table_destroy(&handler_table);
+    rasen_stats.handlers_live = 0;
+    type_atoms_free(ctx);
     global_ctx = NULL;
+    root_parent = NULL;
+    needs_rerender = false;
+    frame_requested = false;
+    event_queue_clear();
 }
 
 // Transform ESM imports to module lookups
@@ -507,73 +3721,396 @@ int qjs_rasen_render(JSContext *ctx, const char *script, lv_obj_t *parent) {
     }
     
     // Execute user script
+    uint64_t start = rasen_stats_now_us();
+    RASEN_PROF_BEGIN(prof_start);
     JSValue ret = JS_Eval(ctx, transformed, strlen(transformed), "<user>", JS_EVAL_TYPE_GLOBAL);
     free(transformed);
+    RASEN_PROF_END(RASEN_PROF_EVAL, "<user>", prof_start);
+    rasen_stats_add_time(RASEN_TIME_JS, start);
     
-    if (JS_IsException(ret)) {
-        JSValue exc = JS_GetException(ctx);
-        const char *str = JS_ToCString(ctx, exc);
-        printf("Script error: %s\n", str);
-        JS_FreeCString(ctx, str);
-        JS_FreeValue(ctx, exc);
-        JS_FreeValue(ctx, ret);
+    if (check_exception(ctx, ret, "Script error") != 0) {
         return -1;
     }
-    JS_FreeValue(ctx, ret);
     
-    // Get __rootElement and render
-    JSValue global = JS_GetGlobalObject(ctx);
-    JSValue root = JS_GetPropertyStr(ctx, global, "__rootElement");
+    // Build the tree from __rootElement (an empty parent means everything is created)
+    mount_root(ctx, parent);
+    
+    return 0;
+}
+
+int qjs_rasen_render_bytecode(JSContext *ctx, const uint8_t *buf, size_t len, lv_obj_t *parent) {
+    if (eval_bytecode(ctx, buf, len, "Script error") != 0) {
+        return -1;
+    }
+    
+    mount_root(ctx, parent);
+    return 0;
+}
+
+// ============ Mapped Loading ============
+
+static uint32_t read_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool is_image(const uint8_t *p, size_t len) {
+    return len >= RASEN_IMAGE_HEADER_SIZE && memcmp(p, "RSNA", 4) == 0;
+}
+
+int rasen_image_find(const void *image, size_t len, rasen_section_type_t type,
+                     const uint8_t **out, size_t *out_len) {
+    const uint8_t *p = image;
+    if (!is_image(p, len) || (p[4] | (p[5] << 8)) != RASEN_IMAGE_VERSION) return -1;
+    
+    uint32_t count = p[6] | (p[7] << 8);
+    uint32_t total = read_u32(p + 8);
+    if (total > len || RASEN_IMAGE_HEADER_SIZE + (size_t)count * 12 > total) return -1;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *entry = p + RASEN_IMAGE_HEADER_SIZE + i * 12;
+        uint32_t offset = read_u32(entry + 4);
+        uint32_t size = read_u32(entry + 8);
+        if (read_u32(entry) != (uint32_t)type) continue;
+        if (offset > total || size > total - offset) return -1;
+        
+        *out = p + offset;
+        *out_len = size;
+        return 0;
+    }
+    return -1;
+}
+
+// True if some line starts with an import declaration, after whitespace and
+// comments; import() and import.meta don't count. A block comment opened
+// after code on a line is not tracked, which can only cause a false match.
+static bool has_import_statement(const char *src) {
+    const char *p = src;
+    bool line_start = true;
+    
+    while (*p) {
+        if (p[0] == '/' && p[1] == '*') {
+            const char *end = strstr(p + 2, "*/");
+            if (!end) return false;
+            if (memchr(p, '\n', (size_t)(end - p))) line_start = true;
+            p = end + 2;
+        } else if (p[0] == '/' && p[1] == '/') {
+            while (*p && *p != '\n') p++;
+        } else if (*p == '\n') {
+            line_start = true;
+            p++;
+        } else if (*p == ' ' || *p == '\t' || *p == '\r') {
+            p++;
+        } else {
+            if (line_start && strncmp(p, "import", 6) == 0 && p[6] && strchr(" \t{*\"'", p[6])) {
+                return true;
+            }
+            // Rest of the line is code; skip it
+            while (*p && *p != '\n') p++;
+            line_start = false;
+        }
+    }
+    return false;
+}
+
+// Source must end with its NUL terminator inside the mapping (JS_Eval requires it)
+static int render_source_in_place(JSContext *ctx, const char *src, size_t len, bool imports_done,
+                                  lv_obj_t *parent) {
+    if (len == 0 || src[len - 1] != '\0') {
+        printf("Mapped source must be NUL-terminated\n");
+        return -1;
+    }
     
-    if (!JS_IsNull(root) && !JS_IsUndefined(root)) {
-        create_element_from_desc(ctx, root, parent);
+    // Sources with imports still need the rewriting copy
+    if (!imports_done && has_import_statement(src)) {
+        return qjs_rasen_render(ctx, src, parent);
     }
     
-    JS_FreeValue(ctx, root);
+    uint64_t start = rasen_stats_now_us();
+    RASEN_PROF_BEGIN(prof_start);
+    JSValue ret = JS_Eval(ctx, src, len - 1, "<user>", JS_EVAL_TYPE_GLOBAL);
+    RASEN_PROF_END(RASEN_PROF_EVAL, "<user>", prof_start);
+    rasen_stats_add_time(RASEN_TIME_JS, start);
+    if (check_exception(ctx, ret, "Script error") != 0) {
+        return -1;
+    }
+    
+    mount_root(ctx, parent);
+    return 0;
+}
+
+int qjs_rasen_render_mapped(JSContext *ctx, const void *data, size_t len, lv_obj_t *parent) {
+    const uint8_t *p = data;
+    if (!p || len == 0) return -1;
+    
+    if (is_image(p, len)) {
+        const uint8_t *section;
+        size_t section_len;
+        
+        // The image decoder reads the table from the LVGL task
+        lvgl_lock();
+        if (rasen_image_find(p, len, RASEN_SECTION_STYLES, &section, &section_len) == 0) {
+            tw_style_table_load(section, section_len);
+        }
+        if (rasen_image_find(p, len, RASEN_SECTION_IMAGES, &section, &section_len) == 0) {
+            rasen_img_table_load(section, section_len);
+        }
+        lvgl_unlock();
+        if (rasen_image_find(p, len, RASEN_SECTION_BYTECODE, &section, &section_len) == 0) {
+            return qjs_rasen_render_bytecode(ctx, section, section_len, parent);
+        }
+        if (rasen_image_find(p, len, RASEN_SECTION_SOURCE, &section, &section_len) == 0) {
+            bool imports_done = read_u32(p + 12) & RASEN_IMAGE_F_IMPORTS_DONE;
+            return render_source_in_place(ctx, (const char *)section, section_len, imports_done, parent);
+        }
+        printf("App image has no script\n");
+        return -1;
+    }
+    
+    // QuickJS bytecode starts with a small version byte, source with text
+    if (p[0] < 0x20 && p[0] != '\t' && p[0] != '\n' && p[0] != '\r') {
+        return qjs_rasen_render_bytecode(ctx, p, len, parent);
+    }
+    return render_source_in_place(ctx, (const char *)p, len, false, parent);
+}
+
+// ============ Bytecode Compilation ============
+
+static uint8_t *compile_source(JSContext *ctx, const char *src, const char *filename, size_t *out_len) {
+    JSValue fn = JS_Eval(ctx, src, strlen(src), filename,
+                         JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY);
+    if (JS_IsException(fn)) {
+        check_exception(ctx, fn, "Compile error");
+        return NULL;
+    }
+    
+    uint8_t *buf = JS_WriteObject(ctx, out_len, fn, JS_WRITE_OBJ_BYTECODE);
+    JS_FreeValue(ctx, fn);
+    return buf;
+}
+
+uint8_t *qjs_rasen_compile(JSContext *ctx, const char *script, size_t *out_len) {
+    // Imports are rewritten here once, so the device never runs transform_imports()
+    char *transformed = transform_imports(script);
+    if (!transformed) {
+        printf("Failed to transform script\n");
+        return NULL;
+    }
+    
+    uint8_t *buf = compile_source(ctx, transformed, "<user>", out_len);
+    free(transformed);
+    return buf;
+}
+
+uint8_t *qjs_rasen_compile_runtime(JSContext *ctx, size_t *out_len) {
+    return compile_source(ctx, rasen_runtime_js, "<rasen>", out_len);
+}
+
+// ============ Snapshot ============
+
+#define SNAPSHOT_MAGIC "RSNP"
+
+int qjs_rasen_snapshot(JSContext *ctx, uint8_t **out, size_t *out_len) {
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue fn = JS_GetPropertyStr(ctx, global, "__snapshot");
+    JSValue state = JS_IsFunction(ctx, fn) ? JS_Call(ctx, fn, global, 0, NULL)
+                                           : JS_ThrowTypeError(ctx, "runtime has no __snapshot()");
+    JS_FreeValue(ctx, fn);
     JS_FreeValue(ctx, global);
+    if (JS_IsException(state)) {
+        return check_exception(ctx, state, "Snapshot error");
+    }
+    
+    size_t len;
+    uint8_t *data = JS_WriteObject(ctx, &len, state, 0);
+    JS_FreeValue(ctx, state);
+    if (!data) {
+        // Functions and other non-data values can't be written
+        return check_exception(ctx, JS_EXCEPTION, "Snapshot error");
+    }
+    
+    uint8_t *buf = js_malloc(ctx, len + 4);
+    if (buf) {
+        memcpy(buf, SNAPSHOT_MAGIC, 4);
+        memcpy(buf + 4, data, len);
+    }
+    js_free(ctx, data);
+    if (!buf) return -1;
     
+    *out = buf;
+    *out_len = len + 4;
+    return 0;
+}
+
+int qjs_rasen_restore(JSContext *ctx, const uint8_t *buf, size_t len) {
+    if (!buf || len < 4 || memcmp(buf, SNAPSHOT_MAGIC, 4) != 0) {
+        printf("Snapshot: bad header\n");
+        return -1;
+    }
+    
+    JSValue state = JS_ReadObject(ctx, buf + 4, len - 4, 0);
+    if (JS_IsException(state)) {
+        return check_exception(ctx, state, "Snapshot error");
+    }
+    JSValue global = JS_GetGlobalObject(ctx);
+    JS_SetPropertyStr(ctx, global, "__restored", state);
+    JS_FreeValue(ctx, global);
     return 0;
 }
 
+bool qjs_rasen_take_sleep_request(uint32_t *ms) {
+    if (!sleep_requested) return false;
+    sleep_requested = false;
+    if (ms) *ms = sleep_ms;
+    return true;
+}
+
 int qjs_rasen_rerender(JSContext *ctx, lv_obj_t *parent) {
-    // Clear existing children
-    lv_obj_clean(parent);
+    uint32_t created = rasen_stats.objects_created;
+    uint32_t deleted = rasen_stats.objects_deleted;
+    uint64_t start = rasen_stats_now_us();
+    
+    // Requests made while rendering schedule the next frame
+    needs_rerender = false;
     
     // Call __rerender()
     JSValue global = JS_GetGlobalObject(ctx);
     JSValue rerender_fn = JS_GetPropertyStr(ctx, global, "__rerender");
     
     if (JS_IsFunction(ctx, rerender_fn)) {
+        RASEN_PROF_BEGIN(prof_start);
         JSValue ret = JS_Call(ctx, rerender_fn, JS_UNDEFINED, 0, NULL);
+        RASEN_PROF_END(RASEN_PROF_CALL, "__rerender", prof_start);
         JS_FreeValue(ctx, ret);
     }
     
     JS_FreeValue(ctx, rerender_fn);
+    JS_FreeValue(ctx, global);
+    rasen_stats_add_time(RASEN_TIME_JS, start);
     
-    // Get new __rootElement and render
-    JSValue root = JS_GetPropertyStr(ctx, global, "__rootElement");
+    // Patch the live tree against the new __rootElement
+    reconcile_root(ctx, parent);
     
-    if (!JS_IsNull(root) && !JS_IsUndefined(root)) {
-        create_element_from_desc(ctx, root, parent);
+    rasen_stats.rerenders++;
+    rasen_stats.rerender_created = rasen_stats.objects_created - created;
+    rasen_stats.rerender_deleted = rasen_stats.objects_deleted - deleted;
+    rasen_alloc_mark_frame();
+    return 0;
+}
+
+// ============ Frame Scheduler ============
+
+#ifndef RASEN_FRAME_PERIOD_MS
+#define RASEN_FRAME_PERIOD_MS LV_DISP_DEF_REFR_PERIOD
+#endif
+
+static uint32_t last_frame_tick = 0;
+static bool frame_ran = false;
+
+static void run_jobs(JSContext *ctx) {
+    JSContext *ctx2;
+    if (JS_IsJobPending(JS_GetRuntime(ctx))) {
+        uint64_t start = rasen_stats_now_us();
+        while (JS_ExecutePendingJob(JS_GetRuntime(ctx), &ctx2) > 0) {
+            // Keep processing
+        }
+        rasen_stats_add_time(RASEN_TIME_JS, start);
     }
-    
-    JS_FreeValue(ctx, root);
+}
+
+static void call_runtime(JSContext *ctx, const char *name) {
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue fn = JS_GetPropertyStr(ctx, global, name);
+    if (JS_IsFunction(ctx, fn)) {
+        uint64_t start = rasen_stats_now_us();
+        RASEN_PROF_BEGIN(prof_start);
+        check_exception(ctx, JS_Call(ctx, fn, JS_UNDEFINED, 0, NULL), name);
+        RASEN_PROF_END(RASEN_PROF_CALL, name, prof_start);
+        rasen_stats_add_time(RASEN_TIME_JS, start);
+    }
+    JS_FreeValue(ctx, fn);
     JS_FreeValue(ctx, global);
-    
-    needs_rerender = false;
-    return 0;
+}
+
+// Milliseconds until the next frame may run, 0 if one is due now
+static uint32_t frame_wait_ms(void) {
+    if (!frame_ran) return 0;
+    uint32_t elapsed = lv_tick_elaps(last_frame_tick);
+    return elapsed >= RASEN_FRAME_PERIOD_MS ? 0 : RASEN_FRAME_PERIOD_MS - elapsed;
+}
+
+/**
+ * One frame of JS work: queued ref effects, a single reconcile however
+ * many handlers or requestRender() calls came in since the last frame,
+ * then nextTick callbacks, which see the patched tree.
+ */
+static void run_frame(JSContext *ctx) {
+    frame_requested = false;
+    last_frame_tick = lv_tick_get();
+    frame_ran = true;
+
+    // User effects run without the LVGL lock; native bindings take it per write
+    call_runtime(ctx, "__flushEffects");
+    if (needs_rerender && root_parent) {
+        qjs_rasen_rerender(ctx, root_parent);
+    }
+    call_runtime(ctx, "__flushTicks");
+    run_jobs(ctx);
 }
 
 void qjs_rasen_process_events(JSContext *ctx) {
-    // Execute pending JS jobs
-    JSContext *ctx2;
-    while (JS_ExecutePendingJob(JS_GetRuntime(ctx), &ctx2) > 0) {
-        // Keep processing
+    run_jobs(ctx);
+    drain_events(ctx);
+    
+    // At most one frame per refresh period, right before lv_timer_handler()
+    uint32_t slices = rasen_stats.mount_slices;
+    if ((needs_rerender || frame_requested) && frame_wait_ms() == 0) {
+        run_frame(ctx);
+    }
+    
+    // One mount slice per call, unless a rerender just ran one
+    if (mount_job.active && rasen_stats.mount_slices == slices) {
+        mount_slice(ctx);
+    }
+}
+
+uint32_t qjs_rasen_next_work_ms(JSContext *ctx) {
+    if (JS_IsJobPending(JS_GetRuntime(ctx)) || !event_queue_empty() || rasen_worker_has_messages() ||
+        mount_job.active) {
+        return 0;
     }
+    if (needs_rerender || frame_requested) return frame_wait_ms();
+    return UINT32_MAX;
+}
+
+bool qjs_rasen_has_pending_work(JSContext *ctx) {
+    return qjs_rasen_next_work_ms(ctx) == 0;
+}
+
+// ============ Idle GC ============
+
+#ifndef RASEN_GC_IDLE_BYTES
+#define RASEN_GC_IDLE_BYTES (16 * 1024)  // Heap growth since the last collection
+#endif
+#ifndef RASEN_GC_IDLE_MIN_MS
+#define RASEN_GC_IDLE_MIN_MS 4           // Shorter gaps are left to rendering
+#endif
+
+static size_t gc_baseline = 0;
+
+void qjs_rasen_idle(JSContext *ctx, uint32_t idle_ms) {
+    if (idle_ms < RASEN_GC_IDLE_MIN_MS) return;
     
-    // Check if we need to re-render
-    if (needs_rerender) {
-        // Re-render will be triggered by the main loop
-        needs_rerender = false;
+    // Refcounting already freed the acyclic garbage; this collects cycles
+    // (closures, host objects) before QuickJS's own trigger fires mid-frame
+    size_t used = rasen_alloc_in_use();
+    if (used < gc_baseline + RASEN_GC_IDLE_BYTES) {
+        if (used < gc_baseline) gc_baseline = used;
+        return;
     }
+    
+    uint64_t start = rasen_stats_now_us();
+    JS_RunGC(JS_GetRuntime(ctx));
+    rasen_stats_add_time(RASEN_TIME_GC, start);
+    rasen_stats.gc_runs++;
+    gc_baseline = rasen_alloc_in_use();
 }
@@ -12,23 +12,63 @@
 #include "quickjs.h"
 #include "lvgl.h"
 
+/*
+ * Compile-time feature selection. `rasen-lvgl build` writes
+ * <name>_features.h with the element types (RASEN_USE_*), Tailwind
+ * groups (RASEN_TW_*) and engine parts (RASEN_USE_REGEXP) an app uses;
+ * build with -DRASEN_FEATURES_H='"app_features.h"' to apply it.
+ */
+#ifdef RASEN_FEATURES_H
+#include RASEN_FEATURES_H
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 // ============ Initialization ============
 
+/**
+ * Create a context for the UI or a worker
+ * Same intrinsics as JS_NewContext(), except that RegExp is left out when
+ * RASEN_USE_REGEXP is 0, so the linker can drop the regexp engine. Scripts
+ * must then not use regular expressions.
+ */
+JSContext *qjs_rasen_new_context(JSRuntime *rt);
+
 /**
  * Initialize the Rasen LVGL module in QuickJS
  * Call this after creating the JS runtime and context
  */
 int qjs_rasen_init(JSContext *ctx);
 
+/**
+ * Initialize the Rasen module from a precompiled runtime
+ * Same as qjs_rasen_init() but skips parsing the runtime source.
+ * @param runtime_bc Output of qjs_rasen_compile_runtime(), or NULL to
+ *                   evaluate the built-in source
+ * @param len Size of runtime_bc in bytes
+ */
+int qjs_rasen_init_bytecode(JSContext *ctx, const uint8_t *runtime_bc, size_t len);
+
 /**
  * Cleanup Rasen module
  */
 void qjs_rasen_cleanup(JSContext *ctx);
 
+/**
+ * Set how many removed widgets of a type are kept for reuse
+ * Removed objects are parked (hidden and stripped) up to the cap instead
+ * of being deleted, and new elements of that type take them back before
+ * allocating. Lowering a cap deletes the excess. Defaults come from
+ * RASEN_POOL_CAP (16) or RASEN_POOL_CAP_OBJ / _LABEL / _BTN / _BAR.
+ * @param type Element type ("obj", "label", "btn", "bar"; other types are
+ *             not pooled), NULL for all
+ * @param cap Maximum parked objects, 0 disables pooling
+ * @return 0 on success, -1 for an unknown type
+ */
+int qjs_rasen_set_pool_cap(const char *type, uint32_t cap);
+
 // ============ Rendering ============
 
 /**
@@ -42,20 +82,200 @@ int qjs_rasen_render(JSContext *ctx, const char *script, lv_obj_t *parent);
 
 /**
  * Re-render the UI (called after state changes)
+ * 
+ * The new descriptor tree is diffed against the live LVGL objects by
+ * type, position and optional `key`; only changed text, values, styles
+ * and handlers are patched, so untouched areas are not invalidated.
  * @param ctx QuickJS context  
  * @param parent LVGL parent object
  * @return 0 on success, -1 on error
  */
 int qjs_rasen_rerender(JSContext *ctx, lv_obj_t *parent);
 
+/**
+ * Time-slice first mounts. After this, qjs_rasen_render*() applies at most
+ * max_nodes elements or max_us microseconds of the initial tree (0 lifts
+ * that bound) and qjs_rasen_process_events() adds one more slice per call,
+ * so LVGL draws, reads input and feeds the watchdog in between. Both 0
+ * mounts in one go. Defaults: RASEN_MOUNT_SLICE_NODES, RASEN_MOUNT_SLICE_US.
+ */
+void qjs_rasen_set_mount_slice(uint32_t max_nodes, uint32_t max_us);
+
+/**
+ * Whether a sliced first mount is still being built
+ */
+bool qjs_rasen_is_mounting(void);
+
+/**
+ * Execute a precompiled application and render the UI
+ * The buffer is only read, so it can be const data mapped from flash.
+ * Bytecode must come from the same QuickJS version as the firmware.
+ * @param ctx QuickJS context
+ * @param buf Output of qjs_rasen_compile() (*.qjsbc)
+ * @param len Size of buf in bytes
+ * @param parent LVGL parent object (usually lv_scr_act())
+ * @return 0 on success, -1 on error
+ */
+int qjs_rasen_render_bytecode(JSContext *ctx, const uint8_t *buf, size_t len, lv_obj_t *parent);
+
+// ============ Mapped Loading ============
+
+/**
+ * App image written by `rasen-lvgl build` (*.rasen), usually flashed to
+ * a data partition and mapped with esp_partition_mmap(). All values are
+ * little-endian; offsets are from the start of the image.
+ *
+ * Header (16 bytes): "RSNA", u16 version, u16 section count,
+ *                    u32 total size, u32 flags (RASEN_IMAGE_F_*)
+ * Section table: section count x { u32 type, u32 offset, u32 size }
+ */
+#define RASEN_IMAGE_VERSION     1
+#define RASEN_IMAGE_HEADER_SIZE 16
+
+#define RASEN_IMAGE_F_IMPORTS_DONE 0x01  // Source section has its imports rewritten
+
+typedef enum {
+    RASEN_SECTION_BYTECODE = 1,  // Output of qjs_rasen_compile()
+    RASEN_SECTION_SOURCE = 2,    // JavaScript source, NUL-terminated
+    RASEN_SECTION_STYLES = 3,    // Precompiled style table (*.tws)
+    RASEN_SECTION_IMAGES = 4,    // Pre-converted images (*.rimg, see rasen_img.h)
+} rasen_section_type_t;
+
+/**
+ * Find a section in an app image
+ * @return 0 and the section's bytes in *out / *out_len, -1 if missing
+ */
+int rasen_image_find(const void *image, size_t len, rasen_section_type_t type,
+                     const uint8_t **out, size_t *out_len);
+
+/**
+ * Run a script or app image directly from mapped memory and render the UI
+ * Accepts an app image, raw bytecode, or NUL-terminated source (len
+ * includes the terminator). Nothing is copied up front: bytecode is read
+ * in place and source without import statements (or from an image with
+ * RASEN_IMAGE_F_IMPORTS_DONE) is evaluated in place. The data
+ * must stay mapped while styles from the image are in use.
+ * @param ctx QuickJS context
+ * @param data Mapped file or flash region
+ * @param len Size of data in bytes
+ * @param parent LVGL parent object (usually lv_scr_act())
+ * @return 0 on success, -1 on error
+ */
+int qjs_rasen_render_mapped(JSContext *ctx, const void *data, size_t len, lv_obj_t *parent);
+
+// ============ Bytecode Compilation ============
+
+/**
+ * Compile an application script to QuickJS bytecode
+ * Imports are rewritten the same way qjs_rasen_render() does.
+ * @param ctx QuickJS context (qjs_rasen_init() is not required)
+ * @param script JavaScript source code
+ * @param out_len Size of the returned buffer
+ * @return Bytecode to free with js_free(ctx, ...), NULL on error
+ */
+uint8_t *qjs_rasen_compile(JSContext *ctx, const char *script, size_t *out_len);
+
+/**
+ * Compile the built-in runtime for qjs_rasen_init_bytecode()
+ * @return Bytecode to free with js_free(ctx, ...), NULL on error
+ */
+uint8_t *qjs_rasen_compile_runtime(JSContext *ctx, size_t *out_len);
+
+// ============ Snapshot ============
+
+/**
+ * Serialize the values of the refs registered with persist()
+ * Meant for RTC memory or NVS before deep sleep: only app state is saved
+ * (plain data, as with JS_WriteObject()); the script and runtime come back
+ * from their bytecode.
+ * @param out Receives a buffer to free with js_free(ctx, ...)
+ * @return 0 on success, -1 on error
+ */
+int qjs_rasen_snapshot(JSContext *ctx, uint8_t **out, size_t *out_len);
+
+/**
+ * Hand a snapshot back to the runtime on wake
+ * Call after qjs_rasen_init() and before rendering: persist() then starts
+ * each ref from its saved value and restored() returns true, so the first
+ * mount already shows the state from before sleep.
+ * @return 0 on success, -1 if the buffer is not a snapshot
+ */
+int qjs_rasen_restore(JSContext *ctx, const uint8_t *buf, size_t len);
+
+/**
+ * Take the script's pending deepSleep(ms) request, if any
+ * The platform snapshots, arms its wake sources (a timer when ms > 0)
+ * and powers down.
+ * @return true once per request
+ */
+bool qjs_rasen_take_sleep_request(uint32_t *ms);
+
+/**
+ * Start or stop the trace profiler (see rasen_prof.h) and tell the
+ * runtime, so component mounts are timed too. Stopping hands the trace
+ * to the callback set with rasen_prof_set_dump().
+ * @return 0 on success, -1 if RASEN_PROFILE is off or out of memory
+ */
+int qjs_rasen_profile(JSContext *ctx, bool on);
+
 // ============ Event Handling ============
 
 /**
  * Process pending JavaScript events
- * Call this in the main loop
+ * Call this in the main loop right before lv_timer_handler(). Runs promise
+ * jobs, the event handlers LVGL queued during the last lv_timer_handler()
+ * (in order, up to RASEN_EVENT_BUDGET_US; later ones wait for the next
+ * call), and at most once per RASEN_FRAME_PERIOD_MS (default
+ * LV_DISP_DEF_REFR_PERIOD) a frame: queued ref effects, one rerender for
+ * all handlers and requestRender() calls since the last frame, then
+ * nextTick callbacks.
  */
 void qjs_rasen_process_events(JSContext *ctx);
 
+/**
+ * Time until qjs_rasen_process_events() has work to do
+ * @return 0 if work is due now, UINT32_MAX if nothing is scheduled
+ */
+uint32_t qjs_rasen_next_work_ms(JSContext *ctx);
+
+/**
+ * Check whether JavaScript work is due now (promise jobs or a frame)
+ * Main loops should not sleep while this returns true.
+ */
+bool qjs_rasen_has_pending_work(JSContext *ctx);
+
+/**
+ * Tell the runtime the main loop is about to sleep for idle_ms
+ * Runs JS_RunGC() when the gap is long enough and the pooled JS heap
+ * (rasen_alloc.h) grew by RASEN_GC_IDLE_BYTES since the last collection,
+ * so cycle collection happens between frames rather than inside one.
+ */
+void qjs_rasen_idle(JSContext *ctx, uint32_t idle_ms);
+
+// ============ Threading ============
+
+/**
+ * Hooks for running JavaScript and LVGL on separate tasks (e.g. one per
+ * core). The JS task calls every qjs_rasen_* function; the LVGL task only
+ * runs lv_timer_handler() while holding the same lock. Rasen takes the
+ * lock just for the native patch, bound property updates and list row
+ * rendering, so handlers and describe/encode run in parallel with
+ * rendering. Events cross from the LVGL task through a lock-free
+ * single-producer/single-consumer queue.
+ */
+typedef struct {
+    void (*lock)(void);         // Recursive LVGL lock
+    void (*unlock)(void);
+    void (*wake_js)(void);      // LVGL task: an event was queued for the JS task
+    void (*wake_lvgl)(void);    // JS task: the tree may have changed
+} qjs_rasen_threading_t;
+
+/**
+ * Install threading hooks before the first render; NULL restores
+ * single-task operation
+ */
+void qjs_rasen_set_threading(const qjs_rasen_threading_t *hooks);
+
 // ============ Tailwind Parser ============
 
 /**
@@ -112,6 +332,91 @@ void tw_parse(const char *class_str, tw_styles_t *styles);
  */
 void tw_apply(lv_obj_t *obj, const tw_styles_t *styles);
 
+// ============ Shared Style Cache ============
+
+/**
+ * Interned style for one class string. Every object with the same class
+ * string shares the entry's lv_style_t via lv_obj_add_style(), so the
+ * string is parsed once and its properties are stored once.
+ */
+typedef struct tw_style {
+    lv_style_t style;
+    uint32_t hash;
+    uint32_t refcount;
+    uint16_t id;        // Precompiled style id, 0 for parsed class strings
+    struct tw_style *next;
+    char class_str[];
+} tw_style_t;
+
+/**
+ * Look up (or parse and build) the shared style for a class string
+ * @param class_str Space-separated Tailwind classes
+ * @return Entry with its refcount incremented, NULL for an empty string
+ */
+tw_style_t *tw_style_acquire(const char *class_str);
+
+/**
+ * Drop one reference taken by tw_style_acquire()
+ * The entry stays cached until tw_style_cache_trim().
+ */
+void tw_style_release(tw_style_t *style);
+
+/**
+ * Free cached styles that are no longer referenced
+ * Only call once no deleted object can still point at them
+ * (e.g. after a render pass has finished).
+ */
+void tw_style_cache_trim(void);
+
+// ============ Precompiled Styles ============
+
+/**
+ * Style table written by `rasen-lvgl build` (*.tws). Static class strings
+ * in the bundle are replaced by 1-based ids into this table, so the device
+ * never parses them. All values are little-endian.
+ *
+ * Header (8 bytes): "RTWS", u8 version, u8 record size, u16 record count
+ *
+ * Record (TW_RECORD_SIZE bytes), one per id:
+ *   0  u8  flags (TW_REC_*)
+ *   1  u8  flex flow: 0 row, 1 column, 2 row wrap, 3 column wrap
+ *   2  u8  justify: 0 start, 1 end, 2 center, 3 between, 4 around, 5 evenly
+ *   3  u8  align items: 0 start, 1 end, 2 center
+ *   4  u8  bg opacity
+ *   5  u8  font size in px, 0 for none
+ *   6  u8  width unit: 0 px, 1 percent, 2 content
+ *   7  u8  height unit
+ *   8  i16 width, height, pad top/bottom/left/right/row/column,
+ *          border width, radius (0x7fff = circle)
+ *   28 u8  bg rgb[3], border rgb[3], text rgb[3]
+ */
+#define TW_TABLE_VERSION 1
+#define TW_HEADER_SIZE   8
+#define TW_RECORD_SIZE   40
+
+#define TW_REC_FLEX         0x01
+#define TW_REC_BG_COLOR     0x02
+#define TW_REC_BORDER_COLOR 0x04
+#define TW_REC_TEXT_COLOR   0x08
+
+/**
+ * Register a precompiled style table
+ * The data is used in place and must stay valid while styles are in use
+ * (e.g. a file kept in memory or a flash mapping). Call before the first
+ * render. One table per run: objects keep the styles built from it and
+ * match them by id, so loading the same data again succeeds and another
+ * table fails.
+ * @return 0 on success, -1 if the table is malformed or another is loaded
+ */
+int tw_style_table_load(const uint8_t *data, size_t len);
+
+/**
+ * Shared style for a precompiled id, built from its record on first use
+ * @return Entry with its refcount incremented, NULL for an unknown id or
+ *         when no table is loaded (logged the first time)
+ */
+tw_style_t *tw_style_acquire_compiled(uint32_t id);
+
 #ifdef __cplusplus
 }
 #endif
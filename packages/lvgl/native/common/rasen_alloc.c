@@ -0,0 +1,260 @@
+/**
+ * @file rasen_alloc.c
+ * @brief Size-class allocator for the UI QuickJS runtime
+ */
+
+#include "rasen_alloc.h"
+#include "rasen_stats.h"
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(ESP_PLATFORM)
+#include "esp_heap_caps.h"
+#endif
+
+// ============ System Memory ============
+
+static void *sys_malloc(size_t size) {
+#if defined(ESP_PLATFORM) && RASEN_ALLOC_PSRAM
+    return heap_caps_malloc_prefer(size, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, MALLOC_CAP_8BIT);
+#else
+    return malloc(size);
+#endif
+}
+
+static void *sys_realloc(void *ptr, size_t size) {
+#if defined(ESP_PLATFORM) && RASEN_ALLOC_PSRAM
+    return heap_caps_realloc_prefer(ptr, size, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, MALLOC_CAP_8BIT);
+#else
+    return realloc(ptr, size);
+#endif
+}
+
+static void sys_free(void *ptr) {
+    free(ptr);
+}
+
+// ============ Blocks ============
+
+/**
+ * Every block starts with its payload size. Blocks not carved from a
+ * chunk (large ones, or small ones once the pool is full) carry
+ * BLOCK_SYSTEM and go straight back to the system heap when freed.
+ */
+typedef union {
+    size_t size;
+    max_align_t align;
+} block_header_t;
+
+#define BLOCK_SYSTEM ((size_t)1 << (sizeof(size_t) * 8 - 1))
+
+// Multiples of 16 keep every carved payload aligned like malloc's
+static const uint16_t class_sizes[] = { 16, 32, 48, 64, 96, 128, 192, 256 };
+#define CLASS_COUNT (sizeof(class_sizes) / sizeof(class_sizes[0]))
+
+_Static_assert(RASEN_ALLOC_SMALL_MAX <= 256, "RASEN_ALLOC_SMALL_MAX exceeds the largest size class");
+
+typedef struct free_block {
+    struct free_block *next;
+} free_block_t;
+
+typedef struct alloc_chunk {
+    struct alloc_chunk *next;
+    block_header_t data[];
+} alloc_chunk_t;
+
+static struct {
+    free_block_t *free[CLASS_COUNT];  // Payload pointers of recycled blocks
+    alloc_chunk_t *chunks;
+    uint8_t *carve;                   // Unused tail of the newest chunk
+    uint8_t *carve_end;
+    size_t chunk_bytes;
+    size_t in_use;
+    uint32_t allocs;
+    uint32_t frame_start;
+    bool active;
+} arena;
+
+static int size_class(size_t size) {
+    if (size > RASEN_ALLOC_SMALL_MAX) return -1;
+    for (unsigned i = 0; i < CLASS_COUNT; i++) {
+        if (size <= class_sizes[i]) return (int)i;
+    }
+    return -1;
+}
+
+static inline block_header_t *header_of(void *ptr) {
+    return (block_header_t *)ptr - 1;
+}
+
+static inline size_t payload_size(const void *ptr) {
+    return ((const block_header_t *)ptr - 1)->size & ~BLOCK_SYSTEM;
+}
+
+// Split what is left of the current chunk into free blocks, largest first
+static void recycle_tail(void) {
+    for (int cls = CLASS_COUNT - 1; cls >= 0; cls--) {
+        size_t block = sizeof(block_header_t) + class_sizes[cls];
+        while ((size_t)(arena.carve_end - arena.carve) >= block) {
+            block_header_t *h = (block_header_t *)arena.carve;
+            h->size = class_sizes[cls];
+            free_block_t *fb = (free_block_t *)(h + 1);
+            fb->next = arena.free[cls];
+            arena.free[cls] = fb;
+            arena.carve += block;
+        }
+    }
+}
+
+// Cut a block of the given class from the current chunk, opening a new
+// chunk when it runs out and the pool cap allows
+static void *carve_block(int cls) {
+    size_t block = sizeof(block_header_t) + class_sizes[cls];
+
+    if ((size_t)(arena.carve_end - arena.carve) < block) {
+        size_t chunk = sizeof(alloc_chunk_t) + RASEN_ALLOC_CHUNK;
+        if (arena.chunk_bytes + chunk > RASEN_ALLOC_POOL_MAX) return NULL;
+        alloc_chunk_t *c = sys_malloc(chunk);
+        if (!c) return NULL;
+
+        recycle_tail();
+        c->next = arena.chunks;
+        arena.chunks = c;
+        arena.chunk_bytes += chunk;
+        arena.carve = (uint8_t *)c->data;
+        arena.carve_end = arena.carve + RASEN_ALLOC_CHUNK;
+    }
+
+    block_header_t *h = (block_header_t *)arena.carve;
+    arena.carve += block;
+    h->size = class_sizes[cls];
+    return h + 1;
+}
+
+// ============ JSMallocFunctions ============
+
+static void *js_pool_malloc(void *opaque, size_t size) {
+    (void)opaque;
+    int cls = size_class(size);
+    void *ptr = NULL;
+
+    if (cls >= 0) {
+        if (arena.free[cls]) {
+            free_block_t *fb = arena.free[cls];
+            arena.free[cls] = fb->next;
+            ptr = fb;
+        } else {
+            ptr = carve_block(cls);
+        }
+    }
+
+    if (ptr) {
+        rasen_stats.js_allocs_pooled++;
+    } else {
+        // Large block, or the pool is full
+        size_t payload = cls >= 0 ? class_sizes[cls] : size;
+        block_header_t *h = sys_malloc(sizeof(block_header_t) + payload);
+        if (!h) return NULL;
+        h->size = payload | BLOCK_SYSTEM;
+        ptr = h + 1;
+        rasen_stats.js_allocs_system++;
+    }
+
+    arena.in_use += payload_size(ptr);
+    arena.allocs++;
+    return ptr;
+}
+
+static void js_pool_free(void *opaque, void *ptr) {
+    (void)opaque;
+    if (!ptr) return;
+
+    block_header_t *h = header_of(ptr);
+    arena.in_use -= payload_size(ptr);
+    if (h->size & BLOCK_SYSTEM) {
+        sys_free(h);
+        return;
+    }
+
+    int cls = size_class(h->size);
+    free_block_t *fb = ptr;
+    fb->next = arena.free[cls];
+    arena.free[cls] = fb;
+}
+
+static void *js_pool_calloc(void *opaque, size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) return NULL;
+    void *ptr = js_pool_malloc(opaque, count * size);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+static void *js_pool_realloc(void *opaque, void *ptr, size_t size) {
+    if (!ptr) return js_pool_malloc(opaque, size);
+    if (size == 0) {
+        js_pool_free(opaque, ptr);
+        return NULL;
+    }
+
+    block_header_t *h = header_of(ptr);
+    size_t old = payload_size(ptr);
+
+    // Large system blocks stay large; let the system heap resize in place
+    if ((h->size & BLOCK_SYSTEM) && size > RASEN_ALLOC_SMALL_MAX && old > RASEN_ALLOC_SMALL_MAX) {
+        block_header_t *nh = sys_realloc(h, sizeof(block_header_t) + size);
+        if (!nh) return NULL;
+        nh->size = size | BLOCK_SYSTEM;
+        arena.in_use += size - old;
+        return nh + 1;
+    }
+
+    // Same size class: nothing to move
+    int cls = size_class(size);
+    if (cls >= 0 && class_sizes[cls] == old) return ptr;
+
+    void *moved = js_pool_malloc(opaque, size);
+    if (!moved) return NULL;
+    memcpy(moved, ptr, old < size ? old : size);
+    js_pool_free(opaque, ptr);
+    return moved;
+}
+
+static size_t js_pool_usable_size(const void *ptr) {
+    return ptr ? payload_size(ptr) : 0;
+}
+
+static const JSMallocFunctions pool_malloc_funcs = {
+    .js_calloc = js_pool_calloc,
+    .js_malloc = js_pool_malloc,
+    .js_free = js_pool_free,
+    .js_realloc = js_pool_realloc,
+    .js_malloc_usable_size = js_pool_usable_size,
+};
+
+// ============ Public API ============
+
+JSRuntime *rasen_alloc_new_runtime(void) {
+    if (arena.active) return NULL;
+    JSRuntime *rt = JS_NewRuntime2(&pool_malloc_funcs, NULL);
+    arena.active = rt != NULL;
+    return rt;
+}
+
+void rasen_alloc_reset(void) {
+    while (arena.chunks) {
+        alloc_chunk_t *c = arena.chunks;
+        arena.chunks = c->next;
+        sys_free(c);
+    }
+    memset(&arena, 0, sizeof(arena));
+}
+
+void rasen_alloc_mark_frame(void) {
+    rasen_stats.js_frame_allocs = arena.allocs - arena.frame_start;
+    arena.frame_start = arena.allocs;
+}
+
+size_t rasen_alloc_in_use(void) {
+    return arena.in_use;
+}
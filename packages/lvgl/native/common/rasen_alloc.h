@@ -0,0 +1,61 @@
+/**
+ * @file rasen_alloc.h
+ * @brief Size-class allocator for the UI QuickJS runtime
+ *
+ * Renders churn through thousands of small, short-lived JS objects
+ * (descriptors, children arrays, host closures). Blocks up to
+ * RASEN_ALLOC_SMALL_MAX bytes are carved from fixed chunks and recycled
+ * through per-size free lists, so they never reach the system heap and
+ * can't fragment it; larger blocks go to malloc (PSRAM first on ESP32 when
+ * RASEN_ALLOC_PSRAM is set).
+ *
+ * There is one allocator, for the runtime that owns the UI. Worker
+ * runtimes keep the default QuickJS allocator.
+ */
+
+#ifndef RASEN_ALLOC_H
+#define RASEN_ALLOC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "quickjs.h"
+
+#ifndef RASEN_ALLOC_SMALL_MAX
+#define RASEN_ALLOC_SMALL_MAX 256           // Largest pooled block (payload bytes)
+#endif
+
+#ifndef RASEN_ALLOC_CHUNK
+#define RASEN_ALLOC_CHUNK 4096              // Bytes per chunk carved into blocks
+#endif
+
+#ifndef RASEN_ALLOC_POOL_MAX
+#define RASEN_ALLOC_POOL_MAX (128 * 1024)   // Chunk memory cap; beyond it small blocks use malloc
+#endif
+
+#ifndef RASEN_ALLOC_PSRAM
+#define RASEN_ALLOC_PSRAM 0                 // ESP32: put chunks and large blocks in PSRAM
+#endif
+
+/**
+ * JS_NewRuntime() backed by the pooled allocator
+ * Only one such runtime may exist at a time.
+ */
+JSRuntime *rasen_alloc_new_runtime(void);
+
+/**
+ * Return chunk memory to the system; call after JS_FreeRuntime()
+ */
+void rasen_alloc_reset(void);
+
+/**
+ * Mark a render boundary: the allocations since the previous mark become
+ * rasen_stats.js_frame_allocs
+ */
+void rasen_alloc_mark_frame(void);
+
+/**
+ * Payload bytes currently allocated by the runtime (cheap, no heap walk)
+ */
+size_t rasen_alloc_in_use(void);
+
+#endif // RASEN_ALLOC_H
@@ -0,0 +1,268 @@
+/**
+ * @file rasen_img.c
+ * @brief Pre-converted images and the decoded-image cache
+ */
+
+#include "rasen_img.h"
+#include "rasen_stats.h"
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============ Table ============
+
+typedef struct {
+    lv_img_dsc_t dsc;       // Handed to lv_img; first, so a source casts back
+    const char *name;
+    uint8_t cf;             // Pixel format after decoding
+    uint8_t encoding;       // RASEN_IMG_RAW / RASEN_IMG_RLE
+    uint16_t opens;         // Decoder sessions currently using `decoded`
+    uint32_t last_use;
+    uint8_t *decoded;       // RLE entries: cached pixels, NULL when evicted
+} img_entry_t;
+
+static struct {
+    const uint8_t *data;    // The loaded table
+    img_entry_t *entries;   // Sorted by name (the build writes them that way)
+    uint16_t count;
+    size_t bytes;           // Decoded bytes held by the cache
+    size_t budget;
+    uint32_t clock;
+    lv_img_decoder_t *decoder;
+} table = { .budget = RASEN_IMG_CACHE_BUDGET };
+
+#if LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP
+#define NATIVE_FLAGS RASEN_IMG_F_SWAP
+#else
+#define NATIVE_FLAGS 0
+#endif
+
+static uint32_t read_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static size_t pixel_size(uint8_t cf) {
+    return cf == LV_IMG_CF_TRUE_COLOR_ALPHA ? LV_IMG_PX_SIZE_ALPHA_BYTE : LV_COLOR_SIZE / 8;
+}
+
+static size_t decoded_size(const img_entry_t *e) {
+    return (size_t)e->dsc.header.w * e->dsc.header.h * pixel_size(e->cf);
+}
+
+// Our entries only; any other source (paths, symbols, app descriptors) is LVGL's
+static img_entry_t *entry_of(const void *src) {
+    uintptr_t p = (uintptr_t)src, base = (uintptr_t)table.entries;
+    if (!table.entries || p < base || p >= base + table.count * sizeof(img_entry_t)) return NULL;
+    if ((p - base) % sizeof(img_entry_t) != 0) return NULL;
+    return (img_entry_t *)src;
+}
+
+// ============ Cache ============
+
+static void cache_evict(img_entry_t *e) {
+    table.bytes -= decoded_size(e);
+    free(e->decoded);
+    e->decoded = NULL;
+    rasen_stats.img_cache_bytes = table.bytes;
+}
+
+// Evict least recently used buffers nobody is drawing until `need` more bytes fit
+static void cache_make_room(size_t need) {
+    while (table.bytes + need > table.budget) {
+        img_entry_t *lru = NULL;
+        for (uint16_t i = 0; i < table.count; i++) {
+            img_entry_t *e = &table.entries[i];
+            if (e->decoded && e->opens == 0 && (!lru || e->last_use < lru->last_use)) lru = e;
+        }
+        if (!lru) return;
+        cache_evict(lru);
+    }
+}
+
+static bool rle_decode(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len, size_t px) {
+    const uint8_t *end = in + in_len;
+    size_t o = 0;
+
+    while (o < out_len) {
+        if (in >= end) return false;
+        uint8_t c = *in++;
+        size_t bytes = ((size_t)(c & 0x7f) + 1) * px;
+        if (bytes > out_len - o) return false;
+
+        if (c & 0x80) {
+            if ((size_t)(end - in) < px) return false;
+            for (size_t i = 0; i < bytes; i += px) memcpy(out + o + i, in, px);
+            in += px;
+        } else {
+            if ((size_t)(end - in) < bytes) return false;
+            memcpy(out + o, in, bytes);
+            in += bytes;
+        }
+        o += bytes;
+    }
+    return true;
+}
+
+// ============ LVGL Decoder ============
+
+static lv_res_t rle_info(lv_img_decoder_t *decoder, const void *src, lv_img_header_t *header) {
+    (void)decoder;
+    const img_entry_t *e = entry_of(src);
+    if (!e || e->encoding != RASEN_IMG_RLE) return LV_RES_INV;
+
+    *header = e->dsc.header;
+    header->cf = e->cf;
+    return LV_RES_OK;
+}
+
+static lv_res_t rle_open(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+    (void)decoder;
+    img_entry_t *e = entry_of(dsc->src);
+    if (!e || e->encoding != RASEN_IMG_RLE) return LV_RES_INV;
+
+    if (e->decoded) {
+        rasen_stats.img_cache_hits++;
+    } else {
+        rasen_stats.img_cache_misses++;
+        size_t size = decoded_size(e);
+        cache_make_room(size);
+        e->decoded = malloc(size);
+        if (!e->decoded) {
+            printf("Image %s: out of memory (%u bytes)\n", e->name, (unsigned)size);
+            return LV_RES_INV;
+        }
+        if (!rle_decode(e->dsc.data, e->dsc.data_size, e->decoded, size, pixel_size(e->cf))) {
+            printf("Image %s: corrupt RLE data\n", e->name);
+            free(e->decoded);
+            e->decoded = NULL;
+            return LV_RES_INV;
+        }
+        table.bytes += size;
+        rasen_stats.img_cache_bytes = table.bytes;
+    }
+
+    e->opens++;
+    e->last_use = ++table.clock;
+    dsc->img_data = e->decoded;
+    return LV_RES_OK;
+}
+
+static void rle_close(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+    (void)decoder;
+    img_entry_t *e = entry_of(dsc->src);
+    if (!e || e->opens == 0) return;
+
+    e->opens--;
+    if (table.bytes > table.budget) cache_make_room(0);
+}
+
+// ============ Public API ============
+
+int rasen_img_table_load(const uint8_t *data, size_t len) {
+    // Live lv_img objects and cached buffers point into the entries
+    if (table.entries) {
+        if (data == table.data) return 0;
+        printf("Image table: one is already loaded\n");
+        return -1;
+    }
+    if (!data || len < RASEN_IMG_HEADER_SIZE || memcmp(data, "RIMG", 4) != 0) {
+        printf("Image table: bad header\n");
+        return -1;
+    }
+    if (data[4] != RASEN_IMG_VERSION) {
+        printf("Image table: unsupported version %d\n", data[4]);
+        return -1;
+    }
+    if (data[5] != LV_COLOR_DEPTH || (data[6] & RASEN_IMG_F_SWAP) != NATIVE_FLAGS) {
+        printf("Image table: built for %d-bit%s color, display is %d-bit%s\n",
+               data[5], (data[6] & RASEN_IMG_F_SWAP) ? " swapped" : "",
+               LV_COLOR_DEPTH, NATIVE_FLAGS ? " swapped" : "");
+        return -1;
+    }
+
+    uint16_t count = read_u16(data + 8);
+    if (len < RASEN_IMG_HEADER_SIZE + (size_t)count * RASEN_IMG_ENTRY_SIZE) {
+        printf("Image table: truncated\n");
+        return -1;
+    }
+
+    img_entry_t *entries = calloc(count ? count : 1, sizeof(img_entry_t));
+    if (!entries) return -1;
+
+    bool rle = false;
+    for (uint16_t i = 0; i < count; i++) {
+        const uint8_t *rec = data + RASEN_IMG_HEADER_SIZE + (size_t)i * RASEN_IMG_ENTRY_SIZE;
+        uint32_t name = read_u32(rec), offset = read_u32(rec + 4), size = read_u32(rec + 8);
+        uint16_t w = read_u16(rec + 12), h = read_u16(rec + 14);
+        img_entry_t *e = &entries[i];
+
+        e->cf = rec[16];
+        e->encoding = rec[17];
+        bool ok = name < len && memchr(data + name, '\0', len - name) &&
+                  offset <= len && size <= len - offset &&
+                  w > 0 && h > 0 && w < 2048 && h < 2048 &&
+                  (e->cf == LV_IMG_CF_TRUE_COLOR || e->cf == LV_IMG_CF_TRUE_COLOR_ALPHA) &&
+                  e->encoding <= RASEN_IMG_RLE;
+        e->dsc.header.w = w;
+        e->dsc.header.h = h;
+        if (ok && e->encoding == RASEN_IMG_RAW && size != decoded_size(e)) ok = false;
+        if (!ok) {
+            printf("Image table: bad entry %u\n", (unsigned)i);
+            free(entries);
+            return -1;
+        }
+
+        e->name = (const char *)data + name;
+        e->dsc.header.cf = e->encoding == RASEN_IMG_RLE ? LV_IMG_CF_USER_ENCODED_0 : e->cf;
+        e->dsc.data = data + offset;
+        e->dsc.data_size = size;
+        rle = rle || e->encoding == RASEN_IMG_RLE;
+    }
+
+    table.data = data;
+    table.entries = entries;
+    table.count = count;
+
+    if (rle && !table.decoder) {
+        table.decoder = lv_img_decoder_create();
+        if (table.decoder) {
+            lv_img_decoder_set_info_cb(table.decoder, rle_info);
+            lv_img_decoder_set_open_cb(table.decoder, rle_open);
+            lv_img_decoder_set_close_cb(table.decoder, rle_close);
+        }
+    }
+    return 0;
+}
+
+const void *rasen_img_lookup(const char *name) {
+    size_t lo = 0, hi = table.count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int cmp = strcmp(name, table.entries[mid].name);
+        if (cmp == 0) return &table.entries[mid].dsc;
+        if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+void rasen_img_set_cache_budget(size_t bytes) {
+    table.budget = bytes;
+    cache_make_room(0);
+}
+
+void rasen_img_cache_flush(void) {
+    for (uint16_t i = 0; i < table.count; i++) {
+        img_entry_t *e = &table.entries[i];
+        if (e->decoded && e->opens == 0) cache_evict(e);
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ * @file rasen_img.h
+ * @brief Pre-converted images and the decoded-image cache
+ *
+ * `rasen-lvgl build` converts the PNGs an app uses into the display's
+ * native pixel format and packs them into an image table (an app image
+ * section, or *.rimg next to the script). Raw entries are handed to
+ * lv_img as lv_img_dsc_t pointing straight into the mapped table, so
+ * they are never decoded or copied. RLE-compressed entries go through a
+ * small LVGL decoder that expands them once into a cache of decoded
+ * buffers, evicted least-recently-used against a byte budget.
+ *
+ * Table layout (little-endian, offsets from the start of the table):
+ *
+ * Header (16 bytes): "RIMG", u8 version, u8 color depth (16 or 32),
+ *                    u8 flags (RASEN_IMG_F_*), u8 reserved,
+ *                    u16 entry count, u16 reserved, u32 reserved
+ * Entry (RASEN_IMG_ENTRY_SIZE bytes):
+ *   0  u32 name offset (NUL-terminated, e.g. "assets/wifi.png")
+ *   4  u32 data offset (4-byte aligned)
+ *   8  u32 data size
+ *   12 u16 width, u16 height
+ *   16 u8  lv_img_cf_t of the decoded pixels
+ *   17 u8  encoding: 0 raw, 1 RLE
+ *   18 u16 reserved
+ *
+ * RLE packets work on whole pixels: a control byte c followed by one
+ * pixel repeated (c & 0x7f) + 1 times when c & 0x80, otherwise by c + 1
+ * literal pixels.
+ */
+
+#ifndef RASEN_IMG_H
+#define RASEN_IMG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RASEN_IMG_VERSION     1
+#define RASEN_IMG_HEADER_SIZE 16
+#define RASEN_IMG_ENTRY_SIZE  20
+
+#define RASEN_IMG_F_SWAP 0x01  // 16-bit pixels byte-swapped (LV_COLOR_16_SWAP)
+
+#define RASEN_IMG_RAW 0
+#define RASEN_IMG_RLE 1
+
+#ifndef RASEN_IMG_CACHE_BUDGET
+#define RASEN_IMG_CACHE_BUDGET (64 * 1024)  // Bytes of decoded RLE images kept around
+#endif
+
+/**
+ * Use an image table; entries are looked up by name from then on
+ * One table per run: lv_img sources and cached buffers point into it, so
+ * it is kept (and its data must stay mapped) until the program ends.
+ * Loading the same data again succeeds, another table fails. Also fails
+ * when the table was built for a different color format than lv_conf.h.
+ * @return 0 on success, -1 on error
+ */
+int rasen_img_table_load(const uint8_t *data, size_t len);
+
+/**
+ * lv_img source for a name in the loaded table, NULL if it isn't there
+ */
+const void *rasen_img_lookup(const char *name);
+
+/**
+ * Byte budget of the decoded-image cache; buffers still in use by LVGL
+ * are kept even when they exceed it. 0 frees each buffer on close.
+ */
+void rasen_img_set_cache_budget(size_t bytes);
+
+/**
+ * Drop every decoded buffer LVGL isn't using
+ */
+void rasen_img_cache_flush(void);
+
+#endif // RASEN_IMG_H
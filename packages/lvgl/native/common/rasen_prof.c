@@ -0,0 +1,262 @@
+/**
+ * @file rasen_prof.c
+ * @brief Trace profiler for the Rasen LVGL runtime
+ */
+
+#include "rasen_prof.h"
+#include "rasen_stats.h"
+#include "lvgl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "freertos/FreeRTOS.h"
+// Dual-core mode records from the JS task and the LVGL task at once
+static portMUX_TYPE prof_lock = portMUX_INITIALIZER_UNLOCKED;
+#define PROF_LOCK() portENTER_CRITICAL(&prof_lock)
+#define PROF_UNLOCK() portEXIT_CRITICAL(&prof_lock)
+#else
+// Elsewhere everything that records runs on the UI thread
+#define PROF_LOCK() ((void)0)
+#define PROF_UNLOCK() ((void)0)
+#endif
+
+volatile bool rasen_prof_active = false;
+
+// ============ Recording ============
+
+typedef struct {
+    uint64_t start;
+    uint64_t dur;
+    const char *name;
+    uint8_t kind;
+} prof_event_t;
+
+static struct {
+    prof_event_t *events;
+    uint32_t capacity;
+    uint32_t next;          // Ring position of the next event
+    uint32_t written;       // Events recorded since start; more than capacity wrapped
+    uint64_t origin;        // Tick count at start, time 0 in the trace
+    rasen_prof_clock_t now;
+    uint64_t ticks_per_sec;
+    void (*dump)(void);
+} prof = { .now = rasen_stats_now_us, .ticks_per_sec = 1000000 };
+
+void rasen_prof_set_clock(rasen_prof_clock_t now, uint64_t ticks_per_sec) {
+    if (rasen_prof_active || !now || !ticks_per_sec) return;
+    prof.now = now;
+    prof.ticks_per_sec = ticks_per_sec;
+}
+
+void rasen_prof_set_dump(void (*dump)(void)) {
+    prof.dump = dump;
+}
+
+uint64_t rasen_prof_now(void) {
+    return prof.now();
+}
+
+void rasen_prof_record(rasen_prof_kind_t kind, const char *name, uint64_t start) {
+    uint64_t end = prof.now();
+    PROF_LOCK();
+    if (rasen_prof_active) {
+        prof_event_t *e = &prof.events[prof.next];
+        e->start = start;
+        e->dur = end > start ? end - start : 0;
+        e->name = name ? name : "";
+        e->kind = (uint8_t)kind;
+        prof.next = prof.next + 1 == prof.capacity ? 0 : prof.next + 1;
+        prof.written++;
+    }
+    PROF_UNLOCK();
+}
+
+// ============ Names ============
+// JS names (component and handler names) are copied once and kept until
+// the next start, so events can point at them
+
+#define PROF_NAME_SLOTS 512  // Power of two; open addressing
+
+static char *names[PROF_NAME_SLOTS];
+static uint32_t name_count = 0;
+
+#if RASEN_PROFILE
+static void names_clear(void) {
+    for (int i = 0; i < PROF_NAME_SLOTS; i++) {
+        free(names[i]);
+        names[i] = NULL;
+    }
+    name_count = 0;
+}
+#endif
+
+const char *rasen_prof_intern(const char *name) {
+    uint32_t h = 2166136261u;
+    for (const char *p = name; *p; p++) h = (h ^ (uint8_t)*p) * 16777619u;
+
+    for (uint32_t i = 0; i < PROF_NAME_SLOTS; i++) {
+        uint32_t slot = (h + i) & (PROF_NAME_SLOTS - 1);
+        if (!names[slot]) {
+            // Keep the table at most three quarters full
+            if (name_count >= PROF_NAME_SLOTS * 3 / 4) return NULL;
+            size_t len = strlen(name);
+            names[slot] = malloc(len + 1);
+            if (!names[slot]) return NULL;
+            memcpy(names[slot], name, len + 1);
+            name_count++;
+            return names[slot];
+        }
+        if (strcmp(names[slot], name) == 0) return names[slot];
+    }
+    return NULL;
+}
+
+// ============ Control ============
+
+int rasen_prof_start(uint32_t events) {
+#if RASEN_PROFILE
+    if (events == 0) events = RASEN_PROF_EVENTS;
+    PROF_LOCK();
+    rasen_prof_active = false;
+    PROF_UNLOCK();
+
+    if (!prof.events || prof.capacity != events) {
+        free(prof.events);
+        prof.events = malloc((size_t)events * sizeof(prof_event_t));
+        prof.capacity = prof.events ? events : 0;
+        if (!prof.events) {
+            printf("Profiler: out of memory for %u events\n", (unsigned)events);
+            return -1;
+        }
+    }
+    names_clear();
+    prof.next = 0;
+    prof.written = 0;
+    prof.origin = prof.now();
+    rasen_prof_active = true;
+    return 0;
+#else
+    (void)events;
+    printf("Profiler: not compiled in (RASEN_PROFILE=0)\n");
+    return -1;
+#endif
+}
+
+void rasen_prof_stop(void) {
+    if (!rasen_prof_active) return;
+    PROF_LOCK();
+    rasen_prof_active = false;
+    PROF_UNLOCK();
+    if (prof.dump) prof.dump();
+}
+
+// ============ Trace Output ============
+
+// Chrome trace event per kind; the name goes into args.data.<arg>. Script
+// work is on one track and LVGL's on another, so each nests on its own
+// (they overlap in dual-core mode).
+static const struct {
+    const char *event;
+    const char *arg;
+    uint8_t tid;
+} kinds[RASEN_PROF_KIND_COUNT] = {
+    [RASEN_PROF_TASK]      = { "RunTask",           NULL,           2 },
+    [RASEN_PROF_EVAL]      = { "EvaluateScript",    "url",          1 },
+    [RASEN_PROF_CALL]      = { "FunctionCall",      "functionName", 1 },
+    [RASEN_PROF_RECONCILE] = { "Reconcile",         NULL,           1 },
+    [RASEN_PROF_CREATE]    = { "CreateElement",     "type",         1 },
+    [RASEN_PROF_STYLE]     = { "RecalculateStyles", NULL,           1 },
+    [RASEN_PROF_LAYOUT]    = { "Layout",            NULL,           2 },
+    [RASEN_PROF_RENDER]    = { "Paint",             NULL,           2 },
+    [RASEN_PROF_FLUSH]     = { "Flush",             NULL,           2 },
+};
+
+// Copy s into out as a JSON string body, cut to fit
+static void json_escape(char *out, size_t size, const char *s) {
+    size_t o = 0;
+    for (; *s && o + 7 < size; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            out[o++] = '\\';
+            out[o++] = (char)c;
+        } else if (c < 0x20) {
+            o += (size_t)snprintf(out + o, size - o, "\\u%04x", c);
+        } else {
+            out[o++] = (char)c;
+        }
+    }
+    out[o] = '\0';
+}
+
+static double ticks_to_us(uint64_t ticks) {
+    return (double)ticks * 1e6 / (double)prof.ticks_per_sec;
+}
+
+void rasen_prof_write(rasen_prof_write_t write, void *user) {
+    char line[320];
+    char name[128];
+    int n;
+
+    n = snprintf(line, sizeof(line),
+                 "{\"traceEvents\":[\n"
+                 "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Rasen\"}},\n"
+                 "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"JS\"}},\n"
+                 "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"LVGL\"}}");
+    write(line, (size_t)n, user);
+
+    uint32_t count = prof.written < prof.capacity ? prof.written : prof.capacity;
+    uint32_t first = prof.written < prof.capacity ? 0 : prof.next;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const prof_event_t *e = &prof.events[(first + i) % prof.capacity];
+        if (e->kind >= RASEN_PROF_KIND_COUNT || e->start < prof.origin) continue;
+
+        n = snprintf(line, sizeof(line),
+                     ",\n{\"name\":\"%s\",\"cat\":\"rasen\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                     "\"ts\":%.3f,\"dur\":%.3f",
+                     kinds[e->kind].event, (unsigned)kinds[e->kind].tid,
+                     ticks_to_us(e->start - prof.origin), ticks_to_us(e->dur));
+        if (kinds[e->kind].arg && e->name[0] && n > 0 && (size_t)n < sizeof(line)) {
+            json_escape(name, sizeof(name), e->name);
+            n += snprintf(line + n, sizeof(line) - (size_t)n,
+                          ",\"args\":{\"data\":{\"%s\":\"%s\"}}", kinds[e->kind].arg, name);
+        }
+        if (n > 0 && (size_t)n < sizeof(line) - 1) {
+            line[n++] = '}';
+            write(line, (size_t)n, user);
+        }
+    }
+
+    n = snprintf(line, sizeof(line),
+                 "\n],\"displayTimeUnit\":\"ms\",\"metadata\":{\"source\":\"rasen\",\"droppedEvents\":%u}}\n",
+                 (unsigned)(prof.written - count));
+    write(line, (size_t)n, user);
+}
+
+// ============ LVGL Phases ============
+
+uint32_t rasen_prof_timer_handler(void) {
+#if RASEN_PROFILE
+    if (rasen_prof_active) {
+        uint64_t task = prof.now();
+
+        // Do the layout lv_refr_now() would do first, so it gets its own span
+        lv_disp_t *disp = lv_disp_get_default();
+        if (disp) {
+            lv_obj_update_layout(lv_disp_get_scr_act(disp));
+            lv_obj_update_layout(lv_disp_get_layer_top(disp));
+            lv_obj_update_layout(lv_disp_get_layer_sys(disp));
+        }
+        rasen_prof_record(RASEN_PROF_LAYOUT, "layout", task);
+
+        uint64_t render = prof.now();
+        uint32_t idle_ms = lv_timer_handler();
+        rasen_prof_record(RASEN_PROF_RENDER, "render", render);
+        rasen_prof_record(RASEN_PROF_TASK, "frame", task);
+        return idle_ms;
+    }
+#endif
+    return lv_timer_handler();
+}
@@ -0,0 +1,115 @@
+/**
+ * @file rasen_prof.h
+ * @brief Trace profiler for the Rasen LVGL runtime
+ *
+ * Records spans for script calls, component mounts, element creation,
+ * Tailwind parsing and the LVGL phases of a frame (layout, render, flush)
+ * into a fixed ring buffer, and writes them as Chrome trace JSON for
+ * Perfetto / chrome://tracing or examples/benchmark/analyze-trace.js.
+ *
+ * Compiled in with RASEN_PROFILE=1 and idle until rasen_prof_start() (or
+ * profile(true) from JavaScript); a recorded span then costs two clock
+ * reads. Without RASEN_PROFILE the macros expand to nothing.
+ */
+
+#ifndef RASEN_PROF_H
+#define RASEN_PROF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef RASEN_PROFILE
+#define RASEN_PROFILE 0
+#endif
+
+#ifndef RASEN_PROF_EVENTS
+#define RASEN_PROF_EVENTS 8192  // Ring size; the oldest spans are overwritten
+#endif
+
+typedef enum {
+    RASEN_PROF_TASK = 0,  // One lv_timer_handler() round: layout, render and flush
+    RASEN_PROF_EVAL,      // Loading the app script or bytecode
+    RASEN_PROF_CALL,      // JS called from native code, or a component mount
+    RASEN_PROF_RECONCILE, // Patching the LVGL tree from a new description
+    RASEN_PROF_CREATE,    // Creating one element (lv_*_create and its props)
+    RASEN_PROF_STYLE,     // tw_parse() of a class string the cache missed
+    RASEN_PROF_LAYOUT,    // lv_obj_update_layout() (flex and size recalcs)
+    RASEN_PROF_RENDER,    // lv_timer_handler(): drawing and timers
+    RASEN_PROF_FLUSH,     // Display flush (copy or SPI transfer)
+    RASEN_PROF_KIND_COUNT
+} rasen_prof_kind_t;
+
+/**
+ * Tick source; must be monotonic while recording. The default is
+ * rasen_stats_now_us(); platforms install a cycle counter.
+ */
+typedef uint64_t (*rasen_prof_clock_t)(void);
+
+/**
+ * Receives the trace JSON in pieces
+ */
+typedef void (*rasen_prof_write_t)(const char *data, size_t len, void *user);
+
+extern volatile bool rasen_prof_active;
+
+/**
+ * Use another tick source (call before rasen_prof_start)
+ */
+void rasen_prof_set_clock(rasen_prof_clock_t now, uint64_t ticks_per_sec);
+
+/**
+ * Called by rasen_prof_stop() with the finished recording, e.g. to write
+ * it to a file or the console with rasen_prof_write()
+ */
+void rasen_prof_set_dump(void (*dump)(void));
+
+/**
+ * Clear the buffer and start recording
+ * @param events Ring size, 0 for RASEN_PROF_EVENTS
+ * @return 0 on success, -1 when not compiled in or out of memory
+ */
+int rasen_prof_start(uint32_t events);
+
+/**
+ * Stop recording and hand the trace to the dump callback
+ */
+void rasen_prof_stop(void);
+
+/**
+ * Current tick count
+ */
+uint64_t rasen_prof_now(void);
+
+/**
+ * Record a span from start to now
+ * @param name Static string, or one returned by rasen_prof_intern()
+ */
+void rasen_prof_record(rasen_prof_kind_t kind, const char *name, uint64_t start);
+
+/**
+ * Copy a name that doesn't outlive the call (JS strings); NULL when full
+ */
+const char *rasen_prof_intern(const char *name);
+
+/**
+ * Write what was recorded as Chrome trace JSON ({"traceEvents": [...]})
+ */
+void rasen_prof_write(rasen_prof_write_t write, void *user);
+
+/**
+ * lv_timer_handler() with layout and rendering recorded as separate
+ * spans while recording; use it in place of lv_timer_handler()
+ */
+uint32_t rasen_prof_timer_handler(void);
+
+#if RASEN_PROFILE
+#define RASEN_PROF_BEGIN(var) uint64_t var = rasen_prof_active ? rasen_prof_now() : 0
+#define RASEN_PROF_END(kind, name, var) \
+    do { if (var && rasen_prof_active) rasen_prof_record((kind), (name), var); } while (0)
+#else
+#define RASEN_PROF_BEGIN(var) ((void)0)
+#define RASEN_PROF_END(kind, name, var) ((void)0)
+#endif
+
+#endif // RASEN_PROF_H
@@ -0,0 +1,155 @@
+/**
+ * @file rasen_stats.c
+ * @brief Runtime counters for the Rasen LVGL runtime
+ */
+
+#include "rasen_stats.h"
+#include "lvgl.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "esp_timer.h"
+#elif defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+rasen_stats_t rasen_stats;
+
+// ============ Clock ============
+
+uint64_t rasen_stats_now_us(void) {
+#if defined(ESP_PLATFORM)
+    return (uint64_t)esp_timer_get_time();
+#elif defined(_WIN32)
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER t;
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t);
+    return (uint64_t)(t.QuadPart * 1000000 / freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+#endif
+}
+
+// ============ LVGL Timing ============
+
+static uint64_t lvgl_start_us;
+static uint64_t lvgl_start_js_us;
+
+void rasen_stats_lvgl_begin(void) {
+    lvgl_start_js_us = rasen_stats.time_us[RASEN_TIME_JS];
+    lvgl_start_us = rasen_stats_now_us();
+}
+
+void rasen_stats_lvgl_end(void) {
+    uint64_t elapsed = rasen_stats_now_us() - lvgl_start_us;
+    uint64_t js = rasen_stats.time_us[RASEN_TIME_JS] - lvgl_start_js_us;
+    rasen_stats.time_us[RASEN_TIME_LVGL] += elapsed > js ? elapsed - js : 0;
+}
+
+// ============ Heaps ============
+
+void rasen_stats_sample_heaps(JSRuntime *rt) {
+#if LV_MEM_CUSTOM == 0
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    rasen_stats.lv_heap_used = mon.total_size - mon.free_size;
+    if (mon.max_used > rasen_stats.lv_heap_peak) rasen_stats.lv_heap_peak = mon.max_used;
+#endif
+    if (rt) {
+        JSMemoryUsage usage;
+        JS_ComputeMemoryUsage(rt, &usage);
+        rasen_stats.js_heap_used = (size_t)usage.malloc_size;
+        if (rasen_stats.js_heap_used > rasen_stats.js_heap_peak) {
+            rasen_stats.js_heap_peak = rasen_stats.js_heap_used;
+        }
+    }
+}
+
+// ============ Reporting ============
+
+int rasen_stats_format_line(JSRuntime *rt, char *buf, size_t len) {
+    static rasen_stats_t prev;
+    static uint64_t prev_us;
+
+    uint64_t now = rasen_stats_now_us();
+    rasen_stats_sample_heaps(rt);
+
+    const rasen_stats_t *s = &rasen_stats;
+    uint32_t created = s->objects_created - prev.objects_created;
+    uint32_t deleted = s->objects_deleted - prev.objects_deleted;
+    uint32_t hits = s->style_hits - prev.style_hits;
+    uint32_t misses = s->style_misses - prev.style_misses;
+    uint32_t lookups = hits + misses;
+
+    int n = snprintf(buf, len,
+        "%.1fs obj %u +%u/-%u pool %u rr %u hnd %u style %u%% miss %u "
+        "js %.1fms lv %.1fms fl %.1fms gc %u/%.1fms heap lv %uk/%uk js %uk/%uk",
+        prev_us ? (double)(now - prev_us) / 1e6 : 0.0,
+        (unsigned)(s->objects_created - s->objects_deleted),
+        (unsigned)created, (unsigned)deleted, (unsigned)s->objects_pooled,
+        (unsigned)(s->rerenders - prev.rerenders),
+        (unsigned)s->handlers_live,
+        lookups ? (unsigned)(hits * 100u / lookups) : 100u, (unsigned)misses,
+        (double)(s->time_us[RASEN_TIME_JS] - prev.time_us[RASEN_TIME_JS]) / 1000.0,
+        (double)(s->time_us[RASEN_TIME_LVGL] - prev.time_us[RASEN_TIME_LVGL]) / 1000.0,
+        (double)(s->time_us[RASEN_TIME_FLUSH] - prev.time_us[RASEN_TIME_FLUSH]) / 1000.0,
+        (unsigned)(s->gc_runs - prev.gc_runs),
+        (double)(s->time_us[RASEN_TIME_GC] - prev.time_us[RASEN_TIME_GC]) / 1000.0,
+        (unsigned)(s->lv_heap_used / 1024), (unsigned)(s->lv_heap_peak / 1024),
+        (unsigned)(s->js_heap_used / 1024), (unsigned)(s->js_heap_peak / 1024));
+
+    prev = *s;
+    prev_us = now;
+    return n;
+}
+
+static void set_number(JSContext *ctx, JSValue obj, const char *name, uint64_t v) {
+    JS_SetPropertyStr(ctx, obj, name, JS_NewFloat64(ctx, (double)v));
+}
+
+JSValue rasen_stats_to_js(JSContext *ctx) {
+    rasen_stats_sample_heaps(JS_GetRuntime(ctx));
+
+    const rasen_stats_t *s = &rasen_stats;
+    JSValue obj = JS_NewObject(ctx);
+    set_number(ctx, obj, "objectsCreated", s->objects_created);
+    set_number(ctx, obj, "objectsDeleted", s->objects_deleted);
+    set_number(ctx, obj, "objectsLive", s->objects_created - s->objects_deleted);
+    set_number(ctx, obj, "handlersLive", s->handlers_live);
+    set_number(ctx, obj, "objectsPooled", s->objects_pooled);
+    set_number(ctx, obj, "poolReuses", s->pool_reuses);
+    set_number(ctx, obj, "rerenders", s->rerenders);
+    set_number(ctx, obj, "renderRequests", s->render_requests);
+    set_number(ctx, obj, "rerenderCreated", s->rerender_created);
+    set_number(ctx, obj, "rerenderDeleted", s->rerender_deleted);
+    set_number(ctx, obj, "eventsDropped", s->events_dropped);
+    set_number(ctx, obj, "eventsDeferred", s->events_deferred);
+    set_number(ctx, obj, "eventsCoalesced", s->events_coalesced);
+    set_number(ctx, obj, "styleHits", s->style_hits);
+    set_number(ctx, obj, "styleMisses", s->style_misses);
+    set_number(ctx, obj, "jsUs", s->time_us[RASEN_TIME_JS]);
+    set_number(ctx, obj, "lvglUs", s->time_us[RASEN_TIME_LVGL]);
+    set_number(ctx, obj, "flushUs", s->time_us[RASEN_TIME_FLUSH]);
+    set_number(ctx, obj, "mountSlices", s->mount_slices);
+    set_number(ctx, obj, "chartPoints", s->chart_points);
+    set_number(ctx, obj, "memoSkips", s->memo_skips);
+    set_number(ctx, obj, "imageCacheHits", s->img_cache_hits);
+    set_number(ctx, obj, "imageCacheMisses", s->img_cache_misses);
+    set_number(ctx, obj, "imageCacheBytes", s->img_cache_bytes);
+    set_number(ctx, obj, "gcRuns", s->gc_runs);
+    set_number(ctx, obj, "gcUs", s->time_us[RASEN_TIME_GC]);
+    set_number(ctx, obj, "jsAllocsPooled", s->js_allocs_pooled);
+    set_number(ctx, obj, "jsAllocsSystem", s->js_allocs_system);
+    set_number(ctx, obj, "jsFrameAllocs", s->js_frame_allocs);
+    set_number(ctx, obj, "lvHeapUsed", s->lv_heap_used);
+    set_number(ctx, obj, "lvHeapPeak", s->lv_heap_peak);
+    set_number(ctx, obj, "jsHeapUsed", s->js_heap_used);
+    set_number(ctx, obj, "jsHeapPeak", s->js_heap_peak);
+    return obj;
+}
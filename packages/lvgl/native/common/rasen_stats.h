@@ -0,0 +1,102 @@
+/**
+ * @file rasen_stats.h
+ * @brief Runtime counters for the Rasen LVGL runtime
+ *
+ * Cheap always-on counters (plain increments and timestamp deltas) used to
+ * diagnose devices that slow down over time. Read from JavaScript with
+ * __rasen.stats(), or print a compact line periodically with
+ * rasen_stats_format_line().
+ */
+
+#ifndef RASEN_STATS_H
+#define RASEN_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "quickjs.h"
+
+typedef enum {
+    RASEN_TIME_JS = 0,   // Script, handlers, jobs and rerender JS
+    RASEN_TIME_LVGL,     // lv_timer_handler() minus JS run from inside it
+    RASEN_TIME_FLUSH,    // Display flush (copy or SPI transfer)
+    RASEN_TIME_GC,       // Idle-time JS_RunGC() (see qjs_rasen_idle)
+    RASEN_TIME_COUNT
+} rasen_time_t;
+
+typedef struct {
+    // Cumulative since start
+    uint32_t objects_created;
+    uint32_t objects_deleted;
+    uint32_t rerenders;
+    uint32_t render_requests; // Handler runs and requestRender() calls, coalesced per frame
+    uint32_t style_hits;     // Class strings served from the style cache
+    uint32_t style_misses;   // Class strings parsed (or records decoded)
+    uint32_t events_dropped;  // LVGL events lost to a full event queue
+    uint32_t events_deferred; // Drains cut short by the handler time budget
+    uint32_t events_coalesced; // Value changes merged into one already queued
+    uint32_t pool_reuses;    // Objects taken from the widget pool instead of created
+    uint32_t js_allocs_pooled; // QuickJS allocations served by the size-class pools
+    uint32_t js_allocs_system; // QuickJS allocations that went to malloc (large, or pool full)
+    uint32_t gc_runs;        // Idle-time garbage collections
+    uint32_t mount_slices;   // Time slices spent on incremental first mounts
+    uint32_t chart_points;   // Samples appended to charts by chartStream().push()
+    uint32_t memo_skips;     // memo() subtrees a reconcile left untouched
+    uint32_t img_cache_hits;   // Compressed images opened from the decoded-image cache
+    uint32_t img_cache_misses; // Compressed images decoded on open
+    uint64_t time_us[RASEN_TIME_COUNT];
+
+    // Current
+    uint32_t handlers_live;
+    uint32_t objects_pooled; // Parked in the widget pool (included in created - deleted)
+    size_t img_cache_bytes;  // Decoded image bytes held by the cache
+
+    // Last rerender
+    uint32_t rerender_created;
+    uint32_t rerender_deleted;
+    uint32_t js_frame_allocs; // QuickJS allocations between the last two render marks
+
+    // Heap usage and peaks, updated by rasen_stats_sample_heaps()
+    size_t lv_heap_used;
+    size_t lv_heap_peak;
+    size_t js_heap_used;
+    size_t js_heap_peak;
+} rasen_stats_t;
+
+extern rasen_stats_t rasen_stats;
+
+/**
+ * Monotonic time in microseconds
+ */
+uint64_t rasen_stats_now_us(void);
+
+/**
+ * Add the time elapsed since start_us to a bucket
+ */
+static inline void rasen_stats_add_time(rasen_time_t kind, uint64_t start_us) {
+    rasen_stats.time_us[kind] += rasen_stats_now_us() - start_us;
+}
+
+/**
+ * Time lv_timer_handler(): call begin before and end after it.
+ * JS run by event handlers in between is left in RASEN_TIME_JS only.
+ */
+void rasen_stats_lvgl_begin(void);
+void rasen_stats_lvgl_end(void);
+
+/**
+ * Refresh heap usage; QuickJS usage is walked, so avoid calling it per frame
+ */
+void rasen_stats_sample_heaps(JSRuntime *rt);
+
+/**
+ * Write a compact one-line summary of the interval since the previous call
+ * @return Length written (excluding NUL)
+ */
+int rasen_stats_format_line(JSRuntime *rt, char *buf, size_t len);
+
+/**
+ * Build the object returned by __rasen.stats()
+ */
+JSValue rasen_stats_to_js(JSContext *ctx);
+
+#endif // RASEN_STATS_H
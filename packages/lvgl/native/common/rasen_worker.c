@@ -0,0 +1,512 @@
+/**
+ * @file rasen_worker.c
+ * @brief Background QuickJS workers for the Rasen LVGL runtime
+ *
+ * The UI context owns the worker list; workers only touch their own inbox
+ * and the shared outbox, each behind a mutex.
+ */
+
+#include "rasen_worker.h"
+#include "qjs_rasen.h"
+#include "rasen_stats.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// ============ Platform ============
+
+#if defined(ESP_PLATFORM)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+typedef SemaphoreHandle_t os_mutex_t;
+typedef SemaphoreHandle_t os_sem_t;
+
+static bool os_mutex_init(os_mutex_t *m) { *m = xSemaphoreCreateMutex(); return *m != NULL; }
+static void os_mutex_lock(os_mutex_t *m) { xSemaphoreTake(*m, portMAX_DELAY); }
+static void os_mutex_unlock(os_mutex_t *m) { xSemaphoreGive(*m); }
+static void os_mutex_destroy(os_mutex_t *m) { vSemaphoreDelete(*m); }
+
+static bool os_sem_init(os_sem_t *s) { *s = xSemaphoreCreateCounting(0xffff, 0); return *s != NULL; }
+static void os_sem_wait(os_sem_t *s) { xSemaphoreTake(*s, portMAX_DELAY); }
+static void os_sem_post(os_sem_t *s) { xSemaphoreGive(*s); }
+static void os_sem_destroy(os_sem_t *s) { vSemaphoreDelete(*s); }
+
+static void worker_main(void *arg);
+
+static void worker_task(void *arg) {
+    worker_main(arg);
+    vTaskDelete(NULL);
+}
+
+static bool os_thread_start(void *arg) {
+    return xTaskCreate(worker_task, "rasen_worker", RASEN_WORKER_STACK, arg,
+                       RASEN_WORKER_PRIORITY, NULL) == pdPASS;
+}
+
+#elif defined(_WIN32)
+#include <windows.h>
+
+typedef CRITICAL_SECTION os_mutex_t;
+typedef HANDLE os_sem_t;
+
+static bool os_mutex_init(os_mutex_t *m) { InitializeCriticalSection(m); return true; }
+static void os_mutex_lock(os_mutex_t *m) { EnterCriticalSection(m); }
+static void os_mutex_unlock(os_mutex_t *m) { LeaveCriticalSection(m); }
+static void os_mutex_destroy(os_mutex_t *m) { DeleteCriticalSection(m); }
+
+static bool os_sem_init(os_sem_t *s) { *s = CreateSemaphore(NULL, 0, LONG_MAX, NULL); return *s != NULL; }
+static void os_sem_wait(os_sem_t *s) { WaitForSingleObject(*s, INFINITE); }
+static void os_sem_post(os_sem_t *s) { ReleaseSemaphore(*s, 1, NULL); }
+static void os_sem_destroy(os_sem_t *s) { CloseHandle(*s); }
+
+static void worker_main(void *arg);
+
+static DWORD WINAPI worker_thread(LPVOID arg) {
+    worker_main(arg);
+    return 0;
+}
+
+static bool os_thread_start(void *arg) {
+    HANDLE thread = CreateThread(NULL, RASEN_WORKER_STACK, worker_thread, arg, 0, NULL);
+    if (!thread) return false;
+    CloseHandle(thread);
+    return true;
+}
+
+#else
+#include <pthread.h>
+
+typedef pthread_mutex_t os_mutex_t;
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t count;
+} os_sem_t;
+
+static bool os_mutex_init(os_mutex_t *m) { return pthread_mutex_init(m, NULL) == 0; }
+static void os_mutex_lock(os_mutex_t *m) { pthread_mutex_lock(m); }
+static void os_mutex_unlock(os_mutex_t *m) { pthread_mutex_unlock(m); }
+static void os_mutex_destroy(os_mutex_t *m) { pthread_mutex_destroy(m); }
+
+static bool os_sem_init(os_sem_t *s) {
+    s->count = 0;
+    if (pthread_mutex_init(&s->lock, NULL) != 0) return false;
+    if (pthread_cond_init(&s->cond, NULL) != 0) {
+        pthread_mutex_destroy(&s->lock);
+        return false;
+    }
+    return true;
+}
+
+static void os_sem_wait(os_sem_t *s) {
+    pthread_mutex_lock(&s->lock);
+    while (s->count == 0) pthread_cond_wait(&s->cond, &s->lock);
+    s->count--;
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void os_sem_post(os_sem_t *s) {
+    pthread_mutex_lock(&s->lock);
+    s->count++;
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void os_sem_destroy(os_sem_t *s) {
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+}
+
+static void worker_main(void *arg);
+
+static void *worker_thread(void *arg) {
+    worker_main(arg);
+    return NULL;
+}
+
+static bool os_thread_start(void *arg) {
+    pthread_attr_t attr;
+    pthread_t thread;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, RASEN_WORKER_STACK);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int ret = pthread_create(&thread, &attr, worker_thread, arg);
+    pthread_attr_destroy(&attr);
+    return ret == 0;
+}
+#endif
+
+// ============ Messages ============
+
+/**
+ * A posted value serialized with JS_WriteObject(). Plain bytes, so it can
+ * be read back by any runtime; the sender's copy is freed right away.
+ */
+typedef struct worker_msg {
+    struct worker_msg *next;
+    uint32_t worker_id;
+    size_t len;
+    uint8_t data[];
+} worker_msg_t;
+
+typedef struct {
+    worker_msg_t *head;
+    worker_msg_t *tail;
+} msg_list_t;
+
+static void msg_list_push(msg_list_t *list, worker_msg_t *msg) {
+    msg->next = NULL;
+    if (list->tail) list->tail->next = msg;
+    else list->head = msg;
+    list->tail = msg;
+}
+
+static worker_msg_t *msg_list_pop(msg_list_t *list) {
+    worker_msg_t *msg = list->head;
+    if (!msg) return NULL;
+    list->head = msg->next;
+    if (!list->head) list->tail = NULL;
+    return msg;
+}
+
+static void msg_list_free(msg_list_t *list) {
+    worker_msg_t *msg;
+    while ((msg = msg_list_pop(list))) free(msg);
+}
+
+// Serialize value from ctx; NULL with a pending exception on failure
+static worker_msg_t *msg_encode(JSContext *ctx, JSValueConst value, uint32_t worker_id) {
+    size_t len = 0;
+    uint8_t *buf = JS_WriteObject(ctx, &len, value, 0);
+    if (!buf) return NULL;
+
+    worker_msg_t *msg = malloc(sizeof(worker_msg_t) + len);
+    if (msg) {
+        msg->worker_id = worker_id;
+        msg->len = len;
+        memcpy(msg->data, buf, len);
+    } else {
+        JS_ThrowOutOfMemory(ctx);
+    }
+    js_free(ctx, buf);
+    return msg;
+}
+
+static void print_exception(JSContext *ctx, const char *prefix) {
+    JSValue exc = JS_GetException(ctx);
+    const char *str = JS_ToCString(ctx, exc);
+    printf("%s: %s\n", prefix, str ? str : "(unknown)");
+    if (str) JS_FreeCString(ctx, str);
+    JS_FreeValue(ctx, exc);
+}
+
+// ============ Workers ============
+
+typedef struct rasen_worker {
+    struct rasen_worker *next;
+    uint32_t id;
+    char *source;
+    size_t mem_limit;
+    os_mutex_t lock;        // Guards inbox
+    os_sem_t wake;          // One post per inbox message, plus one to terminate
+    os_sem_t done;          // Posted by the worker thread right before it exits
+    msg_list_t inbox;
+    volatile bool terminate;
+} rasen_worker_t;
+
+static rasen_worker_t *workers = NULL;  // UI context only
+static uint32_t next_worker_id = 1;
+static void (*wake_ui)(void) = NULL;
+
+// Messages from all workers to the UI context, in arrival order
+static os_mutex_t outbox_lock;
+static bool outbox_ready = false;
+static msg_list_t outbox = {0};
+static volatile uint32_t outbox_count = 0;
+
+// Worker side: postMessage(value) -> outbox
+static JSValue js_worker_post(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    (void)this_val;
+    rasen_worker_t *w = JS_GetContextOpaque(ctx);
+    worker_msg_t *msg = msg_encode(ctx, argc > 0 ? argv[0] : JS_UNDEFINED, w->id);
+    if (!msg) return JS_EXCEPTION;
+
+    os_mutex_lock(&outbox_lock);
+    msg_list_push(&outbox, msg);
+    outbox_count++;
+    os_mutex_unlock(&outbox_lock);
+    if (wake_ui) wake_ui();
+    return JS_UNDEFINED;
+}
+
+// Stops long-running worker scripts once terminate() was called
+static int worker_interrupt(JSRuntime *rt, void *opaque) {
+    (void)rt;
+    return ((rasen_worker_t *)opaque)->terminate;
+}
+
+static void worker_run_jobs(JSContext *ctx) {
+    JSContext *job_ctx;
+    int ret;
+    while ((ret = JS_ExecutePendingJob(JS_GetRuntime(ctx), &job_ctx)) != 0) {
+        if (ret < 0) print_exception(job_ctx, "Worker error");
+    }
+}
+
+static void worker_deliver(JSContext *ctx, worker_msg_t *msg) {
+    JSValue data = JS_ReadObject(ctx, msg->data, msg->len, 0);
+    if (JS_IsException(data)) {
+        print_exception(ctx, "Worker error");
+        return;
+    }
+
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue handler = JS_GetPropertyStr(ctx, global, "onmessage");
+    if (JS_IsFunction(ctx, handler)) {
+        JSValue event = JS_NewObject(ctx);
+        JS_SetPropertyStr(ctx, event, "data", data);
+        JSValue ret = JS_Call(ctx, handler, global, 1, &event);
+        if (JS_IsException(ret)) print_exception(ctx, "Worker error");
+        JS_FreeValue(ctx, ret);
+        JS_FreeValue(ctx, event);
+    } else {
+        JS_FreeValue(ctx, data);
+    }
+    JS_FreeValue(ctx, handler);
+    JS_FreeValue(ctx, global);
+}
+
+/**
+ * Worker thread body. The runtime is created here rather than by the
+ * spawner so QuickJS measures stack depth against this thread's stack.
+ */
+static void worker_main(void *arg) {
+    rasen_worker_t *w = arg;
+    JSRuntime *rt = JS_NewRuntime();
+    JSContext *ctx = NULL;
+
+    if (rt) {
+        JS_SetMemoryLimit(rt, w->mem_limit);
+        JS_SetMaxStackSize(rt, RASEN_WORKER_STACK * 3 / 4);
+        JS_SetInterruptHandler(rt, worker_interrupt, w);
+        ctx = qjs_rasen_new_context(rt);
+    }
+
+    if (ctx) {
+        JS_SetContextOpaque(ctx, w);
+        JSValue global = JS_GetGlobalObject(ctx);
+        JS_SetPropertyStr(ctx, global, "postMessage", JS_NewCFunction(ctx, js_worker_post, "postMessage", 1));
+        JS_SetPropertyStr(ctx, global, "self", JS_DupValue(ctx, global));
+        JS_FreeValue(ctx, global);
+
+        JSValue ret = JS_Eval(ctx, w->source, strlen(w->source), "<worker>", JS_EVAL_TYPE_GLOBAL);
+        if (JS_IsException(ret)) print_exception(ctx, "Worker error");
+        JS_FreeValue(ctx, ret);
+        worker_run_jobs(ctx);
+    } else {
+        printf("Worker %u: failed to create runtime\n", (unsigned)w->id);
+    }
+
+    while (!w->terminate) {
+        os_sem_wait(&w->wake);
+
+        os_mutex_lock(&w->lock);
+        worker_msg_t *msg = msg_list_pop(&w->inbox);
+        os_mutex_unlock(&w->lock);
+        if (!msg) continue;
+
+        if (ctx && !w->terminate) {
+            worker_deliver(ctx, msg);
+            worker_run_jobs(ctx);
+        }
+        free(msg);
+    }
+
+    if (ctx) {
+        // `self` refers back to the global object
+        JSValue global = JS_GetGlobalObject(ctx);
+        JS_SetPropertyStr(ctx, global, "self", JS_UNDEFINED);
+        JS_FreeValue(ctx, global);
+        JS_FreeContext(ctx);
+    }
+    if (rt) JS_FreeRuntime(rt);
+    os_sem_post(&w->done);
+}
+
+static void worker_free(rasen_worker_t *w) {
+    msg_list_free(&w->inbox);
+    os_sem_destroy(&w->done);
+    os_sem_destroy(&w->wake);
+    os_mutex_destroy(&w->lock);
+    free(w->source);
+    free(w);
+}
+
+// Stop the thread, wait for its runtime to be freed, then free w
+static void worker_stop(rasen_worker_t *w) {
+    w->terminate = true;
+    os_sem_post(&w->wake);
+    os_sem_wait(&w->done);
+    worker_free(w);
+}
+
+static rasen_worker_t *worker_find(uint32_t id, rasen_worker_t ***link) {
+    rasen_worker_t **p = &workers;
+    while (*p && (*p)->id != id) p = &(*p)->next;
+    if (link) *link = p;
+    return *p;
+}
+
+static rasen_worker_t *worker_spawn(const char *source, size_t mem_limit) {
+    if (!outbox_ready) {
+        if (!os_mutex_init(&outbox_lock)) return NULL;
+        outbox_ready = true;
+    }
+
+    rasen_worker_t *w = calloc(1, sizeof(rasen_worker_t));
+    if (!w) return NULL;
+    w->source = strdup(source);
+    w->mem_limit = mem_limit ? mem_limit : RASEN_WORKER_MEMORY;
+    if (!w->source) {
+        free(w);
+        return NULL;
+    }
+    if (!os_mutex_init(&w->lock)) goto fail_lock;
+    if (!os_sem_init(&w->wake)) goto fail_wake;
+    if (!os_sem_init(&w->done)) goto fail_done;
+
+    w->id = next_worker_id++;
+    if (!os_thread_start(w)) {
+        os_sem_destroy(&w->done);
+        goto fail_done;
+    }
+    w->next = workers;
+    workers = w;
+    return w;
+
+fail_done:
+    os_sem_destroy(&w->wake);
+fail_wake:
+    os_mutex_destroy(&w->lock);
+fail_lock:
+    free(w->source);
+    free(w);
+    return NULL;
+}
+
+// ============ UI Context API ============
+
+// __rasen.workerSpawn(source, memoryLimit) -> id
+static JSValue js_worker_spawn(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    (void)this_val;
+    uint32_t mem_limit = 0;
+    if (argc < 1) return JS_ThrowTypeError(ctx, "workerSpawn: source required");
+    if (argc > 1 && !JS_IsUndefined(argv[1]) && JS_ToUint32(ctx, &mem_limit, argv[1]) < 0) {
+        return JS_EXCEPTION;
+    }
+
+    const char *source = JS_ToCString(ctx, argv[0]);
+    if (!source) return JS_EXCEPTION;
+    rasen_worker_t *w = worker_spawn(source, mem_limit);
+    JS_FreeCString(ctx, source);
+    if (!w) return JS_ThrowInternalError(ctx, "workerSpawn: failed to start worker");
+    return JS_NewUint32(ctx, w->id);
+}
+
+// __rasen.workerPost(id, value)
+static JSValue js_worker_post_to(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    (void)this_val;
+    uint32_t id;
+    if (argc < 1 || JS_ToUint32(ctx, &id, argv[0]) < 0) return JS_EXCEPTION;
+    rasen_worker_t *w = worker_find(id, NULL);
+    if (!w) return JS_ThrowTypeError(ctx, "workerPost: worker %u is not running", (unsigned)id);
+
+    worker_msg_t *msg = msg_encode(ctx, argc > 1 ? argv[1] : JS_UNDEFINED, id);
+    if (!msg) return JS_EXCEPTION;
+    os_mutex_lock(&w->lock);
+    msg_list_push(&w->inbox, msg);
+    os_mutex_unlock(&w->lock);
+    os_sem_post(&w->wake);
+    return JS_UNDEFINED;
+}
+
+// __rasen.workerTerminate(id); queued replies from it are dropped on delivery
+static JSValue js_worker_terminate(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    (void)this_val;
+    uint32_t id;
+    rasen_worker_t **link;
+    if (argc < 1 || JS_ToUint32(ctx, &id, argv[0]) < 0) return JS_EXCEPTION;
+    rasen_worker_t *w = worker_find(id, &link);
+    if (w) {
+        *link = w->next;
+        worker_stop(w);
+    }
+    return JS_UNDEFINED;
+}
+
+void rasen_worker_install(JSContext *ctx, JSValue api) {
+    JS_SetPropertyStr(ctx, api, "workerSpawn", JS_NewCFunction(ctx, js_worker_spawn, "workerSpawn", 2));
+    JS_SetPropertyStr(ctx, api, "workerPost", JS_NewCFunction(ctx, js_worker_post_to, "workerPost", 2));
+    JS_SetPropertyStr(ctx, api, "workerTerminate", JS_NewCFunction(ctx, js_worker_terminate, "workerTerminate", 1));
+}
+
+void rasen_worker_set_wake(void (*wake)(void)) {
+    wake_ui = wake;
+}
+
+bool rasen_worker_has_messages(void) {
+    return outbox_count != 0;
+}
+
+int rasen_worker_dispatch(JSContext *ctx, uint64_t deadline_us) {
+    if (!outbox_ready || !outbox_count) return 0;
+
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue func = JS_GetPropertyStr(ctx, global, "__workerMessage");
+    JS_FreeValue(ctx, global);
+    int delivered = 0;
+
+    do {
+        os_mutex_lock(&outbox_lock);
+        worker_msg_t *msg = msg_list_pop(&outbox);
+        if (msg) outbox_count--;
+        os_mutex_unlock(&outbox_lock);
+        if (!msg) break;
+
+        // Skip replies from workers terminated after they were posted
+        if (worker_find(msg->worker_id, NULL) && JS_IsFunction(ctx, func)) {
+            JSValue args[2];
+            args[0] = JS_NewUint32(ctx, msg->worker_id);
+            args[1] = JS_ReadObject(ctx, msg->data, msg->len, 0);
+            if (JS_IsException(args[1])) {
+                print_exception(ctx, "Worker message error");
+            } else {
+                JSValue ret = JS_Call(ctx, func, JS_UNDEFINED, 2, args);
+                if (JS_IsException(ret)) print_exception(ctx, "JS Error");
+                JS_FreeValue(ctx, ret);
+                JS_FreeValue(ctx, args[1]);
+                delivered++;
+            }
+        }
+        free(msg);
+    } while (outbox_count && rasen_stats_now_us() < deadline_us);
+
+    JS_FreeValue(ctx, func);
+    return delivered;
+}
+
+void rasen_worker_shutdown(void) {
+    while (workers) {
+        rasen_worker_t *w = workers;
+        workers = w->next;
+        worker_stop(w);
+    }
+    if (outbox_ready) {
+        os_mutex_lock(&outbox_lock);
+        msg_list_free(&outbox);
+        outbox_count = 0;
+        os_mutex_unlock(&outbox_lock);
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ * @file rasen_worker.h
+ * @brief Background QuickJS workers for the Rasen LVGL runtime
+ *
+ * Each worker is a separate JSRuntime with its own memory limit, running
+ * on its own thread (FreeRTOS task on ESP32). Messages are copied between
+ * runtimes with JS_WriteObject()/JS_ReadObject(), so only plain data
+ * (objects, arrays, strings, numbers, typed arrays) can be posted.
+ * Replies are queued and delivered to the UI context by
+ * qjs_rasen_process_events(), under the same time budget as UI events.
+ */
+
+#ifndef RASEN_WORKER_H
+#define RASEN_WORKER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "quickjs.h"
+
+#ifndef RASEN_WORKER_MEMORY
+#define RASEN_WORKER_MEMORY (256 * 1024)    // Default JS heap limit per worker
+#endif
+
+#ifndef RASEN_WORKER_STACK
+#if defined(ESP_PLATFORM)
+#define RASEN_WORKER_STACK 16384
+#else
+#define RASEN_WORKER_STACK (512 * 1024)
+#endif
+#endif
+
+#ifndef RASEN_WORKER_PRIORITY
+#define RASEN_WORKER_PRIORITY 3             // FreeRTOS; below the UI tasks
+#endif
+
+/**
+ * Add workerSpawn / workerPost / workerTerminate to the __rasen object
+ */
+void rasen_worker_install(JSContext *ctx, JSValue api);
+
+/**
+ * Called from a worker thread after it queued a message for the UI
+ * context, so a sleeping main loop can wake up. Optional.
+ */
+void rasen_worker_set_wake(void (*wake)(void));
+
+/**
+ * Whether worker messages are waiting for rasen_worker_dispatch()
+ */
+bool rasen_worker_has_messages(void);
+
+/**
+ * Deliver queued worker messages to __workerMessage(id, data) in ctx
+ * At least one message is delivered; the rest stop once deadline_us
+ * (rasen_stats_now_us() clock) has passed.
+ * @return Number of messages delivered
+ */
+int rasen_worker_dispatch(JSContext *ctx, uint64_t deadline_us);
+
+/**
+ * Terminate all workers and drop undelivered messages
+ */
+void rasen_worker_shutdown(void);
+
+#endif // RASEN_WORKER_H
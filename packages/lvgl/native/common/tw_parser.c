@@ -1,365 +1,413 @@
 /**
  * @file tw_parser.c
  * @brief Tailwind CSS to LVGL style parser
+ *
+ * tw_parse() scans the class string in place: each token is looked up in
+ * the perfect hash tables from tw_tables.h, so no copy of the string is
+ * made and no state is kept between calls.
  */
 
 #include "qjs_rasen.h"
+#include "rasen_stats.h"
+#include "rasen_prof.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 
-// ============ Color Helpers ============
+// ============ Feature Selection ============
 
-static lv_color_t hex_to_color(const char *hex) {
-    // Skip # if present
-    if (hex[0] == '#') hex++;
-    
-    unsigned int r, g, b;
-    if (strlen(hex) == 6) {
-        sscanf(hex, "%02x%02x%02x", &r, &g, &b);
-    } else if (strlen(hex) == 3) {
-        sscanf(hex, "%1x%1x%1x", &r, &g, &b);
-        r *= 17; g *= 17; b *= 17;
-    } else {
-        return lv_color_black();
-    }
-    return lv_color_make(r, g, b);
+/*
+ * Utility groups that pull in data. `rasen-lvgl build` turns off what an
+ * app's class strings don't use (see RASEN_FEATURES_H in qjs_rasen.h), so
+ * the linker drops the palette and unreferenced fonts. Fonts disabled in
+ * lv_conf.h are left out either way; text-* utilities for them do nothing.
+ */
+#ifndef RASEN_TW_PALETTE
+#define RASEN_TW_PALETTE 1      // Named colors (bg-red-500); [#rrggbb] always works
+#endif
+#ifndef RASEN_TW_FONT_12
+#define RASEN_TW_FONT_12 1
+#endif
+#ifndef RASEN_TW_FONT_14
+#define RASEN_TW_FONT_14 1
+#endif
+#ifndef RASEN_TW_FONT_16
+#define RASEN_TW_FONT_16 1
+#endif
+#ifndef RASEN_TW_FONT_18
+#define RASEN_TW_FONT_18 1
+#endif
+#ifndef RASEN_TW_FONT_20
+#define RASEN_TW_FONT_20 1
+#endif
+#ifndef RASEN_TW_FONT_24
+#define RASEN_TW_FONT_24 1
+#endif
+#ifndef RASEN_TW_FONT_28
+#define RASEN_TW_FONT_28 1
+#endif
+#ifndef RASEN_TW_FONT_32
+#define RASEN_TW_FONT_32 1
+#endif
+
+#define TW_HAS_FONT(size) (LV_FONT_MONTSERRAT_##size && RASEN_TW_FONT_##size)
+
+// ============ Lookup Tables ============
+
+// Whole-token utilities (e.g. "flex-col", "rounded-lg")
+enum {
+    TW_OP_NONE = 0,
+    TW_OP_FLEX,
+    TW_OP_FLEX_FLOW,
+    TW_OP_FLEX_WRAP,
+    TW_OP_JUSTIFY,
+    TW_OP_ITEMS,
+    TW_OP_SIZE_FULL,
+    TW_OP_WIDTH_PCT,
+    TW_OP_HEIGHT_PCT,
+    TW_OP_FONT,
+    TW_OP_RADIUS,
+    TW_OP_BG_TRANSPARENT,
+    TW_OP_BORDER_WIDTH,
+};
+
+// Prefixes taking a value after the first '-' (e.g. "p-4", "bg-red-500")
+enum {
+    TW_PREFIX_NONE = 0,
+    TW_PREFIX_WIDTH,
+    TW_PREFIX_HEIGHT,
+    TW_PREFIX_SIZE,
+    TW_PREFIX_GAP,
+    TW_PREFIX_PAD,
+    TW_PREFIX_PAD_X,
+    TW_PREFIX_PAD_Y,
+    TW_PREFIX_PAD_TOP,
+    TW_PREFIX_PAD_BOTTOM,
+    TW_PREFIX_PAD_LEFT,
+    TW_PREFIX_PAD_RIGHT,
+    TW_PREFIX_BG,
+    TW_PREFIX_TEXT,
+    TW_PREFIX_BORDER,
+};
+
+typedef struct {
+    const char *name;
+    uint8_t len;
+    uint8_t op;
+    uint8_t prefix;
+    int16_t arg;
+} tw_keyword_t;
+
+typedef struct {
+    const char *name;
+    uint8_t len;
+    uint32_t rgb;
+} tw_color_entry_t;
+
+#include "tw_tables.h"
+
+static const tw_keyword_t *find_keyword(const char *s, size_t len) {
+    if (len == 0) return NULL;  // Empty slots have len 0
+    uint32_t d = tw_keyword_disp[tw_phash(0, s, len) & (TW_KEYWORD_BUCKETS - 1)];
+    const tw_keyword_t *kw = &tw_keywords[tw_phash(d, s, len) & (TW_KEYWORD_SLOTS - 1)];
+    if (kw->len != len || memcmp(kw->name, s, len) != 0) return NULL;
+    return kw;
 }
 
-// Tailwind color palette (500 variants)
-static lv_color_t get_tw_color(const char *name) {
-    if (strcmp(name, "white") == 0) return lv_color_white();
-    if (strcmp(name, "black") == 0) return lv_color_black();
-    if (strcmp(name, "red-500") == 0) return lv_color_make(239, 68, 68);
-    if (strcmp(name, "orange-500") == 0) return lv_color_make(249, 115, 22);
-    if (strcmp(name, "yellow-500") == 0) return lv_color_make(234, 179, 8);
-    if (strcmp(name, "green-500") == 0) return lv_color_make(34, 197, 94);
-    if (strcmp(name, "blue-500") == 0) return lv_color_make(59, 130, 246);
-    if (strcmp(name, "purple-500") == 0) return lv_color_make(168, 85, 247);
-    if (strcmp(name, "pink-500") == 0) return lv_color_make(236, 72, 153);
-    if (strcmp(name, "gray-500") == 0) return lv_color_make(107, 114, 128);
-    if (strcmp(name, "gray-800") == 0) return lv_color_make(31, 41, 55);
-    if (strcmp(name, "gray-900") == 0) return lv_color_make(17, 24, 39);
-    // Default
-    return lv_color_black();
+static bool find_palette(const char *s, size_t len, lv_color_t *out) {
+#if RASEN_TW_PALETTE
+    if (len == 0) return false;
+    uint32_t d = tw_palette_disp[tw_phash(0, s, len) & (TW_PALETTE_BUCKETS - 1)];
+    const tw_color_entry_t *c = &tw_palette[tw_phash(d, s, len) & (TW_PALETTE_SLOTS - 1)];
+    if (c->len != len || memcmp(c->name, s, len) != 0) return false;
+    *out = lv_color_hex(c->rgb);
+    return true;
+#else
+    (void)s;
+    (void)len;
+    (void)out;
+    return false;
+#endif
 }
 
-// ============ Parse Helpers ============
+// ============ Value Helpers ============
 
-static int parse_number(const char *str) {
-    return atoi(str);
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
 }
 
-// Parse arbitrary value like [#505050] or [200px]
-static bool parse_arbitrary(const char *value, char *out, size_t out_size) {
-    if (value[0] != '[') return false;
+// Decode "#rgb" or "#rrggbb" ('#' optional)
+static bool parse_hex(const char *s, size_t len, lv_color_t *out) {
+    if (len && s[0] == '#') { s++; len--; }
+    if (len != 3 && len != 6) return false;
     
-    const char *end = strchr(value, ']');
-    if (!end) return false;
+    uint32_t rgb = 0;
+    for (size_t i = 0; i < len; i++) {
+        int v = hex_digit(s[i]);
+        if (v < 0) return false;
+        rgb = (rgb << 4) | (uint32_t)v;
+        if (len == 3) rgb = (rgb << 4) | (uint32_t)v;
+    }
+    *out = lv_color_hex(rgb);
+    return true;
+}
+
+// Leading integer of s[0..len), returns chars consumed (0 if none)
+static size_t parse_int(const char *s, size_t len, int *out) {
+    size_t i = 0;
+    bool neg = false;
+    if (i < len && s[i] == '-') { neg = true; i++; }
     
-    size_t len = end - value - 1;
-    if (len >= out_size) len = out_size - 1;
+    size_t start = i;
+    int v = 0;
+    while (i < len && s[i] >= '0' && s[i] <= '9') {
+        v = v * 10 + (s[i] - '0');
+        i++;
+    }
+    if (i == start) return 0;
+    *out = neg ? -v : v;
+    return i;
+}
+
+// Parse CSS length like "200px", "10rem" or "50%"
+static bool parse_length(const char *s, size_t len, lv_coord_t *out) {
+    int v;
+    size_t n = parse_int(s, len, &v);
+    if (!n) return false;
     
-    strncpy(out, value + 1, len);
-    out[len] = '\0';
+    const char *unit = s + n;
+    size_t unit_len = len - n;
+    if (unit_len == 0 || (unit_len == 2 && memcmp(unit, "px", 2) == 0)) {
+        *out = v;
+    } else if (unit_len == 3 && memcmp(unit, "rem", 3) == 0) {
+        *out = v * 16; // 1rem = 16px
+    } else if (unit_len == 1 && unit[0] == '%') {
+        *out = LV_PCT(v);
+    } else {
+        return false;
+    }
     return true;
 }
 
-// Parse CSS length like "200px" or "10rem"
-static lv_coord_t parse_length(const char *str) {
-    int len = strlen(str);
-    int value = atoi(str);
+// Spacing scale value ("4", "0.5") or arbitrary length ("[200px]")
+static bool parse_spacing(const char *s, size_t len, lv_coord_t *out) {
+    if (len >= 2 && s[0] == '[' && s[len - 1] == ']') {
+        return parse_length(s + 1, len - 2, out);
+    }
     
-    if (len > 2 && strcmp(str + len - 2, "px") == 0) {
-        return value;
+    int v;
+    size_t n = parse_int(s, len, &v);
+    if (!n || v < 0) return false;
+    if (n == len) {
+        *out = v * 4;
+        return true;
     }
-    if (len > 3 && strcmp(str + len - 3, "rem") == 0) {
-        return value * 16; // 1rem = 16px
+    if (len - n == 2 && s[n] == '.' && s[n + 1] == '5') {
+        *out = v * 4 + 2;
+        return true;
     }
-    if (len > 1 && str[len - 1] == '%') {
-        return LV_PCT(value);
+    return false;
+}
+
+// Palette name ("red-500") or arbitrary hex ("[#505050]")
+static bool parse_color(const char *s, size_t len, lv_color_t *out) {
+    if (len >= 2 && s[0] == '[' && s[len - 1] == ']') {
+        return parse_hex(s + 1, len - 2, out);
+    }
+    return find_palette(s, len, out);
+}
+
+static const lv_font_t *font_for_size(int size) {
+    switch (size) {
+#if TW_HAS_FONT(12)
+        case 12: return &lv_font_montserrat_12;
+#endif
+#if TW_HAS_FONT(14)
+        case 14: return &lv_font_montserrat_14;
+#endif
+#if TW_HAS_FONT(16)
+        case 16: return &lv_font_montserrat_16;
+#endif
+#if TW_HAS_FONT(18)
+        case 18: return &lv_font_montserrat_18;
+#endif
+#if TW_HAS_FONT(20)
+        case 20: return &lv_font_montserrat_20;
+#endif
+#if TW_HAS_FONT(24)
+        case 24: return &lv_font_montserrat_24;
+#endif
+#if TW_HAS_FONT(28)
+        case 28: return &lv_font_montserrat_28;
+#endif
+#if TW_HAS_FONT(32)
+        case 32: return &lv_font_montserrat_32;
+#endif
+        default: return NULL;
     }
-    return value;
 }
 
 // ============ Main Parser ============
 
-void tw_parse(const char *class_str, tw_styles_t *styles) {
-    // Initialize defaults
-    memset(styles, 0, sizeof(tw_styles_t));
-    styles->width = LV_SIZE_CONTENT;
-    styles->height = LV_SIZE_CONTENT;
-    styles->bg_opa = LV_OPA_COVER;
-    styles->flex_flow = LV_FLEX_FLOW_ROW;
-    styles->justify_content = LV_FLEX_ALIGN_START;
-    styles->align_items = LV_FLEX_ALIGN_START;
-    
-    if (!class_str || !class_str[0]) return;
-    
-    // Make a copy to tokenize
-    char *copy = strdup(class_str);
-    char *token = strtok(copy, " ");
-    
-    while (token) {
-        char arb_value[64];
-        
-        // ===== Flex Layout =====
-        if (strcmp(token, "flex") == 0) {
+static void apply_keyword(const tw_keyword_t *kw, tw_styles_t *styles) {
+    switch (kw->op) {
+        case TW_OP_FLEX:
             styles->flex = true;
-        }
-        else if (strcmp(token, "flex-row") == 0) {
-            styles->flex = true;
-            styles->flex_flow = LV_FLEX_FLOW_ROW;
-        }
-        else if (strcmp(token, "flex-col") == 0) {
+            break;
+        case TW_OP_FLEX_FLOW:
             styles->flex = true;
-            styles->flex_flow = LV_FLEX_FLOW_COLUMN;
-        }
-        else if (strcmp(token, "flex-wrap") == 0) {
+            styles->flex_flow = (lv_flex_flow_t)kw->arg;
+            break;
+        case TW_OP_FLEX_WRAP:
             if (styles->flex_flow == LV_FLEX_FLOW_ROW)
                 styles->flex_flow = LV_FLEX_FLOW_ROW_WRAP;
             else if (styles->flex_flow == LV_FLEX_FLOW_COLUMN)
                 styles->flex_flow = LV_FLEX_FLOW_COLUMN_WRAP;
-        }
-        
-        // ===== Justify Content =====
-        else if (strcmp(token, "justify-start") == 0) {
-            styles->justify_content = LV_FLEX_ALIGN_START;
-        }
-        else if (strcmp(token, "justify-end") == 0) {
-            styles->justify_content = LV_FLEX_ALIGN_END;
-        }
-        else if (strcmp(token, "justify-center") == 0) {
-            styles->justify_content = LV_FLEX_ALIGN_CENTER;
-        }
-        else if (strcmp(token, "justify-between") == 0) {
-            styles->justify_content = LV_FLEX_ALIGN_SPACE_BETWEEN;
-        }
-        else if (strcmp(token, "justify-around") == 0) {
-            styles->justify_content = LV_FLEX_ALIGN_SPACE_AROUND;
-        }
-        else if (strcmp(token, "justify-evenly") == 0) {
-            styles->justify_content = LV_FLEX_ALIGN_SPACE_EVENLY;
-        }
-        
-        // ===== Align Items =====
-        else if (strcmp(token, "items-start") == 0) {
-            styles->align_items = LV_FLEX_ALIGN_START;
-        }
-        else if (strcmp(token, "items-end") == 0) {
-            styles->align_items = LV_FLEX_ALIGN_END;
-        }
-        else if (strcmp(token, "items-center") == 0) {
-            styles->align_items = LV_FLEX_ALIGN_CENTER;
-        }
-        
-        // ===== Sizing =====
-        else if (strcmp(token, "size-full") == 0) {
-            styles->width = LV_PCT(100);
-            styles->height = LV_PCT(100);
-        }
-        else if (strcmp(token, "w-full") == 0) {
+            break;
+        case TW_OP_JUSTIFY:
+            styles->justify_content = (lv_flex_align_t)kw->arg;
+            break;
+        case TW_OP_ITEMS:
+            styles->align_items = (lv_flex_align_t)kw->arg;
+            break;
+        case TW_OP_SIZE_FULL:
             styles->width = LV_PCT(100);
-        }
-        else if (strcmp(token, "h-full") == 0) {
             styles->height = LV_PCT(100);
-        }
-        else if (strncmp(token, "w-[", 3) == 0) {
-            if (parse_arbitrary(token + 2, arb_value, sizeof(arb_value))) {
-                styles->width = parse_length(arb_value);
-            }
-        }
-        else if (strncmp(token, "h-[", 3) == 0) {
-            if (parse_arbitrary(token + 2, arb_value, sizeof(arb_value))) {
-                styles->height = parse_length(arb_value);
-            }
-        }
-        else if (strncmp(token, "size-", 5) == 0) {
-            if (token[5] == '[') {
-                if (parse_arbitrary(token + 5, arb_value, sizeof(arb_value))) {
-                    lv_coord_t size = parse_length(arb_value);
-                    styles->width = size;
-                    styles->height = size;
-                }
-            } else {
-                int n = parse_number(token + 5);
-                styles->width = n * 4;
-                styles->height = n * 4;
-            }
-        }
-        else if (strncmp(token, "w-", 2) == 0) {
-            int n = parse_number(token + 2);
-            styles->width = n * 4;
-        }
-        else if (strncmp(token, "h-", 2) == 0) {
-            int n = parse_number(token + 2);
-            styles->height = n * 4;
-        }
-        
-        // ===== Gap =====
-        else if (strncmp(token, "gap-", 4) == 0) {
-            if (token[4] == '[') {
-                if (parse_arbitrary(token + 4, arb_value, sizeof(arb_value))) {
-                    lv_coord_t gap = parse_length(arb_value);
-                    styles->pad_row = gap;
-                    styles->pad_column = gap;
-                }
-            } else {
-                int n = parse_number(token + 4);
-                styles->pad_row = n * 4;
-                styles->pad_column = n * 4;
-            }
-        }
-        
-        // ===== Padding =====
-        else if (strncmp(token, "p-", 2) == 0 && token[2] != '[') {
-            int n = parse_number(token + 2);
-            lv_coord_t p = n * 4;
-            styles->pad_top = p;
-            styles->pad_bottom = p;
-            styles->pad_left = p;
-            styles->pad_right = p;
-        }
-        else if (strncmp(token, "p-[", 3) == 0) {
-            if (parse_arbitrary(token + 2, arb_value, sizeof(arb_value))) {
-                lv_coord_t p = parse_length(arb_value);
-                styles->pad_top = p;
-                styles->pad_bottom = p;
-                styles->pad_left = p;
-                styles->pad_right = p;
+            break;
+        case TW_OP_WIDTH_PCT:
+            styles->width = LV_PCT(kw->arg);
+            break;
+        case TW_OP_HEIGHT_PCT:
+            styles->height = LV_PCT(kw->arg);
+            break;
+        case TW_OP_FONT: {
+            const lv_font_t *font = font_for_size(kw->arg);
+            if (font) styles->font = font;
+            break;
+        }
+        case TW_OP_RADIUS:
+            styles->border_radius = kw->arg;
+            break;
+        case TW_OP_BG_TRANSPARENT:
+            styles->bg_opa = LV_OPA_TRANSP;
+            styles->has_bg_color = true;
+            break;
+        case TW_OP_BORDER_WIDTH:
+            styles->border_width = kw->arg;
+            break;
+    }
+}
+
+static void apply_prefix(int prefix, const char *v, size_t len, tw_styles_t *styles) {
+    lv_coord_t n;
+    lv_color_t color;
+    
+    switch (prefix) {
+        case TW_PREFIX_WIDTH:
+            if (parse_spacing(v, len, &n)) styles->width = n;
+            break;
+        case TW_PREFIX_HEIGHT:
+            if (parse_spacing(v, len, &n)) styles->height = n;
+            break;
+        case TW_PREFIX_SIZE:
+            if (parse_spacing(v, len, &n)) styles->width = styles->height = n;
+            break;
+        case TW_PREFIX_GAP:
+            if (parse_spacing(v, len, &n)) styles->pad_row = styles->pad_column = n;
+            break;
+        case TW_PREFIX_PAD:
+            if (parse_spacing(v, len, &n)) {
+                styles->pad_top = styles->pad_bottom = n;
+                styles->pad_left = styles->pad_right = n;
             }
-        }
-        else if (strncmp(token, "px-", 3) == 0) {
-            int n = parse_number(token + 3);
-            styles->pad_left = n * 4;
-            styles->pad_right = n * 4;
-        }
-        else if (strncmp(token, "py-", 3) == 0) {
-            int n = parse_number(token + 3);
-            styles->pad_top = n * 4;
-            styles->pad_bottom = n * 4;
-        }
-        else if (strncmp(token, "pt-", 3) == 0) {
-            styles->pad_top = parse_number(token + 3) * 4;
-        }
-        else if (strncmp(token, "pb-", 3) == 0) {
-            styles->pad_bottom = parse_number(token + 3) * 4;
-        }
-        else if (strncmp(token, "pl-", 3) == 0) {
-            styles->pad_left = parse_number(token + 3) * 4;
-        }
-        else if (strncmp(token, "pr-", 3) == 0) {
-            styles->pad_right = parse_number(token + 3) * 4;
-        }
-        
-        // ===== Background Color =====
-        else if (strncmp(token, "bg-[", 4) == 0) {
-            if (parse_arbitrary(token + 3, arb_value, sizeof(arb_value))) {
-                styles->bg_color = hex_to_color(arb_value);
+            break;
+        case TW_PREFIX_PAD_X:
+            if (parse_spacing(v, len, &n)) styles->pad_left = styles->pad_right = n;
+            break;
+        case TW_PREFIX_PAD_Y:
+            if (parse_spacing(v, len, &n)) styles->pad_top = styles->pad_bottom = n;
+            break;
+        case TW_PREFIX_PAD_TOP:
+            if (parse_spacing(v, len, &n)) styles->pad_top = n;
+            break;
+        case TW_PREFIX_PAD_BOTTOM:
+            if (parse_spacing(v, len, &n)) styles->pad_bottom = n;
+            break;
+        case TW_PREFIX_PAD_LEFT:
+            if (parse_spacing(v, len, &n)) styles->pad_left = n;
+            break;
+        case TW_PREFIX_PAD_RIGHT:
+            if (parse_spacing(v, len, &n)) styles->pad_right = n;
+            break;
+        case TW_PREFIX_BG:
+            if (parse_color(v, len, &color)) {
+                styles->bg_color = color;
                 styles->has_bg_color = true;
             }
-        }
-        else if (strncmp(token, "bg-", 3) == 0) {
-            styles->bg_color = get_tw_color(token + 3);
-            styles->has_bg_color = true;
-        }
-        
-        // ===== Text Color =====
-        else if (strncmp(token, "text-[", 6) == 0) {
-            if (parse_arbitrary(token + 5, arb_value, sizeof(arb_value))) {
-                if (arb_value[0] == '#') {
-                    styles->text_color = hex_to_color(arb_value);
-                    styles->has_text_color = true;
-                }
+            break;
+        case TW_PREFIX_TEXT:
+            if (parse_color(v, len, &color)) {
+                styles->text_color = color;
+                styles->has_text_color = true;
             }
-        }
-        else if (strcmp(token, "text-white") == 0) {
-            styles->text_color = lv_color_white();
-            styles->has_text_color = true;
-        }
-        else if (strcmp(token, "text-black") == 0) {
-            styles->text_color = lv_color_black();
-            styles->has_text_color = true;
-        }
-        else if (strcmp(token, "text-xs") == 0) {
-            styles->font = &lv_font_montserrat_12;
-        }
-        else if (strcmp(token, "text-sm") == 0) {
-            styles->font = &lv_font_montserrat_14;
-        }
-        else if (strcmp(token, "text-base") == 0) {
-            styles->font = &lv_font_montserrat_16;
-        }
-        else if (strcmp(token, "text-lg") == 0) {
-            styles->font = &lv_font_montserrat_18;
-        }
-        else if (strcmp(token, "text-xl") == 0) {
-            styles->font = &lv_font_montserrat_20;
-        }
-        else if (strcmp(token, "text-2xl") == 0) {
-            styles->font = &lv_font_montserrat_24;
-        }
-        else if (strcmp(token, "text-3xl") == 0) {
-            styles->font = &lv_font_montserrat_28;
-        }
-        else if (strcmp(token, "text-4xl") == 0) {
-            styles->font = &lv_font_montserrat_32;
-        }
-        
-        // ===== Border =====
-        else if (strcmp(token, "border") == 0) {
-            styles->border_width = 1;
-        }
-        else if (strncmp(token, "border-", 7) == 0) {
-            char c = token[7];
-            if (c >= '0' && c <= '9') {
-                styles->border_width = parse_number(token + 7);
-            } else if (token[7] == '[') {
-                if (parse_arbitrary(token + 7, arb_value, sizeof(arb_value))) {
-                    if (arb_value[0] == '#') {
-                        styles->border_color = hex_to_color(arb_value);
-                        styles->has_border_color = true;
-                    }
-                }
-            } else {
-                styles->border_color = get_tw_color(token + 7);
+            break;
+        case TW_PREFIX_BORDER: {
+            int w;
+            if (len && v[0] >= '0' && v[0] <= '9' && parse_int(v, len, &w) == len) {
+                styles->border_width = w;
+            } else if (parse_color(v, len, &color)) {
+                styles->border_color = color;
                 styles->has_border_color = true;
             }
+            break;
         }
-        
-        // ===== Border Radius =====
-        else if (strcmp(token, "rounded-none") == 0) {
-            styles->border_radius = 0;
-        }
-        else if (strcmp(token, "rounded-sm") == 0) {
-            styles->border_radius = 2;
-        }
-        else if (strcmp(token, "rounded") == 0) {
-            styles->border_radius = 4;
-        }
-        else if (strcmp(token, "rounded-md") == 0) {
-            styles->border_radius = 6;
-        }
-        else if (strcmp(token, "rounded-lg") == 0) {
-            styles->border_radius = 8;
-        }
-        else if (strcmp(token, "rounded-xl") == 0) {
-            styles->border_radius = 12;
-        }
-        else if (strcmp(token, "rounded-2xl") == 0) {
-            styles->border_radius = 16;
-        }
-        else if (strcmp(token, "rounded-3xl") == 0) {
-            styles->border_radius = 24;
-        }
-        else if (strcmp(token, "rounded-full") == 0) {
-            styles->border_radius = LV_RADIUS_CIRCLE;
-        }
-        
-        token = strtok(NULL, " ");
+    }
+}
+
+static void parse_token(const char *tok, size_t len, tw_styles_t *styles) {
+    const tw_keyword_t *kw = find_keyword(tok, len);
+    if (kw && kw->op != TW_OP_NONE) {
+        apply_keyword(kw, styles);
+        return;
     }
     
-    free(copy);
+    const char *dash = memchr(tok, '-', len);
+    if (!dash || dash == tok) return;
+    
+    size_t prefix_len = (size_t)(dash - tok);
+    kw = find_keyword(tok, prefix_len);
+    if (kw && kw->prefix != TW_PREFIX_NONE) {
+        apply_prefix(kw->prefix, dash + 1, len - prefix_len - 1, styles);
+    }
+    // Unknown utilities are ignored
+}
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+void tw_parse(const char *class_str, tw_styles_t *styles) {
+    // Initialize defaults
+    memset(styles, 0, sizeof(tw_styles_t));
+    styles->width = LV_SIZE_CONTENT;
+    styles->height = LV_SIZE_CONTENT;
+    styles->bg_opa = LV_OPA_COVER;
+    styles->flex_flow = LV_FLEX_FLOW_ROW;
+    styles->justify_content = LV_FLEX_ALIGN_START;
+    styles->align_items = LV_FLEX_ALIGN_START;
+    
+    if (!class_str) return;
+    
+    const char *p = class_str;
+    while (*p) {
+        while (is_space(*p)) p++;
+        const char *start = p;
+        while (*p && !is_space(*p)) p++;
+        if (p > start) parse_token(start, (size_t)(p - start), styles);
+    }
 }
 
 // ============ Apply Styles to LVGL Object ============
@@ -413,3 +461,250 @@ void tw_apply(lv_obj_t *obj, const tw_styles_t *styles) {
         lv_obj_set_style_text_font(obj, styles->font, 0);
     }
 }
+
+// ============ Shared Style Cache ============
+
+#define TW_STYLE_BUCKETS 64
+
+static tw_style_t *style_buckets[TW_STYLE_BUCKETS];
+
+static uint32_t tw_hash(const char *str) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    while (*str) {
+        h ^= (uint8_t)*str++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Same properties tw_apply() sets, recorded into a style instead of local styles
+static void tw_build_style(lv_style_t *style, const tw_styles_t *styles) {
+    lv_style_init(style);
+    
+    // Flex layout
+    if (styles->flex) {
+        lv_style_set_layout(style, LV_LAYOUT_FLEX);
+        lv_style_set_flex_flow(style, styles->flex_flow);
+        lv_style_set_flex_main_place(style, styles->justify_content);
+        lv_style_set_flex_cross_place(style, styles->align_items);
+        lv_style_set_flex_track_place(style, LV_FLEX_ALIGN_START);
+    }
+    
+    // Size
+    if (styles->width != LV_SIZE_CONTENT) lv_style_set_width(style, styles->width);
+    if (styles->height != LV_SIZE_CONTENT) lv_style_set_height(style, styles->height);
+    
+    // Padding
+    if (styles->pad_top) lv_style_set_pad_top(style, styles->pad_top);
+    if (styles->pad_bottom) lv_style_set_pad_bottom(style, styles->pad_bottom);
+    if (styles->pad_left) lv_style_set_pad_left(style, styles->pad_left);
+    if (styles->pad_right) lv_style_set_pad_right(style, styles->pad_right);
+    if (styles->pad_row) lv_style_set_pad_row(style, styles->pad_row);
+    if (styles->pad_column) lv_style_set_pad_column(style, styles->pad_column);
+    
+    // Background
+    if (styles->has_bg_color) {
+        lv_style_set_bg_color(style, styles->bg_color);
+        lv_style_set_bg_opa(style, styles->bg_opa);
+    }
+    
+    // Border
+    if (styles->border_width) lv_style_set_border_width(style, styles->border_width);
+    if (styles->has_border_color) lv_style_set_border_color(style, styles->border_color);
+    if (styles->border_radius) lv_style_set_radius(style, styles->border_radius);
+    
+    // Text
+    if (styles->has_text_color) lv_style_set_text_color(style, styles->text_color);
+    if (styles->font) lv_style_set_text_font(style, styles->font);
+}
+
+tw_style_t *tw_style_acquire(const char *class_str) {
+    if (!class_str || !class_str[0]) return NULL;
+    
+    uint32_t hash = tw_hash(class_str);
+    tw_style_t **bucket = &style_buckets[hash % TW_STYLE_BUCKETS];
+    
+    for (tw_style_t *entry = *bucket; entry; entry = entry->next) {
+        if (entry->hash == hash && strcmp(entry->class_str, class_str) == 0) {
+            entry->refcount++;
+            rasen_stats.style_hits++;
+            return entry;
+        }
+    }
+    
+    // Miss: parse once and keep the result for every later user
+    rasen_stats.style_misses++;
+    size_t len = strlen(class_str);
+    tw_style_t *entry = malloc(sizeof(tw_style_t) + len + 1);
+    if (!entry) return NULL;
+    
+    RASEN_PROF_BEGIN(prof_start);
+    tw_styles_t styles;
+    tw_parse(class_str, &styles);
+    tw_build_style(&entry->style, &styles);
+    RASEN_PROF_END(RASEN_PROF_STYLE, "tw_parse", prof_start);
+    entry->hash = hash;
+    entry->refcount = 1;
+    entry->id = 0;
+    memcpy(entry->class_str, class_str, len + 1);
+    entry->next = *bucket;
+    *bucket = entry;
+    
+    return entry;
+}
+
+void tw_style_release(tw_style_t *style) {
+    if (style && style->refcount > 0) style->refcount--;
+}
+
+void tw_style_cache_trim(void) {
+    for (int i = 0; i < TW_STYLE_BUCKETS; i++) {
+        tw_style_t **link = &style_buckets[i];
+        while (*link) {
+            tw_style_t *entry = *link;
+            if (entry->refcount == 0) {
+                *link = entry->next;
+                lv_style_reset(&entry->style);
+                free(entry);
+            } else {
+                link = &entry->next;
+            }
+        }
+    }
+}
+
+// ============ Precompiled Styles ============
+
+static const uint8_t *compiled_records;
+static uint16_t compiled_count;
+static tw_style_t **compiled_styles;
+
+static const lv_flex_flow_t rec_flex_flows[] = {
+    LV_FLEX_FLOW_ROW, LV_FLEX_FLOW_COLUMN, LV_FLEX_FLOW_ROW_WRAP, LV_FLEX_FLOW_COLUMN_WRAP,
+};
+
+static const lv_flex_align_t rec_flex_aligns[] = {
+    LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_END, LV_FLEX_ALIGN_CENTER,
+    LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_SPACE_AROUND, LV_FLEX_ALIGN_SPACE_EVENLY,
+};
+
+#define REC_ENUM(table, v) ((v) < sizeof(table) / sizeof(table[0]) ? table[v] : table[0])
+
+static int16_t rec_i16(const uint8_t *p) {
+    return (int16_t)(p[0] | (p[1] << 8));
+}
+
+static lv_coord_t rec_size(uint8_t unit, int16_t value) {
+    if (unit == 1) return LV_PCT(value);
+    if (unit == 2) return LV_SIZE_CONTENT;
+    return value;
+}
+
+// Expand one record into the same structure tw_parse() produces
+static void tw_decode_record(const uint8_t *rec, tw_styles_t *styles) {
+    memset(styles, 0, sizeof(tw_styles_t));
+    
+    uint8_t flags = rec[0];
+    styles->flex = flags & TW_REC_FLEX;
+    styles->flex_flow = REC_ENUM(rec_flex_flows, rec[1]);
+    styles->justify_content = REC_ENUM(rec_flex_aligns, rec[2]);
+    styles->align_items = REC_ENUM(rec_flex_aligns, rec[3]);
+    styles->bg_opa = rec[4];
+    styles->font = font_for_size(rec[5]);
+    
+    styles->width = rec_size(rec[6], rec_i16(rec + 8));
+    styles->height = rec_size(rec[7], rec_i16(rec + 10));
+    styles->pad_top = rec_i16(rec + 12);
+    styles->pad_bottom = rec_i16(rec + 14);
+    styles->pad_left = rec_i16(rec + 16);
+    styles->pad_right = rec_i16(rec + 18);
+    styles->pad_row = rec_i16(rec + 20);
+    styles->pad_column = rec_i16(rec + 22);
+    styles->border_width = rec_i16(rec + 24);
+    int16_t radius = rec_i16(rec + 26);
+    styles->border_radius = radius == 0x7fff ? LV_RADIUS_CIRCLE : radius;
+    
+    styles->has_bg_color = flags & TW_REC_BG_COLOR;
+    styles->bg_color = lv_color_make(rec[28], rec[29], rec[30]);
+    styles->has_border_color = flags & TW_REC_BORDER_COLOR;
+    styles->border_color = lv_color_make(rec[31], rec[32], rec[33]);
+    styles->has_text_color = flags & TW_REC_TEXT_COLOR;
+    styles->text_color = lv_color_make(rec[34], rec[35], rec[36]);
+}
+
+int tw_style_table_load(const uint8_t *data, size_t len) {
+    // Live objects hold styles built from the records, looked up by id alone
+    if (compiled_records) {
+        if (data && data + TW_HEADER_SIZE == compiled_records) return 0;
+        printf("Style table: one is already loaded\n");
+        return -1;
+    }
+    if (!data || len < TW_HEADER_SIZE || memcmp(data, "RTWS", 4) != 0) {
+        printf("Style table: bad header\n");
+        return -1;
+    }
+    if (data[4] != TW_TABLE_VERSION || data[5] != TW_RECORD_SIZE) {
+        printf("Style table: unsupported version %d\n", data[4]);
+        return -1;
+    }
+    
+    uint16_t count = (uint16_t)(data[6] | (data[7] << 8));
+    if (len < TW_HEADER_SIZE + (size_t)count * TW_RECORD_SIZE) {
+        printf("Style table: truncated\n");
+        return -1;
+    }
+    
+    tw_style_t **styles = calloc(count ? count : 1, sizeof(tw_style_t *));
+    if (!styles) return -1;
+    
+    compiled_styles = styles;
+    compiled_records = data + TW_HEADER_SIZE;
+    compiled_count = count;
+    return 0;
+}
+
+// Reported once: every object with the id would log again on each render
+static void report_bad_id(uint32_t id) {
+    static bool reported_missing, reported_range;
+    if (!compiled_records) {
+        if (reported_missing) return;
+        reported_missing = true;
+        printf("Style table: none loaded for style id %u, objects left unstyled\n", (unsigned)id);
+    } else {
+        if (reported_range) return;
+        reported_range = true;
+        printf("Style table: id %u past the end (%u styles), built for another script?\n",
+               (unsigned)id, (unsigned)compiled_count);
+    }
+}
+
+tw_style_t *tw_style_acquire_compiled(uint32_t id) {
+    if (id == 0 || id > compiled_count) {
+        report_bad_id(id);
+        return NULL;
+    }
+    
+    tw_style_t *entry = compiled_styles[id - 1];
+    if (entry) {
+        rasen_stats.style_hits++;
+    } else {
+        rasen_stats.style_misses++;
+        entry = malloc(sizeof(tw_style_t) + 1);
+        if (!entry) return NULL;
+        
+        tw_styles_t styles;
+        tw_decode_record(compiled_records + (size_t)(id - 1) * TW_RECORD_SIZE, &styles);
+        tw_build_style(&entry->style, &styles);
+        entry->hash = 0;
+        entry->refcount = 0;
+        entry->id = (uint16_t)id;
+        entry->next = NULL;
+        entry->class_str[0] = '\0';
+        compiled_styles[id - 1] = entry;
+    }
+    
+    // Kept for the lifetime of the table, never trimmed
+    entry->refcount++;
+    return entry;
+}
@@ -0,0 +1,382 @@
+/**
+ * @file tw_tables.h
+ * @brief Perfect hash tables for the Tailwind parser
+ *
+ * Generated by scripts/gen-tw-tables.mjs from tw_tables.json - do not edit.
+ * 48 keywords, 244 palette colors.
+ */
+
+#ifndef TW_TABLES_H
+#define TW_TABLES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// FNV-1a with a seeded basis and a murmur3 finalizer
+static inline uint32_t tw_phash(uint32_t seed, const char *s, size_t len) {
+    uint32_t h = 0x811c9dc5u ^ (seed * 0x9e3779b9u);
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)s[i];
+        h *= 0x01000193u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+#define TW_KEYWORD_SLOTS   64
+#define TW_KEYWORD_BUCKETS 32
+
+static const uint16_t tw_keyword_disp[TW_KEYWORD_BUCKETS] = {
+    1, 2, 2, 2, 0, 1, 0, 1, 6, 0, 2, 2,
+    1, 1, 0, 2, 2, 2, 1, 0, 3, 2, 1, 0,
+    1, 3, 2, 2, 0, 10, 3, 0,
+};
+
+static const tw_keyword_t tw_keywords[TW_KEYWORD_SLOTS] = {
+    { "p", 1, TW_OP_NONE, TW_PREFIX_PAD, 0 },
+    { "pr", 2, TW_OP_NONE, TW_PREFIX_PAD_RIGHT, 0 },
+    { "gap", 3, TW_OP_NONE, TW_PREFIX_GAP, 0 },
+    { "text-3xl", 8, TW_OP_FONT, TW_PREFIX_NONE, 28 },
+    { "rounded", 7, TW_OP_RADIUS, TW_PREFIX_NONE, 4 },
+    { "flex-wrap", 9, TW_OP_FLEX_WRAP, TW_PREFIX_NONE, 0 },
+    { "justify-center", 14, TW_OP_JUSTIFY, TW_PREFIX_NONE, LV_FLEX_ALIGN_CENTER },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "text-sm", 7, TW_OP_FONT, TW_PREFIX_NONE, 14 },
+    { "flex-row", 8, TW_OP_FLEX_FLOW, TW_PREFIX_NONE, LV_FLEX_FLOW_ROW },
+    { "justify-end", 11, TW_OP_JUSTIFY, TW_PREFIX_NONE, LV_FLEX_ALIGN_END },
+    { "text-xl", 7, TW_OP_FONT, TW_PREFIX_NONE, 20 },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "size", 4, TW_OP_NONE, TW_PREFIX_SIZE, 0 },
+    { "text-xs", 7, TW_OP_FONT, TW_PREFIX_NONE, 12 },
+    { "text-base", 9, TW_OP_FONT, TW_PREFIX_NONE, 16 },
+    { "rounded-sm", 10, TW_OP_RADIUS, TW_PREFIX_NONE, 2 },
+    { "h-full", 6, TW_OP_HEIGHT_PCT, TW_PREFIX_NONE, 100 },
+    { "border", 6, TW_OP_BORDER_WIDTH, TW_PREFIX_BORDER, 1 },
+    { "h", 1, TW_OP_NONE, TW_PREFIX_HEIGHT, 0 },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "rounded-md", 10, TW_OP_RADIUS, TW_PREFIX_NONE, 6 },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "rounded-xl", 10, TW_OP_RADIUS, TW_PREFIX_NONE, 12 },
+    { "rounded-none", 12, TW_OP_RADIUS, TW_PREFIX_NONE, 0 },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "pl", 2, TW_OP_NONE, TW_PREFIX_PAD_LEFT, 0 },
+    { "rounded-lg", 10, TW_OP_RADIUS, TW_PREFIX_NONE, 8 },
+    { "px", 2, TW_OP_NONE, TW_PREFIX_PAD_X, 0 },
+    { "pt", 2, TW_OP_NONE, TW_PREFIX_PAD_TOP, 0 },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "flex", 4, TW_OP_FLEX, TW_PREFIX_NONE, 0 },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "justify-start", 13, TW_OP_JUSTIFY, TW_PREFIX_NONE, LV_FLEX_ALIGN_START },
+    { "w", 1, TW_OP_NONE, TW_PREFIX_WIDTH, 0 },
+    { "size-full", 9, TW_OP_SIZE_FULL, TW_PREFIX_NONE, 0 },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "items-center", 12, TW_OP_ITEMS, TW_PREFIX_NONE, LV_FLEX_ALIGN_CENTER },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "rounded-3xl", 11, TW_OP_RADIUS, TW_PREFIX_NONE, 24 },
+    { "text-4xl", 8, TW_OP_FONT, TW_PREFIX_NONE, 32 },
+    { "justify-around", 14, TW_OP_JUSTIFY, TW_PREFIX_NONE, LV_FLEX_ALIGN_SPACE_AROUND },
+    { "rounded-full", 12, TW_OP_RADIUS, TW_PREFIX_NONE, LV_RADIUS_CIRCLE },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "bg", 2, TW_OP_NONE, TW_PREFIX_BG, 0 },
+    { "justify-evenly", 14, TW_OP_JUSTIFY, TW_PREFIX_NONE, LV_FLEX_ALIGN_SPACE_EVENLY },
+    { "text-lg", 7, TW_OP_FONT, TW_PREFIX_NONE, 18 },
+    { "items-start", 11, TW_OP_ITEMS, TW_PREFIX_NONE, LV_FLEX_ALIGN_START },
+    { "rounded-2xl", 11, TW_OP_RADIUS, TW_PREFIX_NONE, 16 },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "items-end", 9, TW_OP_ITEMS, TW_PREFIX_NONE, LV_FLEX_ALIGN_END },
+    { "py", 2, TW_OP_NONE, TW_PREFIX_PAD_Y, 0 },
+    { "text", 4, TW_OP_NONE, TW_PREFIX_TEXT, 0 },
+    { "justify-between", 15, TW_OP_JUSTIFY, TW_PREFIX_NONE, LV_FLEX_ALIGN_SPACE_BETWEEN },
+    { "flex-col", 8, TW_OP_FLEX_FLOW, TW_PREFIX_NONE, LV_FLEX_FLOW_COLUMN },
+    { "bg-transparent", 14, TW_OP_BG_TRANSPARENT, TW_PREFIX_NONE, 0 },
+    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },
+    { "text-2xl", 8, TW_OP_FONT, TW_PREFIX_NONE, 24 },
+    { "pb", 2, TW_OP_NONE, TW_PREFIX_PAD_BOTTOM, 0 },
+    { "w-full", 6, TW_OP_WIDTH_PCT, TW_PREFIX_NONE, 100 },
+};
+
+#define TW_PALETTE_SLOTS   256
+#define TW_PALETTE_BUCKETS 128
+
+static const uint16_t tw_palette_disp[TW_PALETTE_BUCKETS] = {
+    2, 0, 1, 4, 1, 5, 6, 11, 1, 1, 7, 2,
+    6, 0, 2, 4, 1, 11, 5, 13, 6, 4, 7, 1,
+    10, 0, 1, 3, 18, 9, 2, 5, 6, 8, 0, 12,
+    28, 3, 9, 4, 5, 4, 1, 0, 3, 2, 5, 2,
+    0, 2, 2, 14, 17, 3, 1, 1, 6, 11, 1, 3,
+    5, 1, 11, 1, 8, 18, 3, 10, 21, 0, 26, 3,
+    19, 8, 5, 0, 5, 1, 0, 10, 3, 8, 13, 0,
+    4, 27, 1, 5, 2, 7, 1, 3, 2, 3, 2, 14,
+    1, 17, 1, 7, 4, 29, 7, 8, 56, 6, 3, 2,
+    0, 8, 1, 46, 2, 0, 5, 6, 2, 1, 2, 13,
+    1, 6, 9, 7, 0, 0, 2, 20,
+};
+
+static const tw_color_entry_t tw_palette[TW_PALETTE_SLOTS] = {
+    { "", 0, 0x000000 },
+    { "pink-100", 8, 0xfce7f3 },
+    { "fuchsia-700", 11, 0xa21caf },
+    { "stone-200", 9, 0xe7e5e4 },
+    { "sky-600", 7, 0x0284c7 },
+    { "rose-100", 8, 0xffe4e6 },
+    { "gray-950", 8, 0x030712 },
+    { "zinc-300", 8, 0xd4d4d8 },
+    { "sky-400", 7, 0x38bdf8 },
+    { "orange-50", 9, 0xfff7ed },
+    { "red-300", 7, 0xfca5a5 },
+    { "zinc-600", 8, 0x52525b },
+    { "black", 5, 0x000000 },
+    { "red-50", 6, 0xfef2f2 },
+    { "emerald-600", 11, 0x059669 },
+    { "gray-900", 8, 0x111827 },
+    { "indigo-900", 10, 0x312e81 },
+    { "white", 5, 0xffffff },
+    { "gray-500", 8, 0x6b7280 },
+    { "", 0, 0x000000 },
+    { "emerald-500", 11, 0x10b981 },
+    { "emerald-300", 11, 0x6ee7b7 },
+    { "neutral-700", 11, 0x404040 },
+    { "zinc-950", 8, 0x09090b },
+    { "blue-950", 8, 0x172554 },
+    { "yellow-400", 10, 0xfacc15 },
+    { "gray-800", 8, 0x1f2937 },
+    { "zinc-800", 8, 0x27272a },
+    { "violet-600", 10, 0x7c3aed },
+    { "amber-950", 9, 0x451a03 },
+    { "orange-950", 10, 0x431407 },
+    { "zinc-200", 8, 0xe4e4e7 },
+    { "zinc-400", 8, 0xa1a1aa },
+    { "yellow-600", 10, 0xca8a04 },
+    { "rose-700", 8, 0xbe123c },
+    { "orange-800", 10, 0x9a3412 },
+    { "cyan-500", 8, 0x06b6d4 },
+    { "blue-200", 8, 0xbfdbfe },
+    { "zinc-500", 8, 0x71717a },
+    { "yellow-800", 10, 0x854d0e },
+    { "pink-200", 8, 0xfbcfe8 },
+    { "zinc-100", 8, 0xf4f4f5 },
+    { "lime-50", 7, 0xf7fee7 },
+    { "fuchsia-400", 11, 0xe879f9 },
+    { "violet-400", 10, 0xa78bfa },
+    { "lime-900", 8, 0x365314 },
+    { "", 0, 0x000000 },
+    { "", 0, 0x000000 },
+    { "teal-700", 8, 0x0f766e },
+    { "rose-600", 8, 0xe11d48 },
+    { "blue-700", 8, 0x1d4ed8 },
+    { "purple-600", 10, 0x9333ea },
+    { "amber-900", 9, 0x78350f },
+    { "gray-50", 7, 0xf9fafb },
+    { "green-500", 9, 0x22c55e },
+    { "", 0, 0x000000 },
+    { "indigo-700", 10, 0x4338ca },
+    { "gray-200", 8, 0xe5e7eb },
+    { "lime-100", 8, 0xecfccb },
+    { "amber-800", 9, 0x92400e },
+    { "purple-500", 10, 0xa855f7 },
+    { "pink-400", 8, 0xf472b6 },
+    { "violet-50", 9, 0xf5f3ff },
+    { "neutral-300", 11, 0xd4d4d4 },
+    { "slate-900", 9, 0x0f172a },
+    { "stone-900", 9, 0x1c1917 },
+    { "yellow-300", 10, 0xfde047 },
+    { "cyan-900", 8, 0x164e63 },
+    { "orange-600", 10, 0xea580c },
+    { "pink-300", 8, 0xf9a8d4 },
+    { "sky-100", 7, 0xe0f2fe },
+    { "fuchsia-950", 11, 0x4a044e },
+    { "pink-900", 8, 0x831843 },
+    { "slate-100", 9, 0xf1f5f9 },
+    { "slate-500", 9, 0x64748b },
+    { "amber-300", 9, 0xfcd34d },
+    { "cyan-300", 8, 0x67e8f9 },
+    { "stone-800", 9, 0x292524 },
+    { "pink-50", 7, 0xfdf2f8 },
+    { "orange-700", 10, 0xc2410c },
+    { "fuchsia-800", 11, 0x86198f },
+    { "amber-700", 9, 0xb45309 },
+    { "red-900", 7, 0x7f1d1d },
+    { "stone-100", 9, 0xf5f5f4 },
+    { "green-300", 9, 0x86efac },
+    { "stone-600", 9, 0x57534e },
+    { "sky-950", 7, 0x082f49 },
+    { "yellow-200", 10, 0xfef08a },
+    { "fuchsia-600", 11, 0xc026d3 },
+    { "emerald-400", 11, 0x34d399 },
+    { "cyan-950", 8, 0x083344 },
+    { "red-950", 7, 0x450a0a },
+    { "sky-50", 6, 0xf0f9ff },
+    { "emerald-800", 11, 0x065f46 },
+    { "violet-200", 10, 0xddd6fe },
+    { "red-800", 7, 0x991b1b },
+    { "sky-800", 7, 0x075985 },
+    { "rose-500", 8, 0xf43f5e },
+    { "emerald-200", 11, 0xa7f3d0 },
+    { "lime-600", 8, 0x65a30d },
+    { "gray-400", 8, 0x9ca3af },
+    { "lime-950", 8, 0x1a2e05 },
+    { "lime-700", 8, 0x4d7c0f },
+    { "teal-900", 8, 0x134e4a },
+    { "lime-200", 8, 0xd9f99d },
+    { "amber-600", 9, 0xd97706 },
+    { "neutral-100", 11, 0xf5f5f5 },
+    { "cyan-700", 8, 0x0e7490 },
+    { "fuchsia-50", 10, 0xfdf4ff },
+    { "teal-500", 8, 0x14b8a6 },
+    { "lime-800", 8, 0x3f6212 },
+    { "", 0, 0x000000 },
+    { "blue-600", 8, 0x2563eb },
+    { "rose-300", 8, 0xfda4af },
+    { "gray-600", 8, 0x4b5563 },
+    { "red-600", 7, 0xdc2626 },
+    { "", 0, 0x000000 },
+    { "gray-300", 8, 0xd1d5db },
+    { "yellow-950", 10, 0x422006 },
+    { "slate-50", 8, 0xf8fafc },
+    { "red-200", 7, 0xfecaca },
+    { "emerald-950", 11, 0x022c22 },
+    { "", 0, 0x000000 },
+    { "orange-400", 10, 0xfb923c },
+    { "orange-900", 10, 0x7c2d12 },
+    { "cyan-400", 8, 0x22d3ee },
+    { "purple-700", 10, 0x7e22ce },
+    { "red-700", 7, 0xb91c1c },
+    { "emerald-50", 10, 0xecfdf5 },
+    { "blue-300", 8, 0x93c5fd },
+    { "blue-100", 8, 0xdbeafe },
+    { "violet-300", 10, 0xc4b5fd },
+    { "", 0, 0x000000 },
+    { "teal-800", 8, 0x115e59 },
+    { "rose-950", 8, 0x4c0519 },
+    { "blue-900", 8, 0x1e3a8a },
+    { "sky-700", 7, 0x0369a1 },
+    { "teal-200", 8, 0x99f6e4 },
+    { "red-100", 7, 0xfee2e2 },
+    { "blue-500", 8, 0x3b82f6 },
+    { "teal-300", 8, 0x5eead4 },
+    { "teal-400", 8, 0x2dd4bf },
+    { "teal-950", 8, 0x042f2e },
+    { "neutral-950", 11, 0x0a0a0a },
+    { "blue-400", 8, 0x60a5fa },
+    { "emerald-700", 11, 0x047857 },
+    { "green-600", 9, 0x16a34a },
+    { "green-900", 9, 0x14532d },
+    { "indigo-400", 10, 0x818cf8 },
+    { "", 0, 0x000000 },
+    { "stone-400", 9, 0xa8a29e },
+    { "yellow-50", 9, 0xfefce8 },
+    { "slate-700", 9, 0x334155 },
+    { "emerald-900", 11, 0x064e3b },
+    { "orange-100", 10, 0xffedd5 },
+    { "teal-600", 8, 0x0d9488 },
+    { "green-800", 9, 0x166534 },
+    { "yellow-900", 10, 0x713f12 },
+    { "stone-300", 9, 0xd6d3d1 },
+    { "slate-600", 9, 0x475569 },
+    { "slate-300", 9, 0xcbd5e1 },
+    { "rose-400", 8, 0xfb7185 },
+    { "slate-400", 9, 0x94a3b8 },
+    { "indigo-200", 10, 0xc7d2fe },
+    { "yellow-500", 10, 0xeab308 },
+    { "orange-200", 10, 0xfed7aa },
+    { "blue-50", 7, 0xeff6ff },
+    { "neutral-600", 11, 0x525252 },
+    { "zinc-50", 7, 0xfafafa },
+    { "purple-300", 10, 0xd8b4fe },
+    { "sky-900", 7, 0x0c4a6e },
+    { "yellow-700", 10, 0xa16207 },
+    { "rose-50", 7, 0xfff1f2 },
+    { "stone-500", 9, 0x78716c },
+    { "neutral-800", 11, 0x262626 },
+    { "neutral-900", 11, 0x171717 },
+    { "purple-50", 9, 0xfaf5ff },
+    { "violet-950", 10, 0x2e1065 },
+    { "neutral-50", 10, 0xfafafa },
+    { "indigo-100", 10, 0xe0e7ff },
+    { "sky-200", 7, 0xbae6fd },
+    { "indigo-600", 10, 0x4f46e5 },
+    { "slate-950", 9, 0x020617 },
+    { "", 0, 0x000000 },
+    { "cyan-100", 8, 0xcffafe },
+    { "pink-700", 8, 0xbe185d },
+    { "violet-100", 10, 0xede9fe },
+    { "neutral-500", 11, 0x737373 },
+    { "sky-300", 7, 0x7dd3fc },
+    { "purple-950", 10, 0x3b0764 },
+    { "indigo-950", 10, 0x1e1b4b },
+    { "red-400", 7, 0xf87171 },
+    { "pink-800", 8, 0x9d174d },
+    { "fuchsia-900", 11, 0x701a75 },
+    { "emerald-100", 11, 0xd1fae5 },
+    { "indigo-800", 10, 0x3730a3 },
+    { "purple-200", 10, 0xe9d5ff },
+    { "lime-300", 8, 0xbef264 },
+    { "violet-800", 10, 0x5b21b6 },
+    { "stone-950", 9, 0x0c0a09 },
+    { "fuchsia-100", 11, 0xfae8ff },
+    { "indigo-300", 10, 0xa5b4fc },
+    { "", 0, 0x000000 },
+    { "green-50", 8, 0xf0fdf4 },
+    { "purple-400", 10, 0xc084fc },
+    { "orange-500", 10, 0xf97316 },
+    { "fuchsia-300", 11, 0xf0abfc },
+    { "neutral-400", 11, 0xa3a3a3 },
+    { "amber-400", 9, 0xfbbf24 },
+    { "purple-900", 10, 0x581c87 },
+    { "green-700", 9, 0x15803d },
+    { "violet-500", 10, 0x8b5cf6 },
+    { "gray-700", 8, 0x374151 },
+    { "pink-500", 8, 0xec4899 },
+    { "amber-500", 9, 0xf59e0b },
+    { "rose-800", 8, 0x9f1239 },
+    { "zinc-900", 8, 0x18181b },
+    { "stone-50", 8, 0xfafaf9 },
+    { "green-950", 9, 0x052e16 },
+    { "pink-600", 8, 0xdb2777 },
+    { "gray-100", 8, 0xf3f4f6 },
+    { "lime-400", 8, 0xa3e635 },
+    { "fuchsia-200", 11, 0xf5d0fe },
+    { "purple-100", 10, 0xf3e8ff },
+    { "cyan-200", 8, 0xa5f3fc },
+    { "amber-200", 9, 0xfde68a },
+    { "rose-200", 8, 0xfecdd3 },
+    { "cyan-600", 8, 0x0891b2 },
+    { "orange-300", 10, 0xfdba74 },
+    { "red-500", 7, 0xef4444 },
+    { "green-400", 9, 0x4ade80 },
+    { "teal-50", 7, 0xf0fdfa },
+    { "rose-900", 8, 0x881337 },
+    { "fuchsia-500", 11, 0xd946ef },
+    { "amber-100", 9, 0xfef3c7 },
+    { "neutral-200", 11, 0xe5e5e5 },
+    { "indigo-50", 9, 0xeef2ff },
+    { "green-200", 9, 0xbbf7d0 },
+    { "cyan-800", 8, 0x155e75 },
+    { "purple-800", 10, 0x6b21a8 },
+    { "teal-100", 8, 0xccfbf1 },
+    { "indigo-500", 10, 0x6366f1 },
+    { "yellow-100", 10, 0xfef9c3 },
+    { "violet-900", 10, 0x4c1d95 },
+    { "zinc-700", 8, 0x3f3f46 },
+    { "slate-800", 9, 0x1e293b },
+    { "stone-700", 9, 0x44403c },
+    { "slate-200", 9, 0xe2e8f0 },
+    { "green-100", 9, 0xdcfce7 },
+    { "violet-700", 10, 0x6d28d9 },
+    { "lime-500", 8, 0x84cc16 },
+    { "cyan-50", 7, 0xecfeff },
+    { "sky-500", 7, 0x0ea5e9 },
+    { "pink-950", 8, 0x500724 },
+    { "amber-50", 8, 0xfffbeb },
+    { "blue-800", 8, 0x1e40af },
+};
+
+#endif // TW_TABLES_H
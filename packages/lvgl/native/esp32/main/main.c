@@ -7,11 +7,25 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "esp_partition.h"
+#include "esp_heap_caps.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_system.h"
+#include "esp_rom_crc.h"
+#include "nvs_flash.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_vendor.h"
 
 // LVGL
 #include "lvgl.h"
@@ -21,36 +35,150 @@
 
 // Rasen common code
 #include "qjs_rasen.h"
+#include "rasen_stats.h"
+#include "rasen_prof.h"
+#include "rasen_worker.h"
+#include "rasen_alloc.h"
+#include "rasen_img.h"
 
 static const char *TAG = "rasen-lvgl";
 
 // ============ Display Configuration ============
-// Adjust these for your specific display module
+// Set via `idf.py menuconfig` -> Rasen LVGL Display (main/Kconfig.projbuild)
 
-#define DISPLAY_WIDTH  320
-#define DISPLAY_HEIGHT 240
-#define LVGL_TICK_PERIOD_MS 2
+#define DISPLAY_WIDTH  CONFIG_RASEN_LCD_H_RES
+#define DISPLAY_HEIGHT CONFIG_RASEN_LCD_V_RES
+#define DISPLAY_BUF_LINES CONFIG_RASEN_LCD_BUF_LINES
 
-// ============ Tick Timer ============
+#define LCD_SPI_HOST ((spi_host_device_t)CONFIG_RASEN_LCD_SPI_HOST)
 
-static void lvgl_tick_task(void *arg) {
-    lv_tick_inc(LVGL_TICK_PERIOD_MS);
+// LVGL reads its tick from esp_timer_get_time() (LV_TICK_CUSTOM in
+// sdkconfig.defaults), so no periodic tick interrupt keeps the CPU awake.
+
+// ============ Main Loop Wakeups ============
+// The main task sleeps on its task notification; these bits say why it woke.
+
+#define WAKE_TOUCH  (1 << 0)  // Touch controller interrupt
+#define WAKE_RENDER (1 << 1)  // Dual-core: the JS task changed the tree
+#define WAKE_EVENT  (1 << 2)  // Dual-core: an LVGL event is queued for the JS task
+#define WAKE_WORKER (1 << 3)  // A worker posted a message for the UI context
+
+// Upper bound on one sleep, so a missed wakeup can never stall the UI
+#define MAX_IDLE_MS 1000
+
+static TaskHandle_t main_task_handle = NULL;
+
+static void IRAM_ATTR wake_main_task_from_isr(uint32_t bits) {
+    BaseType_t woken = pdFALSE;
+    if (main_task_handle) {
+        xTaskNotifyFromISR(main_task_handle, bits, eSetBits, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
 }
 
 // ============ Display Driver ============
 
 static lv_disp_draw_buf_t draw_buf;
 static lv_color_t *buf1 = NULL;
+static lv_color_t *buf2 = NULL;
 static lv_disp_drv_t disp_drv;
+static esp_lcd_panel_handle_t panel_handle = NULL;
+static int64_t flush_start_us = 0;  // LVGL waits for each flush, so one is in flight at most
+
+// Flush time from the ISR, folded into rasen_stats by the render loop: the
+// 64-bit counter can't be updated atomically, and the JS task reads it
+static portMUX_TYPE flush_time_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t flush_isr_us = 0;
+
+// Called from the SPI transfer-done ISR: the buffer is free for LVGL again
+static bool lcd_trans_done_cb(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx) {
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - flush_start_us);
+    portENTER_CRITICAL_ISR(&flush_time_lock);
+    flush_isr_us += elapsed;
+    portEXIT_CRITICAL_ISR(&flush_time_lock);
+    lv_disp_flush_ready((lv_disp_drv_t *)user_ctx);
+    return false;
+}
+
+// Render loop only, after lv_timer_handler() (under the LVGL lock in dual-core mode)
+static void fold_flush_time(void) {
+    portENTER_CRITICAL(&flush_time_lock);
+    uint32_t us = flush_isr_us;
+    flush_isr_us = 0;
+    portEXIT_CRITICAL(&flush_time_lock);
+    rasen_stats.time_us[RASEN_TIME_FLUSH] += us;
+}
 
-// Placeholder flush callback - replace with your display driver
+// Queues the DMA transfer and returns; with two buffers LVGL keeps
+// rendering into the other one while this stripe is on the bus
 static void disp_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p) {
-    // TODO: Implement actual display flush for your hardware
-    // Example for SPI display:
-    // esp_lcd_panel_draw_bitmap(panel_handle, area->x1, area->y1, 
-    //                           area->x2 + 1, area->y2 + 1, color_p);
+    RASEN_PROF_BEGIN(prof_start);
+    flush_start_us = esp_timer_get_time();
+    esp_lcd_panel_draw_bitmap(panel_handle, area->x1, area->y1,
+                              area->x2 + 1, area->y2 + 1, color_p);
+    // The trace shows queueing the stripe; the bus time overlaps rendering
+    RASEN_PROF_END(RASEN_PROF_FLUSH, "flush", prof_start);
+}
+
+static void lcd_init_panel(void) {
+    ESP_LOGI(TAG, "Initializing ST7789 panel...");
+    
+    if (CONFIG_RASEN_LCD_PIN_BL >= 0) {
+        gpio_config_t bl_config = {
+            .mode = GPIO_MODE_OUTPUT,
+            .pin_bit_mask = 1ULL << CONFIG_RASEN_LCD_PIN_BL,
+        };
+        ESP_ERROR_CHECK(gpio_config(&bl_config));
+        gpio_set_level(CONFIG_RASEN_LCD_PIN_BL, 0);
+    }
+    
+    spi_bus_config_t bus_config = {
+        .sclk_io_num = CONFIG_RASEN_LCD_PIN_SCLK,
+        .mosi_io_num = CONFIG_RASEN_LCD_PIN_MOSI,
+        .miso_io_num = -1,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = DISPLAY_WIDTH * DISPLAY_BUF_LINES * sizeof(lv_color_t),
+    };
+    ESP_ERROR_CHECK(spi_bus_initialize(LCD_SPI_HOST, &bus_config, SPI_DMA_CH_AUTO));
+    
+    esp_lcd_panel_io_handle_t io_handle = NULL;
+    esp_lcd_panel_io_spi_config_t io_config = {
+        .dc_gpio_num = CONFIG_RASEN_LCD_PIN_DC,
+        .cs_gpio_num = CONFIG_RASEN_LCD_PIN_CS,
+        .pclk_hz = CONFIG_RASEN_LCD_PIXEL_CLOCK_HZ,
+        .lcd_cmd_bits = 8,
+        .lcd_param_bits = 8,
+        .spi_mode = 0,
+        // Room for both buffers' transfers to be queued at once
+        .trans_queue_depth = 10,
+        .on_color_trans_done = lcd_trans_done_cb,
+        .user_ctx = &disp_drv,
+    };
+    ESP_ERROR_CHECK(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)LCD_SPI_HOST, &io_config, &io_handle));
+    
+    esp_lcd_panel_dev_config_t panel_config = {
+        .reset_gpio_num = CONFIG_RASEN_LCD_PIN_RST,
+        .rgb_ele_order = LCD_RGB_ELEMENT_ORDER_RGB,
+        .bits_per_pixel = 16,
+    };
+    ESP_ERROR_CHECK(esp_lcd_new_panel_st7789(io_handle, &panel_config, &panel_handle));
     
-    lv_disp_flush_ready(drv);
+    ESP_ERROR_CHECK(esp_lcd_panel_reset(panel_handle));
+    ESP_ERROR_CHECK(esp_lcd_panel_init(panel_handle));
+#if CONFIG_RASEN_LCD_INVERT_COLOR
+    ESP_ERROR_CHECK(esp_lcd_panel_invert_color(panel_handle, true));
+#endif
+#if CONFIG_RASEN_LCD_SWAP_XY
+    ESP_ERROR_CHECK(esp_lcd_panel_swap_xy(panel_handle, true));
+#endif
+    ESP_ERROR_CHECK(esp_lcd_panel_mirror(panel_handle,
+                                         CONFIG_RASEN_LCD_MIRROR_X, CONFIG_RASEN_LCD_MIRROR_Y));
+    ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(panel_handle, true));
+    
+    if (CONFIG_RASEN_LCD_PIN_BL >= 0) {
+        gpio_set_level(CONFIG_RASEN_LCD_PIN_BL, 1);
+    }
 }
 
 // ============ Input Driver ============
@@ -58,29 +186,66 @@ static void disp_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t
 // Touch input state
 static bool touch_pressed = false;
 static int16_t touch_x = 0, touch_y = 0;
+static lv_indev_t *touch_indev = NULL;
 
 static void touch_read_cb(lv_indev_drv_t *drv, lv_indev_data_t *data) {
     // TODO: Read from your touch controller (CST816, GT911, etc.)
     data->point.x = touch_x;
     data->point.y = touch_y;
     data->state = touch_pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    
+#if CONFIG_RASEN_TOUCH_PIN_INT >= 0
+    // With an interrupt line there is nothing to poll between touches;
+    // the ISR resumes this timer on the next press
+    if (!touch_pressed) {
+        lv_timer_pause(drv->read_timer);
+    }
+#endif
+}
+
+#if CONFIG_RASEN_TOUCH_PIN_INT >= 0
+static void IRAM_ATTR touch_isr(void *arg) {
+    wake_main_task_from_isr(WAKE_TOUCH);
 }
 
+static void touch_init_irq(void) {
+    gpio_config_t int_config = {
+        .mode = GPIO_MODE_INPUT,
+        .pin_bit_mask = 1ULL << CONFIG_RASEN_TOUCH_PIN_INT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .intr_type = GPIO_INTR_NEGEDGE,
+    };
+    ESP_ERROR_CHECK(gpio_config(&int_config));
+    ESP_ERROR_CHECK(gpio_install_isr_service(0));
+    ESP_ERROR_CHECK(gpio_isr_handler_add(CONFIG_RASEN_TOUCH_PIN_INT, touch_isr, NULL));
+}
+#endif
+
 // ============ LVGL Initialization ============
 
 static void lvgl_init_display(void) {
     ESP_LOGI(TAG, "Initializing LVGL...");
     
     lv_init();
+    lcd_init_panel();
     
-    // Allocate draw buffers
-    buf1 = heap_caps_malloc(DISPLAY_WIDTH * 40 * sizeof(lv_color_t), MALLOC_CAP_DMA);
+    // Allocate DMA-capable draw buffers
+    size_t buf_pixels = DISPLAY_WIDTH * DISPLAY_BUF_LINES;
+    buf1 = heap_caps_malloc(buf_pixels * sizeof(lv_color_t), MALLOC_CAP_DMA);
     if (!buf1) {
         ESP_LOGE(TAG, "Failed to allocate LVGL buffer");
         return;
     }
+#if CONFIG_RASEN_LCD_DOUBLE_BUFFER
+    buf2 = heap_caps_malloc(buf_pixels * sizeof(lv_color_t), MALLOC_CAP_DMA);
+    if (!buf2) {
+        ESP_LOGW(TAG, "No room for a second draw buffer, flushing single-buffered");
+    }
+#endif
     
-    lv_disp_draw_buf_init(&draw_buf, buf1, NULL, DISPLAY_WIDTH * 40);
+    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, buf_pixels);
+    ESP_LOGI(TAG, "Draw buffers: %d x %u bytes", buf2 ? 2 : 1,
+             (unsigned)(buf_pixels * sizeof(lv_color_t)));
     
     // Initialize display driver
     lv_disp_drv_init(&disp_drv);
@@ -95,20 +260,74 @@ static void lvgl_init_display(void) {
     lv_indev_drv_init(&indev_drv);
     indev_drv.type = LV_INDEV_TYPE_POINTER;
     indev_drv.read_cb = touch_read_cb;
-    lv_indev_drv_register(&indev_drv);
-    
-    // Create tick timer
-    const esp_timer_create_args_t tick_timer_args = {
-        .callback = &lvgl_tick_task,
-        .name = "lvgl_tick"
-    };
-    esp_timer_handle_t tick_timer = NULL;
-    ESP_ERROR_CHECK(esp_timer_create(&tick_timer_args, &tick_timer));
-    ESP_ERROR_CHECK(esp_timer_start_periodic(tick_timer, LVGL_TICK_PERIOD_MS * 1000));
+    touch_indev = lv_indev_drv_register(&indev_drv);
+#if CONFIG_RASEN_TOUCH_PIN_INT >= 0
+    touch_init_irq();
+#endif
     
     ESP_LOGI(TAG, "LVGL initialized");
 }
 
+// ============ Prebuilt App ============
+// Files from main/app/ linked into flash by CMakeLists.txt
+
+#ifdef RASEN_RUNTIME_BYTECODE
+extern const uint8_t rasen_runtime_qjsbc_start[] asm("_binary_rasen_runtime_qjsbc_start");
+extern const uint8_t rasen_runtime_qjsbc_end[] asm("_binary_rasen_runtime_qjsbc_end");
+#endif
+
+#ifdef RASEN_APP_BYTECODE
+extern const uint8_t app_qjsbc_start[] asm("_binary_app_qjsbc_start");
+extern const uint8_t app_qjsbc_end[] asm("_binary_app_qjsbc_end");
+#endif
+
+#ifdef RASEN_APP_STYLES
+extern const uint8_t app_tws_start[] asm("_binary_app_tws_start");
+extern const uint8_t app_tws_end[] asm("_binary_app_tws_end");
+#endif
+
+#ifdef RASEN_APP_IMAGES
+extern const uint8_t app_rimg_start[] asm("_binary_app_rimg_start");
+extern const uint8_t app_rimg_end[] asm("_binary_app_rimg_end");
+#endif
+
+// ============ App Partition ============
+// Image from `rasen-lvgl build` flashed to the rasen_app partition
+// (see partitions.csv). It is mapped into the address space and run in
+// place, so the script never gets copied into SRAM.
+
+#define RASEN_APP_PARTITION "rasen_app"
+
+static const void *app_image = NULL;
+static size_t app_image_size = 0;
+
+static bool map_app_partition(void) {
+    const esp_partition_t *part = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, RASEN_APP_PARTITION);
+    if (!part) {
+        return false;
+    }
+    
+    const void *ptr = NULL;
+    esp_partition_mmap_handle_t handle;
+    if (esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, &ptr, &handle) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to map %s partition", RASEN_APP_PARTITION);
+        return false;
+    }
+    
+    // Erased flash reads as 0xFF, so an unflashed partition has no magic
+    if (memcmp(ptr, "RSNA", 4) != 0) {
+        esp_partition_munmap(handle);
+        return false;
+    }
+    
+    // Stays mapped: bytecode and styles are read from it for the app's lifetime
+    app_image = ptr;
+    app_image_size = part->size;
+    ESP_LOGI(TAG, "Mapped app image from %s (%lu bytes)", RASEN_APP_PARTITION, (unsigned long)part->size);
+    return true;
+}
+
 // ============ QuickJS Runtime ============
 
 static JSRuntime *js_rt = NULL;
@@ -117,7 +336,8 @@ static JSContext *js_ctx = NULL;
 static void quickjs_init(void) {
     ESP_LOGI(TAG, "Initializing QuickJS...");
     
-    js_rt = JS_NewRuntime();
+    // Size-class pools absorb the per-render descriptor garbage
+    js_rt = rasen_alloc_new_runtime();
     if (!js_rt) {
         ESP_LOGE(TAG, "Failed to create JS runtime");
         return;
@@ -126,14 +346,20 @@ static void quickjs_init(void) {
     // Limit memory for embedded use
     JS_SetMemoryLimit(js_rt, 256 * 1024);  // 256KB
     
-    js_ctx = JS_NewContext(js_rt);
+    js_ctx = qjs_rasen_new_context(js_rt);
     if (!js_ctx) {
         ESP_LOGE(TAG, "Failed to create JS context");
         return;
     }
     
     // Initialize Rasen bindings (from common/)
-    if (qjs_rasen_init(js_ctx) != 0) {
+#ifdef RASEN_RUNTIME_BYTECODE
+    int ret = qjs_rasen_init_bytecode(js_ctx, rasen_runtime_qjsbc_start,
+                                      rasen_runtime_qjsbc_end - rasen_runtime_qjsbc_start);
+#else
+    int ret = qjs_rasen_init(js_ctx);
+#endif
+    if (ret != 0) {
         ESP_LOGE(TAG, "Failed to init Rasen bindings");
         return;
     }
@@ -141,8 +367,159 @@ static void quickjs_init(void) {
     ESP_LOGI(TAG, "QuickJS initialized");
 }
 
+// ============ Profiling ============
+// With CONFIG_RASEN_PROFILE, profile(false) prints the trace to the console
+// between marker lines; analyze-trace.js reads a saved log directly.
+
+#if CONFIG_RASEN_PROFILE
+#if !CONFIG_RASEN_DUAL_CORE && !CONFIG_PM_ENABLE
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+
+// CPU cycle counter widened to 64 bits; it wraps every ~18 s at 240 MHz, and
+// the main loop reads it at least every MAX_IDLE_MS
+static uint64_t profile_clock(void) {
+    static uint32_t last = 0;
+    static uint64_t high = 0;
+    uint32_t now = esp_cpu_get_cycle_count();
+    if (now < last) {
+        high += 1ULL << 32;
+    }
+    last = now;
+    return high | now;
+}
+#define PROFILE_TICKS_PER_SEC ((uint64_t)esp_rom_get_cpu_ticks_per_us() * 1000000ULL)
+#else
+// The two cores' cycle counters aren't in step, and frequency scaling
+// changes their rate, so use the system timer
+static uint64_t profile_clock(void) {
+    return (uint64_t)esp_timer_get_time();
+}
+#define PROFILE_TICKS_PER_SEC 1000000ULL
+#endif
+
+static void profile_print(const char *data, size_t len, void *user) {
+    fwrite(data, 1, len, stdout);
+}
+
+static void profile_dump(void) {
+    printf("\n----- rasen trace begin -----\n");
+    rasen_prof_write(profile_print, NULL);
+    printf("----- rasen trace end -----\n");
+    fflush(stdout);
+}
+
+static void profile_init(void) {
+    rasen_prof_set_clock(profile_clock, PROFILE_TICKS_PER_SEC);
+    rasen_prof_set_dump(profile_dump);
+#if CONFIG_RASEN_PROFILE_AT_BOOT
+    if (js_ctx && qjs_rasen_profile(js_ctx, true) == 0) {
+        ESP_LOGI(TAG, "Profiling; call profile(false) to print the trace");
+    }
+#endif
+}
+#endif
+
+// ============ Deep Sleep ============
+// deepSleep(ms) in the script snapshots the persist() refs and powers
+// down. Small snapshots stay in RTC slow memory, which survives deep sleep
+// and starts zeroed after a power cycle; larger ones go to NVS. On wake
+// the snapshot is restored before the app runs, so the first mount shows
+// the saved state straight from the mapped bytecode.
+
+#define SNAPSHOT_NVS_NAMESPACE "rasen"
+#define SNAPSHOT_NVS_KEY "snapshot"
+
+RTC_DATA_ATTR static uint32_t rtc_snapshot_len;
+RTC_DATA_ATTR static uint32_t rtc_snapshot_crc;
+RTC_DATA_ATTR static uint8_t rtc_snapshot[CONFIG_RASEN_SNAPSHOT_RTC_SIZE];
+// Set only when this sleep's snapshot went to NVS, so a blob left there by
+// an earlier sleep is never restored. RTC memory is intact on every
+// deep-sleep wake, and only those restore.
+RTC_DATA_ATTR static bool rtc_snapshot_in_nvs;
+
+static void save_snapshot(void) {
+    uint8_t *buf;
+    size_t len;
+    rtc_snapshot_len = 0;
+    rtc_snapshot_in_nvs = false;
+    if (qjs_rasen_snapshot(js_ctx, &buf, &len) != 0) {
+        return;
+    }
+    
+    if (len <= sizeof(rtc_snapshot)) {
+        memcpy(rtc_snapshot, buf, len);
+        rtc_snapshot_len = len;
+        rtc_snapshot_crc = esp_rom_crc32_le(0, buf, len);
+    } else {
+        // Flash writes wear the sector; only taken when RTC memory is too small
+        nvs_handle_t nvs;
+        if (nvs_flash_init() == ESP_OK && nvs_open(SNAPSHOT_NVS_NAMESPACE, NVS_READWRITE, &nvs) == ESP_OK) {
+            if (nvs_set_blob(nvs, SNAPSHOT_NVS_KEY, buf, len) == ESP_OK && nvs_commit(nvs) == ESP_OK) {
+                rtc_snapshot_in_nvs = true;
+            }
+            nvs_close(nvs);
+        }
+        if (!rtc_snapshot_in_nvs) {
+            ESP_LOGE(TAG, "Failed to store %u-byte snapshot", (unsigned)len);
+        }
+    }
+    js_free(js_ctx, buf);
+}
+
+static void restore_snapshot(void) {
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP) {
+        return;
+    }
+    
+    if (rtc_snapshot_len && rtc_snapshot_len <= sizeof(rtc_snapshot) &&
+        esp_rom_crc32_le(0, rtc_snapshot, rtc_snapshot_len) == rtc_snapshot_crc) {
+        qjs_rasen_restore(js_ctx, rtc_snapshot, rtc_snapshot_len);
+        return;
+    }
+    if (!rtc_snapshot_in_nvs) {
+        return;
+    }
+    
+    nvs_handle_t nvs;
+    size_t len = 0;
+    if (nvs_flash_init() != ESP_OK || nvs_open(SNAPSHOT_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return;
+    }
+    if (nvs_get_blob(nvs, SNAPSHOT_NVS_KEY, NULL, &len) == ESP_OK && len > 0) {
+        uint8_t *buf = malloc(len);
+        if (buf && nvs_get_blob(nvs, SNAPSHOT_NVS_KEY, buf, &len) == ESP_OK) {
+            qjs_rasen_restore(js_ctx, buf, len);
+        }
+        free(buf);
+    }
+    nvs_close(nvs);
+}
+
+static void enter_deep_sleep(uint32_t ms) {
+    ESP_LOGI(TAG, "Deep sleep (%lu ms)", (unsigned long)ms);
+    save_snapshot();
+    
+    if (ms > 0) {
+        esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+    }
+#if CONFIG_RASEN_TOUCH_PIN_INT >= 0 && SOC_PM_SUPPORT_EXT0_WAKEUP
+    // The touch controller pulls its interrupt line low on a press
+    esp_sleep_enable_ext0_wakeup((gpio_num_t)CONFIG_RASEN_TOUCH_PIN_INT, 0);
+#endif
+    esp_deep_sleep_start();
+}
+
+static void handle_sleep_request(void) {
+    uint32_t ms;
+    if (js_ctx && qjs_rasen_take_sleep_request(&ms)) {
+        enter_deep_sleep(ms);
+    }
+}
+
 // ============ Example Application ============
 
+#ifndef RASEN_APP_BYTECODE
 // Simple counter app (normally loaded from filesystem or OTA)
 static const char *example_app = 
 "const { ref, div, label, button, run } = __modules['@rasenjs/lvgl'];\n"
@@ -177,38 +554,243 @@ static const char *example_app =
 "}\n"
 "\n"
 "run(App);\n";
+#endif
+
+// ============ App Startup ============
+
+#if CONFIG_RASEN_DUAL_CORE
+static SemaphoreHandle_t lvgl_mutex = NULL;
+
+static void lvgl_lock(void) {
+    xSemaphoreTakeRecursive(lvgl_mutex, portMAX_DELAY);
+}
+
+static void lvgl_unlock(void) {
+    xSemaphoreGiveRecursive(lvgl_mutex);
+}
+#else
+// JS and LVGL share the main task
+static void lvgl_lock(void) {}
+static void lvgl_unlock(void) {}
+#endif
+
+// Takes the LVGL lock only for its own LVGL calls; script evaluation and
+// the first mount lock around each patch, so the LVGL task keeps running
+static void render_app(void) {
+    if (!js_ctx) {
+        return;
+    }
+    
+    ESP_LOGI(TAG, "Rendering application...");
+    restore_snapshot();
+    lvgl_lock();
+    lv_obj_t *screen = lv_scr_act();
+    lvgl_unlock();
+    if (map_app_partition()) {
+        qjs_rasen_render_mapped(js_ctx, app_image, app_image_size, screen);
+    } else {
+        // Fall back to the app linked into the firmware
+        lvgl_lock();
+#ifdef RASEN_APP_STYLES
+        tw_style_table_load(app_tws_start, app_tws_end - app_tws_start);
+#endif
+#ifdef RASEN_APP_IMAGES
+        rasen_img_table_load(app_rimg_start, app_rimg_end - app_rimg_start);
+#endif
+        lvgl_unlock();
+#ifdef RASEN_APP_BYTECODE
+        qjs_rasen_render_bytecode(js_ctx, app_qjsbc_start, app_qjsbc_end - app_qjsbc_start, screen);
+#else
+        qjs_rasen_render(js_ctx, example_app, screen);
+#endif
+    }
+}
+
+#if CONFIG_RASEN_STATS_INTERVAL_MS > 0
+static int64_t next_stats_us = 0;
+
+static void log_stats_if_due(void) {
+    int64_t now = esp_timer_get_time();
+    if (!next_stats_us) {
+        next_stats_us = now + CONFIG_RASEN_STATS_INTERVAL_MS * 1000LL;
+    } else if (now >= next_stats_us) {
+        char line[256];
+        rasen_stats_format_line(js_rt, line, sizeof(line));
+        ESP_LOGI(TAG, "stats %s", line);
+        next_stats_us += CONFIG_RASEN_STATS_INTERVAL_MS * 1000LL;
+    }
+}
+#endif
+
+// Block on the task notification for at most idle_ms; returns the wake bits
+static uint32_t wait_for_wake(uint32_t idle_ms) {
+    if (idle_ms > MAX_IDLE_MS) {
+        idle_ms = MAX_IDLE_MS;
+    }
+    
+    TickType_t ticks = pdMS_TO_TICKS(idle_ms);
+    if (ticks == 0 && idle_ms > 0) {
+        ticks = 1;
+    }
+    
+    uint32_t wake = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &wake, ticks);
+    return wake;
+}
+
+static void handle_touch_wake(uint32_t wake) {
+    if ((wake & WAKE_TOUCH) && touch_indev) {
+        // Read the new touch immediately instead of at the next poll
+        lv_timer_resume(touch_indev->driver->read_timer);
+        lv_timer_ready(touch_indev->driver->read_timer);
+    }
+}
+
+#if CONFIG_RASEN_DUAL_CORE
+
+// ============ Dual-Core Mode ============
+// The main task (core 0) only renders: lv_timer_handler(), input and flush.
+// The JS task (core 1) runs handlers, effects and describe/encode, and holds
+// the LVGL lock only while patching the tree (see qjs_rasen_set_threading).
+
+static TaskHandle_t js_task_handle = NULL;
+
+static void wake_js_task(void) {
+    if (js_task_handle) {
+        xTaskNotify(js_task_handle, WAKE_EVENT, eSetBits);
+    }
+}
+
+static void wake_main_task(void) {
+    xTaskNotify(main_task_handle, WAKE_RENDER, eSetBits);
+}
+
+static void js_task(void *pvParameters) {
+    quickjs_init();
+#if CONFIG_RASEN_PROFILE
+    profile_init();
+#endif
+    
+    render_app();
+    wake_main_task();
+    
+    while (1) {
+        if (js_ctx) {
+            qjs_rasen_process_events(js_ctx);
+        }
+        handle_sleep_request();
+        
+#if CONFIG_RASEN_STATS_INTERVAL_MS > 0
+        // QuickJS usage may only be sampled here; the LVGL heap under the lock
+        lvgl_lock();
+        log_stats_if_due();
+        lvgl_unlock();
+#endif
+        
+        uint32_t idle_ms = js_ctx ? qjs_rasen_next_work_ms(js_ctx) : UINT32_MAX;
+        if (idle_ms > 0) {
+            if (js_ctx) {
+                qjs_rasen_idle(js_ctx, idle_ms);
+            }
+            wait_for_wake(idle_ms);
+        }
+    }
+}
+
+static void main_task(void *pvParameters) {
+    lvgl_init_display();
+    
+    lvgl_mutex = xSemaphoreCreateRecursiveMutex();
+    const qjs_rasen_threading_t hooks = {
+        .lock = lvgl_lock,
+        .unlock = lvgl_unlock,
+        .wake_js = wake_js_task,
+        .wake_lvgl = wake_main_task,
+    };
+    qjs_rasen_set_threading(&hooks);
+    rasen_worker_set_wake(wake_js_task);
+    
+    xTaskCreatePinnedToCore(js_task, "js", CONFIG_RASEN_JS_TASK_STACK, NULL, 5, &js_task_handle, 1);
+    
+    uint32_t wake = 0;
+    while (1) {
+        // JS runs on the other core; all of this is LVGL time
+        lvgl_lock();
+        handle_touch_wake(wake);
+        uint64_t start = rasen_stats_now_us();
+        uint32_t idle_ms = rasen_prof_timer_handler();
+        rasen_stats_add_time(RASEN_TIME_LVGL, start);
+        fold_flush_time();
+        lvgl_unlock();
+        
+        wake = wait_for_wake(idle_ms);
+    }
+}
+
+#else
 
 // ============ Main Task ============
 
+// Called from worker tasks after they post a message
+static void wake_for_worker(void) {
+    xTaskNotify(main_task_handle, WAKE_WORKER, eSetBits);
+}
+
 static void main_task(void *pvParameters) {
     // Initialize LVGL
     lvgl_init_display();
+    rasen_worker_set_wake(wake_for_worker);
     
     // Initialize QuickJS
     quickjs_init();
+#if CONFIG_RASEN_PROFILE
+    profile_init();
+#endif
     
     // Render the app
-    if (js_ctx) {
-        ESP_LOGI(TAG, "Rendering application...");
-        lv_obj_t *screen = lv_scr_act();
-        qjs_rasen_render(js_ctx, example_app, screen);
-    }
+    render_app();
     
-    // Main loop
+    // Main loop: run due work, then block until the next LVGL timer, a touch
+    // interrupt or queued JS work, whichever comes first
     while (1) {
         // Process JS events
         if (js_ctx) {
             qjs_rasen_process_events(js_ctx);
         }
+        handle_sleep_request();
         
-        // Run LVGL handler
-        lv_timer_handler();
+        // Run LVGL handler; returns the time until its next timer
+        rasen_stats_lvgl_begin();
+        uint32_t idle_ms = rasen_prof_timer_handler();
+        rasen_stats_lvgl_end();
+        fold_flush_time();
         
-        // Small delay
-        vTaskDelay(pdMS_TO_TICKS(10));
+#if CONFIG_RASEN_STATS_INTERVAL_MS > 0
+        log_stats_if_due();
+#endif
+        
+        // Scheduled JS frames (coalesced rerenders) wake the loop like timers
+        if (js_ctx) {
+            uint32_t js_ms = qjs_rasen_next_work_ms(js_ctx);
+            if (js_ms == 0) {
+                continue;
+            }
+            if (js_ms < idle_ms) {
+                idle_ms = js_ms;
+            }
+        }
+        
+        // Collect cycles now rather than in the middle of the next frame
+        if (js_ctx) {
+            qjs_rasen_idle(js_ctx, idle_ms);
+        }
+        
+        handle_touch_wake(wait_for_wake(idle_ms));
     }
 }
 
+#endif // CONFIG_RASEN_DUAL_CORE
+
 // ============ Entry Point ============
 
 void app_main(void) {
@@ -218,6 +800,21 @@ void app_main(void) {
     ESP_LOGI(TAG, "=================================");
     ESP_LOGI(TAG, "Free heap: %lu bytes", esp_get_free_heap_size());
     
+#if CONFIG_PM_ENABLE
+    // Let the idle task light-sleep while the main loop is blocked
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = 40,
+        .light_sleep_enable = true,
+    };
+    ESP_ERROR_CHECK(esp_pm_configure(&pm_config));
+#endif
+    
     // Create main task with sufficient stack
-    xTaskCreate(main_task, "main", 8192, NULL, 5, NULL);
+#if CONFIG_RASEN_DUAL_CORE
+    // Rendering stays on core 0; main_task starts the JS task on core 1
+    xTaskCreatePinnedToCore(main_task, "lvgl", 8192, NULL, 5, &main_task_handle, 0);
+#else
+    xTaskCreate(main_task, "main", 8192, NULL, 5, &main_task_handle);
+#endif
 }
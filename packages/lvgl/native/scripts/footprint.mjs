@@ -0,0 +1,179 @@
+#!/usr/bin/env node
+/**
+ * Flash and RAM footprint per component from a GNU ld map file
+ *
+ * Sums the input sections the linker kept (discarded ones are listed
+ * separately in the map and skipped) by archive: liblvgl.a, libmain.a,
+ * libqjs.a and so on. The component holding the Rasen runtime is also
+ * broken down per object file, so QuickJS, the reconciler and the
+ * Tailwind parser show up on their own lines.
+ *
+ * Flash counts code, read-only data and the initial values of .data;
+ * RAM counts .data, .bss and code placed in IRAM.
+ *
+ * Run with: node scripts/footprint.mjs <file.map> [--expand name] [--top n] [--json]
+ * or through the `footprint` build target (ESP32 and simulator).
+ */
+
+import { readFileSync } from 'fs'
+import { basename } from 'path'
+
+// Output sections never loaded on the target
+const IGNORED = /debug|comment|note|stab|xtensa\.info|dummy|heap_start|_end$|\.gnu\.|attributes/
+
+function sectionKind(name) {
+  if (IGNORED.test(name)) return null
+  if (/bss|noinit/.test(name)) return 'bss'
+  if (/iram|vectors|rtc\.text|data/.test(name)) return 'data'
+  if (/text|rodata|appdesc|eh_frame|init_array|fini_array|ctors|dtors|got|plt/.test(name)) return 'flash'
+  return null
+}
+
+// "esp-idf/main/libmain.a(qjs_rasen.c.obj)" -> ["main", "qjs_rasen.c"]
+function owner(file) {
+  const member = file.match(/(?:^|[/\\])lib([^/\\()]+)\.a\((.+)\)$/)
+  if (member) return [member[1], member[2].replace(/\.(obj|o)$/, '')]
+
+  const object = basename(file).replace(/\.(obj|o)$/, '')
+  const target = file.match(/CMakeFiles[/\\](.+?)\.dir[/\\]/)
+  return [target ? target[1] : object, object]
+}
+
+function parseMap(text) {
+  const components = new Map()
+  const start = text.indexOf('Linker script and memory map')
+  const lines = (start >= 0 ? text.slice(start) : text).split(/\r?\n/)
+
+  let output = null
+  let pending = null
+
+  function add(file, size) {
+    const kind = sectionKind(output || '')
+    if (!kind || size === 0) return
+    const [comp, object] = owner(file.trim())
+
+    let c = components.get(comp)
+    if (!c) {
+      c = { name: comp, flash: 0, ram: 0, objects: new Map() }
+      components.set(comp, c)
+    }
+    let o = c.objects.get(object)
+    if (!o) {
+      o = { name: object, flash: 0, ram: 0 }
+      c.objects.set(object, o)
+    }
+    for (const entry of [c, o]) {
+      if (kind !== 'bss') entry.flash += size
+      if (kind !== 'flash') entry.ram += size
+    }
+  }
+
+  for (const line of lines) {
+    let m
+    if ((m = line.match(/^(\.\S+)/))) {
+      // Output section, e.g. ".flash.text     0x400d0020   0x5a3b0"
+      output = m[1]
+      pending = null
+    } else if ((m = line.match(/^ (\.\S+|COMMON)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$/i))) {
+      add(m[4], parseInt(m[3], 16))
+      pending = null
+    } else if ((m = line.match(/^ (\.\S+|COMMON)\s*$/))) {
+      // Long input section names continue on the next line
+      pending = m[1]
+    } else if (pending && (m = line.match(/^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$/i))) {
+      add(m[3], parseInt(m[2], 16))
+      pending = null
+    } else {
+      pending = null
+    }
+  }
+  return [...components.values()].sort((a, b) => b.flash - a.flash)
+}
+
+function kb(bytes) {
+  return `${(bytes / 1024).toFixed(1)} KB`.padStart(10)
+}
+
+function printTable(components, { expand, top }) {
+  const total = { flash: 0, ram: 0 }
+  components.forEach((c) => {
+    total.flash += c.flash
+    total.ram += c.ram
+  })
+
+  console.log(`${'Component'.padEnd(28)}${'Flash'.padStart(10)}${'RAM'.padStart(10)}`)
+  components.slice(0, top).forEach((c) => {
+    console.log(`${c.name.padEnd(28)}${kb(c.flash)}${kb(c.ram)}`)
+    if (!expand.has(c.name)) return
+    const objects = [...c.objects.values()].sort((a, b) => b.flash - a.flash)
+    objects.slice(0, top).forEach((o) => {
+      console.log(`  ${o.name.padEnd(26)}${kb(o.flash)}${kb(o.ram)}`)
+    })
+  })
+
+  const rest = components.slice(top)
+  if (rest.length) {
+    const flash = rest.reduce((n, c) => n + c.flash, 0)
+    const ram = rest.reduce((n, c) => n + c.ram, 0)
+    console.log(`${`(${rest.length} more)`.padEnd(28)}${kb(flash)}${kb(ram)}`)
+  }
+  console.log(`${'Total'.padEnd(28)}${kb(total.flash)}${kb(total.ram)}`)
+}
+
+function main() {
+  const args = process.argv.slice(2)
+  let mapFile = null
+  let top = 20
+  let json = false
+  const expand = new Set()
+
+  for (let i = 0; i < args.length; i++) {
+    if (args[i] === '--expand') {
+      expand.add(args[++i])
+    } else if (args[i] === '--top') {
+      top = parseInt(args[++i], 10) || top
+    } else if (args[i] === '--json') {
+      json = true
+    } else {
+      mapFile = args[i]
+    }
+  }
+
+  if (!mapFile) {
+    console.error('Usage: node scripts/footprint.mjs <file.map> [--expand name] [--top n] [--json]')
+    process.exit(1)
+  }
+
+  let text
+  try {
+    text = readFileSync(mapFile, 'utf8')
+  } catch (e) {
+    console.error(`Cannot read ${mapFile}: ${e.message}`)
+    process.exit(1)
+  }
+
+  const components = parseMap(text)
+  if (components.length === 0) {
+    console.error(`${mapFile}: no linked sections found (not a GNU ld map?)`)
+    process.exit(1)
+  }
+
+  // The runtime is compiled into the app component; always break it down
+  for (const c of components) {
+    if (c.objects.has('qjs_rasen.c')) expand.add(c.name)
+  }
+
+  if (json) {
+    const out = components.map((c) => ({
+      name: c.name,
+      flash: c.flash,
+      ram: c.ram,
+      objects: [...c.objects.values()]
+    }))
+    console.log(JSON.stringify(out, null, 2))
+  } else {
+    printTable(components, { expand, top })
+  }
+}
+
+main()
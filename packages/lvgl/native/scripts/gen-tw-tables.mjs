@@ -0,0 +1,198 @@
+#!/usr/bin/env node
+/**
+ * Tailwind lookup table generator for tw_parser.c
+ *
+ * Reads common/tw_tables.json and writes common/tw_tables.h with two
+ * minimal perfect hash tables (hash-and-displace): one for utility names
+ * and prefixes, one for the color palette. Lookups on the device are two
+ * hashes and one memcmp, with no allocation.
+ *
+ * Run with: node scripts/gen-tw-tables.mjs
+ */
+
+import { readFileSync, writeFileSync } from 'fs'
+import { join, dirname } from 'path'
+import { fileURLToPath } from 'url'
+
+const __dirname = dirname(fileURLToPath(import.meta.url))
+const COMMON_DIR = join(__dirname, '..', 'common')
+const INPUT = join(COMMON_DIR, 'tw_tables.json')
+const OUTPUT = join(COMMON_DIR, 'tw_tables.h')
+
+const MAX_DISPLACEMENT = 0xffff
+
+// Must match tw_phash() in tw_tables.h
+function phash(seed, str) {
+  let h = (0x811c9dc5 ^ Math.imul(seed, 0x9e3779b9)) >>> 0
+  for (let i = 0; i < str.length; i++) {
+    h ^= str.charCodeAt(i)
+    h = Math.imul(h, 0x01000193) >>> 0
+  }
+  h ^= h >>> 16
+  h = Math.imul(h, 0x85ebca6b) >>> 0
+  h ^= h >>> 13
+  h = Math.imul(h, 0xc2b2ae35) >>> 0
+  h ^= h >>> 16
+  return h >>> 0
+}
+
+function nextPow2(n) {
+  let p = 1
+  while (p < n) p <<= 1
+  return p
+}
+
+/**
+ * Build a hash-and-displace table: keys are grouped into buckets by
+ * phash(0, key), then each bucket (largest first) searches for a
+ * displacement seed that drops all of its keys into free slots.
+ */
+function buildPerfectHash(keys) {
+  const slots = nextPow2(keys.length)
+  const buckets = Math.max(1, slots >> 1)
+
+  const groups = Array.from({ length: buckets }, () => [])
+  for (const key of keys) {
+    groups[phash(0, key) & (buckets - 1)].push(key)
+  }
+
+  const order = groups
+    .map((group, index) => ({ group, index }))
+    .sort((a, b) => b.group.length - a.group.length)
+
+  const table = new Array(slots).fill(null)
+  const disp = new Array(buckets).fill(0)
+
+  for (const { group, index } of order) {
+    if (group.length === 0) continue
+
+    let found = false
+    for (let d = 1; d <= MAX_DISPLACEMENT && !found; d++) {
+      const taken = group.map((key) => phash(d, key) & (slots - 1))
+      if (new Set(taken).size !== taken.length) continue
+      if (taken.some((slot) => table[slot] !== null)) continue
+
+      taken.forEach((slot, i) => (table[slot] = group[i]))
+      disp[index] = d
+      found = true
+    }
+
+    if (!found) {
+      throw new Error(`No displacement found for bucket ${index}`)
+    }
+  }
+
+  return { slots, buckets, table, disp }
+}
+
+function cString(str) {
+  return JSON.stringify(str)
+}
+
+function formatDisp(disp) {
+  const lines = []
+  for (let i = 0; i < disp.length; i += 12) {
+    lines.push('    ' + disp.slice(i, i + 12).join(', ') + ',')
+  }
+  return lines.join('\n')
+}
+
+function flattenPalette(palette) {
+  const colors = {}
+  for (const [name, value] of Object.entries(palette)) {
+    if (typeof value === 'string') {
+      colors[name] = value
+    } else {
+      for (const [shade, hex] of Object.entries(value)) {
+        colors[`${name}-${shade}`] = hex
+      }
+    }
+  }
+  return colors
+}
+
+function generate() {
+  const spec = JSON.parse(readFileSync(INPUT, 'utf8'))
+
+  // ---- Keywords (exact utilities and value prefixes) ----
+  const keywords = spec.keywords
+  const kw = buildPerfectHash(Object.keys(keywords))
+  const kwRows = kw.table.map((name) => {
+    if (name === null) return '    { "", 0, TW_OP_NONE, TW_PREFIX_NONE, 0 },'
+    const entry = keywords[name]
+    const op = entry.op ? `TW_OP_${entry.op}` : 'TW_OP_NONE'
+    const prefix = entry.prefix ? `TW_PREFIX_${entry.prefix}` : 'TW_PREFIX_NONE'
+    const arg = entry.arg !== undefined ? entry.arg : 0
+    return `    { ${cString(name)}, ${name.length}, ${op}, ${prefix}, ${arg} },`
+  })
+
+  // ---- Palette ----
+  const colors = flattenPalette(spec.palette)
+  const pal = buildPerfectHash(Object.keys(colors))
+  const palRows = pal.table.map((name) => {
+    if (name === null) return '    { "", 0, 0x000000 },'
+    const rgb = colors[name].replace('#', '').toLowerCase()
+    return `    { ${cString(name)}, ${name.length}, 0x${rgb} },`
+  })
+
+  const out = `/**
+ * @file tw_tables.h
+ * @brief Perfect hash tables for the Tailwind parser
+ *
+ * Generated by scripts/gen-tw-tables.mjs from tw_tables.json - do not edit.
+ * ${Object.keys(keywords).length} keywords, ${Object.keys(colors).length} palette colors.
+ */
+
+#ifndef TW_TABLES_H
+#define TW_TABLES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// FNV-1a with a seeded basis and a murmur3 finalizer
+static inline uint32_t tw_phash(uint32_t seed, const char *s, size_t len) {
+    uint32_t h = 0x811c9dc5u ^ (seed * 0x9e3779b9u);
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)s[i];
+        h *= 0x01000193u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+#define TW_KEYWORD_SLOTS   ${kw.slots}
+#define TW_KEYWORD_BUCKETS ${kw.buckets}
+
+static const uint16_t tw_keyword_disp[TW_KEYWORD_BUCKETS] = {
+${formatDisp(kw.disp)}
+};
+
+static const tw_keyword_t tw_keywords[TW_KEYWORD_SLOTS] = {
+${kwRows.join('\n')}
+};
+
+#define TW_PALETTE_SLOTS   ${pal.slots}
+#define TW_PALETTE_BUCKETS ${pal.buckets}
+
+static const uint16_t tw_palette_disp[TW_PALETTE_BUCKETS] = {
+${formatDisp(pal.disp)}
+};
+
+static const tw_color_entry_t tw_palette[TW_PALETTE_SLOTS] = {
+${palRows.join('\n')}
+};
+
+#endif // TW_TABLES_H
+`
+
+  writeFileSync(OUTPUT, out)
+  console.log(
+    `Wrote ${OUTPUT} (${kw.slots} keyword slots, ${pal.slots} palette slots)`
+  )
+}
+
+generate()
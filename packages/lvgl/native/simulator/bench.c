@@ -0,0 +1,409 @@
+/**
+ * @file bench.c
+ * @brief Native benchmark harness for the Rasen LVGL runtime
+ *
+ * Runs scenario scripts on the headless backend and reports timing
+ * distributions for the hot paths: Tailwind parsing, first mount, full
+ * render, rerender and click-to-flush latency, plus LVGL and QuickJS heap
+ * high-water marks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "lvgl.h"
+#include "quickjs.h"
+#include "../common/qjs_rasen.h"
+#include "../common/rasen_alloc.h"
+#include "../common/rasen_stats.h"
+#include "headless.h"
+
+#define DISPLAY_WIDTH  320
+#define DISPLAY_HEIGHT 240
+#define FRAME_MS       LV_DISP_DEF_REFR_PERIOD
+
+// Flush must follow a release within this many frames
+#define MAX_CLICK_FRAMES 10
+
+// tw_parse calls timed together per sample
+#define PARSE_BATCH 1000
+
+static const char *default_scenarios[] = {
+    "bench/list.js",
+    "bench/deep.js",
+    "bench/clicks.js",
+    "bench/classes.js",
+};
+
+// Representative class strings for the parser benchmark
+static const char *parse_samples[] = {
+    "flex flex-col items-center justify-center size-full bg-gray-900 gap-4",
+    "px-4 py-2 bg-blue-500 rounded-lg",
+    "text-2xl text-white",
+    "w-[120px] h-8 p-2.5 border-2 border-red-900 bg-[#1e293b] rounded-full",
+    "flex flex-row flex-wrap w-full h-full gap-1 bg-transparent unknown-class",
+};
+
+// ============ Timing ============
+
+static double now_us(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER t;
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart * 1e6 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+#endif
+}
+
+typedef struct {
+    double *values;
+    size_t count;
+    size_t capacity;
+} samples_t;
+
+static void samples_add(samples_t *s, double v) {
+    if (s->count == s->capacity) {
+        size_t capacity = s->capacity ? s->capacity * 2 : 64;
+        double *grown = (double *)realloc(s->values, capacity * sizeof(double));
+        if (!grown) return;
+        s->values = grown;
+        s->capacity = capacity;
+    }
+    s->values[s->count++] = v;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const samples_t *s, double p) {
+    size_t i = (size_t)(p * (double)(s->count - 1) + 0.5);
+    return s->values[i];
+}
+
+static void samples_report(const char *name, samples_t *s) {
+    if (s->count == 0) {
+        printf("  %-12s %6s\n", name, "-");
+        return;
+    }
+    qsort(s->values, s->count, sizeof(double), compare_double);
+    double sum = 0;
+    for (size_t i = 0; i < s->count; i++) sum += s->values[i];
+    printf("  %-12s %6zu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+           name, s->count, s->values[0], percentile(s, 0.5), percentile(s, 0.9),
+           percentile(s, 0.99), s->values[s->count - 1], sum / (double)s->count);
+    free(s->values);
+    memset(s, 0, sizeof(*s));
+}
+
+static void print_header(void) {
+    printf("  %-12s %6s %10s %10s %10s %10s %10s %10s\n",
+           "op (us)", "n", "min", "p50", "p90", "p99", "max", "mean");
+}
+
+// ============ Heap Watermarks ============
+
+static size_t lv_heap_peak = 0;
+static size_t js_heap_peak = 0;
+
+static void sample_heaps(JSRuntime *rt) {
+#if LV_MEM_CUSTOM == 0
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    if (mon.max_used > lv_heap_peak) lv_heap_peak = mon.max_used;
+#endif
+    if (rt) {
+        JSMemoryUsage usage;
+        JS_ComputeMemoryUsage(rt, &usage);
+        if ((size_t)usage.malloc_size > js_heap_peak) js_heap_peak = (size_t)usage.malloc_size;
+    }
+}
+
+// ============ Helpers ============
+
+static char *load_file(const char *filename) {
+    FILE *f = fopen(filename, "rb");
+    if (!f) {
+        printf("Cannot open file: %s\n", filename);
+        return NULL;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    char *content = (char *)malloc(size + 1);
+    if (!content) {
+        fclose(f);
+        return NULL;
+    }
+
+    fread(content, 1, size, f);
+    content[size] = '\0';
+    fclose(f);
+
+    return content;
+}
+
+typedef struct {
+    JSRuntime *rt;
+    JSContext *ctx;
+} bench_js_t;
+
+static int bench_js_open(bench_js_t *js, long bench_n) {
+    js->rt = rasen_alloc_new_runtime();
+    js->ctx = js->rt ? qjs_rasen_new_context(js->rt) : NULL;
+    if (!js->ctx || qjs_rasen_init(js->ctx) != 0) {
+        printf("Failed to create JS context\n");
+        return -1;
+    }
+
+    if (bench_n > 0) {
+        char src[64];
+        snprintf(src, sizeof(src), "var BENCH_N = %ld;", bench_n);
+        JS_FreeValue(js->ctx, JS_Eval(js->ctx, src, strlen(src), "<bench>", JS_EVAL_TYPE_GLOBAL));
+    }
+    return 0;
+}
+
+// Delete the tree while the context is alive, so nodes release their JS refs
+static void bench_js_close(bench_js_t *js, lv_obj_t *screen) {
+    lv_obj_clean(screen);
+    if (js->ctx) {
+        qjs_rasen_cleanup(js->ctx);
+        JS_FreeContext(js->ctx);
+    }
+    if (js->rt) {
+        JS_FreeRuntime(js->rt);
+        rasen_alloc_reset();
+    }
+    js->ctx = NULL;
+    js->rt = NULL;
+}
+
+static uint32_t count_objects(lv_obj_t *obj) {
+    uint32_t n = 1;
+    for (uint32_t i = 0; i < lv_obj_get_child_cnt(obj); i++) {
+        n += count_objects(lv_obj_get_child(obj, i));
+    }
+    return n;
+}
+
+static lv_obj_t *find_button(lv_obj_t *obj) {
+    if (lv_obj_check_type(obj, &lv_btn_class)) return obj;
+    for (uint32_t i = 0; i < lv_obj_get_child_cnt(obj); i++) {
+        lv_obj_t *found = find_button(lv_obj_get_child(obj, i));
+        if (found) return found;
+    }
+    return NULL;
+}
+
+// Run frames until nothing is left to draw
+static void settle(JSContext *ctx) {
+    for (int i = 0; i < MAX_CLICK_FRAMES && headless_step(ctx, FRAME_MS); i++) {
+    }
+}
+
+static JSValue eval_global(JSContext *ctx, const char *src) {
+    return JS_Eval(ctx, src, strlen(src), "<bench>", JS_EVAL_TYPE_GLOBAL);
+}
+
+// ============ Benchmarks ============
+
+static void bench_parse(int iterations) {
+    samples_t parse = {0};
+    tw_styles_t styles;
+
+    printf("\ntw_parse (%d calls per sample)\n", PARSE_BATCH);
+    print_header();
+    for (size_t k = 0; k < sizeof(parse_samples) / sizeof(parse_samples[0]); k++) {
+        for (int it = 0; it < iterations; it++) {
+            double t0 = now_us();
+            for (int i = 0; i < PARSE_BATCH; i++) {
+                tw_parse(parse_samples[k], &styles);
+            }
+            samples_add(&parse, (now_us() - t0) / PARSE_BATCH);
+        }
+    }
+    samples_report("parse", &parse);
+}
+
+static int bench_scenario(const char *path, lv_obj_t *screen, int iterations, int clicks, long bench_n) {
+    char *script = load_file(path);
+    if (!script) return -1;
+
+    samples_t render = {0}, mount = {0}, describe = {0}, rerender = {0}, click = {0};
+    bench_js_t js = {0};
+    uint32_t objects = 0;
+    uint32_t frame_allocs = 0;
+    uint32_t pooled = rasen_stats.js_allocs_pooled;
+    uint32_t system = rasen_stats.js_allocs_system;
+    int status = 0;
+    lv_heap_peak = 0;
+    js_heap_peak = 0;
+
+    // Full render: evaluate the script in a fresh context and mount the tree
+    for (int it = 0; it < iterations && status == 0; it++) {
+        if (bench_js_open(&js, bench_n) != 0) {
+            status = -1;
+            break;
+        }
+        double t0 = now_us();
+        status = qjs_rasen_render(js.ctx, script, screen);
+        samples_add(&render, now_us() - t0);
+        settle(js.ctx);
+        sample_heaps(js.rt);
+        if (it + 1 < iterations) bench_js_close(&js, screen);
+    }
+
+    if (status == 0) {
+        objects = count_objects(screen) - 1;
+
+        for (int it = 0; it < iterations; it++) {
+            // JS side only: build the descriptor tree
+            double t0 = now_us();
+            JS_FreeValue(js.ctx, eval_global(js.ctx, "__rerender()"));
+            samples_add(&describe, now_us() - t0);
+
+            // Rerender against the live tree (JS + patch)
+            rasen_alloc_mark_frame();
+            t0 = now_us();
+            qjs_rasen_rerender(js.ctx, screen);
+            samples_add(&rerender, now_us() - t0);
+            frame_allocs = rasen_stats.js_frame_allocs;
+            settle(js.ctx);
+
+            // Mount from scratch (JS + create_element_from_desc for every node)
+            lv_obj_clean(screen);
+            t0 = now_us();
+            qjs_rasen_rerender(js.ctx, screen);
+            samples_add(&mount, now_us() - t0);
+            settle(js.ctx);
+            sample_heaps(js.rt);
+        }
+
+        /*
+         * Click-to-flush: release over a button, stop at the first flush after
+         * the rerender its handler requests. Handlers run from the event queue
+         * on a later step, so the first flush alone is only LVGL redrawing the
+         * released state.
+         */
+        lv_obj_t *btn = find_button(screen);
+        if (btn) {
+            lv_area_t area;
+            lv_obj_get_coords(btn, &area);
+            int16_t x = (int16_t)((area.x1 + area.x2) / 2);
+            int16_t y = (int16_t)((area.y1 + area.y2) / 2);
+
+            for (int i = 0; i < clicks; i++) {
+                headless_set_pointer(x, y, true);
+                settle(js.ctx);
+
+                headless_set_pointer(x, y, false);
+                uint32_t rerenders = rasen_stats.rerenders;
+                double t0 = now_us();
+                bool done = false;
+                for (int f = 0; f < MAX_CLICK_FRAMES && !done; f++) {
+                    bool flushed = headless_step(js.ctx, FRAME_MS);
+                    done = flushed && rasen_stats.rerenders != rerenders;
+                }
+                if (done) samples_add(&click, now_us() - t0);
+                settle(js.ctx);
+            }
+            sample_heaps(js.rt);
+        }
+    }
+
+    printf("\n%s (%u objects)\n", path, (unsigned)objects);
+    print_header();
+    samples_report("render", &render);
+    samples_report("describe", &describe);
+    samples_report("mount", &mount);
+    samples_report("rerender", &rerender);
+    samples_report("click", &click);
+    printf("  heap peak    LVGL %zu B, QuickJS %zu B\n", lv_heap_peak, js_heap_peak);
+    pooled = rasen_stats.js_allocs_pooled - pooled;
+    system = rasen_stats.js_allocs_system - system;
+    printf("  js allocs    %u per rerender, %u%% from size-class pools\n", (unsigned)frame_allocs,
+           pooled + system ? (unsigned)((uint64_t)pooled * 100 / (pooled + system)) : 100u);
+
+    bench_js_close(&js, screen);
+    free(script);
+    return status;
+}
+
+// ============ Main ============
+
+static void print_usage(const char *prog) {
+    printf("Rasen LVGL benchmark\n\n");
+    printf("Usage: %s [options] [scenario.js ...]\n\n", prog);
+    printf("Options:\n");
+    printf("  --iterations <n>  Samples per operation (default 20)\n");
+    printf("  --clicks <n>      Click-to-flush samples (default 50)\n");
+    printf("  --n <size>        Scenario size, exposed to scripts as BENCH_N\n\n");
+    printf("Without scenarios, runs bench/*.js from the working directory.\n");
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = 20;
+    int clicks = 50;
+    long bench_n = 0;
+    const char **scenarios = (const char **)malloc(sizeof(char *) * (argc + 1));
+    int scenario_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(arg, "--iterations") == 0 && has_value) {
+            iterations = atoi(argv[++i]);
+        } else if (strcmp(arg, "--clicks") == 0 && has_value) {
+            clicks = atoi(argv[++i]);
+        } else if (strcmp(arg, "--n") == 0 && has_value) {
+            bench_n = atol(argv[++i]);
+        } else if (arg[0] != '-') {
+            scenarios[scenario_count++] = arg;
+        } else {
+            print_usage(argv[0]);
+            free(scenarios);
+            return 1;
+        }
+    }
+    if (iterations < 1) iterations = 1;
+    
+    // "render" times the whole first mount, not its first slice
+    qjs_rasen_set_mount_slice(0, 0);
+
+    if (headless_init(DISPLAY_WIDTH, DISPLAY_HEIGHT) != 0) {
+        free(scenarios);
+        return 1;
+    }
+
+    bench_parse(iterations);
+
+    const char **list = scenario_count ? scenarios : default_scenarios;
+    int count = scenario_count ? scenario_count
+                               : (int)(sizeof(default_scenarios) / sizeof(default_scenarios[0]));
+    int status = 0;
+    for (int i = 0; i < count; i++) {
+        if (bench_scenario(list[i], lv_scr_act(), iterations, clicks, bench_n) != 0) {
+            status = 1;
+        }
+    }
+
+    headless_cleanup();
+    free(scenarios);
+    return status;
+}
@@ -0,0 +1,430 @@
+/**
+ * @file headless.c
+ * @brief Headless display backend for the Rasen LVGL simulator
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "headless.h"
+#include "../common/qjs_rasen.h"
+#include "../common/rasen_stats.h"
+#include "../common/rasen_prof.h"
+
+#define DRAW_BUF_LINES 10
+
+// ============ Display Driver ============
+
+static int fb_width = 0;
+static int fb_height = 0;
+static uint32_t *framebuffer = NULL;  // ARGB8888, row-major
+static lv_color_t *draw_buf_mem = NULL;
+static bool flushed = false;
+
+static lv_disp_draw_buf_t draw_buf;
+static lv_disp_drv_t disp_drv;
+static lv_indev_drv_t indev_drv;
+
+static void headless_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p) {
+    uint64_t start = rasen_stats_now_us();
+    RASEN_PROF_BEGIN(prof_start);
+    int32_t w = lv_area_get_width(area);
+    uint32_t *dst = framebuffer + area->y1 * fb_width + area->x1;
+
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+#if LV_COLOR_DEPTH == 32
+        memcpy(dst, color_p, w * sizeof(uint32_t));
+#else
+        for (int32_t x = 0; x < w; x++) {
+            dst[x] = lv_color_to32(color_p[x]);
+        }
+#endif
+        color_p += w;
+        dst += fb_width;
+    }
+
+    flushed = true;
+    rasen_stats_add_time(RASEN_TIME_FLUSH, start);
+    RASEN_PROF_END(RASEN_PROF_FLUSH, "flush", prof_start);
+    lv_disp_flush_ready(drv);
+}
+
+// Pointer state, driven by the input script
+static bool pointer_pressed = false;
+static int16_t pointer_x = 0, pointer_y = 0;
+
+static void headless_input_read_cb(lv_indev_drv_t *drv, lv_indev_data_t *data) {
+    data->point.x = pointer_x;
+    data->point.y = pointer_y;
+    data->state = pointer_pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+}
+
+int headless_init(int width, int height) {
+    fb_width = width;
+    fb_height = height;
+
+    framebuffer = (uint32_t *)calloc((size_t)width * height, sizeof(uint32_t));
+    draw_buf_mem = (lv_color_t *)malloc((size_t)width * DRAW_BUF_LINES * sizeof(lv_color_t));
+    if (!framebuffer || !draw_buf_mem) {
+        printf("Framebuffer allocation failed\n");
+        headless_cleanup();
+        return -1;
+    }
+
+    lv_init();
+
+    lv_disp_draw_buf_init(&draw_buf, draw_buf_mem, NULL, width * DRAW_BUF_LINES);
+
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = width;
+    disp_drv.ver_res = height;
+    disp_drv.flush_cb = headless_flush_cb;
+    disp_drv.draw_buf = &draw_buf;
+    lv_disp_drv_register(&disp_drv);
+
+    lv_indev_drv_init(&indev_drv);
+    indev_drv.type = LV_INDEV_TYPE_POINTER;
+    indev_drv.read_cb = headless_input_read_cb;
+    lv_indev_drv_register(&indev_drv);
+
+    return 0;
+}
+
+void headless_cleanup(void) {
+    free(framebuffer);
+    free(draw_buf_mem);
+    framebuffer = NULL;
+    draw_buf_mem = NULL;
+}
+
+void headless_set_pointer(int16_t x, int16_t y, bool pressed) {
+    pointer_x = x;
+    pointer_y = y;
+    pointer_pressed = pressed;
+}
+
+bool headless_step(JSContext *ctx, uint32_t ms) {
+    flushed = false;
+    lv_tick_inc(ms);
+    qjs_rasen_process_events(ctx);
+    rasen_stats_lvgl_begin();
+    rasen_prof_timer_handler();
+    rasen_stats_lvgl_end();
+    return flushed;
+}
+
+// ============ Frame Dumps ============
+
+static uint32_t crc_table[256];
+
+static void crc_init(void) {
+    if (crc_table[1]) return;
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        crc_table[n] = c;
+    }
+}
+
+static uint32_t crc_update(uint32_t crc, const uint8_t *buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        crc = crc_table[(crc ^ buf[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static void put_u32be(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static void write_chunk(FILE *f, const char *type, const uint8_t *data, uint32_t len) {
+    uint8_t hdr[8];
+    put_u32be(hdr, len);
+    memcpy(hdr + 4, type, 4);
+    fwrite(hdr, 1, 8, f);
+    if (len) fwrite(data, 1, len, f);
+
+    uint32_t crc = crc_update(0xFFFFFFFFu, hdr + 4, 4);
+    crc = crc_update(crc, data, len) ^ 0xFFFFFFFFu;
+    uint8_t tail[4];
+    put_u32be(tail, crc);
+    fwrite(tail, 1, 4, f);
+}
+
+int headless_write_png(const char *path) {
+    if (!framebuffer) return -1;
+    crc_init();
+
+    // Filtered scanlines: filter byte 0 + RGB
+    size_t row_len = 1 + (size_t)fb_width * 3;
+    size_t raw_len = row_len * fb_height;
+
+    // zlib stream of stored (uncompressed) deflate blocks
+    size_t blocks = (raw_len + 65534) / 65535;
+    size_t zlen = 2 + blocks * 5 + raw_len + 4;
+    uint8_t *z = (uint8_t *)malloc(zlen);
+    uint8_t *raw = (uint8_t *)malloc(raw_len);
+    if (!z || !raw) {
+        free(z);
+        free(raw);
+        return -1;
+    }
+
+    uint8_t *p = raw;
+    for (int y = 0; y < fb_height; y++) {
+        const uint32_t *src = framebuffer + (size_t)y * fb_width;
+        *p++ = 0;
+        for (int x = 0; x < fb_width; x++) {
+            *p++ = (uint8_t)(src[x] >> 16);
+            *p++ = (uint8_t)(src[x] >> 8);
+            *p++ = (uint8_t)src[x];
+        }
+    }
+
+    uint8_t *q = z;
+    *q++ = 0x78;
+    *q++ = 0x01;
+    uint32_t a = 1, b = 0;
+    for (size_t off = 0; off < raw_len; ) {
+        size_t n = raw_len - off > 65535 ? 65535 : raw_len - off;
+        *q++ = off + n == raw_len ? 1 : 0;  // BFINAL, BTYPE = stored
+        *q++ = (uint8_t)n;
+        *q++ = (uint8_t)(n >> 8);
+        *q++ = (uint8_t)~n;
+        *q++ = (uint8_t)(~n >> 8);
+        memcpy(q, raw + off, n);
+        for (size_t i = 0; i < n; i++) {
+            a = (a + raw[off + i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        q += n;
+        off += n;
+    }
+    put_u32be(q, (b << 16) | a);
+    free(raw);
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        printf("Cannot write file: %s\n", path);
+        free(z);
+        return -1;
+    }
+
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    fwrite(signature, 1, 8, f);
+
+    uint8_t ihdr[13];
+    put_u32be(ihdr, (uint32_t)fb_width);
+    put_u32be(ihdr + 4, (uint32_t)fb_height);
+    ihdr[8] = 8;   // bit depth
+    ihdr[9] = 2;   // color type: RGB
+    ihdr[10] = 0;  // compression
+    ihdr[11] = 0;  // filter
+    ihdr[12] = 0;  // interlace
+    write_chunk(f, "IHDR", ihdr, sizeof(ihdr));
+    write_chunk(f, "IDAT", z, (uint32_t)zlen);
+    write_chunk(f, "IEND", NULL, 0);
+
+    fclose(f);
+    free(z);
+    return 0;
+}
+
+int headless_write_raw(const char *path) {
+    if (!framebuffer) return -1;
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        printf("Cannot write file: %s\n", path);
+        return -1;
+    }
+
+    size_t count = (size_t)fb_width * fb_height;
+    size_t written = fwrite(framebuffer, sizeof(uint32_t), count, f);
+    fclose(f);
+    return written == count ? 0 : -1;
+}
+
+static int write_screenshot(const char *path) {
+    size_t len = strlen(path);
+    if (len > 4 && strcmp(path + len - 4, ".raw") == 0) {
+        return headless_write_raw(path);
+    }
+    return headless_write_png(path);
+}
+
+// ============ Input Script ============
+
+typedef enum {
+    INPUT_MOVE,
+    INPUT_DOWN,
+    INPUT_UP,
+    INPUT_CLICK,
+    INPUT_RERENDER,
+} input_action_t;
+
+typedef struct {
+    uint32_t frame;
+    input_action_t action;
+    int16_t x, y;
+} input_event_t;
+
+static int parse_action(const char *name, input_action_t *out) {
+    static const struct { const char *name; input_action_t action; } actions[] = {
+        { "move", INPUT_MOVE },
+        { "down", INPUT_DOWN },
+        { "up", INPUT_UP },
+        { "click", INPUT_CLICK },
+        { "rerender", INPUT_RERENDER },
+    };
+    for (size_t i = 0; i < sizeof(actions) / sizeof(actions[0]); i++) {
+        if (strcmp(name, actions[i].name) == 0) {
+            *out = actions[i].action;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static input_event_t *load_input(const char *path, size_t *out_count) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        printf("Cannot open file: %s\n", path);
+        return NULL;
+    }
+
+    input_event_t *events = NULL;
+    size_t count = 0, capacity = 0;
+    char line[256];
+    int line_no = 0;
+    bool ok = true;
+
+    while (fgets(line, sizeof(line), f)) {
+        line_no++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char name[32];
+        unsigned frame;
+        int x = 0, y = 0;
+        int n = sscanf(line, "%u %31s %d %d", &frame, name, &x, &y);
+        if (n <= 0) continue;  // blank or comment
+
+        input_event_t ev = { frame, INPUT_MOVE, (int16_t)x, (int16_t)y };
+        bool needs_point = false;
+        if (n < 2 || parse_action(name, &ev.action) != 0) {
+            ok = false;
+        } else {
+            needs_point = ev.action == INPUT_MOVE || ev.action == INPUT_DOWN || ev.action == INPUT_CLICK;
+            if ((needs_point && n < 4) || (count && frame < events[count - 1].frame)) {
+                ok = false;
+            }
+        }
+        if (!ok) {
+            printf("%s:%d: invalid input event\n", path, line_no);
+            break;
+        }
+
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 32;
+            input_event_t *grown = (input_event_t *)realloc(events, capacity * sizeof(input_event_t));
+            if (!grown) {
+                ok = false;
+                break;
+            }
+            events = grown;
+        }
+        events[count++] = ev;
+    }
+
+    fclose(f);
+    if (!ok) {
+        free(events);
+        return NULL;
+    }
+
+    *out_count = count;
+    if (!events) {
+        events = (input_event_t *)malloc(sizeof(input_event_t));  // empty script
+    }
+    return events;
+}
+
+// ============ Frame Loop ============
+
+int headless_run(JSContext *ctx, lv_obj_t *screen, const headless_options_t *opts) {
+    input_event_t *events = NULL;
+    size_t event_count = 0;
+    if (opts->input_file) {
+        events = load_input(opts->input_file, &event_count);
+        if (!events) return -1;
+    }
+
+    size_t next = 0;
+    uint32_t release_frame = UINT32_MAX;
+    uint32_t changed = 0;
+    int status = 0;
+    clock_t start = clock();
+
+    for (uint32_t frame = 0; frame < opts->frames; frame++) {
+        if (frame == release_frame) {
+            pointer_pressed = false;
+            release_frame = UINT32_MAX;
+        }
+
+        for (; next < event_count && events[next].frame == frame; next++) {
+            const input_event_t *ev = &events[next];
+            switch (ev->action) {
+                case INPUT_MOVE:
+                    headless_set_pointer(ev->x, ev->y, pointer_pressed);
+                    break;
+                case INPUT_DOWN:
+                    headless_set_pointer(ev->x, ev->y, true);
+                    break;
+                case INPUT_UP:
+                    pointer_pressed = false;
+                    break;
+                case INPUT_CLICK:
+                    headless_set_pointer(ev->x, ev->y, true);
+                    release_frame = frame + 1;
+                    break;
+                case INPUT_RERENDER:
+                    qjs_rasen_rerender(ctx, screen);
+                    break;
+            }
+        }
+
+        if (headless_step(ctx, opts->frame_ms)) {
+            changed++;
+            if (opts->dump_dir) {
+                char path[1024];
+                snprintf(path, sizeof(path), "%s/frame_%05u.png", opts->dump_dir, (unsigned)frame);
+                if (headless_write_png(path) != 0) {
+                    status = -1;
+                    break;
+                }
+            }
+        }
+    }
+
+    double cpu_ms = (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+    printf("Headless: %u frames (%u changed) in %.1f ms CPU\n",
+           (unsigned)opts->frames, (unsigned)changed, cpu_ms);
+
+    if (status == 0 && opts->screenshot) {
+        status = write_screenshot(opts->screenshot);
+        if (status == 0) {
+            printf("Wrote %s\n", opts->screenshot);
+        }
+    }
+
+    free(events);
+    return status;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file headless.h
+ * @brief Headless display backend for the Rasen LVGL simulator
+ *
+ * Renders into an in-memory framebuffer and advances LVGL with a virtual
+ * clock, so frames are not bound to vsync or a display. Used for batch
+ * rendering in CI (visual regression and perf runs).
+ */
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+#include "quickjs.h"
+
+typedef struct {
+    uint32_t frames;          // Number of frames to run
+    uint32_t frame_ms;        // Virtual time advanced per frame
+    const char *input_file;   // Scripted input events, or NULL
+    const char *dump_dir;     // Write frame_NNNNN.png for every changed frame, or NULL
+    const char *screenshot;   // Write the last frame (.png or .raw), or NULL
+} headless_options_t;
+
+/**
+ * Initialize LVGL with an in-memory display and a scripted pointer device
+ * @return 0 on success
+ */
+int headless_init(int width, int height);
+
+/**
+ * Free the framebuffer
+ */
+void headless_cleanup(void);
+
+/**
+ * Set the pointer state read by LVGL on its next input poll
+ */
+void headless_set_pointer(int16_t x, int16_t y, bool pressed);
+
+/**
+ * Advance the virtual clock by ms and run one iteration of the main loop
+ * (JS events, then LVGL timers)
+ * @return true if LVGL flushed anything during this step
+ */
+bool headless_step(JSContext *ctx, uint32_t ms);
+
+/**
+ * Write the framebuffer as an uncompressed 24-bit PNG
+ * @return 0 on success
+ */
+int headless_write_png(const char *path);
+
+/**
+ * Write the framebuffer as raw ARGB8888 (native-endian uint32, row-major,
+ * no header)
+ * @return 0 on success
+ */
+int headless_write_raw(const char *path);
+
+/**
+ * Run opts->frames frames, replaying the input script and writing the
+ * requested dumps
+ *
+ * Input script: one event per line, "<frame> <action> [x y]", frames in
+ * ascending order, '#' starts a comment. Actions:
+ *   move x y    Move the pointer
+ *   down x y    Press at x, y
+ *   up          Release
+ *   click x y   Press at x, y and release on the next frame
+ *   rerender    Call qjs_rasen_rerender()
+ *
+ * @return 0 on success
+ */
+int headless_run(JSContext *ctx, lv_obj_t *screen, const headless_options_t *opts);
+
+#endif // HEADLESS_H
@@ -38,12 +38,12 @@
    FEATURE CONFIGURATION
  *====================*/
 #define LV_DRAW_COMPLEX 1
-#define LV_SHADOW_CACHE_SIZE 0
+#define LV_SHADOW_CACHE_SIZE 32
 #define LV_CIRCLE_CACHE_SIZE 4
 #define LV_LAYER_SIMPLE_BUF_SIZE (24 * 1024)
-#define LV_IMG_CACHE_DEF_SIZE 0
+#define LV_IMG_CACHE_DEF_SIZE 8
 #define LV_GRADIENT_MAX_STOPS 2
-#define LV_GRAD_CACHE_DEF_SIZE 0
+#define LV_GRAD_CACHE_DEF_SIZE (4 * 1024)
 #define LV_DITHER_GRADIENT 0
 #define LV_DISP_ROT_MAX_BUF (10 * 1024)
 
@@ -92,7 +92,8 @@
 #define LV_ATTRIBUTE_FAST_MEM
 #define LV_ATTRIBUTE_DMA
 #define LV_EXPORT_CONST_INT(int_value) struct _silence_gcc_warning
-#define LV_USE_LARGE_COORD 0
+/*Without it coordinates end at 8191 px, i.e. a 255-row virtualList at 32 px rows*/
+#define LV_USE_LARGE_COORD 1
 
 /*====================
  * FONT USAGE
@@ -175,7 +176,7 @@
  *====================*/
 #define LV_USE_ANIMIMG 1
 #define LV_USE_CALENDAR 0
-#define LV_USE_CHART 0
+#define LV_USE_CHART 1
 #define LV_USE_COLORWHEEL 0
 #define LV_USE_IMGBTN 1
 #define LV_USE_KEYBOARD 0
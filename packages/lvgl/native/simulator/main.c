@@ -9,6 +9,15 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 // SDL2 headers
 #include "SDL.h"
 
@@ -18,6 +27,12 @@
 
 // Rasen common code
 #include "../common/qjs_rasen.h"
+#include "../common/rasen_stats.h"
+#include "../common/rasen_prof.h"
+#include "../common/rasen_worker.h"
+#include "../common/rasen_alloc.h"
+#include "../common/rasen_img.h"
+#include "headless.h"
 
 // ============ Configuration ============
 
@@ -32,21 +47,72 @@ static SDL_Renderer *renderer = NULL;
 static SDL_Texture *texture = NULL;
 static uint32_t *framebuffer = NULL;
 
+// Union of the areas LVGL flushed since the last upload, and whether the
+// window must be presented again (flush or expose)
+static lv_area_t dirty_area;
+static bool has_dirty_area = false;
+static bool frame_dirty = true;
+
+static void mark_dirty(const lv_area_t *area) {
+    if (!has_dirty_area) {
+        dirty_area = *area;
+        has_dirty_area = true;
+    } else {
+        if (area->x1 < dirty_area.x1) dirty_area.x1 = area->x1;
+        if (area->y1 < dirty_area.y1) dirty_area.y1 = area->y1;
+        if (area->x2 > dirty_area.x2) dirty_area.x2 = area->x2;
+        if (area->y2 > dirty_area.y2) dirty_area.y2 = area->y2;
+    }
+    frame_dirty = true;
+}
+
 // Flush callback for LVGL
 static void sdl_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
-    int32_t x, y;
-    
-    for (y = area->y1; y <= area->y2; y++) {
-        for (x = area->x1; x <= area->x2; x++) {
-            uint32_t color32 = lv_color_to32(*color_p);
-            framebuffer[y * DISPLAY_WIDTH + x] = color32;
-            color_p++;
+    uint64_t start = rasen_stats_now_us();
+    RASEN_PROF_BEGIN(prof_start);
+    int32_t w = lv_area_get_width(area);
+    uint32_t *dst = framebuffer + area->y1 * DISPLAY_WIDTH + area->x1;
+    
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+#if LV_COLOR_DEPTH == 32
+        // lv_color32_t is already laid out as ARGB8888
+        memcpy(dst, color_p, w * sizeof(uint32_t));
+#else
+        for (int32_t x = 0; x < w; x++) {
+            dst[x] = lv_color_to32(color_p[x]);
         }
+#endif
+        color_p += w;
+        dst += DISPLAY_WIDTH;
     }
     
+    mark_dirty(area);
+    rasen_stats_add_time(RASEN_TIME_FLUSH, start);
+    RASEN_PROF_END(RASEN_PROF_FLUSH, "flush", prof_start);
     lv_disp_flush_ready(disp_drv);
 }
 
+// Upload the dirty region to the texture and present the window
+static void sdl_present(void) {
+    if (has_dirty_area) {
+        SDL_Rect rect = {
+            .x = dirty_area.x1,
+            .y = dirty_area.y1,
+            .w = lv_area_get_width(&dirty_area),
+            .h = lv_area_get_height(&dirty_area),
+        };
+        const uint32_t *src = framebuffer + rect.y * DISPLAY_WIDTH + rect.x;
+        SDL_UpdateTexture(texture, &rect, src, DISPLAY_WIDTH * sizeof(uint32_t));
+        has_dirty_area = false;
+    }
+    
+    // The back buffer is undefined after a present, so copy the whole texture
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, texture, NULL, NULL);
+    SDL_RenderPresent(renderer);
+    frame_dirty = false;
+}
+
 // Input callback for LVGL
 static bool mouse_pressed = false;
 static int16_t mouse_x = 0, mouse_y = 0;
@@ -106,6 +172,10 @@ static int sdl_init(void) {
     
     memset(framebuffer, 0, DISPLAY_WIDTH * DISPLAY_HEIGHT * sizeof(uint32_t));
     
+    // Start with the whole (blank) texture pending upload
+    lv_area_t full = { 0, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1 };
+    mark_dirty(&full);
+    
     return 0;
 }
 
@@ -147,7 +217,7 @@ static void lvgl_init(void) {
 
 // ============ File Loading ============
 
-static char *load_file(const char *filename) {
+static char *load_file(const char *filename, size_t *out_size) {
     FILE *f = fopen(filename, "rb");
     if (!f) {
         printf("Cannot open file: %s\n", filename);
@@ -168,22 +238,184 @@ static char *load_file(const char *filename) {
     content[size] = '\0';
     fclose(f);
     
+    if (out_size) *out_size = (size_t)size;
     return content;
 }
 
+// Read-only mapping of a whole file; bytecode and app images run from it in place
+typedef struct {
+    void *data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+} mapped_file_t;
+
+static int map_file(const char *filename, mapped_file_t *m) {
+    memset(m, 0, sizeof(*m));
+#ifdef _WIN32
+    m->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
+    if (m->file == INVALID_HANDLE_VALUE) {
+        printf("Cannot open file: %s\n", filename);
+        return -1;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(m->file, &size);
+    m->size = (size_t)size.QuadPart;
+    m->mapping = m->size ? CreateFileMappingA(m->file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+    m->data = m->mapping ? MapViewOfFile(m->mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!m->data) {
+        printf("Cannot map file: %s\n", filename);
+        if (m->mapping) CloseHandle(m->mapping);
+        CloseHandle(m->file);
+        return -1;
+    }
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        printf("Cannot open file: %s\n", filename);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return -1;
+    }
+    m->size = (size_t)st.st_size;
+    m->data = mmap(NULL, m->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m->data == MAP_FAILED) {
+        printf("Cannot map file: %s\n", filename);
+        m->data = NULL;
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+static void unmap_file(mapped_file_t *m) {
+    if (!m->data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(m->data);
+    CloseHandle(m->mapping);
+    CloseHandle(m->file);
+#else
+    munmap(m->data, m->size);
+#endif
+    m->data = NULL;
+}
+
+static bool has_suffix(const char *str, const char *suffix) {
+    size_t len = strlen(str), suffix_len = strlen(suffix);
+    return len > suffix_len && strcmp(str + len - suffix_len, suffix) == 0;
+}
+
+// Tables written by `rasen-lvgl build` next to the script (app.js ->
+// app.tws, app.rimg). Kept loaded for the whole run.
+static char *load_sibling_table(const char *script_file, const char *ext, const char *what,
+                                int (*load)(const uint8_t *, size_t)) {
+    size_t len = strlen(script_file);
+    char *path = malloc(len + strlen(ext) + 1);
+    if (!path) return NULL;
+    
+    memcpy(path, script_file, len + 1);
+    char *dot = strrchr(path, '.');
+    char *slash = strrchr(path, '/');
+    char *bslash = strrchr(path, '\\');
+    if (bslash > slash) slash = bslash;
+    if (dot && (!slash || dot > slash)) *dot = '\0';
+    strcat(path, ext);
+    
+    char *table = NULL;
+    FILE *f = fopen(path, "rb");
+    if (f) {
+        fclose(f);
+        size_t size = 0;
+        table = load_file(path, &size);
+        if (table && load((const uint8_t *)table, size) == 0) {
+            printf("Loaded %s: %s\n", what, path);
+        } else {
+            free(table);
+            table = NULL;
+        }
+    }
+    
+    free(path);
+    return table;
+}
+
+// ============ Snapshot ============
+// Stands in for deep sleep: --snapshot <file> saves the persist() refs on
+// exit (or when the script calls deepSleep()) and restores them on start.
+
+static void restore_snapshot_file(JSContext *ctx, const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return;  // First run
+    fclose(f);
+    
+    size_t size = 0;
+    char *buf = load_file(path, &size);
+    if (buf && qjs_rasen_restore(ctx, (const uint8_t *)buf, size) == 0) {
+        printf("Restored state: %s\n", path);
+    }
+    free(buf);
+}
+
+static void save_snapshot_file(JSContext *ctx, const char *path) {
+    uint8_t *buf;
+    size_t len;
+    if (qjs_rasen_snapshot(ctx, &buf, &len) != 0) return;
+    
+    FILE *f = fopen(path, "wb");
+    if (f && fwrite(buf, 1, len, f) == len) {
+        printf("Saved state: %s (%u bytes)\n", path, (unsigned)len);
+    } else {
+        printf("Failed to write snapshot: %s\n", path);
+    }
+    if (f) fclose(f);
+    js_free(ctx, buf);
+}
+
+// ============ Profiling ============
+// --profile <file> records from before the script loads until exit; a
+// script that calls profile(false) itself gets its trace written there too.
+
+static const char *profile_file = "rasen-trace.json";
+
+static uint64_t profile_clock(void) {
+    return SDL_GetPerformanceCounter();
+}
+
+static void profile_fwrite(const char *data, size_t len, void *user) {
+    fwrite(data, 1, len, (FILE *)user);
+}
+
+static void profile_dump(void) {
+    FILE *f = fopen(profile_file, "wb");
+    if (!f) {
+        printf("Cannot write trace: %s\n", profile_file);
+        return;
+    }
+    rasen_prof_write(profile_fwrite, f);
+    fclose(f);
+    printf("Wrote trace: %s\n", profile_file);
+}
+
 // ============ QuickJS Initialization ============
 
 static JSRuntime *js_rt = NULL;
 static JSContext *js_ctx = NULL;
 
 static int quickjs_init(void) {
-    js_rt = JS_NewRuntime();
+    // Size-class pools absorb the per-render descriptor garbage
+    js_rt = rasen_alloc_new_runtime();
     if (!js_rt) {
         printf("Failed to create JS runtime\n");
         return -1;
     }
     
-    js_ctx = JS_NewContext(js_rt);
+    js_ctx = qjs_rasen_new_context(js_rt);
     if (!js_ctx) {
         printf("Failed to create JS context\n");
         return -1;
@@ -205,6 +437,127 @@ static void quickjs_cleanup(void) {
     }
     if (js_rt) {
         JS_FreeRuntime(js_rt);
+        rasen_alloc_reset();
+    }
+}
+
+// ============ Main Loop ============
+
+// Upper bound on one wait, so a missed wakeup can never stall the loop
+#define MAX_IDLE_MS 500
+
+// Returns false when the simulator should quit
+static bool handle_sdl_event(const SDL_Event *event, lv_obj_t *screen) {
+    switch (event->type) {
+        case SDL_QUIT:
+            return false;
+            
+        case SDL_MOUSEMOTION:
+            mouse_x = event->motion.x;
+            mouse_y = event->motion.y;
+            break;
+            
+        case SDL_MOUSEBUTTONDOWN:
+            if (event->button.button == SDL_BUTTON_LEFT) {
+                mouse_pressed = true;
+            }
+            break;
+            
+        case SDL_MOUSEBUTTONUP:
+            if (event->button.button == SDL_BUTTON_LEFT) {
+                mouse_pressed = false;
+            }
+            break;
+            
+        case SDL_KEYDOWN:
+            if (event->key.keysym.sym == SDLK_r) {
+                // Reload on 'R' key
+                printf("Reloading...\n");
+                qjs_rasen_rerender(js_ctx, screen);
+            }
+            break;
+            
+        case SDL_WINDOWEVENT:
+            // Window was uncovered or resized: present again, nothing to upload
+            if (event->window.event == SDL_WINDOWEVENT_EXPOSED) {
+                frame_dirty = true;
+            }
+            break;
+    }
+    return true;
+}
+
+// Called from worker threads: SDL_PushEvent is thread-safe and ends the wait below
+static void wake_main_loop(void) {
+    SDL_Event event = { .type = SDL_USEREVENT };
+    SDL_PushEvent(&event);
+}
+
+// Interactive loop: runs until the window is closed or the script asks
+// for deep sleep. A non-zero stats_ms prints a runtime stats line at that
+// interval.
+static void run_interactive(lv_obj_t *screen, uint32_t stats_ms) {
+    printf("Simulator running. Close window to exit.\n");
+    
+    rasen_worker_set_wake(wake_main_loop);
+    
+    bool running = true;
+    uint32_t last_tick = SDL_GetTicks();
+    uint32_t last_stats = last_tick;
+    
+    while (running) {
+        // Update LVGL tick
+        uint32_t current_tick = SDL_GetTicks();
+        lv_tick_inc(current_tick - last_tick);
+        last_tick = current_tick;
+        
+        // Process JS events
+        qjs_rasen_process_events(js_ctx);
+        
+        uint32_t sleep_ms;
+        if (qjs_rasen_take_sleep_request(&sleep_ms)) {
+            printf("Deep sleep requested (%u ms), exiting\n", (unsigned)sleep_ms);
+            break;
+        }
+        
+        // Run LVGL task handler; returns the time until its next timer
+        rasen_stats_lvgl_begin();
+        uint32_t idle_ms = rasen_prof_timer_handler();
+        rasen_stats_lvgl_end();
+        
+        if (stats_ms && current_tick - last_stats >= stats_ms) {
+            char line[256];
+            rasen_stats_format_line(js_rt, line, sizeof(line));
+            printf("stats %s\n", line);
+            last_stats = current_tick;
+        }
+        
+        // Only upload and present when LVGL actually flushed something
+        if (frame_dirty) {
+            sdl_present();
+        }
+        
+        // Sleep until input arrives, the next LVGL timer or the next JS frame is due
+        uint32_t js_ms = qjs_rasen_next_work_ms(js_ctx);
+        if (js_ms < idle_ms) {
+            idle_ms = js_ms;
+        }
+        if (idle_ms > MAX_IDLE_MS) {
+            idle_ms = MAX_IDLE_MS;
+        }
+        if (stats_ms && idle_ms > stats_ms) {
+            idle_ms = stats_ms;
+        }
+        
+        // Collect cycles now rather than in the middle of the next frame
+        qjs_rasen_idle(js_ctx, idle_ms);
+        
+        SDL_Event event;
+        if (SDL_WaitEventTimeout(&event, (int)idle_ms)) {
+            do {
+                running = handle_sdl_event(&event, screen) && running;
+            } while (SDL_PollEvent(&event));
+        }
     }
 }
 
@@ -212,119 +565,176 @@ static void quickjs_cleanup(void) {
 
 static void print_usage(const char *prog) {
     printf("Rasen LVGL Simulator\n\n");
-    printf("Usage: %s <script.js>\n\n", prog);
+    printf("Usage: %s [options] <script.js | script.qjsbc | app.rasen>\n\n", prog);
+    printf("Options:\n");
+    printf("  --headless           Render without a window, on a virtual clock\n");
+    printf("  --frames <n>         Frames to run in headless mode (default 60)\n");
+    printf("  --frame-ms <ms>      Virtual time per frame (default %d)\n", LV_DISP_DEF_REFR_PERIOD);
+    printf("  --input <file>       Replay scripted input events (headless)\n");
+    printf("  --dump <dir>         Write every changed frame as PNG (headless)\n");
+    printf("  --screenshot <file>  Write the last frame as .png or .raw (headless)\n");
+    printf("  --stats <ms>         Print runtime stats at this interval\n");
+    printf("  --pool <n>           Removed widgets kept for reuse per type (default 16)\n");
+    printf("  --mount-slice <us>   Time per slice of the first mount, 0 = all at once (default 8000)\n");
+    printf("                       Ignored with --headless, which mounts in one go\n");
+    printf("  --snapshot <file>    Restore persist() refs from this file and save them on exit\n");
+    printf("  --profile <file>     Record a Chrome trace of the run (chrome://tracing, Perfetto)\n\n");
     printf("Example scripts:\n");
     printf("  Counter app:  %s examples/counter.js\n", prog);
     printf("  Hello world:  %s examples/hello.js\n", prog);
+    printf("  CI snapshot:  %s --headless --frames 10 --screenshot out.png examples/counter.js\n", prog);
 }
 
 int main(int argc, char *argv[]) {
-    if (argc < 2) {
+    const char *script_file = NULL;
+    bool headless = false;
+    uint32_t stats_ms = 0;
+    const char *snapshot_file = NULL;
+    bool profile = false;
+    headless_options_t opts = {
+        .frames = 60,
+        .frame_ms = LV_DISP_DEF_REFR_PERIOD,
+    };
+    
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(arg, "--headless") == 0) {
+            headless = true;
+        } else if (strcmp(arg, "--frames") == 0 && has_value) {
+            opts.frames = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--frame-ms") == 0 && has_value) {
+            opts.frame_ms = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--input") == 0 && has_value) {
+            opts.input_file = argv[++i];
+        } else if (strcmp(arg, "--dump") == 0 && has_value) {
+            opts.dump_dir = argv[++i];
+        } else if (strcmp(arg, "--screenshot") == 0 && has_value) {
+            opts.screenshot = argv[++i];
+        } else if (strcmp(arg, "--stats") == 0 && has_value) {
+            stats_ms = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--pool") == 0 && has_value) {
+            qjs_rasen_set_pool_cap(NULL, (uint32_t)strtoul(argv[++i], NULL, 10));
+        } else if (strcmp(arg, "--mount-slice") == 0 && has_value) {
+            qjs_rasen_set_mount_slice(0, (uint32_t)strtoul(argv[++i], NULL, 10));
+        } else if (strcmp(arg, "--snapshot") == 0 && has_value) {
+            snapshot_file = argv[++i];
+        } else if (strcmp(arg, "--profile") == 0 && has_value) {
+            profile_file = argv[++i];
+            profile = true;
+        } else if (arg[0] != '-' && !script_file) {
+            script_file = arg;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    
+    if (!script_file) {
         print_usage(argv[0]);
         return 1;
     }
     
-    const char *script_file = argv[1];
+    // A wall-clock slice would make the frame a mount finishes on depend on the host
+    if (headless) {
+        qjs_rasen_set_mount_slice(0, 0);
+    }
     
-    // Load script
-    char *script = load_file(script_file);
-    if (!script) {
-        return 1;
+    // Bytecode and app images from `rasen-lvgl build` are mapped, not copied
+    bool is_mapped = has_suffix(script_file, ".qjsbc") || has_suffix(script_file, ".rasen");
+    mapped_file_t mapped = {0};
+    char *script = NULL;
+    
+    if (is_mapped) {
+        if (map_file(script_file, &mapped) != 0) {
+            return 1;
+        }
+    } else {
+        script = load_file(script_file, NULL);
+        if (!script) {
+            return 1;
+        }
     }
     
     printf("Loading: %s\n", script_file);
     
-    // Initialize SDL
-    if (sdl_init() != 0) {
+    // Initialize the display: SDL window, or an in-memory framebuffer
+    int display_status;
+    if (headless) {
+        display_status = headless_init(DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    } else {
+        display_status = sdl_init();
+        if (display_status == 0) {
+            lvgl_init();
+        }
+    }
+    if (display_status != 0) {
+        if (!headless) sdl_cleanup();
         free(script);
+        unmap_file(&mapped);
         return 1;
     }
     
-    // Initialize LVGL
-    lvgl_init();
-    
     // Initialize QuickJS
     if (quickjs_init() != 0) {
-        sdl_cleanup();
+        if (headless) headless_cleanup(); else sdl_cleanup();
         free(script);
+        unmap_file(&mapped);
         return 1;
     }
     
+    rasen_prof_set_clock(profile_clock, SDL_GetPerformanceFrequency());
+    rasen_prof_set_dump(profile_dump);
+    if (profile) {
+        qjs_rasen_profile(js_ctx, true);
+    }
+    
+    // App images carry their own style and image tables
+    bool is_app_image = has_suffix(script_file, ".rasen");
+    char *styles = is_app_image ? NULL : load_sibling_table(script_file, ".tws", "styles", tw_style_table_load);
+    char *images = is_app_image ? NULL : load_sibling_table(script_file, ".rimg", "images", rasen_img_table_load);
+    
+    if (snapshot_file) {
+        restore_snapshot_file(js_ctx, snapshot_file);
+    }
+    
     // Render the script
     lv_obj_t *screen = lv_scr_act();
-    if (qjs_rasen_render(js_ctx, script, screen) != 0) {
+    int render_status = is_mapped
+        ? qjs_rasen_render_mapped(js_ctx, mapped.data, mapped.size, screen)
+        : qjs_rasen_render(js_ctx, script, screen);
+    if (render_status != 0) {
         printf("Render failed\n");
     }
     
     free(script);
     
-    // Main loop
-    printf("Simulator running. Close window to exit.\n");
-    
-    bool running = true;
-    uint32_t last_tick = SDL_GetTicks();
-    
-    while (running) {
-        // Handle SDL events
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            switch (event.type) {
-                case SDL_QUIT:
-                    running = false;
-                    break;
-                    
-                case SDL_MOUSEMOTION:
-                    mouse_x = event.motion.x;
-                    mouse_y = event.motion.y;
-                    break;
-                    
-                case SDL_MOUSEBUTTONDOWN:
-                    if (event.button.button == SDL_BUTTON_LEFT) {
-                        mouse_pressed = true;
-                    }
-                    break;
-                    
-                case SDL_MOUSEBUTTONUP:
-                    if (event.button.button == SDL_BUTTON_LEFT) {
-                        mouse_pressed = false;
-                    }
-                    break;
-                    
-                case SDL_KEYDOWN:
-                    if (event.key.keysym.sym == SDLK_r) {
-                        // Reload on 'R' key
-                        printf("Reloading...\n");
-                        qjs_rasen_rerender(js_ctx, screen);
-                    }
-                    break;
-            }
+    int exit_status = 0;
+    if (headless) {
+        if (render_status != 0 || headless_run(js_ctx, screen, &opts) != 0) {
+            exit_status = 1;
         }
-        
-        // Update LVGL tick
-        uint32_t current_tick = SDL_GetTicks();
-        lv_tick_inc(current_tick - last_tick);
-        last_tick = current_tick;
-        
-        // Process JS events
-        qjs_rasen_process_events(js_ctx);
-        
-        // Run LVGL task handler
-        lv_timer_handler();
-        
-        // Update SDL texture
-        SDL_UpdateTexture(texture, NULL, framebuffer, DISPLAY_WIDTH * sizeof(uint32_t));
-        SDL_RenderClear(renderer);
-        SDL_RenderCopy(renderer, texture, NULL, NULL);
-        SDL_RenderPresent(renderer);
-        
-        // Small delay
-        SDL_Delay(5);
+        if (stats_ms) {
+            char line[256];
+            rasen_stats_format_line(js_rt, line, sizeof(line));
+            printf("stats %s\n", line);
+        }
+    } else {
+        run_interactive(screen, stats_ms);
+    }
+    
+    if (snapshot_file && render_status == 0) {
+        save_snapshot_file(js_ctx, snapshot_file);
     }
     
     // Cleanup
+    qjs_rasen_profile(js_ctx, false);
     quickjs_cleanup();
-    sdl_cleanup();
+    if (headless) headless_cleanup(); else sdl_cleanup();
+    free(styles);
+    free(images);
+    unmap_file(&mapped);
     
     printf("Simulator closed.\n");
-    return 0;
+    return exit_status;
 }
@@ -0,0 +1,99 @@
+/**
+ * @file rasen_compile.c
+ * @brief Compile Rasen scripts to QuickJS bytecode (*.qjsbc)
+ *
+ * Host tool used by `rasen-lvgl build`. The output can only be loaded by
+ * a firmware built against the same QuickJS version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "quickjs.h"
+#include "../common/qjs_rasen.h"
+
+static char *load_file(const char *filename) {
+    FILE *f = fopen(filename, "rb");
+    if (!f) {
+        printf("Cannot open file: %s\n", filename);
+        return NULL;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    char *content = (char *)malloc(size + 1);
+    if (!content) {
+        fclose(f);
+        return NULL;
+    }
+
+    fread(content, 1, size, f);
+    content[size] = '\0';
+    fclose(f);
+
+    return content;
+}
+
+static int write_file(const char *filename, const uint8_t *data, size_t len) {
+    FILE *f = fopen(filename, "wb");
+    if (!f) {
+        printf("Cannot write file: %s\n", filename);
+        return -1;
+    }
+
+    size_t written = fwrite(data, 1, len, f);
+    fclose(f);
+    return written == len ? 0 : -1;
+}
+
+static void print_usage(const char *prog) {
+    printf("Rasen bytecode compiler\n\n");
+    printf("Usage:\n");
+    printf("  %s <script.js> <out.qjsbc>   Compile an application\n", prog);
+    printf("  %s --runtime <out.qjsbc>     Compile the built-in runtime\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    bool runtime = strcmp(argv[1], "--runtime") == 0;
+    const char *out_file = argv[2];
+
+    JSRuntime *rt = JS_NewRuntime();
+    JSContext *ctx = rt ? JS_NewContext(rt) : NULL;
+    if (!ctx) {
+        printf("Failed to create JS context\n");
+        return 1;
+    }
+
+    size_t len = 0;
+    uint8_t *bc = NULL;
+
+    if (runtime) {
+        bc = qjs_rasen_compile_runtime(ctx, &len);
+    } else {
+        char *script = load_file(argv[1]);
+        if (script) {
+            bc = qjs_rasen_compile(ctx, script, &len);
+            free(script);
+        }
+    }
+
+    int status = 1;
+    if (bc) {
+        if (write_file(out_file, bc, len) == 0) {
+            printf("Wrote %s (%zu bytes)\n", out_file, len);
+            status = 0;
+        }
+        js_free(ctx, bc);
+    }
+
+    JS_FreeContext(ctx);
+    JS_FreeRuntime(rt);
+    return status;
+}
@@ -20,10 +20,12 @@ import type { SyncComponent, PropValue, Mountable, Ref } from '@rasenjs/core'
 export interface LvglHost {
   /** Append a child element descriptor */
   appendChild(element: ElementDescriptor): void
-  /** Request a re-render */
+  /** Request a re-render; all requests within a frame cost one reconcile */
   requestRender(): void
+  /** Run fn after the next frame has patched the LVGL tree */
+  nextTick(fn?: () => void): Promise<void>
   /** Register event handler */
-  on(event: string, handler: () => void): () => void
+  on(event: string, handler: (event: LvglEvent) => void): () => void
 }
 
 /**
@@ -45,26 +47,73 @@ export type ElementType =
   | 'dropdown' // lv_dropdown - dropdown
   | 'table' // lv_table - table
   | 'chart' // lv_chart - chart
+  | 'list' // Virtual list - only visible rows are materialized
 
 /**
  * Element descriptor passed to the native runtime
  */
 export interface ElementDescriptor {
   type: ElementType
-  class: string
-  text?: string
+  class: string | number // Tailwind classes, or a style id precompiled by `rasen-lvgl build`
+  key?: string | number // Identity across re-renders (reconciler matching)
+  text?: string // For labels, checkboxes, textareas
+  placeholder?: string // For textareas
   src?: string // For images
-  value?: number // For sliders, arcs, bars
+  value?: number // Sliders, arcs, bars; checked (0/1) for switches and checkboxes; selected index
   min?: number
   max?: number
   options?: string[] // For dropdowns, rollers
+  points?: number // For charts: points per series
+  chartType?: number // For charts: 0 line, 1 bar
+  mode?: number // For charts: 0 shift, 1 circular
+  series?: number[] // For charts: one 0xRRGGBB color per series
+  stream?: ChartStream // For charts: receives the native handle
+  rows?: number // For tables: row count
+  cols?: number // For tables: column count
+  cells?: (string | number | null)[][] // For tables: cell texts, one array per row
+  count?: number // For lists: total rows
+  rowHeight?: number // For lists: fixed row pitch in px
+  overscan?: number // For lists: extra rows kept on each side of the view
+  render?: (index: number) => ElementDescriptor | null // For lists: row callback
   children?: ElementDescriptor[]
-  handlers?: Record<string, () => void>
+  handlers?: Record<string, (event: LvglEvent) => void> // click, long_press, change
+  bind?: ElementBindings
+  memo?: number // Stamp of the memo() result this descriptor belongs to
+}
+
+/**
+ * Argument of native event handlers
+ */
+export interface LvglEvent {
+  code: number // lv_event_code_t
+  x: number // Pointer position when the event fired
+  y: number
+  /** change events: the widget's value when the handler runs */
+  value?: number | boolean | string | TableCell | null
+}
+
+/**
+ * A table cell position; the value of a table's change event
+ */
+export interface TableCell {
+  row: number
+  col: number
+}
+
+/**
+ * Reactive sources the native runtime subscribes to directly.
+ * A change updates the single bound LVGL property without re-rendering.
+ */
+export interface ElementBindings {
+  text?: PropValue<string | number> // Label, checkbox or textarea text
+  value?: PropValue<number | boolean> // Bar, slider, arc value; checked; selected index
+  count?: PropValue<number> // Virtual list row count
 }
 
 // ============ Component Props ============
 
 export interface DivProps {
+  key?: string | number
   class?: PropValue<string>
   onClick?: () => void
   onLongPress?: () => void
@@ -72,6 +121,7 @@ export interface DivProps {
 }
 
 export interface LabelProps {
+  key?: string | number
   class?: PropValue<string>
   children: PropValue<string | number>
 }
@@ -82,6 +132,7 @@ export interface TextProps {
 }
 
 export interface ButtonProps {
+  key?: string | number
   class?: PropValue<string>
   onClick?: () => void
   onLongPress?: () => void
@@ -90,6 +141,7 @@ export interface ButtonProps {
 
 export interface ImageProps {
   class?: PropValue<string>
+  /** PNG path converted by `rasen-lvgl build`, or an LVGL path / symbol */
   src: PropValue<string>
   onClick?: () => void
 }
@@ -133,18 +185,45 @@ export interface ArcProps {
 }
 
 export interface BarProps {
+  key?: string | number
   class?: PropValue<string>
   value?: PropValue<number>
   min?: number
   max?: number
 }
 
+export interface VirtualListProps {
+  key?: string | number
+  class?: PropValue<string>
+  /** Total number of rows */
+  count: PropValue<number>
+  /** Fixed height of every row in px (default 32) */
+  rowHeight?: number
+  /** Rows kept alive above and below the view (default 2) */
+  overscan?: number
+  /** Called for each row as it scrolls into view */
+  renderRow: (index: number) => Mountable<LvglHost>
+}
+
 export interface SpinnerProps {
   class?: PropValue<string>
   speed?: number
   arcLength?: number
 }
 
+export interface ChartProps {
+  class?: PropValue<string>
+  points?: number // Points per series (default 100)
+  min?: number // Y range (default 0..100)
+  max?: number
+  type?: 'line' | 'bar'
+  /** shift scrolls old points out; circular overwrites in place (cheaper redraw) */
+  mode?: 'shift' | 'circular'
+  /** Number of series, or one color per series */
+  series?: number | (string | number)[]
+  stream?: ChartStream
+}
+
 export interface DropdownProps {
   class?: PropValue<string>
   options: PropValue<string[]>
@@ -159,15 +238,37 @@ export interface RollerProps {
   onChange?: (index: number) => void
 }
 
+export interface TableProps {
+  class?: PropValue<string>
+  /** One array of cell texts per row */
+  cells: PropValue<(string | number | null)[][]>
+  rows?: number // Defaults to cells.length
+  cols?: number // Defaults to the longest row
+  onChange?: (cell: TableCell | null) => void
+}
+
 // ============ Utility Functions ============
 
 function unrefValue<T>(value: PropValue<T>): T {
+  if (typeof value === 'function') {
+    return (value as () => T)()
+  }
   if (value && typeof value === 'object' && 'value' in value) {
     return (value as Ref<T>).value
   }
   return value as T
 }
 
+/**
+ * Whether a prop can change after mount (ref or getter) and should be bound
+ */
+function isReactive<T>(value: PropValue<T>): boolean {
+  return (
+    typeof value === 'function' ||
+    (!!value && typeof value === 'object' && 'value' in value)
+  )
+}
+
 // ============ Components (Three-Phase Pattern) ============
 
 /**
@@ -178,10 +279,9 @@ function createChildHost(parentDescriptor: ElementDescriptor): LvglHost {
     appendChild(element: ElementDescriptor) {
       parentDescriptor.children!.push(element)
     },
-    requestRender() {
-      // Propagates to root
-    },
-    on(_event: string, _handler: () => void) {
+    requestRender,
+    nextTick,
+    on(_event: string, _handler: (event: LvglEvent) => void) {
       // Event binding handled by native
       return () => {}
     }
@@ -205,6 +305,7 @@ export const div: SyncComponent<LvglHost, [DivProps]> = (props) => {
       children: [],
       handlers: {}
     }
+    if (props.key != null) descriptor.key = props.key
 
     const cleanups: (() => void)[] = []
 
@@ -249,6 +350,8 @@ export const label: SyncComponent<LvglHost, [LabelProps]> = (props) => {
       class: unrefValue(props.class) || '',
       text: String(unrefValue(props.children))
     }
+    if (props.key != null) descriptor.key = props.key
+    if (isReactive(props.children)) descriptor.bind = { text: props.children }
 
     host.appendChild(descriptor)
 
@@ -279,6 +382,7 @@ export const button: SyncComponent<LvglHost, [ButtonProps]> = (props) => {
       children: [],
       handlers: {}
     }
+    if (props.key != null) descriptor.key = props.key
 
     const cleanups: (() => void)[] = []
 
@@ -343,17 +447,18 @@ export const slider: SyncComponent<LvglHost, [SliderProps]> = (props) => {
     const descriptor: ElementDescriptor = {
       type: 'slider',
       class: unrefValue(props.class) || '',
-      value: unrefValue(props.value) ?? 0,
       min: props.min ?? 0,
       max: props.max ?? 100,
       handlers: {}
     }
+    // Without a value the slider is uncontrolled and keeps its own
+    if (props.value !== undefined) descriptor.value = unrefValue(props.value)
+    if (isReactive(props.value)) descriptor.bind = { value: props.value }
 
     const cleanups: (() => void)[] = []
 
     if (props.onChange) {
-      descriptor.handlers!.change = () =>
-        props.onChange!(unrefValue(props.value) ?? 0)
+      descriptor.handlers!.change = (e) => props.onChange!(e.value as number)
       cleanups.push(host.on('change', descriptor.handlers!.change))
     }
 
@@ -373,15 +478,15 @@ export const lvSwitch: SyncComponent<LvglHost, [SwitchProps]> = (props) => {
     const descriptor: ElementDescriptor = {
       type: 'switch',
       class: unrefValue(props.class) || '',
-      value: unrefValue(props.checked) ? 1 : 0,
       handlers: {}
     }
+    if (props.checked !== undefined) descriptor.value = unrefValue(props.checked) ? 1 : 0
+    if (isReactive(props.checked)) descriptor.bind = { value: props.checked }
 
     const cleanups: (() => void)[] = []
 
     if (props.onChange) {
-      descriptor.handlers!.change = () =>
-        props.onChange!(!unrefValue(props.checked))
+      descriptor.handlers!.change = (e) => props.onChange!(e.value as boolean)
       cleanups.push(host.on('change', descriptor.handlers!.change))
     }
 
@@ -401,16 +506,18 @@ export const checkbox: SyncComponent<LvglHost, [CheckboxProps]> = (props) => {
     const descriptor: ElementDescriptor = {
       type: 'checkbox',
       class: unrefValue(props.class) || '',
-      text: unrefValue(props.label) || '',
-      value: unrefValue(props.checked) ? 1 : 0,
+      bind: {},
       handlers: {}
     }
+    if (props.label !== undefined) descriptor.text = unrefValue(props.label)
+    if (isReactive(props.label)) descriptor.bind!.text = props.label
+    if (props.checked !== undefined) descriptor.value = unrefValue(props.checked) ? 1 : 0
+    if (isReactive(props.checked)) descriptor.bind!.value = props.checked
 
     const cleanups: (() => void)[] = []
 
     if (props.onChange) {
-      descriptor.handlers!.change = () =>
-        props.onChange!(!unrefValue(props.checked))
+      descriptor.handlers!.change = (e) => props.onChange!(e.value as boolean)
       cleanups.push(host.on('change', descriptor.handlers!.change))
     }
 
@@ -430,15 +537,16 @@ export const textarea: SyncComponent<LvglHost, [TextAreaProps]> = (props) => {
     const descriptor: ElementDescriptor = {
       type: 'textarea',
       class: unrefValue(props.class) || '',
-      text: unrefValue(props.value) || '',
       handlers: {}
     }
+    if (props.value !== undefined) descriptor.text = unrefValue(props.value)
+    if (isReactive(props.value)) descriptor.bind = { text: props.value }
+    if (props.placeholder !== undefined) descriptor.placeholder = unrefValue(props.placeholder)
 
     const cleanups: (() => void)[] = []
 
     if (props.onChange) {
-      descriptor.handlers!.change = () =>
-        props.onChange!(unrefValue(props.value) || '')
+      descriptor.handlers!.change = (e) => props.onChange!(e.value as string)
       cleanups.push(host.on('change', descriptor.handlers!.change))
     }
 
@@ -458,17 +566,17 @@ export const arc: SyncComponent<LvglHost, [ArcProps]> = (props) => {
     const descriptor: ElementDescriptor = {
       type: 'arc',
       class: unrefValue(props.class) || '',
-      value: unrefValue(props.value) ?? 0,
       min: props.min ?? 0,
       max: props.max ?? 100,
       handlers: {}
     }
+    if (props.value !== undefined) descriptor.value = unrefValue(props.value)
+    if (isReactive(props.value)) descriptor.bind = { value: props.value }
 
     const cleanups: (() => void)[] = []
 
     if (props.onChange) {
-      descriptor.handlers!.change = () =>
-        props.onChange!(unrefValue(props.value) ?? 0)
+      descriptor.handlers!.change = (e) => props.onChange!(e.value as number)
       cleanups.push(host.on('change', descriptor.handlers!.change))
     }
 
@@ -492,6 +600,40 @@ export const bar: SyncComponent<LvglHost, [BarProps]> = (props) => {
       min: props.min ?? 0,
       max: props.max ?? 100
     }
+    if (props.key != null) descriptor.key = props.key
+    if (isReactive(props.value)) descriptor.bind = { value: props.value }
+
+    host.appendChild(descriptor)
+
+    return () => {}
+  }
+}
+
+/**
+ * virtualList - Scrolling list that only materializes visible rows
+ *
+ * The native runtime keeps the rows in view plus overscan as live objects
+ * and recycles them while scrolling, so the row count is not limited by
+ * the LVGL heap. Rows are placed at a fixed `rowHeight` pitch.
+ */
+export const virtualList: SyncComponent<LvglHost, [VirtualListProps]> = (props) => {
+  return (host: LvglHost) => {
+    const render = (index: number): ElementDescriptor | null => {
+      const rowHost = createHost()
+      props.renderRow(index)(rowHost)
+      return rowHost.getElements()[0] || null
+    }
+
+    const descriptor: ElementDescriptor = {
+      type: 'list',
+      class: unrefValue(props.class) || '',
+      count: unrefValue(props.count) ?? 0,
+      rowHeight: props.rowHeight ?? 32,
+      overscan: props.overscan ?? 2,
+      render
+    }
+    if (props.key != null) descriptor.key = props.key
+    if (isReactive(props.count)) descriptor.bind = { count: props.count }
 
     host.appendChild(descriptor)
 
@@ -524,15 +666,15 @@ export const dropdown: SyncComponent<LvglHost, [DropdownProps]> = (props) => {
       type: 'dropdown',
       class: unrefValue(props.class) || '',
       options: unrefValue(props.options),
-      value: unrefValue(props.selected) ?? 0,
       handlers: {}
     }
+    if (props.selected !== undefined) descriptor.value = unrefValue(props.selected)
+    if (isReactive(props.selected)) descriptor.bind = { value: props.selected }
 
     const cleanups: (() => void)[] = []
 
     if (props.onChange) {
-      descriptor.handlers!.change = () =>
-        props.onChange!(unrefValue(props.selected) ?? 0)
+      descriptor.handlers!.change = (e) => props.onChange!(e.value as number)
       cleanups.push(host.on('change', descriptor.handlers!.change))
     }
 
@@ -553,15 +695,15 @@ export const roller: SyncComponent<LvglHost, [RollerProps]> = (props) => {
       type: 'roller',
       class: unrefValue(props.class) || '',
       options: unrefValue(props.options),
-      value: unrefValue(props.selected) ?? 0,
       handlers: {}
     }
+    if (props.selected !== undefined) descriptor.value = unrefValue(props.selected)
+    if (isReactive(props.selected)) descriptor.bind = { value: props.selected }
 
     const cleanups: (() => void)[] = []
 
     if (props.onChange) {
-      descriptor.handlers!.change = () =>
-        props.onChange!(unrefValue(props.selected) ?? 0)
+      descriptor.handlers!.change = (e) => props.onChange!(e.value as number)
       cleanups.push(host.on('change', descriptor.handlers!.change))
     }
 
@@ -573,6 +715,146 @@ export const roller: SyncComponent<LvglHost, [RollerProps]> = (props) => {
   }
 }
 
+/**
+ * table - Table component (lv_table)
+ */
+export const table: SyncComponent<LvglHost, [TableProps]> = (props) => {
+  return (host: LvglHost) => {
+    const cells = unrefValue(props.cells) || []
+    const descriptor: ElementDescriptor = {
+      type: 'table',
+      class: unrefValue(props.class) || '',
+      rows: props.rows ?? cells.length,
+      cols: props.cols ?? cells.reduce((n, row) => Math.max(n, row ? row.length : 0), 0),
+      cells,
+      handlers: {}
+    }
+
+    const cleanups: (() => void)[] = []
+
+    if (props.onChange) {
+      descriptor.handlers!.change = (e) => props.onChange!(e.value as TableCell | null)
+      cleanups.push(host.on('change', descriptor.handlers!.change))
+    }
+
+    host.appendChild(descriptor)
+
+    return () => {
+      cleanups.forEach((cleanup) => cleanup())
+    }
+  }
+}
+
+// ============ Charts ============
+
+const chartColors = [0x2196f3, 0xf44336, 0x4caf50, 0xff9800]
+
+function parseColor(color: string | number): number {
+  return typeof color === 'string' ? parseInt(color.replace('#', ''), 16) : color | 0
+}
+
+/**
+ * Handle for pushing samples into a mounted chart without rerendering
+ */
+export class ChartStream {
+  /** Native object handle, set when the chart is created (0 until then) */
+  node = 0
+
+  /**
+   * Append samples to a series; the oldest points scroll out
+   * Typed arrays (Float32/Float64/Int16/Int32) are read without copying.
+   * @returns false when the chart isn't mounted
+   */
+  push(series: number, samples: number | ArrayBufferView): boolean {
+    const native = nativeApi()
+    return native ? native.chartPush(this.node, series, samples) : false
+  }
+}
+
+export function chartStream(): ChartStream {
+  return new ChartStream()
+}
+
+/**
+ * chart - Streaming line/bar chart component (lv_chart)
+ */
+export const chart: SyncComponent<LvglHost, [ChartProps]> = (props) => {
+  return (host: LvglHost) => {
+    const series = props.series ?? 1
+    const colors =
+      typeof series === 'number'
+        ? Array.from({ length: series }, (_, i) => chartColors[i % chartColors.length])
+        : series.map(parseColor)
+
+    const descriptor: ElementDescriptor = {
+      type: 'chart',
+      class: unrefValue(props.class) || '',
+      points: props.points ?? 100,
+      min: props.min ?? 0,
+      max: props.max ?? 100,
+      chartType: props.type === 'bar' ? 1 : 0,
+      mode: props.mode === 'circular' ? 1 : 0,
+      series: colors
+    }
+    if (props.stream) descriptor.stream = props.stream
+
+    host.appendChild(descriptor)
+
+    return () => {}
+  }
+}
+
+// ============ Memo ============
+
+let memoStamp = 0
+
+function depsChanged(prev: unknown[] | null, next: unknown[]): boolean {
+  if (!prev || prev.length !== next.length) return true
+  return next.some((value, i) => value !== prev[i])
+}
+
+/**
+ * memo - Reuse a subtree until one of its dependencies changes
+ *
+ * `deps` lists refs, getters or plain values (or is a getter returning an
+ * array). While they compare equal (===), rerenders neither run the
+ * component nor diff its LVGL objects: the cached descriptors carry a
+ * stamp and the native reconciler leaves a subtree built from it alone.
+ * Bound refs inside still update their widgets. `component` is a
+ * mountable or a component returning one.
+ */
+export function memo(
+  component: LvglApp | (() => LvglApp),
+  deps: PropValue<unknown>[] | (() => unknown[])
+): LvglApp {
+  let last: unknown[] | null = null
+  let elements: ElementDescriptor[] = []
+  let unmount: (() => void) | null = null
+
+  return (host: LvglHost) => {
+    const next = typeof deps === 'function' ? deps() : deps.map((d) => unrefValue(d))
+
+    if (depsChanged(last, next)) {
+      unmount?.()
+      const memoHost = createHost()
+      const mountable = component.length ? (component as LvglApp) : (component as () => LvglApp)()
+      const result = mountable(memoHost)
+      unmount = typeof result === 'function' ? result : null
+      elements = memoHost.getElements()
+      const stamp = ++memoStamp
+      elements.forEach((element) => {
+        element.memo = stamp
+      })
+      last = next
+    }
+
+    elements.forEach((element) => host.appendChild(element))
+
+    // The cached subtree outlives the parent's remounts
+    return () => {}
+  }
+}
+
 // ============ App Runner ============
 
 export type LvglApp = Mountable<LvglHost>
@@ -590,10 +872,9 @@ function createHost(): LvglHost & { getElements(): ElementDescriptor[] } {
     appendChild(element: ElementDescriptor) {
       elements.push(element)
     },
-    requestRender() {
-      // Will be called by native runtime
-    },
-    on(_event: string, _handler: () => void) {
+    requestRender,
+    nextTick,
+    on(_event: string, _handler: (event: LvglEvent) => void) {
       // Event binding handled by native
       return () => {}
     },
@@ -634,6 +915,215 @@ function __rerender(): ElementDescriptor | null {
 // eslint-disable-next-line @typescript-eslint/no-explicit-any
 ;(globalThis as unknown as Record<string, unknown>).__rerender = __rerender
 
+// ============ Runtime Stats ============
+
+/**
+ * Counters kept by the native runtime (cumulative unless noted)
+ */
+export interface RuntimeStats {
+  objectsCreated: number
+  objectsDeleted: number
+  objectsLive: number
+  handlersLive: number
+  objectsPooled: number // Parked in the widget pool (counted in objectsLive)
+  poolReuses: number // Objects taken from the pool instead of created
+  rerenders: number
+  renderRequests: number // Handler runs and requestRender() calls (coalesced per frame)
+  rerenderCreated: number // Objects created by the last rerender
+  rerenderDeleted: number // Objects deleted by the last rerender
+  styleHits: number
+  styleMisses: number
+  jsUs: number
+  lvglUs: number
+  flushUs: number
+  eventsCoalesced: number // Value changes folded into one already queued
+  chartPoints: number // Samples appended through ChartStream.push()
+  memoSkips: number // memo() subtrees the reconciler left untouched
+  imageCacheHits: number // Compressed images opened from the decoded-image cache
+  imageCacheMisses: number // Compressed images decoded on open
+  imageCacheBytes: number // Decoded image bytes held now
+  mountSlices: number // Time slices spent building first mounts
+  gcRuns: number // Idle-time collections (qjs_rasen_idle)
+  gcUs: number
+  jsAllocsPooled: number // QuickJS allocations served by the size-class pools
+  jsAllocsSystem: number // QuickJS allocations that went to malloc
+  jsFrameAllocs: number // QuickJS allocations between the last two rerenders
+  lvHeapUsed: number
+  lvHeapPeak: number
+  jsHeapUsed: number
+  jsHeapPeak: number
+}
+
+/**
+ * Native helpers installed by the runtime as `__rasen`
+ */
+interface NativeApi {
+  stats(): RuntimeStats
+  requestRender(): void
+  requestFrame(): void
+  chartPush(node: number, series: number, samples: number | ArrayBufferView): boolean
+  imageCache(bytes: number): void
+  profile(on?: boolean): boolean
+  deepSleep(ms: number): void
+}
+
+function nativeApi(): NativeApi | undefined {
+  return (globalThis as unknown as Record<string, unknown>).__rasen as
+    | NativeApi
+    | undefined
+}
+
+/**
+ * stats - Read the native runtime counters (null outside the native runtime)
+ */
+export function stats(): RuntimeStats | null {
+  const native = nativeApi()
+  return native ? native.stats() : null
+}
+
+/**
+ * imageCache - Set the byte budget for decoded compressed images
+ *
+ * Images packed with `rasen-lvgl build --compress` are expanded on first
+ * use and kept until the budget forces the least recently used out.
+ * Uncompressed images are drawn from flash and don't count.
+ */
+export function imageCache(bytes: number): void {
+  nativeApi()?.imageCache(bytes)
+}
+
+/**
+ * profile - Start or stop recording a trace; returns whether it records
+ *
+ * Needs a runtime built with RASEN_PROFILE. Component mounts appear under
+ * the component's function name. Stopping writes the Chrome trace (the
+ * simulator's --profile file, the ESP32 console). Without `on`, only
+ * reports the state.
+ */
+export function profile(on?: boolean): boolean {
+  const native = nativeApi()
+  return native ? native.profile(on) : false
+}
+
+// ============ Scheduling ============
+
+/**
+ * requestRender - Schedule a rerender at the next frame
+ *
+ * Handlers already request one. Calls within the same LVGL refresh period
+ * are coalesced into a single reconcile.
+ */
+export function requestRender(): void {
+  nativeApi()?.requestRender()
+}
+
+/**
+ * nextTick - Resolve after the next frame has patched the LVGL tree
+ */
+export function nextTick(fn?: () => void): Promise<void> {
+  // The native runtime queues ticks behind its frame; elsewhere use a microtask
+  const g = globalThis as unknown as Record<string, unknown>
+  const runtimeNextTick = g.nextTick as ((fn?: () => void) => Promise<void>) | undefined
+  if (runtimeNextTick && runtimeNextTick !== nextTick) return runtimeNextTick(fn)
+  return Promise.resolve().then(fn)
+}
+
+// ============ Deep Sleep ============
+
+const __persisted = new Map<string, Ref<unknown>>()
+
+function restoredState(): Record<string, unknown> | null {
+  const state = (globalThis as unknown as Record<string, unknown>).__restored
+  return state && typeof state === 'object' ? (state as Record<string, unknown>) : null
+}
+
+/**
+ * persist - Keep a ref's value across deep sleep
+ *
+ * The value is saved by deepSleep() and assigned back to the ref when the
+ * app starts again after waking. Only plain data survives the snapshot.
+ */
+export function persist<T>(key: string, source: Ref<T>): Ref<T> {
+  const state = restoredState()
+  if (state && Object.prototype.hasOwnProperty.call(state, key)) {
+    source.value = state[key] as T
+  }
+  __persisted.set(key, source as Ref<unknown>)
+  return source
+}
+
+/**
+ * restored - Whether this start resumed from a snapshot
+ *
+ * Lets the app skip first-boot work (network setup, splash) on wake.
+ */
+export function restored(): boolean {
+  return restoredState() !== null
+}
+
+/**
+ * deepSleep - Snapshot the persisted refs and power down
+ *
+ * Wakes after `ms`, or on the next touch when 0. Everything not passed
+ * to persist() starts from scratch; the compiled app itself is mapped
+ * from flash again, so resuming costs one render.
+ */
+export function deepSleep(ms = 0): void {
+  nativeApi()?.deepSleep(ms)
+}
+
+/**
+ * Snapshot hook - called by the native runtime before sleeping
+ */
+function __snapshot(): Record<string, unknown> {
+  const out: Record<string, unknown> = {}
+  __persisted.forEach((source, key) => {
+    out[key] = source.value
+  })
+  return out
+}
+
+;(globalThis as unknown as Record<string, unknown>).__snapshot = __snapshot
+
+// ============ Workers ============
+
+export interface WorkerOptions {
+  memoryLimit?: number // JS heap limit in bytes (native default when omitted)
+}
+
+/**
+ * A script running in its own JS runtime and thread
+ *
+ * Messages are copied, so only plain data (objects, arrays, strings,
+ * numbers, typed arrays) can be posted. Replies are delivered between
+ * frames, like LVGL events.
+ */
+export interface RasenWorker {
+  onmessage: ((event: { data: unknown }) => void) | null
+  postMessage(data: unknown): void
+  terminate(): void
+}
+
+/**
+ * createWorker - Start a worker from source text or a self-contained function
+ *
+ * A function is stringified and run in the worker, so it must not close
+ * over anything; inside it use the globals `postMessage` and `onmessage`.
+ */
+export function createWorker(
+  source: string | (() => void),
+  options?: WorkerOptions
+): RasenWorker {
+  const g = globalThis as unknown as Record<string, unknown>
+  const RuntimeWorker = g.Worker as
+    | (new (source: string | (() => void), options?: WorkerOptions) => RasenWorker)
+    | undefined
+  if (!RuntimeWorker || !nativeApi()) {
+    throw new Error('createWorker: workers need the native runtime')
+  }
+  return new RuntimeWorker(source, options)
+}
+
 /**
  * run - Start a LVGL application
  */